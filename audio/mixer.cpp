@@ -27,6 +27,7 @@
 #include "common/textconsole.h"
 
 #include "audio/mixer_intern.h"
+#include "audio/mixer_kernels.h"
 #include "audio/rate.h"
 #include "audio/audiostream.h"
 #include "audio/timestamp.h"
@@ -48,20 +49,20 @@ public:
 	~Channel();
 
 	/**
-	 * Mixes the channel's samples into the given buffer.
+	 * Mixes the channel's samples into the given accumulator.
 	 *
-	 * @param data buffer where to mix the data
-	 * @param len  number of sample *pairs*. So a value of
-	 *             10 means that the buffer contains twice 10 sample, each
-	 *             16 bits, for a total of 40 bytes.
+	 * @param acc     accumulator where to mix the data, see accumulateStereo()
+	 * @param scratch buffer for the resampled data, at least as big as acc
+	 * @param len     number of sample *pairs*. So a value of
+	 *                10 means that the buffers contain twice 10 samples.
 	 * @return number of sample pairs processed (which can still be silence!)
 	 */
-	int mix(int16 *data, uint len);
+	int mix(int32 *acc, int16 *scratch, uint len);
 
 	/**
 	 * Queries whether the channel is still playing or not.
 	 */
-	bool isFinished() const { return _stream->endOfStream(); }
+	bool isFinished() const { return _stream->endOfStream() && !_converter->needsDrain(); }
 
 	/**
 	 * Queries whether the channel is a permanent channel.
@@ -229,13 +230,16 @@ void MixerImpl::playStream(
 			DisposeAfterUse::Flag autofreeStream,
 			bool permanent,
 			bool reverseStereo) {
-	Common::StackLock lock(_mutex);
-
 	if (stream == 0) {
 		warning("stream is 0");
 		return;
 	}
 
+	// Do the expensive part of creating the rate converter before locking
+	prepareRateConverter(stream->getRate(), getOutputRate());
+
+	Common::StackLock lock(_mutex);
+
 
 	assert(_mixerReady);
 
@@ -269,8 +273,6 @@ void MixerImpl::playStream(
 int MixerImpl::mixCallback(byte *samples, uint len) {
 	assert(samples);
 
-	Common::StackLock lock(_mutex);
-
 	int16 *buf = (int16 *)samples;
 	// we store stereo, 16-bit samples
 	assert(len % 4 == 0);
@@ -279,24 +281,48 @@ int MixerImpl::mixCallback(byte *samples, uint len) {
 	// Since the mixer callback has been called, the mixer must be ready...
 	_mixerReady = true;
 
-	//  zero the buf
-	memset(buf, 0, 2 * len * sizeof(int16));
+	// Mix in blocks, so the lock is never held for a whole buffer and
+	// engine threads starting or stopping sounds wait for one block at most
+	int res = 0;
+	while (len > 0) {
+		const uint blockLen = MIN<uint>(len, kMixBlockSize);
+		res += mixBlock(buf, blockLen);
+		buf += blockLen * 2;
+		len -= blockLen;
+	}
+
+	return res;
+}
+
+int MixerImpl::mixBlock(int16 *buf, uint len) {
+	Common::StackLock lock(_mutex);
+
+	// zero the accumulator
+	memset(_mixAccumulator, 0, 2 * len * sizeof(int32));
 
 	// mix all channels
 	int res = 0, tmp;
+	bool mixed = false;
 	for (int i = 0; i != NUM_CHANNELS; i++)
 		if (_channels[i]) {
 			if (_channels[i]->isFinished()) {
 				delete _channels[i];
 				_channels[i] = 0;
 			} else if (!_channels[i]->isPaused()) {
-				tmp = _channels[i]->mix(buf, len);
+				tmp = _channels[i]->mix(_mixAccumulator, _mixScratch, len);
+				mixed = true;
 
 				if (tmp > res)
 					res = tmp;
 			}
 		}
 
+	// saturate once, after all channels have been summed up
+	if (mixed)
+		saturateStereo(buf, _mixAccumulator, len);
+	else
+		memset(buf, 0, 2 * len * sizeof(int16));
+
 	return res;
 }
 
@@ -607,18 +633,29 @@ Timestamp Channel::getElapsedTime() {
 	return ts;
 }
 
-int Channel::mix(int16 *data, uint len) {
+int Channel::mix(int32 *acc, int16 *scratch, uint len) {
 	assert(_stream);
 
 	int res = 0;
 	if (_stream->endOfData()) {
-		// TODO: call drain method
+		// Mix what the converter holds for the last samples of the stream
+		if (_stream->endOfStream() && _converter->needsDrain()) {
+			memset(scratch, 0, len * 2 * sizeof(int16));
+			res = _converter->drain(scratch, len, Mixer::kMaxMixerVolume);
+			if (_volL || _volR)
+				accumulateStereo(acc, scratch, res, _volL, _volR);
+		}
 	} else {
 		assert(_converter);
 		_samplesConsumed = _samplesDecoded;
 		_mixerTimeStamp = g_system->getMillis(true);
 		_pauseTime = 0;
-		res = _converter->flow(*_stream, data, len, _volL, _volR);
+
+		// The converter only resamples here. Volume and balance are applied
+		// while accumulating, and a muted channel still consumes its stream.
+		res = _converter->resample(*_stream, scratch, len);
+		if (_volL || _volR)
+			accumulateStereo(acc, scratch, res, _volL, _volR);
 		_samplesDecoded += res;
 	}
 
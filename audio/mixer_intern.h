@@ -51,7 +51,10 @@ namespace Audio {
 class MixerImpl : public Mixer {
 private:
 	enum {
-		NUM_CHANNELS = 16
+		NUM_CHANNELS = 16,
+
+		/** Number of sample pairs mixed under one hold of _mutex */
+		kMixBlockSize = 256
 	};
 
 	Common::Mutex _mutex;
@@ -70,6 +73,11 @@ private:
 	SoundTypeSettings _soundTypeSettings[4];
 	Channel *_channels[NUM_CHANNELS];
 
+	/** The sum of all channels of the current block, at full precision */
+	int32 _mixAccumulator[kMixBlockSize * 2];
+	/** The resampled output of one channel, before volume and balance */
+	int16 _mixScratch[kMixBlockSize * 2];
+
 
 public:
 
@@ -121,6 +129,13 @@ public:
 protected:
 	void insertChannel(SoundHandle *handle, Channel *chan);
 
+	/**
+	 * Mix one block of at most kMixBlockSize sample pairs.
+	 *
+	 * @return number of sample pairs processed (which can still be silence!)
+	 */
+	int mixBlock(int16 *buf, uint len);
+
 public:
 	/**
 	 * The mixer callback function, to be called at regular intervals by
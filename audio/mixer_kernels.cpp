@@ -0,0 +1,129 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "audio/mixer_kernels.h"
+#include "audio/mixer.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define USE_SSE2_MIXER
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define USE_NEON_MIXER
+#endif
+
+namespace Audio {
+
+/**
+ * Volumes are fixed point with Mixer::kMaxMixerVolume as one, so the
+ * accumulator is brought back to sample range by this shift.
+ */
+enum {
+	kVolumeShift = 8
+};
+
+void accumulateStereo(int32 *acc, const int16 *src, uint frames, uint16 volL, uint16 volR) {
+	assert((1 << kVolumeShift) == Mixer::kMaxMixerVolume);
+
+	uint n = frames * 2;
+
+#if defined(USE_SSE2_MIXER)
+	// The volumes fit into 16 bits, so the full products are assembled from
+	// the low and high halves of a 16x16 bit multiplication.
+	const __m128i vol = _mm_set_epi16(volR, volL, volR, volL, volR, volL, volR, volL);
+	while (n >= 8) {
+		const __m128i s = _mm_loadu_si128((const __m128i *)src);
+		const __m128i lo = _mm_mullo_epi16(s, vol);
+		const __m128i hi = _mm_mulhi_epi16(s, vol);
+		const __m128i a0 = _mm_loadu_si128((const __m128i *)acc);
+		const __m128i a1 = _mm_loadu_si128((const __m128i *)(acc + 4));
+		_mm_storeu_si128((__m128i *)acc, _mm_add_epi32(a0, _mm_unpacklo_epi16(lo, hi)));
+		_mm_storeu_si128((__m128i *)(acc + 4), _mm_add_epi32(a1, _mm_unpackhi_epi16(lo, hi)));
+		src += 8;
+		acc += 8;
+		n -= 8;
+	}
+#elif defined(USE_NEON_MIXER)
+	const int16 volumes[4] = { (int16)volL, (int16)volR, (int16)volL, (int16)volR };
+	const int16x4_t vol = vld1_s16(volumes);
+	while (n >= 8) {
+		const int16x8_t s = vld1q_s16(src);
+		vst1q_s32(acc, vmlal_s16(vld1q_s32(acc), vget_low_s16(s), vol));
+		vst1q_s32(acc + 4, vmlal_s16(vld1q_s32(acc + 4), vget_high_s16(s), vol));
+		src += 8;
+		acc += 8;
+		n -= 8;
+	}
+#endif
+
+	for (; n >= 2; n -= 2) {
+		acc[0] += src[0] * (int32)volL;
+		acc[1] += src[1] * (int32)volR;
+		src += 2;
+		acc += 2;
+	}
+}
+
+void saturateStereo(int16 *dst, const int32 *acc, uint frames) {
+	uint n = frames * 2;
+
+#if defined(USE_SSE2_MIXER)
+	while (n >= 8) {
+		const __m128i a0 = _mm_srai_epi32(_mm_loadu_si128((const __m128i *)acc), kVolumeShift);
+		const __m128i a1 = _mm_srai_epi32(_mm_loadu_si128((const __m128i *)(acc + 4)), kVolumeShift);
+		__m128i out = _mm_packs_epi32(a0, a1);
+#ifdef OUTPUT_UNSIGNED_AUDIO
+		out = _mm_xor_si128(out, _mm_set1_epi16((int16)0x8000));
+#endif
+		_mm_storeu_si128((__m128i *)dst, out);
+		acc += 8;
+		dst += 8;
+		n -= 8;
+	}
+#elif defined(USE_NEON_MIXER)
+	while (n >= 8) {
+		int16x8_t out = vcombine_s16(vqshrn_n_s32(vld1q_s32(acc), kVolumeShift), vqshrn_n_s32(vld1q_s32(acc + 4), kVolumeShift));
+#ifdef OUTPUT_UNSIGNED_AUDIO
+		out = veorq_s16(out, vdupq_n_s16((int16)0x8000));
+#endif
+		vst1q_s16(dst, out);
+		acc += 8;
+		dst += 8;
+		n -= 8;
+	}
+#endif
+
+	for (; n > 0; --n) {
+		int32 val = *acc++ >> kVolumeShift;
+		if (val > 32767)
+			val = 32767;
+		else if (val < -32768)
+			val = -32768;
+#ifdef OUTPUT_UNSIGNED_AUDIO
+		*dst++ = (int16)val ^ 0x8000;
+#else
+		*dst++ = val;
+#endif
+	}
+}
+
+} // End of namespace Audio
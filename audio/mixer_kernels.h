@@ -0,0 +1,66 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef AUDIO_MIXER_KERNELS_H
+#define AUDIO_MIXER_KERNELS_H
+
+#include "common/scummsys.h"
+
+namespace Audio {
+
+/**
+ * @name Block mixing kernels
+ *
+ * Block based mixing sums the channels into a 32 bit accumulator and
+ * saturates once at the end, instead of clamping after every channel
+ * like clampedAdd() does. All buffers hold interleaved stereo frames.
+ * SSE2 and NEON versions are used where the compiler targets them.
+ * @{
+ */
+
+/**
+ * Add a block of samples to the accumulator, scaling the left and right
+ * samples by the given volumes.
+ *
+ * @param acc     the accumulator
+ * @param src     the samples to add
+ * @param frames  the number of stereo frames
+ * @param volL    the volume of the left channel, 0 to Mixer::kMaxMixerVolume
+ * @param volR    the volume of the right channel, 0 to Mixer::kMaxMixerVolume
+ */
+void accumulateStereo(int32 *acc, const int16 *src, uint frames, uint16 volL, uint16 volR);
+
+/**
+ * Scale the accumulator down by Mixer::kMaxMixerVolume and store it with
+ * saturation.
+ *
+ * @param dst     the output samples
+ * @param acc     the accumulator
+ * @param frames  the number of stereo frames
+ */
+void saturateStereo(int16 *dst, const int32 *acc, uint frames);
+
+/** @} */
+
+} // End of namespace Audio
+
+#endif
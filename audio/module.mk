@@ -13,9 +13,11 @@ MODULE_OBJS := \
 	miles_adlib.o \
 	miles_mt32.o \
 	mixer.o \
+	mixer_kernels.o \
 	mpu401.o \
 	musicplugin.o \
 	null.o \
+	rate_sinc.o \
 	timestamp.o \
 	decoders/3do.o \
 	decoders/aac.o \
@@ -31,6 +31,7 @@
 #include "audio/audiostream.h"
 #include "audio/rate.h"
 #include "audio/mixer.h"
+#include "common/config-manager.h"
 #include "common/frac.h"
 #include "common/textconsole.h"
 #include "common/util.h"
@@ -57,6 +58,24 @@ enum {
 	FRAC_HALF_LOW = (1L << (FRAC_BITS_LOW-1))
 };
 
+/**
+ * Write one output frame: scaled and mixed into the output for flow(), or
+ * stored as is for resample().
+ */
+template<bool scale, bool reverseStereo>
+static inline void outputFrame(st_sample_t *obuf, st_sample_t out0, st_sample_t out1, st_volume_t vol_l, st_volume_t vol_r) {
+	if (scale) {
+		// output left channel
+		clampedAdd(obuf[reverseStereo    ], (out0 * (int)vol_l) / Audio::Mixer::kMaxMixerVolume);
+
+		// output right channel
+		clampedAdd(obuf[reverseStereo ^ 1], (out1 * (int)vol_r) / Audio::Mixer::kMaxMixerVolume);
+	} else {
+		obuf[reverseStereo    ] = out0;
+		obuf[reverseStereo ^ 1] = out1;
+	}
+}
+
 /**
  * Audio rate converter based on simple resampling. Used when no
  * interpolation is required.
@@ -77,9 +96,17 @@ protected:
 	/** fractional position increment in the output stream */
 	long opos_inc;
 
+	template<bool scale>
+	int process(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r);
+
 public:
 	SimpleRateConverter(st_rate_t inrate, st_rate_t outrate);
-	int flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r);
+	int flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
+		return process<true>(input, obuf, osamp, vol_l, vol_r);
+	}
+	int resample(AudioStream &input, st_sample_t *obuf, st_size_t osamp) {
+		return process<false>(input, obuf, osamp, 0, 0);
+	}
 	int drain(st_sample_t *obuf, st_size_t osamp, st_volume_t vol) {
 		return ST_SUCCESS;
 	}
@@ -112,7 +139,8 @@ SimpleRateConverter<stereo, reverseStereo>::SimpleRateConverter(st_rate_t inrate
  * Return number of sample pairs processed.
  */
 template<bool stereo, bool reverseStereo>
-int SimpleRateConverter<stereo, reverseStereo>::flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
+template<bool scale>
+int SimpleRateConverter<stereo, reverseStereo>::process(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
 	st_sample_t *ostart, *oend;
 
 	ostart = obuf;
@@ -143,11 +171,7 @@ int SimpleRateConverter<stereo, reverseStereo>::flow(AudioStream &input, st_samp
 		// Increment output position
 		opos += opos_inc;
 
-		// output left channel
-		clampedAdd(obuf[reverseStereo    ], (out0 * (int)vol_l) / Audio::Mixer::kMaxMixerVolume);
-
-		// output right channel
-		clampedAdd(obuf[reverseStereo ^ 1], (out1 * (int)vol_r) / Audio::Mixer::kMaxMixerVolume);
+		outputFrame<scale, reverseStereo>(obuf, out0, out1, vol_l, vol_r);
 
 		obuf += 2;
 	}
@@ -183,9 +207,17 @@ protected:
 	/** current sample(s) in the input stream (left/right channel) */
 	st_sample_t icur0, icur1;
 
+	template<bool scale>
+	int process(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r);
+
 public:
 	LinearRateConverter(st_rate_t inrate, st_rate_t outrate);
-	int flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r);
+	int flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
+		return process<true>(input, obuf, osamp, vol_l, vol_r);
+	}
+	int resample(AudioStream &input, st_sample_t *obuf, st_size_t osamp) {
+		return process<false>(input, obuf, osamp, 0, 0);
+	}
 	int drain(st_sample_t *obuf, st_size_t osamp, st_volume_t vol) {
 		return ST_SUCCESS;
 	}
@@ -221,7 +253,8 @@ LinearRateConverter<stereo, reverseStereo>::LinearRateConverter(st_rate_t inrate
  * Return number of sample pairs processed.
  */
 template<bool stereo, bool reverseStereo>
-int LinearRateConverter<stereo, reverseStereo>::flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
+template<bool scale>
+int LinearRateConverter<stereo, reverseStereo>::process(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
 	st_sample_t *ostart, *oend;
 
 	ostart = obuf;
@@ -258,11 +291,7 @@ int LinearRateConverter<stereo, reverseStereo>::flow(AudioStream &input, st_samp
 						  (st_sample_t)(ilast1 + (((icur1 - ilast1) * opos + FRAC_HALF_LOW) >> FRAC_BITS_LOW)) :
 						  out0);
 
-			// output left channel
-			clampedAdd(obuf[reverseStereo    ], (out0 * (int)vol_l) / Audio::Mixer::kMaxMixerVolume);
-
-			// output right channel
-			clampedAdd(obuf[reverseStereo ^ 1], (out1 * (int)vol_r) / Audio::Mixer::kMaxMixerVolume);
+			outputFrame<scale, reverseStereo>(obuf, out0, out1, vol_l, vol_r);
 
 			obuf += 2;
 
@@ -284,13 +313,9 @@ template<bool stereo, bool reverseStereo>
 class CopyRateConverter : public RateConverter {
 	st_sample_t *_buffer;
 	st_size_t _bufferSize;
-public:
-	CopyRateConverter() : _buffer(0), _bufferSize(0) {}
-	~CopyRateConverter() {
-		free(_buffer);
-	}
 
-	virtual int flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
+	template<bool scale>
+	int process(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
 		assert(input.isStereo() == stereo);
 
 		st_sample_t *ptr;
@@ -321,17 +346,31 @@ public:
 			out0 = *ptr++;
 			out1 = (stereo ? *ptr++ : out0);
 
-			// output left channel
-			clampedAdd(obuf[reverseStereo    ], (out0 * (int)vol_l) / Audio::Mixer::kMaxMixerVolume);
-
-			// output right channel
-			clampedAdd(obuf[reverseStereo ^ 1], (out1 * (int)vol_r) / Audio::Mixer::kMaxMixerVolume);
+			outputFrame<scale, reverseStereo>(obuf, out0, out1, vol_l, vol_r);
 
 			obuf += 2;
 		}
 		return (obuf - ostart) / 2;
 	}
 
+public:
+	CopyRateConverter() : _buffer(0), _bufferSize(0) {}
+	~CopyRateConverter() {
+		free(_buffer);
+	}
+
+	virtual int flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
+		return process<true>(input, obuf, osamp, vol_l, vol_r);
+	}
+
+	virtual int resample(AudioStream &input, st_sample_t *obuf, st_size_t osamp) {
+		// Stereo input is already in the output layout
+		if (stereo && !reverseStereo)
+			return MAX(input.readBuffer(obuf, osamp * 2), 0) / 2;
+
+		return process<false>(input, obuf, osamp, 0, 0);
+	}
+
 	virtual int drain(st_sample_t *obuf, st_size_t osamp, st_volume_t vol) {
 		return ST_SUCCESS;
 	}
@@ -357,6 +396,12 @@ RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate) {
  * Create and return a RateConverter object for the specified input and output rates.
  */
 RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate, bool stereo, bool reverseStereo) {
+	if (inrate != outrate && ConfMan.hasKey("resampler") && ConfMan.get("resampler") == "sinc") {
+		RateConverter *converter = makeSincRateConverter(inrate, outrate, stereo, reverseStereo);
+		if (converter)
+			return converter;
+	}
+
 	if (stereo) {
 		if (reverseStereo)
 			return makeRateConverter<true, true>(inrate, outrate);
@@ -24,6 +24,7 @@
 #define AUDIO_RATE_H
 
 #include "common/scummsys.h"
+#include "audio/mixer.h"
 
 namespace Audio {
 
@@ -75,11 +76,51 @@ public:
 	 */
 	virtual int flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) = 0;
 
+	/**
+	 * Like flow(), but the output buffer is overwritten with the unscaled
+	 * samples instead of being mixed into. Used by the block mixer, which
+	 * applies the volume itself.
+	 *
+	 * @return Number of sample pairs written into the buffer.
+	 */
+	virtual int resample(AudioStream &input, st_sample_t *obuf, st_size_t osamp) {
+		memset(obuf, 0, osamp * 2 * sizeof(st_sample_t));
+		return flow(input, obuf, osamp, Mixer::kMaxMixerVolume, Mixer::kMaxMixerVolume);
+	}
+
 	virtual int drain(st_sample_t *obuf, st_size_t osamp, st_volume_t vol) = 0;
+
+	/**
+	 * Whether the converter still holds output for input it has already
+	 * read. Once the stream has ended, drain() mixes that output into the
+	 * buffer like flow() does.
+	 */
+	virtual bool needsDrain() const { return false; }
 };
 
+/**
+ * Create a rate converter. The "resampler" config key selects between
+ * "linear" interpolation (the default) and "sinc".
+ */
 RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate, bool stereo, bool reverseStereo = false);
 
+/**
+ * Build the data makeRateConverter() needs for the given rates, if it is
+ * not there yet. The filter tables of the sinc converter are shared and
+ * take a while to build, so the mixer calls this before it takes the lock
+ * the audio callback waits for.
+ */
+void prepareRateConverter(st_rate_t inrate, st_rate_t outrate);
+
+/**
+ * Create a polyphase windowed sinc rate converter, regardless of the
+ * configuration. The rates must differ.
+ *
+ * @return the converter, or 0 if the ratio of the rates needs too many
+ *         filter phases
+ */
+RateConverter *makeSincRateConverter(st_rate_t inrate, st_rate_t outrate, bool stereo, bool reverseStereo = false);
+
 } // End of namespace Audio
 
 #endif
@@ -44,6 +44,7 @@
 #include "audio/audiostream.h"
 #include "audio/rate.h"
 #include "audio/mixer.h"
+#include "common/config-manager.h"
 #include "common/util.h"
 #include "common/textconsole.h"
 
@@ -448,6 +449,12 @@ public:
  * Create and return a RateConverter object for the specified input and output rates.
  */
 RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate, bool stereo, bool reverseStereo) {
+	if (inrate != outrate && ConfMan.hasKey("resampler") && ConfMan.get("resampler") == "sinc") {
+		RateConverter *converter = makeSincRateConverter(inrate, outrate, stereo, reverseStereo);
+		if (converter)
+			return converter;
+	}
+
 	if (inrate != outrate) {
 		if ((inrate % outrate) == 0 && (inrate < 65536)) {
 			if (stereo) {
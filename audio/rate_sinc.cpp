@@ -0,0 +1,413 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+/*
+ * Windowed sinc rate converter.
+ *
+ * The conversion ratio is reduced to outrate/inrate = L/M, and the low pass
+ * filter is split into L phases of kTaps coefficients each, one for every
+ * position an output sample can have between two input samples. Every
+ * output sample is then a single dot product of the input history with one
+ * precomputed phase. Floating point is only used to build the table.
+ *
+ * The tables are shared by all converters for the same pair of rates and
+ * kept until the end of the process, since building one takes too long to
+ * do for every sound that starts playing.
+ */
+
+#include "audio/audiostream.h"
+#include "audio/rate.h"
+#include "audio/mixer.h"
+#include "common/algorithm.h"
+#include "common/array.h"
+#include "common/config-manager.h"
+#include "common/mutex.h"
+#include "common/singleton.h"
+#include "common/system.h"
+#include "common/textconsole.h"
+#include "common/util.h"
+
+#include <math.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define USE_SSE2_RATE
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define USE_NEON_RATE
+#endif
+
+namespace Audio {
+
+enum {
+	/** Filter length in input samples */
+	kTaps = 32,
+
+	/** Fixed point precision of the coefficients */
+	kCoeffBits = 14,
+
+	/**
+	 * Ratios which do not reduce to at most this many phases are left to
+	 * the linear converter.
+	 */
+	kMaxPhases = 1024,
+
+	/** The size of the intermediate input cache */
+	kInputBufferSize = 512,
+
+	/**
+	 * Silent input samples pushed through the filter at the end of a
+	 * stream. The output lags the input by half the filter length, and
+	 * the other half lets it ring out instead of stopping with a click.
+	 */
+	kFlushSamples = kTaps
+};
+
+/** Kaiser window shape, for about 60 dB of stopband attenuation */
+static const double kKaiserBeta = 6.0;
+
+/** The passband ends this far below the Nyquist frequency of the lower rate */
+static const double kPassband = 0.90;
+
+/** Zeroth order modified Bessel function of the first kind */
+static double besselI0(double x) {
+	double sum = 1.0, term = 1.0;
+	for (int k = 1; k < 32; ++k) {
+		term *= (x / (2 * k)) * (x / (2 * k));
+		sum += term;
+		if (term < sum * 1e-12)
+			break;
+	}
+	return sum;
+}
+
+/**
+ * Compute the coefficients of all phases. Phase p produces the output
+ * sample p/L input samples after the center of the history window; each
+ * phase is normalized to unity gain at DC.
+ */
+static int16 *makeSincTable(uint phases, st_rate_t inrate, st_rate_t outrate) {
+	int16 *table = new int16[phases * kTaps];
+
+	// Cutoff in cycles per input sample, below the lower Nyquist frequency
+	const double cutoff = 0.5 * kPassband * MIN<double>(1.0, (double)outrate / inrate);
+	const double windowNorm = besselI0(kKaiserBeta);
+	const double center = kTaps / 2 - 1;
+
+	for (uint p = 0; p < phases; ++p) {
+		double h[kTaps];
+		double sum = 0.0;
+
+		for (int k = 0; k < kTaps; ++k) {
+			const double x = center - k + (double)p / phases;
+			const double sinc = (x == 0.0) ? 2 * cutoff : sin(2 * M_PI * cutoff * x) / (M_PI * x);
+			const double w = x / (kTaps / 2);
+			const double window = (fabs(w) < 1.0) ? besselI0(kKaiserBeta * sqrt(1.0 - w * w)) / windowNorm : 0.0;
+			h[k] = sinc * window;
+			sum += h[k];
+		}
+
+		// Quantize, and put the rounding error into the largest tap so
+		// every phase sums up to exactly one
+		int16 *c = table + p * kTaps;
+		int total = 0, largest = 0;
+		for (int k = 0; k < kTaps; ++k) {
+			c[k] = (int16)floor(h[k] / sum * (1 << kCoeffBits) + 0.5);
+			total += c[k];
+			if (ABS(c[k]) > ABS(c[largest]))
+				largest = k;
+		}
+		c[largest] += (1 << kCoeffBits) - total;
+	}
+
+	return table;
+}
+
+/**
+ * The coefficient tables of all converters, by pair of rates.
+ */
+class SincTableCache : public Common::Singleton<SincTableCache> {
+public:
+	SincTableCache() : _mutex(0) {
+		// The unit tests run without an OSystem, and without other threads
+		if (g_system)
+			_mutex = new Common::Mutex();
+	}
+
+	~SincTableCache() {
+		for (uint i = 0; i < _tables.size(); ++i)
+			delete[] _tables[i].table;
+		delete _mutex;
+	}
+
+	/**
+	 * Return the table for the given rates, building it first if needed.
+	 * The cache is not locked while the table is being built.
+	 */
+	const int16 *getTable(st_rate_t inrate, st_rate_t outrate, uint phases);
+
+private:
+	struct Entry {
+		st_rate_t inrate;
+		st_rate_t outrate;
+		int16 *table;
+	};
+
+	const int16 *findTable(st_rate_t inrate, st_rate_t outrate) const;
+	void lock() { if (_mutex) _mutex->lock(); }
+	void unlock() { if (_mutex) _mutex->unlock(); }
+
+	Common::Array<Entry> _tables;
+	Common::Mutex *_mutex;
+};
+
+const int16 *SincTableCache::findTable(st_rate_t inrate, st_rate_t outrate) const {
+	for (uint i = 0; i < _tables.size(); ++i) {
+		if (_tables[i].inrate == inrate && _tables[i].outrate == outrate)
+			return _tables[i].table;
+	}
+	return 0;
+}
+
+const int16 *SincTableCache::getTable(st_rate_t inrate, st_rate_t outrate, uint phases) {
+	lock();
+	const int16 *found = findTable(inrate, outrate);
+	unlock();
+	if (found)
+		return found;
+
+	int16 *table = makeSincTable(phases, inrate, outrate);
+
+	// Another thread may have built the same table in the meantime
+	lock();
+	found = findTable(inrate, outrate);
+	if (!found) {
+		Entry entry;
+		entry.inrate = inrate;
+		entry.outrate = outrate;
+		entry.table = table;
+		_tables.push_back(entry);
+	}
+	unlock();
+
+	if (found) {
+		delete[] table;
+		return found;
+	}
+	return table;
+}
+
+} // End of namespace Audio
+
+namespace Common {
+DECLARE_SINGLETON(Audio::SincTableCache);
+}
+
+namespace Audio {
+
+/** Dot product of kTaps samples with kTaps coefficients */
+static inline int32 dotProduct(const int16 *samples, const int16 *coeffs) {
+#if defined(USE_SSE2_RATE)
+	__m128i sum = _mm_setzero_si128();
+	for (int i = 0; i < kTaps; i += 8) {
+		const __m128i s = _mm_loadu_si128((const __m128i *)(samples + i));
+		const __m128i c = _mm_loadu_si128((const __m128i *)(coeffs + i));
+		sum = _mm_add_epi32(sum, _mm_madd_epi16(s, c));
+	}
+	sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+	sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+	return _mm_cvtsi128_si32(sum);
+#elif defined(USE_NEON_RATE)
+	int32x4_t sum = vdupq_n_s32(0);
+	for (int i = 0; i < kTaps; i += 8) {
+		const int16x8_t s = vld1q_s16(samples + i);
+		const int16x8_t c = vld1q_s16(coeffs + i);
+		sum = vmlal_s16(sum, vget_low_s16(s), vget_low_s16(c));
+		sum = vmlal_s16(sum, vget_high_s16(s), vget_high_s16(c));
+	}
+	const int32x2_t half = vadd_s32(vget_low_s32(sum), vget_high_s32(sum));
+	return vget_lane_s32(vpadd_s32(half, half), 0);
+#else
+	int32 sum = 0;
+	for (int i = 0; i < kTaps; ++i)
+		sum += samples[i] * coeffs[i];
+	return sum;
+#endif
+}
+
+static inline st_sample_t scaleSample(int32 sum) {
+	sum = (sum + (1 << (kCoeffBits - 1))) >> kCoeffBits;
+	return (st_sample_t)CLIP<int32>(sum, ST_SAMPLE_MIN, ST_SAMPLE_MAX);
+}
+
+/**
+ * Audio rate converter based on polyphase windowed sinc interpolation.
+ */
+template<bool stereo, bool reverseStereo>
+class SincRateConverter : public RateConverter {
+protected:
+	st_sample_t inBuf[kInputBufferSize];
+	const st_sample_t *inPtr;
+	int inLen;
+
+	/** The shared coefficient table, kTaps per phase */
+	const int16 *_table;
+	/** Number of phases, the L in outrate/inrate = L/M */
+	uint _phases;
+	/** Phase increment per output sample, the M in outrate/inrate = L/M */
+	uint _step;
+	/** Current phase; at _phases or above the next input sample is due */
+	uint _phase;
+
+	/**
+	 * The last kTaps input samples of each channel. Every sample is stored
+	 * twice, kTaps apart, so the window starting at _historyPos is always
+	 * contiguous.
+	 */
+	int16 _history[2][kTaps * 2];
+	uint _historyPos;
+
+	/** Silent samples still to push through the filter once input ends */
+	uint _flushLeft;
+
+	/**
+	 * Convert from input, or flush the filter if input is 0. The filter is
+	 * also flushed as soon as input reaches the end of its stream.
+	 */
+	template<bool scale>
+	int process(AudioStream *input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r);
+
+public:
+	SincRateConverter(st_rate_t inrate, st_rate_t outrate, uint phases);
+
+	int flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
+		return process<true>(&input, obuf, osamp, vol_l, vol_r);
+	}
+	int resample(AudioStream &input, st_sample_t *obuf, st_size_t osamp) {
+		return process<false>(&input, obuf, osamp, 0, 0);
+	}
+	int drain(st_sample_t *obuf, st_size_t osamp, st_volume_t vol) {
+		return process<true>(0, obuf, osamp, vol, vol);
+	}
+	bool needsDrain() const {
+		return _flushLeft != 0;
+	}
+};
+
+template<bool stereo, bool reverseStereo>
+SincRateConverter<stereo, reverseStereo>::SincRateConverter(st_rate_t inrate, st_rate_t outrate, uint phases) {
+	const st_rate_t divisor = Common::gcd(inrate, outrate);
+
+	_phases = phases;
+	_step = inrate / divisor;
+	_phase = _phases;
+	_table = SincTableCache::instance().getTable(inrate, outrate, _phases);
+
+	memset(_history, 0, sizeof(_history));
+	_historyPos = 0;
+	_flushLeft = 0;
+
+	inLen = 0;
+}
+
+template<bool stereo, bool reverseStereo>
+template<bool scale>
+int SincRateConverter<stereo, reverseStereo>::process(AudioStream *input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
+	st_sample_t *ostart = obuf;
+	st_sample_t *oend = obuf + osamp * 2;
+
+	while (obuf < oend) {
+		// Shift input samples into the history until the output position
+		// lies inside the window again
+		while (_phase >= _phases) {
+			if (inLen == 0) {
+				inPtr = inBuf;
+				inLen = input ? input->readBuffer(inBuf, ARRAYSIZE(inBuf)) : 0;
+				if (inLen > 0) {
+					_flushLeft = kFlushSamples;
+				} else if (_flushLeft && (!input || input->endOfStream())) {
+					inBuf[0] = inBuf[1] = 0;
+					inLen = stereo ? 2 : 1;
+					_flushLeft--;
+				} else {
+					inLen = 0;
+					return (obuf - ostart) / 2;
+				}
+			}
+			inLen -= (stereo ? 2 : 1);
+
+			_history[0][_historyPos] = _history[0][_historyPos + kTaps] = *inPtr++;
+			if (stereo)
+				_history[1][_historyPos] = _history[1][_historyPos + kTaps] = *inPtr++;
+			_historyPos = (_historyPos + 1) % kTaps;
+
+			_phase -= _phases;
+		}
+
+		const int16 *coeffs = _table + _phase * kTaps;
+		const st_sample_t out0 = scaleSample(dotProduct(_history[0] + _historyPos, coeffs));
+		const st_sample_t out1 = stereo ? scaleSample(dotProduct(_history[1] + _historyPos, coeffs)) : out0;
+
+		if (scale) {
+			// output left channel
+			clampedAdd(obuf[reverseStereo    ], (out0 * (int)vol_l) / Audio::Mixer::kMaxMixerVolume);
+
+			// output right channel
+			clampedAdd(obuf[reverseStereo ^ 1], (out1 * (int)vol_r) / Audio::Mixer::kMaxMixerVolume);
+		} else {
+			obuf[reverseStereo    ] = out0;
+			obuf[reverseStereo ^ 1] = out1;
+		}
+
+		obuf += 2;
+		_phase += _step;
+	}
+
+	return (obuf - ostart) / 2;
+}
+
+void prepareRateConverter(st_rate_t inrate, st_rate_t outrate) {
+	if (inrate == outrate || !ConfMan.hasKey("resampler") || ConfMan.get("resampler") != "sinc")
+		return;
+
+	const uint phases = outrate / Common::gcd(inrate, outrate);
+	if (phases <= kMaxPhases)
+		SincTableCache::instance().getTable(inrate, outrate, phases);
+}
+
+RateConverter *makeSincRateConverter(st_rate_t inrate, st_rate_t outrate, bool stereo, bool reverseStereo) {
+	assert(inrate != outrate);
+
+	const uint phases = outrate / Common::gcd(inrate, outrate);
+	if (phases > kMaxPhases)
+		return 0;
+
+	if (stereo) {
+		if (reverseStereo)
+			return new SincRateConverter<true, true>(inrate, outrate, phases);
+		else
+			return new SincRateConverter<true, false>(inrate, outrate, phases);
+	} else
+		return new SincRateConverter<false, false>(inrate, outrate, phases);
+}
+
+} // End of namespace Audio
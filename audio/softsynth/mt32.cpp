@@ -37,7 +37,10 @@
 #include "common/error.h"
 #include "common/events.h"
 #include "common/file.h"
+#include "common/mutex.h"
+#include "common/spscqueue.h"
 #include "common/system.h"
+#include "common/thread.h"
 #include "common/util.h"
 #include "common/archive.h"
 #include "common/textconsole.h"
@@ -91,6 +94,16 @@ class MidiChannel_MT32 : public MidiChannel_MPU401 {
 };
 
 class MidiDriver_MT32 : public MidiDriver_Emulated {
+public:
+	/** Counters for tuning the render ahead mode. */
+	struct RenderStats {
+		uint32 underruns;         ///< Mixer callbacks which found too few rendered samples
+		uint32 underrunFrames;    ///< Frames which were played as silence because of that
+		uint32 events;            ///< Events handed over to the render thread
+		uint64 totalLatency;      ///< Frames between sending and rendering, summed over all events
+		uint32 maxLatency;        ///< Most frames between sending and rendering an event
+	};
+
 private:
 	MidiChannel_MT32 _midiChannels[16];
 	uint16 _channelMask;
@@ -102,6 +115,56 @@ private:
 
 	int _outputRate;
 
+	/**
+	 * @name Render ahead mode
+	 *
+	 * When enabled, the synth and the timer callback run on their own
+	 * thread, which keeps up to _renderAheadFrames rendered frames in
+	 * _sampleQueue. The mixer only copies from there. Events sent from
+	 * other threads are passed through _eventQueue and played before the
+	 * next chunk is rendered; events sent from the timer callback are
+	 * played immediately, just like without render ahead.
+	 * @{
+	 */
+
+	enum {
+		/** Frames rendered at once by the render thread */
+		kRenderChunkFrames = 128,
+
+		kEventQueueSize = 1024
+	};
+
+	struct QueuedEvent {
+		uint32 msg;          ///< The short message, or the length of sysex
+		byte *sysex;         ///< A copy of the sysex data, or 0 for short messages
+		uint32 timestamp;    ///< The value of _framesPlayed when the event was sent
+	};
+
+	Common::Thread _renderThread;
+	Common::SPSCQueue<QueuedEvent> *_eventQueue;
+	Common::SPSCQueue<int16> *_sampleQueue;
+	/** Serializes the threads which may send events. */
+	Common::Mutex _eventMutex;
+	volatile bool _stopRendering;
+	uint _renderAheadFrames;
+
+	/** Frames consumed by the mixer; only written by the mixer thread. */
+	volatile uint32 _framesPlayed;
+	/** Frames rendered; only written by the render thread. */
+	uint32 _framesRendered;
+
+	RenderStats _renderStats;
+
+	bool startRenderThread(uint renderAheadMillis);
+	void stopRenderThread();
+	static void renderThreadProc(void *driver);
+	void renderChunk();
+	void playQueuedEvents();
+	void queueEvent(uint32 msg, const byte *sysex);
+	void playSysex(const byte *msg, uint16 length);
+
+	/** @} */
+
 protected:
 	void generateSamples(int16 *buf, int len);
 
@@ -121,7 +184,10 @@ public:
 	MidiChannel *allocateChannel();
 	MidiChannel *getPercussionChannel();
 
+	const RenderStats &getRenderStats() const { return _renderStats; }
+
 	// AudioStream API
+	int readBuffer(int16 *data, const int numSamples);
 	bool isStereo() const { return true; }
 	int getRate() const { return _outputRate; }
 };
@@ -148,9 +214,19 @@ MidiDriver_MT32::MidiDriver_MT32(Audio::Mixer *mixer) : MidiDriver_Emulated(mixe
 	_pcmROM = NULL;
 	_controlFile = NULL;
 	_pcmFile = NULL;
+
+	_eventQueue = NULL;
+	_sampleQueue = NULL;
+	_stopRendering = false;
+	_renderAheadFrames = 0;
+	_framesPlayed = 0;
+	_framesRendered = 0;
+	memset(&_renderStats, 0, sizeof(_renderStats));
 }
 
 MidiDriver_MT32::~MidiDriver_MT32() {
+	stopRenderThread();
+	delete _sampleQueue;
 	deleteMuntStructures();
 }
 
@@ -223,6 +299,9 @@ int MidiDriver_MT32::open() {
 
 	_initializing = false;
 
+	if (ConfMan.hasKey("mt32_render_ahead"))
+		startRenderThread(ConfMan.getInt("mt32_render_ahead"));
+
 	if (screenFormat.bytesPerPixel > 1)
 		g_system->fillScreen(screenFormat.RGBToColor(0, 0, 0));
 	else
@@ -236,7 +315,10 @@ int MidiDriver_MT32::open() {
 }
 
 void MidiDriver_MT32::send(uint32 b) {
-	_synth->playMsg(b);
+	if (_renderThread.isRunning() && !_renderThread.isCurrent())
+		queueEvent(b, NULL);
+	else
+		_synth->playMsg(b);
 }
 
 void MidiDriver_MT32::setPitchBendRange(byte channel, uint range) {
@@ -257,6 +339,13 @@ void MidiDriver_MT32::setPitchBendRange(byte channel, uint range) {
 }
 
 void MidiDriver_MT32::sysEx(const byte *msg, uint16 length) {
+	if (_renderThread.isRunning() && !_renderThread.isCurrent())
+		queueEvent(length, msg);
+	else
+		playSysex(msg, length);
+}
+
+void MidiDriver_MT32::playSysex(const byte *msg, uint16 length) {
 	if (msg[0] == 0xf0) {
 		_synth->playSysex(msg, length);
 	} else {
@@ -269,11 +358,16 @@ void MidiDriver_MT32::close() {
 		return;
 	_isOpen = false;
 
+	// The render thread calls the player callback, so stop it first
+	stopRenderThread();
 	// Detach the player callback handler
 	setTimerCallback(NULL, NULL);
 	// Detach the mixer callback handler
 	_mixer->stopHandle(_mixerSoundHandle);
 
+	delete _sampleQueue;
+	_sampleQueue = NULL;
+
 	_synth->close();
 	deleteMuntStructures();
 }
@@ -282,6 +376,159 @@ void MidiDriver_MT32::generateSamples(int16 *data, int len) {
 	_synth->render(data, len);
 }
 
+int MidiDriver_MT32::readBuffer(int16 *data, const int numSamples) {
+	if (!_renderThread.isRunning())
+		return MidiDriver_Emulated::readBuffer(data, numSamples);
+
+	const uint available = _sampleQueue->read(data, numSamples);
+	if (available < (uint)numSamples) {
+		memset(data + available, 0, (numSamples - available) * sizeof(int16));
+		_renderStats.underruns++;
+		_renderStats.underrunFrames += (numSamples - available) / 2;
+	}
+
+	_framesPlayed = _framesPlayed + numSamples / 2;
+	return numSamples;
+}
+
+bool MidiDriver_MT32::startRenderThread(uint renderAheadMillis) {
+	if (renderAheadMillis == 0)
+		return false;
+
+	if (!Common::Thread::isSupported()) {
+		warning("MT32emu: Rendering ahead needs threads, which are not available");
+		return false;
+	}
+
+	// The render thread runs the engine's timer callback, which relies on
+	// the engine's mutexes. Backends without real mutexes hand out null
+	// references; there, the music code would run unprotected on two threads.
+	OSystem::MutexRef mutex = g_system->createMutex();
+	if (!mutex) {
+		static bool warned = false;
+		if (!warned) {
+			warning("MT32emu: Rendering ahead needs mutexes, which are not available");
+			warned = true;
+		}
+		return false;
+	}
+	g_system->deleteMutex(mutex);
+
+	_renderAheadFrames = MAX<uint>(renderAheadMillis * _outputRate / 1000, kRenderChunkFrames);
+
+	uint capacity = 1;
+	while (capacity < _renderAheadFrames * 2)
+		capacity <<= 1;
+
+	_sampleQueue = new Common::SPSCQueue<int16>(capacity);
+	_eventQueue = new Common::SPSCQueue<QueuedEvent>(kEventQueueSize);
+	_stopRendering = false;
+	_framesPlayed = 0;
+	_framesRendered = 0;
+	memset(&_renderStats, 0, sizeof(_renderStats));
+
+	// Start out with a full queue, so the mixer does not begin with an underrun
+	while (_sampleQueue->size() + kRenderChunkFrames * 2 <= _renderAheadFrames * 2)
+		renderChunk();
+
+	if (!_renderThread.start(renderThreadProc, this)) {
+		warning("MT32emu: Could not create the render thread");
+		delete _eventQueue;
+		_eventQueue = NULL;
+		delete _sampleQueue;
+		_sampleQueue = NULL;
+		return false;
+	}
+
+	debug(1, "MT32emu: Rendering %u frames ahead", _renderAheadFrames);
+	return true;
+}
+
+void MidiDriver_MT32::stopRenderThread() {
+	if (!_renderThread.isRunning())
+		return;
+
+	_stopRendering = true;
+	_renderThread.join();
+
+	// Play the events which were sent after the last chunk, so they take
+	// effect when the synth renders synchronously again
+	{
+		Common::StackLock lock(_eventMutex);
+		playQueuedEvents();
+	}
+	delete _eventQueue;
+	_eventQueue = NULL;
+
+	const double framesPerMilli = _outputRate / 1000.0;
+	debug(1, "MT32emu: %u underruns (%u frames), %u events, event latency %.1f ms average, %.1f ms maximum",
+	      _renderStats.underruns, _renderStats.underrunFrames, _renderStats.events,
+	      _renderStats.events ? _renderStats.totalLatency / framesPerMilli / _renderStats.events : 0.0,
+	      _renderStats.maxLatency / framesPerMilli);
+}
+
+void MidiDriver_MT32::renderThreadProc(void *driver) {
+	MidiDriver_MT32 *mt32 = (MidiDriver_MT32 *)driver;
+
+	while (!mt32->_stopRendering) {
+		if (mt32->_sampleQueue->size() + kRenderChunkFrames * 2 > mt32->_renderAheadFrames * 2) {
+			// Wait for the mixer to consume about half a chunk
+			Common::Thread::sleep(kRenderChunkFrames * 500000 / mt32->_outputRate);
+			continue;
+		}
+
+		mt32->playQueuedEvents();
+		mt32->renderChunk();
+	}
+}
+
+void MidiDriver_MT32::renderChunk() {
+	int16 buf[kRenderChunkFrames * 2];
+
+	// This also calls the timer callback at the right sample positions
+	MidiDriver_Emulated::readBuffer(buf, ARRAYSIZE(buf));
+	_sampleQueue->write(buf, ARRAYSIZE(buf));
+	_framesRendered += kRenderChunkFrames;
+}
+
+void MidiDriver_MT32::playQueuedEvents() {
+	const QueuedEvent *event;
+	while ((event = _eventQueue->peek()) != NULL) {
+		if (event->sysex) {
+			playSysex(event->sysex, event->msg);
+			delete[] event->sysex;
+		} else {
+			_synth->playMsg(event->msg);
+		}
+
+		// The event becomes audible once the mixer reaches the frames
+		// which are rendered next
+		const uint32 latency = _framesRendered - event->timestamp;
+		_renderStats.events++;
+		_renderStats.totalLatency += latency;
+		_renderStats.maxLatency = MAX(_renderStats.maxLatency, latency);
+
+		_eventQueue->drop();
+	}
+}
+
+void MidiDriver_MT32::queueEvent(uint32 msg, const byte *sysex) {
+	Common::StackLock lock(_eventMutex);
+
+	QueuedEvent event;
+	event.msg = msg;
+	event.sysex = NULL;
+	event.timestamp = _framesPlayed;
+	if (sysex) {
+		event.sysex = new byte[msg];
+		memcpy(event.sysex, sysex, msg);
+	}
+
+	// The render thread empties the queue at least once per chunk
+	while (!_eventQueue->push(event))
+		Common::Thread::sleep(1000);
+}
+
 uint32 MidiDriver_MT32::property(int prop, uint32 param) {
 	switch (prop) {
 	case PROP_CHANNEL_MASK:
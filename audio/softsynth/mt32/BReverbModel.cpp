@@ -18,6 +18,7 @@
 //#include <cstring>
 #include "mt32emu.h"
 #include "BReverbModel.h"
+#include "SampleBlock.h"
 
 // Analysing of state of reverb RAM address lines gives exact sizes of the buffers of filters used. This also indicates that
 // the reverb model implemented in the real devices consists of three series allpass filters preceded by a non-feedback comb (or a delay with a LPF)
@@ -34,6 +35,16 @@ static const Bit32u PROCESS_DELAY = 1;
 static const Bit32u MODE_3_ADDITIONAL_DELAY = 1;
 static const Bit32u MODE_3_FEEDBACK_DELAY = 1;
 
+// The reverb is processed filter by filter in blocks of this many samples, which lets the parts without
+// sample-to-sample feedback use SSE2 or NEON. The precise multiplication mode has no vector versions.
+static const Bit32u BLOCK_SIZE = 256;
+
+#if MT32EMU_USE_SSE2 && !MT32EMU_BOSS_REVERB_PRECISE_MODE
+#define MT32EMU_REVERB_SSE2 1
+#elif MT32EMU_USE_NEON && !MT32EMU_BOSS_REVERB_PRECISE_MODE
+#define MT32EMU_REVERB_NEON 1
+#endif
+
 // Default reverb settings for "new" reverb model implemented in CM-32L / LAPC-I.
 // Found by tracing reverb RAM data lines (thanks go to Lord_Nightmare & balrog).
 const BReverbSettings &BReverbModel::getCM32L_LAPCSettings(const ReverbMode mode) {
@@ -193,6 +204,136 @@ static Sample weirdMul(Sample a, Bit8u addMask, Bit8u carryMask) {
 #endif
 }
 
+// dry = weirdMul((inLeft >> 2) + (inRight >> 2), dryAmp, 0xFF)
+static void mixDry(Sample *dry, const Sample *inLeft, const Sample *inRight, const Bit8u dryAmp, Bit32u numSamples) {
+#if MT32EMU_REVERB_SSE2
+	const __m128i amp = _mm_set1_epi16(dryAmp);
+	for (; numSamples >= 8; numSamples -= 8) {
+		const __m128i left = _mm_srai_epi16(_mm_loadu_si128((const __m128i *)inLeft), 2);
+		const __m128i right = _mm_srai_epi16(_mm_loadu_si128((const __m128i *)inRight), 2);
+		_mm_storeu_si128((__m128i *)dry, mulShift8(_mm_add_epi16(left, right), amp));
+		inLeft += 8;
+		inRight += 8;
+		dry += 8;
+	}
+#elif MT32EMU_REVERB_NEON
+	const int16x8_t amp = vdupq_n_s16(dryAmp);
+	for (; numSamples >= 8; numSamples -= 8) {
+		const int16x8_t sum = vaddq_s16(vshrq_n_s16(vld1q_s16(inLeft), 2), vshrq_n_s16(vld1q_s16(inRight), 2));
+		vst1q_s16(dry, mulShift8(sum, amp));
+		inLeft += 8;
+		inRight += 8;
+		dry += 8;
+	}
+#endif
+
+	while ((numSamples--) > 0) {
+#if MT32EMU_USE_FLOAT_SAMPLES
+		const Sample sum = (*(inLeft++) * 0.25f) + (*(inRight++) * 0.25f);
+#elif MT32EMU_BOSS_REVERB_PRECISE_MODE
+		const Sample sum = (*(inLeft++) >> 1) / 2 + (*(inRight++) >> 1) / 2;
+#else
+		const Sample sum = (*(inLeft++) >> 2) + (*(inRight++) >> 2);
+#endif
+		*(dry++) = weirdMul(sum, dryAmp, 0xFF);
+	}
+}
+
+// out = in + weirdMul(feedback, feedbackFactor, 0xF0)
+static void addFeedback(Sample *out, const Sample *in, const Sample *feedback, const Bit8u feedbackFactor, Bit32u numSamples) {
+#if MT32EMU_REVERB_SSE2
+	const __m128i factor = _mm_set1_epi16(feedbackFactor);
+	for (; numSamples >= 8; numSamples -= 8) {
+		const __m128i scaled = mulShift8(_mm_loadu_si128((const __m128i *)feedback), factor);
+		_mm_storeu_si128((__m128i *)out, _mm_add_epi16(_mm_loadu_si128((const __m128i *)in), scaled));
+		in += 8;
+		feedback += 8;
+		out += 8;
+	}
+#elif MT32EMU_REVERB_NEON
+	const int16x8_t factor = vdupq_n_s16(feedbackFactor);
+	for (; numSamples >= 8; numSamples -= 8) {
+		vst1q_s16(out, vaddq_s16(vld1q_s16(in), mulShift8(vld1q_s16(feedback), factor)));
+		in += 8;
+		feedback += 8;
+		out += 8;
+	}
+#endif
+
+	while ((numSamples--) > 0) {
+		*(out++) = *(in++) + weirdMul(*(feedback++), feedbackFactor, 0xF0);
+	}
+}
+
+// out = weirdMul(1.5 * a + 1.5 * b + c, wetLevel, 0xFF), the sum saturated
+static void mixWet(Sample *out, const Sample *a, const Sample *b, const Sample *c, const Bit8u wetLevel, Bit32u numSamples) {
+#if MT32EMU_REVERB_SSE2
+	const __m128i level = _mm_set1_epi16(wetLevel);
+	for (; numSamples >= 8; numSamples -= 8) {
+		const __m128i va = _mm_loadu_si128((const __m128i *)a);
+		const __m128i vb = _mm_loadu_si128((const __m128i *)b);
+		const __m128i vc = _mm_loadu_si128((const __m128i *)c);
+		const __m128i ha = _mm_srai_epi16(va, 1);
+		const __m128i hb = _mm_srai_epi16(vb, 1);
+		// Sign extend to 32 bits by unpacking into the upper halves
+		__m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(va, va), 16);
+		__m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(va, va), 16);
+		lo = _mm_add_epi32(lo, _mm_srai_epi32(_mm_unpacklo_epi16(ha, ha), 16));
+		hi = _mm_add_epi32(hi, _mm_srai_epi32(_mm_unpackhi_epi16(ha, ha), 16));
+		lo = _mm_add_epi32(lo, _mm_srai_epi32(_mm_unpacklo_epi16(vb, vb), 16));
+		hi = _mm_add_epi32(hi, _mm_srai_epi32(_mm_unpackhi_epi16(vb, vb), 16));
+		lo = _mm_add_epi32(lo, _mm_srai_epi32(_mm_unpacklo_epi16(hb, hb), 16));
+		hi = _mm_add_epi32(hi, _mm_srai_epi32(_mm_unpackhi_epi16(hb, hb), 16));
+		lo = _mm_add_epi32(lo, _mm_srai_epi32(_mm_unpacklo_epi16(vc, vc), 16));
+		hi = _mm_add_epi32(hi, _mm_srai_epi32(_mm_unpackhi_epi16(vc, vc), 16));
+		_mm_storeu_si128((__m128i *)out, mulShift8(_mm_packs_epi32(lo, hi), level));
+		a += 8;
+		b += 8;
+		c += 8;
+		out += 8;
+	}
+#elif MT32EMU_REVERB_NEON
+	const int16x8_t level = vdupq_n_s16(wetLevel);
+	for (; numSamples >= 8; numSamples -= 8) {
+		const int16x8_t va = vld1q_s16(a);
+		const int16x8_t vb = vld1q_s16(b);
+		const int16x8_t vc = vld1q_s16(c);
+		const int16x8_t ha = vshrq_n_s16(va, 1);
+		const int16x8_t hb = vshrq_n_s16(vb, 1);
+		int32x4_t lo = vaddl_s16(vget_low_s16(va), vget_low_s16(ha));
+		int32x4_t hi = vaddl_s16(vget_high_s16(va), vget_high_s16(ha));
+		lo = vaddq_s32(lo, vaddl_s16(vget_low_s16(vb), vget_low_s16(hb)));
+		hi = vaddq_s32(hi, vaddl_s16(vget_high_s16(vb), vget_high_s16(hb)));
+		lo = vaddw_s16(lo, vget_low_s16(vc));
+		hi = vaddw_s16(hi, vget_high_s16(vc));
+		vst1q_s16(out, mulShift8(vcombine_s16(vqmovn_s32(lo), vqmovn_s32(hi)), level));
+		a += 8;
+		b += 8;
+		c += 8;
+		out += 8;
+	}
+#endif
+
+	while ((numSamples--) > 0) {
+		const Sample outA = *(a++);
+		const Sample outB = *(b++);
+		const Sample outC = *(c++);
+#if MT32EMU_USE_FLOAT_SAMPLES
+		Sample outSample = 1.5f * (outA + outB) + outC;
+#elif MT32EMU_BOSS_REVERB_PRECISE_MODE
+		/* NOTE:
+		 *   Thanks to Mok for discovering, the adder in BOSS reverb chip is found to perform addition with saturation to avoid integer overflow.
+		 *   Analysing of the algorithm suggests that the overflow is most probable when the combs output is added below.
+		 *   So, despite this isn't actually accurate, we only add the check here for performance reasons.
+		 */
+		Sample outSample = Synth::clipSampleEx(Synth::clipSampleEx(Synth::clipSampleEx(Synth::clipSampleEx((SampleEx)outA + SampleEx(outA >> 1)) + (SampleEx)outB) + SampleEx(outB >> 1)) + (SampleEx)outC);
+#else
+		Sample outSample = Synth::clipSampleEx((SampleEx)outA + SampleEx(outA >> 1) + (SampleEx)outB + SampleEx(outB >> 1) + (SampleEx)outC);
+#endif
+		*(out++) = weirdMul(outSample, wetLevel, 0xFF);
+	}
+}
+
 RingBuffer::RingBuffer(Bit32u newsize) : size(newsize), index(0) {
 	buffer = new Sample[size];
 }
@@ -252,8 +393,90 @@ Sample AllpassFilter::process(const Sample in) {
 #endif
 }
 
+void AllpassFilter::process(const Sample *in, Sample *out, const Bit32u numSamples) {
+	Bit32u done = 0;
+	while (done < numSamples) {
+		// Within one pass over the buffer, every slot is read and replaced once, independent of the others
+		const Bit32u pos = (index + 1 < size) ? index + 1 : 0;
+		Bit32u run = size - pos;
+		if (run > numSamples - done) {
+			run = numSamples - done;
+		}
+
+		Sample *slot = buffer + pos;
+		const Sample *src = in + done;
+		Sample *dst = out + done;
+		Bit32u i = 0;
+#if MT32EMU_REVERB_SSE2
+		for (; i + 8 <= run; i += 8) {
+			const __m128i bufferOut = _mm_loadu_si128((const __m128i *)(slot + i));
+			const __m128i stored = _mm_sub_epi16(_mm_loadu_si128((const __m128i *)(src + i)), _mm_srai_epi16(bufferOut, 1));
+			_mm_storeu_si128((__m128i *)(slot + i), stored);
+			_mm_storeu_si128((__m128i *)(dst + i), _mm_add_epi16(bufferOut, _mm_srai_epi16(stored, 1)));
+		}
+#elif MT32EMU_REVERB_NEON
+		for (; i + 8 <= run; i += 8) {
+			const int16x8_t bufferOut = vld1q_s16(slot + i);
+			const int16x8_t stored = vsubq_s16(vld1q_s16(src + i), vshrq_n_s16(bufferOut, 1));
+			vst1q_s16(slot + i, stored);
+			vst1q_s16(dst + i, vaddq_s16(bufferOut, vshrq_n_s16(stored, 1)));
+		}
+#endif
+		if (i > 0) {
+			index = pos + i - 1;
+		}
+		for (; i < run; i++) {
+			dst[i] = process(src[i]);
+		}
+
+		done += run;
+	}
+}
+
 CombFilter::CombFilter(const Bit32u useSize, const Bit32u useFilterFactor) : RingBuffer(useSize), filterFactor(useFilterFactor) {}
 
+void CombFilter::readTaps(const Bit32u *tapDelays, Sample * const *taps, const Bit32u tapCount, const Bit32u sampleIndex, const Sample value) const {
+	for (Bit32u t = 0; t < tapCount; t++) {
+		// A delay of size addresses the slot at index, which still holds the previous value
+		const Bit32u delay = tapDelays[t];
+		if (delay == 0) {
+			taps[t][sampleIndex] = value;
+		} else {
+			taps[t][sampleIndex] = buffer[(index >= delay) ? index - delay : index + size - delay];
+		}
+	}
+}
+
+void CombFilter::process(const Sample *in, const Bit32u numSamples, const Bit32u *tapDelays, Sample * const *taps, const Bit32u tapCount) {
+	Sample filterIn[BLOCK_SIZE];
+
+	Bit32u done = 0;
+	while (done < numSamples) {
+		const Bit32u pos = (index + 1 < size) ? index + 1 : 0;
+		Bit32u run = size - pos;
+		if (run > numSamples - done) {
+			run = numSamples - done;
+		}
+		if (run > BLOCK_SIZE) {
+			run = BLOCK_SIZE;
+		}
+
+		// The feedback comes from the slots about to be replaced, so it is known for the whole run in advance
+		addFeedback(filterIn, in + done, buffer + pos, feedbackFactor, run);
+
+		// Only the low-pass filter needs to go sample by sample
+		for (Bit32u i = 0; i < run; i++) {
+			const Sample last = buffer[index];
+			index = pos + i;
+			const Sample value = weirdMul(last, filterFactor, 0xC0) - filterIn[i];
+			readTaps(tapDelays, taps, tapCount, done + i, value);
+			buffer[index] = value;
+		}
+
+		done += run;
+	}
+}
+
 void CombFilter::process(const Sample in) {
 	// This model corresponds to the comb filter implementation of the real CM-32L device
 
@@ -292,6 +515,17 @@ void DelayWithLowPassFilter::process(const Sample in) {
 	buffer[index] = weirdMul(lpfOut, amp, 0xFF);
 }
 
+void DelayWithLowPassFilter::process(const Sample *in, const Bit32u numSamples, const Bit32u *tapDelays, Sample * const *taps, const Bit32u tapCount) {
+	for (Bit32u i = 0; i < numSamples; i++) {
+		const Sample last = buffer[index];
+		next();
+		const Sample lpfOut = weirdMul(last, filterFactor, 0xFF) + in[i];
+		const Sample value = weirdMul(lpfOut, amp, 0xFF);
+		readTaps(tapDelays, taps, tapCount, i, value);
+		buffer[index] = value;
+	}
+}
+
 TapDelayCombFilter::TapDelayCombFilter(const Bit32u useSize, const Bit32u useFilterFactor) : CombFilter(useSize, useFilterFactor) {}
 
 void TapDelayCombFilter::process(const Sample in) {
@@ -437,90 +671,82 @@ void BReverbModel::process(const Sample *inLeft, const Sample *inRight, Sample *
 		return;
 	}
 
-	Sample dry;
+	if (tapDelayMode) {
+		processTapDelay(inLeft, inRight, outLeft, outRight, numSamples);
+		return;
+	}
 
-	while ((numSamples--) > 0) {
-		if (tapDelayMode) {
-#if MT32EMU_USE_FLOAT_SAMPLES
-			dry = (*(inLeft++) * 0.5f) + (*(inRight++) * 0.5f);
-#else
-			dry = (*(inLeft++) >> 1) + (*(inRight++) >> 1);
-#endif
-		} else {
-#if MT32EMU_USE_FLOAT_SAMPLES
-			dry = (*(inLeft++) * 0.25f) + (*(inRight++) * 0.25f);
-#elif MT32EMU_BOSS_REVERB_PRECISE_MODE
-			dry = (*(inLeft++) >> 1) / 2 + (*(inRight++) >> 1) / 2;
-#else
-			dry = (*(inLeft++) >> 2) + (*(inRight++) >> 2);
-#endif
-		}
+	// Each filter processes the whole block before the next one starts. The outputs of the combs, which the old
+	// sample by sample model read before or after processing the comb, become taps with the equivalent delay.
+	Sample dry[BLOCK_SIZE], link[BLOCK_SIZE];
+	Sample outL1[BLOCK_SIZE], outL2[BLOCK_SIZE], outL3[BLOCK_SIZE];
+	Sample outR1[BLOCK_SIZE], outR2[BLOCK_SIZE], outR3[BLOCK_SIZE];
 
-		// Looks like dryAmp doesn't change in MT-32 but it does in CM-32L / LAPC-I
-		dry = weirdMul(dry, dryAmp, 0xFF);
+	const Bit32u linkDelay = currentSettings.combSizes[0];
+	Sample * const linkTaps[] = {link};
+	const Bit32u comb1Delays[] = {currentSettings.outLPositions[0], currentSettings.outRPositions[0]};
+	Sample * const comb1Taps[] = {outL1, outR1};
+	const Bit32u comb2Delays[] = {currentSettings.outLPositions[1], currentSettings.outRPositions[1]};
+	Sample * const comb2Taps[] = {outL2, outR2};
+	const Bit32u comb3Delays[] = {currentSettings.outLPositions[2], currentSettings.outRPositions[2]};
+	Sample * const comb3Taps[] = {outL3, outR3};
 
-		if (tapDelayMode) {
-			TapDelayCombFilter *comb = static_cast<TapDelayCombFilter *> (*combs);
-			comb->process(dry);
-			if (outLeft != NULL) {
-				*(outLeft++) = weirdMul(comb->getLeftOutput(), wetLevel, 0xFF);
-			}
-			if (outRight != NULL) {
-				*(outRight++) = weirdMul(comb->getRightOutput(), wetLevel, 0xFF);
-			}
-		} else {
-			// If the output position is equal to the comb size, get it now in order not to loose it
-			Sample link = combs[0]->getOutputAt(currentSettings.combSizes[0] - 1);
+	while (numSamples > 0) {
+		const Bit32u len = numSamples > BLOCK_SIZE ? BLOCK_SIZE : Bit32u(numSamples);
 
-			// Entrance LPF. Note, comb.process() differs a bit here.
-			combs[0]->process(dry);
+		// Looks like dryAmp doesn't change in MT-32 but it does in CM-32L / LAPC-I
+		mixDry(dry, inLeft, inRight, dryAmp, len);
+
+		// Entrance LPF, the link is the sample it drops out of its buffer
+		static_cast<DelayWithLowPassFilter *>(combs[0])->process(dry, len, &linkDelay, linkTaps, 1);
 
 #if !MT32EMU_USE_FLOAT_SAMPLES
-			// This introduces reverb noise which actually makes output from the real Boss chip nondeterministic
-			link = link - 1;
+		// This introduces reverb noise which actually makes output from the real Boss chip nondeterministic
+		for (Bit32u i = 0; i < len; i++) {
+			link[i] = link[i] - 1;
+		}
 #endif
-			link = allpasses[0]->process(link);
-			link = allpasses[1]->process(link);
-			link = allpasses[2]->process(link);
+		allpasses[0]->process(link, link, len);
+		allpasses[1]->process(link, link, len);
+		allpasses[2]->process(link, link, len);
 
-			// If the output position is equal to the comb size, get it now in order not to loose it
-			Sample outL1 = combs[1]->getOutputAt(currentSettings.outLPositions[0] - 1);
+		combs[1]->process(link, len, comb1Delays, comb1Taps, 2);
+		combs[2]->process(link, len, comb2Delays, comb2Taps, 2);
+		combs[3]->process(link, len, comb3Delays, comb3Taps, 2);
 
-			combs[1]->process(link);
-			combs[2]->process(link);
-			combs[3]->process(link);
+		if (outLeft != NULL) {
+			mixWet(outLeft, outL1, outL2, outL3, wetLevel, len);
+			outLeft += len;
+		}
+		if (outRight != NULL) {
+			mixWet(outRight, outR1, outR2, outR3, wetLevel, len);
+			outRight += len;
+		}
 
-			if (outLeft != NULL) {
-				Sample outL2 = combs[2]->getOutputAt(currentSettings.outLPositions[1]);
-				Sample outL3 = combs[3]->getOutputAt(currentSettings.outLPositions[2]);
-#if MT32EMU_USE_FLOAT_SAMPLES
-				Sample outSample = 1.5f * (outL1 + outL2) + outL3;
-#elif MT32EMU_BOSS_REVERB_PRECISE_MODE
-				/* NOTE:
-				 *   Thanks to Mok for discovering, the adder in BOSS reverb chip is found to perform addition with saturation to avoid integer overflow.
-				 *   Analysing of the algorithm suggests that the overflow is most probable when the combs output is added below.
-				 *   So, despite this isn't actually accurate, we only add the check here for performance reasons.
-				 */
-				Sample outSample = Synth::clipSampleEx(Synth::clipSampleEx(Synth::clipSampleEx(Synth::clipSampleEx((SampleEx)outL1 + SampleEx(outL1 >> 1)) + (SampleEx)outL2) + SampleEx(outL2 >> 1)) + (SampleEx)outL3);
-#else
-				Sample outSample = Synth::clipSampleEx((SampleEx)outL1 + SampleEx(outL1 >> 1) + (SampleEx)outL2 + SampleEx(outL2 >> 1) + (SampleEx)outL3);
-#endif
-				*(outLeft++) = weirdMul(outSample, wetLevel, 0xFF);
-			}
-			if (outRight != NULL) {
-				Sample outR1 = combs[1]->getOutputAt(currentSettings.outRPositions[0]);
-				Sample outR2 = combs[2]->getOutputAt(currentSettings.outRPositions[1]);
-				Sample outR3 = combs[3]->getOutputAt(currentSettings.outRPositions[2]);
+		inLeft += len;
+		inRight += len;
+		numSamples -= len;
+	}
+}
+
+void BReverbModel::processTapDelay(const Sample *inLeft, const Sample *inRight, Sample *outLeft, Sample *outRight, unsigned long numSamples) {
+	TapDelayCombFilter *comb = static_cast<TapDelayCombFilter *> (*combs);
+
+	while ((numSamples--) > 0) {
 #if MT32EMU_USE_FLOAT_SAMPLES
-				Sample outSample = 1.5f * (outR1 + outR2) + outR3;
-#elif MT32EMU_BOSS_REVERB_PRECISE_MODE
-				// See the note above for the left channel output.
-				Sample outSample = Synth::clipSampleEx(Synth::clipSampleEx(Synth::clipSampleEx(Synth::clipSampleEx((SampleEx)outR1 + SampleEx(outR1 >> 1)) + (SampleEx)outR2) + SampleEx(outR2 >> 1)) + (SampleEx)outR3);
+		Sample dry = (*(inLeft++) * 0.5f) + (*(inRight++) * 0.5f);
 #else
-				Sample outSample = Synth::clipSampleEx((SampleEx)outR1 + SampleEx(outR1 >> 1) + (SampleEx)outR2 + SampleEx(outR2 >> 1) + (SampleEx)outR3);
+		Sample dry = (*(inLeft++) >> 1) + (*(inRight++) >> 1);
 #endif
-				*(outRight++) = weirdMul(outSample, wetLevel, 0xFF);
-			}
+
+		dry = weirdMul(dry, dryAmp, 0xFF);
+
+		comb->process(dry);
+		if (outLeft != NULL) {
+			*(outLeft++) = weirdMul(comb->getLeftOutput(), wetLevel, 0xFF);
+		}
+		if (outRight != NULL) {
+			*(outRight++) = weirdMul(comb->getRightOutput(), wetLevel, 0xFF);
 		}
 	}
 }
@@ -52,6 +52,8 @@ class AllpassFilter : public RingBuffer {
 public:
 	AllpassFilter(const Bit32u size);
 	Sample process(const Sample in);
+	// Processes a block of samples, in and out may be the same buffer.
+	void process(const Sample *in, Sample *out, const Bit32u numSamples);
 };
 
 class CombFilter : public RingBuffer {
@@ -62,8 +64,14 @@ protected:
 public:
 	CombFilter(const Bit32u size, const Bit32u useFilterFactor);
 	virtual void process(const Sample in);
+	// Processes a block of samples. For each of them, taps[i] receives the value stored tapDelays[i] samples earlier,
+	// a delay of 0 yields the sample just stored, and a delay of size the one it replaced.
+	void process(const Sample *in, const Bit32u numSamples, const Bit32u *tapDelays, Sample * const *taps, const Bit32u tapCount);
 	Sample getOutputAt(const Bit32u outIndex) const;
 	void setFeedbackFactor(const Bit32u useFeedbackFactor);
+
+protected:
+	void readTaps(const Bit32u *tapDelays, Sample * const *taps, const Bit32u tapCount, const Bit32u sampleIndex, const Sample value) const;
 };
 
 class DelayWithLowPassFilter : public CombFilter {
@@ -72,6 +80,8 @@ class DelayWithLowPassFilter : public CombFilter {
 public:
 	DelayWithLowPassFilter(const Bit32u useSize, const Bit32u useFilterFactor, const Bit32u useAmp);
 	void process(const Sample in);
+	// Same as CombFilter::process() for blocks.
+	void process(const Sample *in, const Bit32u numSamples, const Bit32u *tapDelays, Sample * const *taps, const Bit32u tapCount);
 	void setFeedbackFactor(const Bit32u) {}
 };
 
@@ -99,6 +109,8 @@ class BReverbModel {
 	static const BReverbSettings &getCM32L_LAPCSettings(const ReverbMode mode);
 	static const BReverbSettings &getMT32Settings(const ReverbMode mode);
 
+	void processTapDelay(const Sample *inLeft, const Sample *inRight, Sample *outLeft, Sample *outRight, unsigned long numSamples);
+
 public:
 	BReverbModel(const ReverbMode mode, const bool mt32CompatibleModel = false);
 	~BReverbModel();
@@ -22,6 +22,7 @@
 #include "mt32emu.h"
 #include "mmath.h"
 #include "internals.h"
+#include "SampleBlock.h"
 
 namespace MT32Emu {
 
@@ -276,6 +277,10 @@ bool Partial::produceOutput(Sample *leftBuf, Sample *rightBuf, unsigned long len
 	}
 	alreadyOutputed = true;
 
+	// Generate the whole block first, so the pan and the mix can be done in one go.
+	// Synth never renders more than MAX_SAMPLES_PER_RUN samples at once.
+	Sample buffer[MAX_SAMPLES_PER_RUN];
+
 	for (sampleNum = 0; sampleNum < length; sampleNum++) {
 		if (!tva->isPlaying() || !la32Pair.isActive(LA32PartialPair::MASTER)) {
 			deactivate();
@@ -295,30 +300,12 @@ bool Partial::produceOutput(Sample *leftBuf, Sample *rightBuf, unsigned long len
 
 		// Although, LA32 applies panning itself, we assume here it is applied in the mixer, not within a pair.
 		// Applying the pan value in the log-space looks like a waste of unlog resources. Though, it needs clarification.
-		Sample sample = la32Pair.nextOutSample();
-
-		// FIXME: Sample analysis suggests that the use of panVal is linear, but there are some quirks that still need to be resolved.
-#if MT32EMU_USE_FLOAT_SAMPLES
-		Sample leftOut = (sample * (float)leftPanValue) / 14.0f;
-		Sample rightOut = (sample * (float)rightPanValue) / 14.0f;
-		*(leftBuf++) += leftOut;
-		*(rightBuf++) += rightOut;
-#else
-		// FIXME: Dividing by 7 (or by 14 in a Mok-friendly way) looks of course pointless. Need clarification.
-		// FIXME2: LA32 may produce distorted sound in case if the absolute value of maximal amplitude of the input exceeds 8191
-		// when the panning value is non-zero. Most probably the distortion occurs in the same way it does with ring modulation,
-		// and it seems to be caused by limited precision of the common multiplication circuit.
-		// From analysis of this overflow, it is obvious that the right channel output is actually found
-		// by subtraction of the left channel output from the input.
-		// Though, it is unknown whether this overflow is exploited somewhere.
-		Sample leftOut = Sample((sample * leftPanValue) >> 8);
-		Sample rightOut = Sample((sample * rightPanValue) >> 8);
-		*leftBuf = Synth::clipSampleEx((SampleEx)*leftBuf + (SampleEx)leftOut);
-		*rightBuf = Synth::clipSampleEx((SampleEx)*rightBuf + (SampleEx)rightOut);
-		leftBuf++;
-		rightBuf++;
-#endif
+		buffer[sampleNum] = la32Pair.nextOutSample();
 	}
+
+	// FIXME: Sample analysis suggests that the use of panVal is linear, but there are some quirks that still need to be resolved.
+	mixPanned(leftBuf, rightBuf, buffer, leftPanValue, rightPanValue, sampleNum);
+
 	sampleNum = 0;
 	return true;
 }
@@ -0,0 +1,109 @@
+/* Copyright (C) 2003, 2004, 2005, 2006, 2008, 2009 Dean Beeler, Jerome Fisher
+ * Copyright (C) 2011, 2012, 2013, 2014 Dean Beeler, Jerome Fisher, Sergey V. Mikayev
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MT32EMU_SAMPLE_BLOCK_H
+#define MT32EMU_SAMPLE_BLOCK_H
+
+// Helpers for processing blocks of 16-bit samples with SSE2 or NEON where the compiler targets them.
+// All of them produce exactly the same results as the scalar code they replace.
+
+#if !MT32EMU_USE_FLOAT_SAMPLES
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define MT32EMU_USE_SSE2 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define MT32EMU_USE_NEON 1
+#endif
+#endif
+
+namespace MT32Emu {
+
+#if MT32EMU_USE_SSE2
+
+// Sample((a * b) >> 8) for 8 samples, assembled from the low and high halves of the 32-bit products
+static inline __m128i mulShift8(const __m128i a, const __m128i b) {
+	const __m128i lo = _mm_mullo_epi16(a, b);
+	const __m128i hi = _mm_mulhi_epi16(a, b);
+	return _mm_or_si128(_mm_slli_epi16(hi, 8), _mm_srli_epi16(lo, 8));
+}
+
+#elif MT32EMU_USE_NEON
+
+// Sample((a * b) >> 8) for 8 samples
+static inline int16x8_t mulShift8(const int16x8_t a, const int16x8_t b) {
+	const int32x4_t lo = vmull_s16(vget_low_s16(a), vget_low_s16(b));
+	const int32x4_t hi = vmull_s16(vget_high_s16(a), vget_high_s16(b));
+	return vcombine_s16(vshrn_n_s32(lo, 8), vshrn_n_s32(hi, 8));
+}
+
+#endif
+
+// Adds a block of samples to the left and right buffers, scaled by the pan values and with saturation
+static inline void mixPanned(Sample *leftBuf, Sample *rightBuf, const Sample *in, Bit32s leftPanValue, Bit32s rightPanValue, Bit32u length) {
+#if MT32EMU_USE_SSE2
+	const __m128i leftPan = _mm_set1_epi16((Bit16s)leftPanValue);
+	const __m128i rightPan = _mm_set1_epi16((Bit16s)rightPanValue);
+	for (; length >= 8; length -= 8) {
+		const __m128i sample = _mm_loadu_si128((const __m128i *)in);
+		const __m128i left = _mm_loadu_si128((const __m128i *)leftBuf);
+		const __m128i right = _mm_loadu_si128((const __m128i *)rightBuf);
+		_mm_storeu_si128((__m128i *)leftBuf, _mm_adds_epi16(left, mulShift8(sample, leftPan)));
+		_mm_storeu_si128((__m128i *)rightBuf, _mm_adds_epi16(right, mulShift8(sample, rightPan)));
+		in += 8;
+		leftBuf += 8;
+		rightBuf += 8;
+	}
+#elif MT32EMU_USE_NEON
+	const int16x8_t leftPan = vdupq_n_s16((Bit16s)leftPanValue);
+	const int16x8_t rightPan = vdupq_n_s16((Bit16s)rightPanValue);
+	for (; length >= 8; length -= 8) {
+		const int16x8_t sample = vld1q_s16(in);
+		vst1q_s16(leftBuf, vqaddq_s16(vld1q_s16(leftBuf), mulShift8(sample, leftPan)));
+		vst1q_s16(rightBuf, vqaddq_s16(vld1q_s16(rightBuf), mulShift8(sample, rightPan)));
+		in += 8;
+		leftBuf += 8;
+		rightBuf += 8;
+	}
+#endif
+
+	while (length--) {
+		const Sample sample = *(in++);
+#if MT32EMU_USE_FLOAT_SAMPLES
+		*(leftBuf++) += (sample * (float)leftPanValue) / 14.0f;
+		*(rightBuf++) += (sample * (float)rightPanValue) / 14.0f;
+#else
+		// FIXME: Dividing by 7 (or by 14 in a Mok-friendly way) looks of course pointless. Need clarification.
+		// FIXME2: LA32 may produce distorted sound in case if the absolute value of maximal amplitude of the input exceeds 8191
+		// when the panning value is non-zero. Most probably the distortion occurs in the same way it does with ring modulation,
+		// and it seems to be caused by limited precision of the common multiplication circuit.
+		// From analysis of this overflow, it is obvious that the right channel output is actually found
+		// by subtraction of the left channel output from the input.
+		// Though, it is unknown whether this overflow is exploited somewhere.
+		const Sample leftOut = Sample((sample * leftPanValue) >> 8);
+		const Sample rightOut = Sample((sample * rightPanValue) >> 8);
+		*leftBuf = Synth::clipSampleEx((SampleEx)*leftBuf + (SampleEx)leftOut);
+		*rightBuf = Synth::clipSampleEx((SampleEx)*rightBuf + (SampleEx)rightOut);
+		leftBuf++;
+		rightBuf++;
+#endif
+	}
+}
+
+}
+
+#endif
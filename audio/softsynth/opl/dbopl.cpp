@@ -173,6 +173,11 @@ static Bit16u MulTable[ 384 ];
 static Bit8u KslTable[ 8 * 16 ];
 static Bit8u TremoloTable[ TREMOLO_TABLE ];
 //Start of a channel behind the chip struct start
+//Noise generator state after 8 steps, for every value of the low 8 bits
+static Bit32u NoiseTable[ 256 ];
+//Contribution of each byte of the noise generator state to the state after 64 steps
+static Bit32u NoiseJumpTable[ 3 ][ 256 ];
+
 static Bit16u ChanOffsetTable[32];
 //Start of an operator behind the chip struct start
 static Bit16u OpOffsetTable[64];
@@ -1030,6 +1035,14 @@ INLINE Bit32u Chip::ForwardNoise() {
 	noiseCounter += noiseAdd;
 	Bitu count = noiseCounter >> LFO_SH;
 	noiseCounter &= WAVE_MASK;
+	//The generator is linear, so many steps at once are the xor of the steps of each byte.
+	//The bits above the lowest 8 only shift down during 8 steps
+	for ( ; count >= 64; count -= 64 ) {
+		noiseValue = NoiseJumpTable[ 0 ][ noiseValue & 0xff ] ^ NoiseJumpTable[ 1 ][ ( noiseValue >> 8 ) & 0xff ] ^ NoiseJumpTable[ 2 ][ noiseValue >> 16 ];
+	}
+	for ( ; count >= 8; count -= 8 ) {
+		noiseValue = ( noiseValue >> 8 ) ^ NoiseTable[ noiseValue & 0xff ];
+	}
 	for ( ; count > 0; --count ) {
 		//Noise calculation from mame
 		noiseValue ^= ( 0x800302 ) & ( 0 - (noiseValue & 1 ) );
@@ -1424,6 +1437,26 @@ void InitTables( void ) {
 	}
 #endif
 
+	//Noise generator steps
+	for ( int i = 0; i < 256; i++ ) {
+		Bit32u value = i;
+		for ( int step = 0; step < 8; step++ ) {
+			value ^= ( 0x800302 ) & ( 0 - (value & 1 ) );
+			value >>= 1;
+		}
+		NoiseTable[ i ] = value;
+	}
+	for ( int b = 0; b < 3; b++ ) {
+		for ( int i = 0; i < 256; i++ ) {
+			Bit32u value = i << ( b * 8 );
+			for ( int step = 0; step < 64; step++ ) {
+				value ^= ( 0x800302 ) & ( 0 - (value & 1 ) );
+				value >>= 1;
+			}
+			NoiseJumpTable[ b ][ i ] = value;
+		}
+	}
+
 	//	|    |//\\|____|WAV7|//__|/\  |____|/\/\|
 	//	|\\//|    |    |WAV7|    |  \/|    |    |
 	//	|06  |0126|27  |7   |3   |4   |4 5 |5   |
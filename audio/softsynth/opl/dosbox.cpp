@@ -40,9 +40,39 @@
 #include <math.h>
 #include <string.h>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define USE_SSE2_OPL
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define USE_NEON_OPL
+#endif
+
 namespace OPL {
 namespace DOSBox {
 
+void convertSamples(int16 *dst, const int32 *src, uint count) {
+#if defined(USE_SSE2_OPL)
+	for (; count >= 8; count -= 8) {
+		// Sign extend the low halves, so the saturating pack keeps them as they are
+		const __m128i lo = _mm_srai_epi32(_mm_slli_epi32(_mm_loadu_si128((const __m128i *)src), 16), 16);
+		const __m128i hi = _mm_srai_epi32(_mm_slli_epi32(_mm_loadu_si128((const __m128i *)(src + 4)), 16), 16);
+		_mm_storeu_si128((__m128i *)dst, _mm_packs_epi32(lo, hi));
+		src += 8;
+		dst += 8;
+	}
+#elif defined(USE_NEON_OPL)
+	for (; count >= 8; count -= 8) {
+		vst1q_s16(dst, vcombine_s16(vmovn_s32(vld1q_s32(src)), vmovn_s32(vld1q_s32(src + 4))));
+		src += 8;
+		dst += 8;
+	}
+#endif
+
+	while (count--)
+		*dst++ = *src++;
+}
+
 Timer::Timer() {
 	masked = false;
 	overflow = false;
@@ -323,9 +353,7 @@ void OPL::generateSamples(int16 *buffer, int length) {
 			const uint readSamples = MIN<uint>(length, bufferLength);
 
 			_emulator->GenerateBlock3(readSamples, tempBuffer);
-
-			for (uint i = 0; i < (readSamples << 1); ++i)
-				buffer[i] = tempBuffer[i];
+			convertSamples(buffer, tempBuffer, readSamples << 1);
 
 			buffer += (readSamples << 1);
 			length -= readSamples;
@@ -335,9 +363,7 @@ void OPL::generateSamples(int16 *buffer, int length) {
 			const uint readSamples = MIN<uint>(length, bufferLength << 1);
 
 			_emulator->GenerateBlock2(readSamples, tempBuffer);
-
-			for (uint i = 0; i < readSamples; ++i)
-				buffer[i] = tempBuffer[i];
+			convertSamples(buffer, tempBuffer, readSamples);
 
 			buffer += readSamples;
 			length -= readSamples;
@@ -69,6 +69,12 @@ namespace DBOPL {
 struct Chip;
 } // end of namespace DBOPL
 
+/**
+ * Store the emulator output as 16 bit samples. Like DOSBox, this keeps the
+ * low 16 bits instead of saturating.
+ */
+void convertSamples(int16 *dst, const int32 *src, uint count);
+
 class OPL : public ::OPL::EmulatedOPL {
 private:
 	Config::OplType _type;
@@ -173,6 +173,17 @@ public:
 	 */
 	virtual bool isWritable() const = 0;
 
+	/**
+	 * Fetches the size and the modification time of the file referred by
+	 * this path, without opening it. The modification time is only meant
+	 * to tell whether the file changed, so its epoch is up to the backend.
+	 *
+	 * The default implementation reports the information as unavailable.
+	 *
+	 * @return true if both values are known, false otherwise.
+	 */
+	virtual bool getFileInfo(uint32 &size, uint32 &modificationTime) const { return false; }
+
 
 	/**
 	 * Creates a SeekableReadStream instance corresponding to the file
@@ -0,0 +1,108 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+// Disable symbol overrides so that we can use open, mmap etc.
+#define FORBIDDEN_SYMBOL_ALLOW_ALL
+
+#include "backends/fs/posix/mmapstream.h"
+
+#if defined(HAVE_MMAP)
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+MmapReadStream::MmapReadStream(const byte *data, uint32 size)
+	: _data(data), _size(size), _pos(0), _eos(false) {
+	assert(data);
+}
+
+MmapReadStream::~MmapReadStream() {
+	munmap(const_cast<byte *>(_data), _size);
+}
+
+bool MmapReadStream::seek(int32 offs, int whence) {
+	switch (whence) {
+	case SEEK_END:
+		offs = _size + offs;
+		break;
+	case SEEK_CUR:
+		offs = _pos + offs;
+		break;
+	default:
+		break;
+	}
+
+	if (offs < 0 || (uint32)offs > _size)
+		return false;
+
+	_pos = offs;
+	_eos = false;
+	return true;
+}
+
+uint32 MmapReadStream::read(void *dataPtr, uint32 dataSize) {
+	// Read at most as many bytes as are still available...
+	if (dataSize > _size - _pos) {
+		dataSize = _size - _pos;
+		_eos = true;
+	}
+	memcpy(dataPtr, _data + _pos, dataSize);
+	_pos += dataSize;
+
+	return dataSize;
+}
+
+const byte *MmapReadStream::borrow(uint32 dataSize) {
+	if (dataSize > _size - _pos)
+		return 0;
+
+	const byte *data = _data + _pos;
+	_pos += dataSize;
+
+	return data;
+}
+
+MmapReadStream *MmapReadStream::makeFromPath(const Common::String &path) {
+	const int fd = open(path.c_str(), O_RDONLY);
+	if (fd < 0)
+		return 0;
+
+	struct stat st;
+	if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size < (off_t)kMinMapSize || st.st_size > (off_t)0x7FFFFFFF) {
+		close(fd);
+		return 0;
+	}
+
+	void *data = mmap(0, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	// The mapping keeps its own reference to the file
+	close(fd);
+
+	if (data == MAP_FAILED)
+		return 0;
+
+	return new MmapReadStream((const byte *)data, st.st_size);
+}
+
+#endif
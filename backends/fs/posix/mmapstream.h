@@ -0,0 +1,78 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef BACKENDS_FS_POSIX_MMAPSTREAM_H
+#define BACKENDS_FS_POSIX_MMAPSTREAM_H
+
+#include "common/scummsys.h"
+
+#if defined(HAVE_MMAP)
+
+#include "common/noncopyable.h"
+#include "common/stream.h"
+#include "common/str.h"
+
+/**
+ * A read stream for a file which is mapped into memory as a whole. Reading
+ * copies straight out of the mapping, and borrow() hands out pointers into
+ * it, so callers which only need to look at the data do not have to copy
+ * it at all.
+ */
+class MmapReadStream : public Common::SeekableReadStream, public Common::NonCopyable {
+public:
+	/**
+	 * Files smaller than this are left to StdioStream; for them, a mapping
+	 * costs more than reading through the stdio buffer does.
+	 */
+	static const uint32 kMinMapSize = 64 * 1024;
+
+	/**
+	 * Given a path, maps the file it points to. Returns 0 if the file can
+	 * not be opened or mapped, or is too small to be worth it, so the caller
+	 * can fall back to a StdioStream.
+	 */
+	static MmapReadStream *makeFromPath(const Common::String &path);
+
+	virtual ~MmapReadStream();
+
+	virtual bool eos() const { return _eos; }
+	virtual void clearErr() { _eos = false; }
+
+	virtual int32 pos() const { return _pos; }
+	virtual int32 size() const { return _size; }
+	virtual bool seek(int32 offs, int whence = SEEK_SET);
+	virtual uint32 read(void *dataPtr, uint32 dataSize);
+	virtual const byte *borrow(uint32 dataSize);
+
+private:
+	MmapReadStream(const byte *data, uint32 size);
+
+	/** The mapping of the whole file. */
+	const byte *_data;
+	uint32 _size;
+	uint32 _pos;
+	bool _eos;
+};
+
+#endif
+
+#endif
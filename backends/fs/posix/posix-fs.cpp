@@ -29,6 +29,7 @@
 #define FORBIDDEN_SYMBOL_EXCEPTION_exit		//Needed for IRIX's unistd.h
 
 #include "backends/fs/posix/posix-fs.h"
+#include "backends/fs/posix/mmapstream.h"
 #include "backends/fs/stdiostream.h"
 #include "common/algorithm.h"
 
@@ -38,6 +39,7 @@
 #include <stdio.h>
 #include <errno.h>
 #include <fcntl.h>
+#include <sys/stat.h>
 
 void POSIXFilesystemNode::setFlags()
 {
@@ -157,7 +159,23 @@ AbstractFSNode *POSIXFilesystemNode::getParent() const
 	return makeNode(Common::String(start, end));
 }
 
+bool POSIXFilesystemNode::getFileInfo(uint32 &size, uint32 &modificationTime) const {
+	struct stat st;
+	if (stat(_path.c_str(), &st) != 0 || !S_ISREG(st.st_mode))
+		return false;
+
+	size = (uint32)st.st_size;
+	modificationTime = (uint32)st.st_mtime;
+	return true;
+}
+
 Common::SeekableReadStream *POSIXFilesystemNode::createReadStream() {
+#if defined(HAVE_MMAP)
+	Common::SeekableReadStream *stream = MmapReadStream::makeFromPath(getPath());
+	if (stream)
+		return stream;
+#endif
+
 	return StdioStream::makeFromPath(getPath(), false);
 }
 
@@ -55,6 +55,19 @@ bool WindowsFilesystemNode::isWritable() const {
 	return _access(_path.c_str(), W_OK) == 0;
 }
 
+bool WindowsFilesystemNode::getFileInfo(uint32 &size, uint32 &modificationTime) const {
+	WIN32_FILE_ATTRIBUTE_DATA data;
+	if (!GetFileAttributesEx(toUnicode(_path.c_str()), GetFileExInfoStandard, &data))
+		return false;
+	if (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+		return false;
+
+	size = data.nFileSizeLow;
+	// Fold the 100ns ticks into 32 bits, it only has to change with the file
+	modificationTime = data.ftLastWriteTime.dwLowDateTime ^ data.ftLastWriteTime.dwHighDateTime;
+	return true;
+}
+
 void WindowsFilesystemNode::addFile(AbstractFSList &list, ListMode mode, const char *base, bool hidden, WIN32_FIND_DATA* find_data) {
 	WindowsFilesystemNode entry;
 	char *asciiName = toAscii(find_data->cFileName);
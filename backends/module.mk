@@ -188,6 +188,7 @@ endif
 
 ifdef POSIX
 MODULE_OBJS += \
+	fs/posix/mmapstream.o \
 	fs/posix/posix-fs.o \
 	fs/posix/posix-fs-factory.o \
 	fs/chroot/chroot-fs-factory.o \
@@ -1,7 +1,13 @@
 #define FORBIDDEN_SYMBOL_ALLOW_ALL
 
 #include "base/main.h"
+#include "base/plugins.h"
 #include "common/scummsys.h"
+#include "common/config-manager.h"
+#include "common/error.h"
+#include "common/memstream.h"
+#include "engines/engine.h"
+#include "engines/metaengine.h"
 #include "graphics/surface.libretro.h"
 #include "audio/mixer_intern.h"
 
@@ -23,6 +29,24 @@ static retro_audio_sample_batch_t audio_batch_cb = NULL;
 static retro_environment_t environ_cb = NULL;
 static retro_input_poll_t poll_cb = NULL;
 static retro_input_state_t input_cb = NULL;
+static bool can_dupe = false;
+static struct retro_perf_callback perf_cb;
+
+/* Timing. Every frame uploads sample_rate / frame_rate stereo frames; the
+ * remainder is carried over so the audio never drifts from the video. */
+static unsigned frame_rate = 60;
+static unsigned sample_rate = 44100;
+static unsigned sample_remainder = 0;
+
+/* Large enough for the highest sample rate at the lowest frame rate */
+#define MAX_FRAME_SAMPLES (48000 / 30 + 1)
+static int16_t audio_buf[MAX_FRAME_SAMPLES * 2];
+
+/* Counters reported through the log every STATS_INTERVAL seconds */
+#define STATS_INTERVAL 10
+static unsigned stats_frames = 0;
+static retro_time_t stats_mix_usec = 0;
+static retro_time_t stats_mix_max_usec = 0;
 
 void retro_set_video_refresh(retro_video_refresh_t cb) { video_cb = cb; }
 void retro_set_audio_sample(retro_audio_sample_t cb) { }
@@ -32,9 +56,69 @@ void retro_set_input_state(retro_input_state_t cb) { input_cb = cb; }
 
 void retro_set_environment(retro_environment_t cb)
 {
+   static const struct retro_variable vars[] = {
+      { "scummvm_frame_rate", "Frame rate; 60|50|30" },
+      { "scummvm_sample_rate", "Audio sample rate (restart); 44100|48000|32000|22050" },
+      { NULL, NULL },
+   };
+
    environ_cb = cb;
    bool tmp = true;
    environ_cb(RETRO_ENVIRONMENT_SET_SUPPORT_NO_GAME, &tmp);
+   environ_cb(RETRO_ENVIRONMENT_SET_VARIABLES, (void*)vars);
+}
+
+static unsigned get_variable(const char *key, unsigned defaultValue)
+{
+   struct retro_variable var = { key, NULL };
+   if (!environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) || !var.value)
+      return defaultValue;
+
+   const unsigned value = strtoul(var.value, NULL, 10);
+   return value ? value : defaultValue;
+}
+
+static void check_variables(bool startup)
+{
+   /* The mixer rate is fixed once the backend exists */
+   if (startup)
+      sample_rate = MIN(get_variable("scummvm_sample_rate", 44100), 48000u);
+
+   const unsigned fps = MAX(get_variable("scummvm_frame_rate", 60), 30u);
+   if (fps == frame_rate && !startup)
+      return;
+
+   frame_rate = fps;
+   sample_remainder = 0;
+   retroSetFrameRate(frame_rate);
+
+   if (!startup)
+   {
+      struct retro_system_av_info info;
+      retro_get_system_av_info(&info);
+      environ_cb(RETRO_ENVIRONMENT_SET_SYSTEM_AV_INFO, &info);
+   }
+}
+
+static retro_time_t get_time_usec(void)
+{
+   return perf_cb.get_time_usec ? perf_cb.get_time_usec() : 0;
+}
+
+static void log_frame_stats(void)
+{
+   if (++stats_frames < frame_rate * STATS_INTERVAL)
+      return;
+
+   if (log_cb)
+      log_cb(RETRO_LOG_DEBUG, "Frames: %u, engine frames: %u, yields on updateScreen: %u, on frame budget: %u, mix: %.1f us average, %u us max.\n",
+            stats_frames, retroThreadStats.screenUpdates, retroThreadStats.frameYields, retroThreadStats.budgetYields,
+            (double)stats_mix_usec / stats_frames, (unsigned)stats_mix_max_usec);
+
+   memset(&retroThreadStats, 0, sizeof(retroThreadStats));
+   stats_frames = 0;
+   stats_mix_usec = 0;
+   stats_mix_max_usec = 0;
 }
 
 bool FRONTENDwantsExit;
@@ -108,8 +192,8 @@ void retro_get_system_av_info(struct retro_system_av_info *info)
    info->geometry.max_width = RES_W;
    info->geometry.max_height = RES_H;
    info->geometry.aspect_ratio = 4.0f / 3.0f;
-   info->timing.fps = 60.0;
-   info->timing.sample_rate = 44100.0;
+   info->timing.fps = frame_rate;
+   info->timing.sample_rate = sample_rate;
 }
 
 void retro_init (void)
@@ -120,23 +204,29 @@ void retro_init (void)
    else
       log_cb = NULL;
 
-   /* Get color mode: 32 first as VGA has 6 bits per pixel */
-
-#if 0
-   RDOSGFXcolorMode = RETRO_PIXEL_FORMAT_XRGB8888;
-   if(!environ_cb(RETRO_ENVIRONMENT_SET_PIXEL_FORMAT, &RDOSGFXcolorMode))
+   /* Get color mode: 32 first, so true color games and the overlay need
+    * no down-conversion */
+   enum retro_pixel_format colorMode = RETRO_PIXEL_FORMAT_XRGB8888;
+   if(!environ_cb(RETRO_ENVIRONMENT_SET_PIXEL_FORMAT, &colorMode))
    {
-      RDOSGFXcolorMode = RETRO_PIXEL_FORMAT_RGB565;
-      if(!environ_cb(RETRO_ENVIRONMENT_SET_PIXEL_FORMAT, &RDOSGFXcolorMode))
-         RDOSGFXcolorMode = RETRO_PIXEL_FORMAT_0RGB1555;
-   }
-#endif
-
 #ifdef FRONTEND_SUPPORTS_RGB565
-   enum retro_pixel_format rgb565 = RETRO_PIXEL_FORMAT_RGB565;
-   if (!environ_cb(RETRO_ENVIRONMENT_SET_PIXEL_FORMAT, &rgb565) && log_cb)
-      log_cb(RETRO_LOG_INFO, "Frontend supports RGB565 -will use that instead of XRGB1555.\n");
+      colorMode = RETRO_PIXEL_FORMAT_RGB565;
+      if(!environ_cb(RETRO_ENVIRONMENT_SET_PIXEL_FORMAT, &colorMode))
 #endif
+         colorMode = RETRO_PIXEL_FORMAT_0RGB1555;
+   }
+
+   if (log_cb)
+      log_cb(RETRO_LOG_INFO, "Using %s output.\n",
+            colorMode == RETRO_PIXEL_FORMAT_XRGB8888 ? "XRGB8888" :
+            colorMode == RETRO_PIXEL_FORMAT_RGB565 ? "RGB565" : "0RGB1555");
+   retroSetPixelFormat(colorMode);
+
+   if (!environ_cb(RETRO_ENVIRONMENT_GET_CAN_DUPE, &can_dupe))
+      can_dupe = false;
+
+   if (!environ_cb(RETRO_ENVIRONMENT_GET_PERF_INTERFACE, &perf_cb))
+      memset(&perf_cb, 0, sizeof(perf_cb));
 
    retro_keyboard_callback cb = {retroKeyEvent};
    environ_cb(RETRO_ENVIRONMENT_SET_KEYBOARD_CALLBACK, &cb);
@@ -255,6 +345,9 @@ bool retro_load_game(const struct retro_game_info *game)
 
    environ_cb(RETRO_ENVIRONMENT_SET_INPUT_DESCRIPTORS, desc);
 
+   check_variables(true);
+   retroSetSampleRate(sample_rate);
+
    if(environ_cb(RETRO_ENVIRONMENT_GET_SYSTEM_DIRECTORY, &sysdir))
       retroSetSystemDir(sysdir);
    else
@@ -283,6 +376,10 @@ void retro_run (void)
    if(!emuThread)
       return;
 
+   bool updated = false;
+   if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE_UPDATE, &updated) && updated)
+      check_variables(false);
+
    /* Mouse */
    if(g_system)
    {
@@ -295,25 +392,176 @@ void retro_run (void)
 
    if(g_system)
    {
-      /* Upload video: TODO: Check the CANDUPE env value */
+      /* Upload video, or let the frontend dupe the last frame if nothing changed */
       const Graphics::Surface& screen = getScreen();
-      video_cb(screen.pixels, screen.w, screen.h, screen.pitch);
+      if (retroScreenChanged() || !can_dupe)
+         video_cb(screen.pixels, screen.w, screen.h, screen.pitch);
+      else
+         video_cb(NULL, screen.w, screen.h, screen.pitch);
 
       // Upload audio
-      static uint32 buf[735];
-      int count = ((Audio::MixerImpl*)g_system->getMixer())->mixCallback((byte*)buf, 735*4);
-      audio_batch_cb((int16_t*)buf, count);
+      sample_remainder += sample_rate;
+      const unsigned count = sample_remainder / frame_rate;
+      sample_remainder %= frame_rate;
+
+      const retro_time_t mixStart = get_time_usec();
+      ((Audio::MixerImpl*)g_system->getMixer())->mixCallback((byte*)audio_buf, count * 4);
+      const retro_time_t mixTime = get_time_usec() - mixStart;
+      stats_mix_usec += mixTime;
+      stats_mix_max_usec = MAX(stats_mix_max_usec, mixTime);
+
+      /* The buffer is silence past what the channels produced, so always
+       * upload the full frame to keep the frontend's audio sync fed */
+      audio_batch_cb(audio_buf, count);
+
+      log_frame_stats();
    }
 }
 
+/* Save states
+ *
+ * Snapshots go straight through Engine::saveGameStream/loadGameStream into
+ * the frontend's buffer, so rewind, run-ahead and netplay never touch the
+ * savefile manager. A snapshot is laid out as:
+ *   uint32 BE  'SVMS'
+ *   uint32 LE  payload size
+ *   payload    engine stream
+ */
+#define SNAPSHOT_TAG MKTAG('S','V','M','S')
+#define SNAPSHOT_HEADER_SIZE 8
+#define SNAPSHOT_SIZE_ALIGN (64 * 1024)
+
+/* Reported until a state could be measured. Frontends ask right after
+ * retro_load_game(), before the engine exists, and turn save states off
+ * for the whole session if the answer is 0. This is more than the engines
+ * with save stream support need for their states. */
+#define SNAPSHOT_DEFAULT_SIZE (4 * 1024 * 1024)
+
+/* Size reported to the frontend. It is measured once per engine instance
+ * and then only grown by retro_serialize(), which sees the real payload
+ * sizes anyway, so the frontend's size queries cost no extra save. */
+static size_t snapshot_size = SNAPSHOT_DEFAULT_SIZE;
+static bool snapshot_measured;
+
+static void retro_grow_snapshot_size(size_t payloadSize)
+{
+   /* The frontend sizes its rewind buffer from this, so it must not shrink.
+    * Keep generous headroom on top of the current state. */
+   size_t needed = SNAPSHOT_HEADER_SIZE + payloadSize + payloadSize / 2;
+   needed = (needed + SNAPSHOT_SIZE_ALIGN - 1) & ~(size_t)(SNAPSHOT_SIZE_ALIGN - 1);
+
+   if (needed > snapshot_size)
+      snapshot_size = needed;
+}
+
+static bool retro_measure_snapshot(void)
+{
+   if (!g_engine->canSaveGameStateCurrently())
+      return false;
+
+   Common::MemoryWriteStreamDynamic stream(DisposeAfterUse::YES);
+   if (g_engine->saveGameStream(&stream).getCode() != Common::kNoError)
+      return false;
+
+   retro_grow_snapshot_size(stream.size());
+   snapshot_measured = true;
+   return true;
+}
+
+static bool retro_engine_supports_snapshots(void)
+{
+   static Engine *checkedEngine = NULL;
+   static bool supported = false;
+
+   if (!g_engine)
+      return false;
+
+   /* Only look up the plugin once per engine instance */
+   if (g_engine != checkedEngine)
+   {
+      const EnginePlugin *plugin = NULL;
+      EngineMan.findGameInLoadedPlugins(ConfMan.get("gameid"), &plugin);
+
+      supported = plugin && (*plugin)->hasFeature(MetaEngine::kSupportsSaveStreams);
+      checkedEngine = g_engine;
+      snapshot_measured = false;
+   }
+
+   return supported;
+}
+
+size_t retro_serialize_size (void)
+{
+   /* Until there is an engine, assume it supports save states */
+   if (!g_engine)
+      return snapshot_size;
+
+   if (!retro_engine_supports_snapshots())
+      return 0;
+
+   if (!snapshot_measured)
+      retro_measure_snapshot();
+
+   return snapshot_size;
+}
+
+bool retro_serialize(void *data, size_t size)
+{
+   if (size <= SNAPSHOT_HEADER_SIZE || !retro_engine_supports_snapshots())
+      return false;
+
+   if (!g_engine->canSaveGameStateCurrently())
+      return false;
+
+   byte *buf = (byte *)data;
+   Common::MemoryWriteStream stream(buf + SNAPSHOT_HEADER_SIZE, size - SNAPSHOT_HEADER_SIZE);
+
+   if (g_engine->saveGameStream(&stream).getCode() != Common::kNoError)
+      return false;
+
+   if (stream.err())
+   {
+      if (log_cb)
+         log_cb(RETRO_LOG_WARN, "Game state does not fit into %u bytes.\n", (unsigned)size);
+      /* Let the next retro_serialize_size() ask for enough */
+      retro_measure_snapshot();
+      return false;
+   }
+
+   retro_grow_snapshot_size(stream.pos());
+
+   WRITE_BE_UINT32(buf, SNAPSHOT_TAG);
+   WRITE_LE_UINT32(buf + 4, stream.pos());
+   return true;
+}
+
+bool retro_unserialize(const void * data, size_t size)
+{
+   if (size <= SNAPSHOT_HEADER_SIZE || !retro_engine_supports_snapshots())
+      return false;
+
+   const byte *buf = (const byte *)data;
+   const uint32 payloadSize = READ_LE_UINT32(buf + 4);
+
+   if (READ_BE_UINT32(buf) != SNAPSHOT_TAG || payloadSize > size - SNAPSHOT_HEADER_SIZE)
+      return false;
+
+   /* Engines may defer the restore to their next safe point, so they get
+    * their own copy of the frontend's buffer */
+   byte *payload = (byte *)malloc(payloadSize);
+   if (!payload)
+      return false;
+   memcpy(payload, buf + SNAPSHOT_HEADER_SIZE, payloadSize);
+
+   Common::SeekableReadStream *stream = new Common::MemoryReadStream(payload, payloadSize, DisposeAfterUse::YES);
+   return g_engine->loadGameStream(stream).getCode() == Common::kNoError;
+}
+
 // Stubs
 void retro_set_controller_port_device(unsigned in_port, unsigned device) { }
 void *retro_get_memory_data(unsigned type) { return 0; }
 size_t retro_get_memory_size(unsigned type) { return 0; }
 void retro_reset (void) { }
-size_t retro_serialize_size (void) { return 0; }
-bool retro_serialize(void *data, size_t size) { return false; }
-bool retro_unserialize(const void * data, size_t size) { return false; }
 void retro_cheat_reset(void) { }
 void retro_cheat_set(unsigned unused, bool unused1, const char* unused2) { }
 void retro_unload_game (void) { }
@@ -32,6 +32,8 @@
 #include "graphics/surface.libretro.h"
 #include "backends/base-backend.h"
 #include "common/events.h"
+#include "common/list.h"
+#include "common/rect.h"
 #include "audio/mixer_intern.h"
 
 #include "backends/fs/posix/posix-fs-factory.h"
@@ -40,6 +42,7 @@
 #include "backends/timer/default/default-timer.h"
 #include "graphics/colormasks.h"
 #include "graphics/palette.h"
+#include "graphics/palette_lut.h"
 #include "backends/saves/default/default-saves.h"
 #if defined(_WIN32)
 #include <direct.h>
@@ -57,163 +60,106 @@
 #endif
 
 #include "libretro.h"
+#include "os.h"
 
 extern retro_log_printf_t log_cb;
 
-struct RetroPalette
-{
-   unsigned char _colors[256 * 3];
+/* Timing negotiated with the frontend */
+static uint32 s_sampleRate = 44100;
+static uint32 s_frameMillis = 17;
 
-   RetroPalette()
-   {
-      memset(_colors, 0, sizeof(_colors));
-   }
+RetroThreadStats retroThreadStats;
 
-   void set(const byte *colors, uint start, uint num)
-   {
-      memcpy(_colors + start * 3, colors, num * 3);
-   }
+/* Output format negotiated with the frontend in retro_init */
+static Graphics::PixelFormat s_screenFormat(2, 5, 5, 5, 1, 10, 5, 0, 15);
 
-   void get(byte* colors, uint start, uint num)
-   {
-      memcpy(colors, _colors + start * 3, num * 3);
-   }
+void retroSetSampleRate(uint32_t aRate)
+{
+   s_sampleRate = aRate;
+}
 
-   unsigned char *getColor(uint aIndex) const
-   {
-      return (unsigned char*)&_colors[aIndex * 3];
-   }
-};
+void retroSetFrameRate(uint32_t aFps)
+{
+   s_frameMillis = (1000 + aFps - 1) / aFps;
+}
 
-static INLINE void blit_uint8_uint16_fast(Graphics::Surface& aOut, const Graphics::Surface& aIn, const RetroPalette& aColors)
+void retroSetPixelFormat(enum retro_pixel_format aFormat)
 {
-   for(int i = 0; i < aIn.h; i ++)
+   switch(aFormat)
    {
-      if(i >= aOut.h)
-         continue;
-
-      uint8_t * const in  = (uint8_t*)aIn.pixels + (i * aIn.w);
-      uint16_t* const out = (uint16_t*)aOut.pixels + (i * aOut.w);
-
-      for(int j = 0; j < aIn.w; j ++)
-      {
-         if (j >= aOut.w)
-            continue;
-
-         uint8 r, g, b;
-
-         const uint8_t val = in[j];
-         if(val != 0xFFFFFFFF)
-         {
-            if(aIn.format.bytesPerPixel == 1)
-            {
-               unsigned char *col = aColors.getColor(val);
-               r = *col++;
-               g = *col++;
-               b = *col++;
-            }
-            else
-               aIn.format.colorToRGB(in[j], r, g, b);
-
-            out[j] = aOut.format.RGBToColor(r, g, b);
-         }
-      }
+      case RETRO_PIXEL_FORMAT_XRGB8888:
+         s_screenFormat = Graphics::PixelFormat(4, 8, 8, 8, 0, 16, 8, 0, 0);
+         break;
+      case RETRO_PIXEL_FORMAT_RGB565:
+         s_screenFormat = Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0);
+         break;
+      default:
+         s_screenFormat = Graphics::PixelFormat(2, 5, 5, 5, 1, 10, 5, 0, 15);
+         break;
    }
 }
 
-static INLINE void blit_uint32_uint16(Graphics::Surface& aOut, const Graphics::Surface& aIn, const RetroPalette& aColors)
+static INLINE void blit_uint8_fast(Graphics::Surface& aOut, const Graphics::Surface& aIn, const Graphics::PaletteLUT& aColors, const Common::Rect& aRect)
 {
-   for(int i = 0; i < aIn.h; i ++)
-   {
-      if(i >= aOut.h)
-         continue;
-
-      uint32_t* const in = (uint32_t*)aIn.pixels + (i * aIn.w);
-      uint16_t* const out = (uint16_t*)aOut.pixels + (i * aOut.w);
-
-      for(int j = 0; j < aIn.w; j ++)
-      {
-         if(j >= aOut.w)
-            continue;
-
-         uint8 r, g, b;
-
-         const uint32_t val = in[j];
-         if(val != 0xFFFFFFFF)
-         {
-            aIn.format.colorToRGB(in[j], r, g, b);
-            out[j] = aOut.format.RGBToColor(r, g, b);
-         }
-      }
-   }
+   aColors.convert((byte*)aOut.getBasePtr(aRect.left, aRect.top), aOut.pitch,
+         (const byte*)aIn.getBasePtr(aRect.left, aRect.top), aIn.pitch, aRect.width(), aRect.height());
 }
 
-static INLINE void blit_uint16_uint16(Graphics::Surface& aOut, const Graphics::Surface& aIn, const RetroPalette& aColors)
+template<typename OutT, typename InT>
+static INLINE void blit_rgb(Graphics::Surface& aOut, const Graphics::Surface& aIn, const Common::Rect& aRect)
 {
-   for(int i = 0; i < aIn.h; i ++)
+   for(int i = aRect.top; i < aRect.bottom; i ++)
    {
-      if(i >= aOut.h)
-         continue;
-
-      uint16_t* const in = (uint16_t*)aIn.pixels + (i * aIn.w);
-      uint16_t* const out = (uint16_t*)aOut.pixels + (i * aOut.w);
+      const InT* const in = (const InT*)aIn.getBasePtr(0, i);
+      OutT* const out = (OutT*)aOut.getBasePtr(0, i);
 
-      for(int j = 0; j < aIn.w; j ++)
+      for(int j = aRect.left; j < aRect.right; j ++)
       {
-         if(j >= aOut.w)
-            continue;
-
          uint8 r, g, b;
 
-         const uint16_t val = in[j];
-         if(val != 0xFFFFFFFF)
-         {
-            aIn.format.colorToRGB(in[j], r, g, b);
-            out[j] = aOut.format.RGBToColor(r, g, b);
-         }
+         const InT val = in[j];
+         if(sizeof(InT) == 4 && val == (InT)0xFFFFFFFF)
+            continue;
+
+         aIn.format.colorToRGB(val, r, g, b);
+         out[j] = aOut.format.RGBToColor(r, g, b);
       }
    }
 }
 
-static void blit_uint8_uint16(Graphics::Surface& aOut, const Graphics::Surface& aIn, int aX, int aY, const RetroPalette& aColors, uint32 aKeyColor)
+template<typename OutT>
+static void blit_cursor_uint8(Graphics::Surface& aOut, const Graphics::Surface& aIn, int aX, int aY, const Graphics::PaletteLUT& aColors, uint32 aKeyColor)
 {
    for(int i = 0; i < aIn.h; i ++)
    {
       if((i + aY) < 0 || (i + aY) >= aOut.h)
          continue;
 
-      uint8_t* const in = (uint8_t*)aIn.pixels + (i * aIn.w);
-      uint16_t* const out = (uint16_t*)aOut.pixels + ((i + aY) * aOut.w);
+      const uint8_t* const in = (const uint8_t*)aIn.getBasePtr(0, i);
+      OutT* const out = (OutT*)aOut.getBasePtr(0, i + aY);
 
       for(int j = 0; j < aIn.w; j ++)
       {
          if((j + aX) < 0 || (j + aX) >= aOut.w)
             continue;
 
-         uint8 r, g, b;
-
          const uint8_t val = in[j];
          if(val != aKeyColor)
-         {
-            unsigned char *col = aColors.getColor(val);
-            r = *col++;
-            g = *col++;
-            b = *col++;
-            out[j + aX] = aOut.format.RGBToColor(r, g, b);
-         }
+            out[j + aX] = aColors.getColor(val);
       }
    }
 }
 
-static void blit_uint16_uint16(Graphics::Surface& aOut, const Graphics::Surface& aIn, int aX, int aY, const RetroPalette& aColors, uint32 aKeyColor)
+template<typename OutT, typename InT>
+static void blit_cursor_rgb(Graphics::Surface& aOut, const Graphics::Surface& aIn, int aX, int aY, uint32 aKeyColor)
 {
    for(int i = 0; i < aIn.h; i ++)
    {
       if((i + aY) < 0 || (i + aY) >= aOut.h)
          continue;
 
-      uint16_t* const in = (uint16_t*)aIn.pixels + (i * aIn.w);
-      uint16_t* const out = (uint16_t*)aOut.pixels + ((i + aY) * aOut.w);
+      const InT* const in = (const InT*)aIn.getBasePtr(0, i);
+      OutT* const out = (OutT*)aOut.getBasePtr(0, i + aY);
 
       for(int j = 0; j < aIn.w; j ++)
       {
@@ -222,10 +168,10 @@ static void blit_uint16_uint16(Graphics::Surface& aOut, const Graphics::Surface&
 
          uint8 r, g, b;
 
-         const uint16_t val = in[j];
+         const InT val = in[j];
          if(val != aKeyColor)
          {
-            aIn.format.colorToRGB(in[j], r, g, b);
+            aIn.format.colorToRGB(val, r, g, b);
             out[j + aX] = aOut.format.RGBToColor(r, g, b);
          }
       }
@@ -278,18 +224,33 @@ static Common::String s_systemDir;
 
 std::list<Common::Event> _events;
 
+/* Past this many separate dirty rects, one full conversion is cheaper */
+#define MAX_DIRTY_RECTS 32
+
 class OSystem_RETRO : public EventsBaseBackend, public PaletteManager {
    public:
       Graphics::Surface _screen;
 
       Graphics::Surface _gameScreen;
-      RetroPalette _gamePalette;
+      Graphics::PaletteLUT _gamePalette;
 
       Graphics::Surface _overlay;
       bool _overlayVisible;
 
+      /* Regions of the visible game screen or overlay which still need to
+       * be converted into _screen */
+      Common::List<Common::Rect> _dirtyRects;
+      bool _fullRedraw;
+      bool _screenChanged;
+
+      /* Cursor save-under: the _screen pixels hidden by the cursor */
+      Graphics::Surface _cursorSaveUnder;
+      Common::Rect _cursorRect;
+      bool _cursorDrawn;
+      bool _cursorDirty;
+
       Graphics::Surface _mouseImage;
-      RetroPalette _mousePalette;
+      Graphics::PaletteLUT _mousePalette;
       bool _mousePaletteEnabled;
       bool _mouseVisible;
       int _mouseX;
@@ -304,14 +265,16 @@ class OSystem_RETRO : public EventsBaseBackend, public PaletteManager {
 
       uint32 _startTime;
       uint32 _threadExitTime;
+      bool _frameReady;
 
 
       Audio::MixerImpl* _mixer;
 
 
       OSystem_RETRO() :
-         _mousePaletteEnabled(false), _mouseVisible(false), _mouseX(0), _mouseY(0), _mouseHotspotX(0), _mouseHotspotY(0),
-         _mouseKeyColor(0), _mouseDontScale(false), _mixer(0), _startTime(0), _threadExitTime(10)
+         _gamePalette(s_screenFormat), _overlayVisible(false), _fullRedraw(true), _screenChanged(true), _cursorDrawn(false), _cursorDirty(true),
+         _mousePalette(s_screenFormat), _mousePaletteEnabled(false), _mouseVisible(false), _mouseX(0), _mouseY(0), _mouseHotspotX(0), _mouseHotspotY(0),
+         _mouseKeyColor(0), _mouseDontScale(false), _mixer(0), _startTime(0), _threadExitTime(s_frameMillis), _frameReady(false)
    {
       _fsFactory = new FS_SYSTEM_FACTORY();
       memset(_mouseButtons, 0, sizeof(_mouseButtons));
@@ -329,6 +292,7 @@ class OSystem_RETRO : public EventsBaseBackend, public PaletteManager {
          _gameScreen.free();
          _overlay.free();
          _mouseImage.free();
+         _cursorSaveUnder.free();
          _screen.free();
 
          delete _mixer;
@@ -337,12 +301,10 @@ class OSystem_RETRO : public EventsBaseBackend, public PaletteManager {
       virtual void initBackend()
       {
          _savefileManager = new DefaultSaveFileManager();
-#ifdef FRONTEND_SUPPORTS_RGB565
-         _overlay.create(RES_W, RES_H, Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0));
-#else
-         _overlay.create(RES_W, RES_H, Graphics::PixelFormat(2, 5, 5, 5, 1, 10, 5, 0, 15));
-#endif
-         _mixer = new Audio::MixerImpl(this, 44100);
+         /* The overlay is kept in the output format, so the GUI never needs
+          * converting */
+         _overlay.create(RES_W, RES_H, s_screenFormat);
+         _mixer = new Audio::MixerImpl(this, s_sampleRate);
          _timerManager = new DefaultTimerManager();
 
          _mixer->setReady(true);
@@ -358,7 +320,10 @@ class OSystem_RETRO : public EventsBaseBackend, public PaletteManager {
       virtual void setFeatureState(Feature f, bool enable)
       {
          if (f == kFeatureCursorPalette)
+         {
             _mousePaletteEnabled = enable;
+            _cursorDirty = true;
+         }
       }
 
       virtual bool getFeatureState(Feature f)
@@ -390,6 +355,7 @@ class OSystem_RETRO : public EventsBaseBackend, public PaletteManager {
       virtual void initSize(uint width, uint height, const Graphics::PixelFormat *format)
       {
          _gameScreen.create(width, height, format ? *format : Graphics::PixelFormat::createFormatCLUT8());
+         markFullRedraw();
       }
 
       virtual int16 getHeight()
@@ -409,17 +375,26 @@ class OSystem_RETRO : public EventsBaseBackend, public PaletteManager {
 
       virtual Common::List<Graphics::PixelFormat> getSupportedFormats() const
       {
+         static const Graphics::PixelFormat formats[] =
+         {
+            /* RGBA8888 */
+            Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0),
+            /* RGB565 */
+            Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0),
+            /* RGB555 - fmtowns */
+            Graphics::PixelFormat(2, 5, 5, 5, 1, 10, 5, 0, 15)
+         };
+
          Common::List<Graphics::PixelFormat> result;
 
-         /* RGBA8888 */
-         result.push_back(Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0));
+         /* Output format first: games using it are passed through as is */
+         result.push_back(s_screenFormat);
 
-#ifdef FRONTEND_SUPPORTS_RGB565
-         /* RGB565 - overlay */
-         result.push_back(Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0));
-#endif
-         /* RGB555 - fmtowns */
-         result.push_back(Graphics::PixelFormat(2, 5, 5, 5, 1, 10, 5, 0, 15));
+         for(uint i = 0; i < ARRAYSIZE(formats); i ++)
+         {
+            if(formats[i] != s_screenFormat)
+               result.push_back(formats[i]);
+         }
 
          /* Palette - most games */
          result.push_back(Graphics::PixelFormat::createFormatCLUT8());
@@ -433,12 +408,18 @@ class OSystem_RETRO : public EventsBaseBackend, public PaletteManager {
       // PaletteManager API
       virtual void setPalette(const byte *colors, uint start, uint num)
       {
-         _gamePalette.set(colors, start, num);
+         _gamePalette.setPalette(colors, start, num);
+
+         if(!_overlayVisible && _gameScreen.format.bytesPerPixel == 1)
+            markFullRedraw();
+
+         if(!_mousePaletteEnabled)
+            _cursorDirty = true;
       }
 
       virtual void grabPalette(byte *colors, uint start, uint num)
       {
-         _gamePalette.get(colors, start, num);
+         _gamePalette.grabPalette(colors, start, num);
       }
 
 
@@ -448,39 +429,72 @@ class OSystem_RETRO : public EventsBaseBackend, public PaletteManager {
          const uint8_t *src = (const uint8_t*)buf;
          uint8_t *pix = (uint8_t*)_gameScreen.pixels;
          copyRectToSurface(pix, _gameScreen.pitch, src, pitch, x, y, w, h, _gameScreen.format.bytesPerPixel);
+
+         if(!_overlayVisible)
+            addDirtyRect(Common::Rect(x, y, x + w, y + h));
       }
 
       virtual void updateScreen()
       {
+         /* Whatever happens below, the engine is done with this frame */
+         _frameReady = true;
+         retroThreadStats.screenUpdates++;
+
          const Graphics::Surface& srcSurface = (_overlayVisible) ? _overlay : _gameScreen;
+
+         /* Make sure _screen matches the visible surface before drawing */
+         getScreen();
+
+         const bool cursorVisible = _mouseVisible && _mouseImage.w && _mouseImage.h;
+         Common::Rect cursorRect;
+         if(cursorVisible)
+         {
+            cursorRect = Common::Rect(_mouseImage.w, _mouseImage.h);
+            cursorRect.translate(_mouseX - _mouseHotspotX, _mouseY - _mouseHotspotY);
+            cursorRect.clip(_screen.w, _screen.h);
+         }
+
+         const bool cursorChanged = _cursorDirty || cursorVisible != _cursorDrawn || cursorRect != _cursorRect;
+         if(!_fullRedraw && _dirtyRects.empty() && !cursorChanged)
+            return;
+
+         /* Take the cursor off the screen, so dirty rects see the game pixels */
+         if(_cursorDrawn)
+            _screen.copyRectToSurface(_cursorSaveUnder, _cursorRect.left, _cursorRect.top, Common::Rect(_cursorRect.width(), _cursorRect.height()));
+
          if(srcSurface.w && srcSurface.h)
          {
-            switch(srcSurface.format.bytesPerPixel)
+            if(_fullRedraw)
+               convertRect(srcSurface, Common::Rect(srcSurface.w, srcSurface.h));
+            else
             {
-               case 1:
-               case 3:
-                  blit_uint8_uint16_fast(_screen, srcSurface, _gamePalette);
-                  break;
-               case 2:
-                  blit_uint16_uint16(_screen, srcSurface, _gamePalette);
-                  break;
-               case 4:
-                  blit_uint32_uint16(_screen, srcSurface, _gamePalette);
-                  break;
+               for(Common::List<Common::Rect>::const_iterator i = _dirtyRects.begin(); i != _dirtyRects.end(); ++i)
+                  convertRect(srcSurface, *i);
             }
          }
 
+         _dirtyRects.clear();
+         _fullRedraw = false;
+
          // Draw Mouse
-         if(_mouseVisible && _mouseImage.w && _mouseImage.h)
+         _cursorDrawn = false;
+         if(cursorVisible && !cursorRect.isEmpty())
          {
             const int x = _mouseX - _mouseHotspotX;
             const int y = _mouseY - _mouseHotspotY;
 
-            if(_mouseImage.format.bytesPerPixel == 1)
-               blit_uint8_uint16(_screen, _mouseImage, x, y, _mousePaletteEnabled ? _mousePalette : _gamePalette, _mouseKeyColor);
-            else
-               blit_uint16_uint16(_screen, _mouseImage, x, y, _mousePaletteEnabled ? _mousePalette : _gamePalette, _mouseKeyColor);
+            if(_cursorSaveUnder.w != cursorRect.width() || _cursorSaveUnder.h != cursorRect.height())
+               _cursorSaveUnder.create(cursorRect.width(), cursorRect.height(), _screen.format);
+            _cursorSaveUnder.copyRectToSurface(_screen, 0, 0, cursorRect);
+
+            drawCursor(x, y);
+
+            _cursorDrawn = true;
          }
+
+         _cursorRect = cursorRect;
+         _cursorDirty = false;
+         _screenChanged = true;
       }
 
       virtual Graphics::Surface *lockScreen()
@@ -490,7 +504,9 @@ class OSystem_RETRO : public EventsBaseBackend, public PaletteManager {
 
       virtual void unlockScreen()
       {
-         /* EMPTY */
+         /* We can't know what was touched through the surface */
+         if(!_overlayVisible)
+            markFullRedraw();
       }
 
       virtual void setShakePos(int shakeOffset)
@@ -500,17 +516,24 @@ class OSystem_RETRO : public EventsBaseBackend, public PaletteManager {
 
       virtual void showOverlay()
       {
+         if(!_overlayVisible)
+            markFullRedraw();
          _overlayVisible = true;
       }
 
       virtual void hideOverlay()
       {
+         if(_overlayVisible)
+            markFullRedraw();
          _overlayVisible = false;
       }
 
       virtual void clearOverlay()
       {
          _overlay.fillRect(Common::Rect(_overlay.w, _overlay.h), 0);
+
+         if(_overlayVisible)
+            markFullRedraw();
       }
 
       virtual void grabOverlay(void *buf, int pitch)
@@ -520,9 +543,9 @@ class OSystem_RETRO : public EventsBaseBackend, public PaletteManager {
          unsigned i = RES_H;
 
          do{
-            memcpy(dst, src, RES_W << 1);
+            memcpy(dst, src, RES_W * _overlay.format.bytesPerPixel);
             dst += pitch;
-            src += RES_W << 1;
+            src += _overlay.pitch;
          }while(--i);
       }
 
@@ -531,6 +554,9 @@ class OSystem_RETRO : public EventsBaseBackend, public PaletteManager {
          const uint8_t *src = (const uint8_t*)buf;
          uint8_t *pix = (uint8_t*)_overlay.pixels;
          copyRectToSurface(pix, _overlay.pitch, src, pitch, x, y, w, h, _overlay.format.bytesPerPixel);
+
+         if(_overlayVisible)
+            addDirtyRect(Common::Rect(x, y, x + w, y + h));
       }
 
       virtual int16 getOverlayHeight()
@@ -578,22 +604,34 @@ class OSystem_RETRO : public EventsBaseBackend, public PaletteManager {
          _mouseHotspotY = hotspotY;
          _mouseKeyColor = keycolor;
          _mouseDontScale = dontScale;
+         _cursorDirty = true;
       }
 
       virtual void setCursorPalette(const byte *colors, uint start, uint num)
       {
-         _mousePalette.set(colors, start, num);
+         _mousePalette.setPalette(colors, start, num);
          _mousePaletteEnabled = true;
+         _cursorDirty = true;
       }
 
+      /* Return to the frontend once the engine presented a frame, or once
+       * it ran for a whole frame without presenting one (loading, busy
+       * loops). offset is the time the caller is about to wait. */
       bool retroCheckThread(uint32 offset = 0)
       {
-         if(_threadExitTime <= (getMillis() + offset))
+         const bool budgetExpired = _threadExitTime <= (getMillis() + offset);
+         if(_frameReady || budgetExpired)
          {
+            if(_frameReady)
+               retroThreadStats.frameYields++;
+            else
+               retroThreadStats.budgetYields++;
+
             extern void retro_leave_thread();
             retro_leave_thread();
 
-            _threadExitTime = getMillis() + 10;
+            _frameReady = false;
+            _threadExitTime = getMillis() + s_frameMillis;
             return true;
          }
 
@@ -720,23 +758,122 @@ class OSystem_RETRO : public EventsBaseBackend, public PaletteManager {
 
       //
 
+      void markFullRedraw()
+      {
+         _fullRedraw = true;
+         _dirtyRects.clear();
+      }
+
+      void addDirtyRect(Common::Rect aRect)
+      {
+         if(_fullRedraw)
+            return;
+
+         const Graphics::Surface& srcSurface = (_overlayVisible) ? _overlay : _gameScreen;
+         aRect.clip(srcSurface.w, srcSurface.h);
+         if(aRect.isEmpty())
+            return;
+
+         for(Common::List<Common::Rect>::iterator i = _dirtyRects.begin(); i != _dirtyRects.end();)
+         {
+            if(i->contains(aRect))
+               return;
+
+            if(aRect.contains(*i))
+               i = _dirtyRects.erase(i);
+            else
+               ++i;
+         }
+
+         if(_dirtyRects.size() >= MAX_DIRTY_RECTS)
+            markFullRedraw();
+         else
+            _dirtyRects.push_back(aRect);
+      }
+
+      void convertRect(const Graphics::Surface& aIn, Common::Rect aRect)
+      {
+         aRect.clip(MIN<int16>(aIn.w, _screen.w), MIN<int16>(aIn.h, _screen.h));
+         if(aRect.isEmpty())
+            return;
+
+         if(aIn.format == _screen.format)
+         {
+            _screen.copyRectToSurface(aIn, aRect.left, aRect.top, aRect);
+            return;
+         }
+
+         switch(aIn.format.bytesPerPixel)
+         {
+            case 1:
+               blit_uint8_fast(_screen, aIn, _gamePalette, aRect);
+               break;
+            case 2:
+               if(_screen.format.bytesPerPixel == 4)
+                  blit_rgb<uint32, uint16>(_screen, aIn, aRect);
+               else
+                  blit_rgb<uint16, uint16>(_screen, aIn, aRect);
+               break;
+            case 4:
+               if(_screen.format.bytesPerPixel == 4)
+                  blit_rgb<uint32, uint32>(_screen, aIn, aRect);
+               else
+                  blit_rgb<uint16, uint32>(_screen, aIn, aRect);
+               break;
+         }
+      }
+
+      void drawCursor(int aX, int aY)
+      {
+         const Graphics::PaletteLUT& palette = _mousePaletteEnabled ? _mousePalette : _gamePalette;
+         const bool out32 = (_screen.format.bytesPerPixel == 4);
+
+         switch(_mouseImage.format.bytesPerPixel)
+         {
+            case 1:
+               if(out32)
+                  blit_cursor_uint8<uint32>(_screen, _mouseImage, aX, aY, palette, _mouseKeyColor);
+               else
+                  blit_cursor_uint8<uint16>(_screen, _mouseImage, aX, aY, palette, _mouseKeyColor);
+               break;
+            case 2:
+               if(out32)
+                  blit_cursor_rgb<uint32, uint16>(_screen, _mouseImage, aX, aY, _mouseKeyColor);
+               else
+                  blit_cursor_rgb<uint16, uint16>(_screen, _mouseImage, aX, aY, _mouseKeyColor);
+               break;
+            case 4:
+               if(out32)
+                  blit_cursor_rgb<uint32, uint32>(_screen, _mouseImage, aX, aY, _mouseKeyColor);
+               else
+                  blit_cursor_rgb<uint16, uint32>(_screen, _mouseImage, aX, aY, _mouseKeyColor);
+               break;
+         }
+      }
+
       const Graphics::Surface& getScreen()
       {
          const Graphics::Surface& srcSurface = (_overlayVisible) ? _overlay : _gameScreen;
 
          if(srcSurface.w != _screen.w || srcSurface.h != _screen.h)
          {
-#ifdef FRONTEND_SUPPORTS_RGB565
-            _screen.create(srcSurface.w, srcSurface.h, Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0));
-#else
-            _screen.create(srcSurface.w, srcSurface.h, Graphics::PixelFormat(2, 5, 5, 5, 1, 10, 5, 0, 15));
-#endif
+            _screen.create(srcSurface.w, srcSurface.h, s_screenFormat);
+            /* Fresh surface: nothing in it is valid, including the save-under */
+            markFullRedraw();
+            _cursorDrawn = false;
+            _screenChanged = true;
          }
 
-
          return _screen;
       }
 
+      bool screenChanged()
+      {
+         const bool changed = _screenChanged;
+         _screenChanged = false;
+         return changed;
+      }
+
 #define ANALOG_VALUE_X_ADD 1
 #define ANALOG_VALUE_Y_ADD 1
 #define ANALOG_THRESHOLD1 10000
@@ -1007,6 +1144,11 @@ const Graphics::Surface& getScreen()
    return ((OSystem_RETRO*)g_system)->getScreen();
 }
 
+bool retroScreenChanged()
+{
+   return ((OSystem_RETRO*)g_system)->screenChanged();
+}
+
 void retroProcessMouse(retro_input_state_t aCallback)
 {
    ((OSystem_RETRO*)g_system)->processMouse(aCallback);
@@ -43,7 +43,24 @@ extern int access(const char *path, int amode);
 #endif
 
 OSystem* retroBuildOS();
+/* Must be called before retroBuildOS() */
+void retroSetPixelFormat(enum retro_pixel_format aFormat);
+void retroSetSampleRate(uint32_t aRate);
+/* The emulator thread runs for at most one frame before yielding */
+void retroSetFrameRate(uint32_t aFps);
+
+/* Emulator thread counters, reset by the reader */
+struct RetroThreadStats
+{
+   uint32_t frameYields;   /* yields after the engine called updateScreen() */
+   uint32_t budgetYields;  /* yields because the frame budget ran out */
+   uint32_t screenUpdates; /* updateScreen() calls */
+};
+
+extern RetroThreadStats retroThreadStats;
 const Graphics::Surface& getScreen();
+/* Whether updateScreen() changed the screen since the last call */
+bool retroScreenChanged();
 
 void retroProcessMouse(retro_input_state_t aCallback);
 void retroPostQuit();
@@ -31,6 +31,7 @@
 // FIXME: Avoid using printf
 #define FORBIDDEN_SYMBOL_EXCEPTION_printf
 
+#include "engines/detectionCache.h"
 #include "engines/engine.h"
 #include "engines/metaengine.h"
 #include "base/commandLine.h"
@@ -606,6 +607,8 @@ extern "C" int scummvm_main(int argc, const char * const argv[]) {
 #endif
 	PluginManager::instance().unloadAllPlugins();
 	PluginManager::destroy();
+	// Saves the detection cache, before the config needed for that is gone
+	DetectionCache::destroy();
 	GUI::GuiManager::destroy();
 	Common::ConfigManager::destroy();
 	Common::DebugManager::destroy();
@@ -48,6 +48,14 @@ public:
 	virtual SeekableReadStream *createReadStream() const = 0;
 	virtual String getName() const = 0;
 	virtual String getDisplayName() const { return getName(); }
+
+	/**
+	 * Fetches the size and the modification time of the member without
+	 * opening it. Only members backed by a file system node know them.
+	 *
+	 * @return true if both values are known, false otherwise
+	 */
+	virtual bool getFileInfo(uint32 &size, uint32 &modificationTime) const { return false; }
 };
 
 typedef SharedPtr<ArchiveMember> ArchiveMemberPtr;
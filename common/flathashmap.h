@@ -0,0 +1,483 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef COMMON_FLATHASHMAP_H
+#define COMMON_FLATHASHMAP_H
+
+#include "common/func.h"
+
+namespace Common {
+
+/**
+ * FlatHashMap<Key,Val> is an open addressing variant of HashMap, with the
+ * same interface. The nodes live directly in the table instead of being
+ * allocated one by one, and a separate array with one control byte per
+ * slot tells whether it is empty, erased or in use. The control byte of a
+ * used slot also holds 7 more bits of the hash, so the probe loop only has
+ * to look at the small control array and rarely compares keys that do not
+ * match.
+ *
+ * Unlike with HashMap, inserting elements may move all nodes, which
+ * invalidates references and pointers to keys and values as well as
+ * iterators. Use HashMap where these have to stay valid.
+ *
+ * The lookup methods are templates: any type the hash and the equality
+ * functors accept can be used as a key. With the string functors from
+ * common/hash-str.h, a map with String keys can be searched with a plain
+ * const char * without creating a temporary String.
+ */
+template<class Key, class Val, class HashFunc = Hash<Key>, class EqualFunc = EqualTo<Key> >
+class FlatHashMap {
+public:
+	typedef uint size_type;
+
+	struct Node {
+		const Key _key;
+		Val _value;
+		explicit Node(const Key &key) : _key(key), _value() {}
+		Node(const Node &node) : _key(node._key), _value(node._value) {}
+
+	private:
+		Node &operator=(const Node &);
+	};
+
+private:
+	typedef FlatHashMap<Key, Val, HashFunc, EqualFunc> FHM_t;
+
+	enum {
+		/** Control byte of a slot which never was used. */
+		kEmpty = 0x80,
+		/** Control byte of a slot whose element was erased. */
+		kErased = 0xFE,
+
+		kMinCapacity = 16,
+
+		// Used and erased slots may fill up the table to this fraction
+		// before it is rehashed.
+		kLoadNumerator = 3,
+		kLoadDenominator = 4
+	};
+
+	byte *_control;     ///< One control byte per slot
+	Node *_nodes;       ///< The slots; only constructed where the control byte is < 0x80
+	size_type _mask;    ///< Capacity of the table minus one, the capacity is a power of two
+	size_type _shift;   ///< Right shift turning a mixed hash into a slot index
+	size_type _size;
+	size_type _erased;  ///< Number of slots marked as kErased
+
+	HashFunc _hash;
+	EqualFunc _equal;
+
+	/** Default value, returned by the const getVal. */
+	const Val _defaultVal;
+
+	/**
+	 * The slot index to start the probing at. The hash is folded before
+	 * the Fibonacci multiplication, so keys which already are multiples
+	 * of some constant do not end up in long runs.
+	 */
+	size_type homeSlot(uint hash) const {
+		return (size_type)(((hash ^ (hash >> 16)) * 2654435769U) >> _shift);
+	}
+
+	/** The 7 hash bits kept in the control byte, independent from homeSlot(). */
+	static byte hashTag(uint hash) {
+		return (byte)((hash * 2246822507U) >> 25);
+	}
+
+	static bool isUsed(byte control) {
+		return control < kEmpty;
+	}
+
+	void allocate(size_type capacity);
+	void destroyNodes();
+	void assign(const FHM_t &map);
+	void rehash(size_type capacity);
+
+	template<class K>
+	size_type lookup(const K &key) const;
+
+	template<class K>
+	size_type lookupAndCreateIfMissing(const K &key);
+
+	void eraseSlot(size_type slot);
+
+	/**
+	 * Simple FlatHashMap iterator implementation.
+	 */
+	template<class NodeType>
+	class IteratorImpl {
+		friend class FlatHashMap;
+		template<class T> friend class IteratorImpl;
+
+	protected:
+		typedef const FlatHashMap hashmap_t;
+
+		size_type _idx;
+		hashmap_t *_hashmap;
+
+		IteratorImpl(size_type idx, hashmap_t *hashmap) : _idx(idx), _hashmap(hashmap) {}
+
+		NodeType *deref() const {
+			assert(_hashmap != 0);
+			assert(_idx <= _hashmap->_mask);
+			assert(isUsed(_hashmap->_control[_idx]));
+			return &_hashmap->_nodes[_idx];
+		}
+
+	public:
+		IteratorImpl() : _idx(0), _hashmap(0) {}
+		template<class T>
+		IteratorImpl(const IteratorImpl<T> &c) : _idx(c._idx), _hashmap(c._hashmap) {}
+
+		NodeType &operator*() const { return *deref(); }
+		NodeType *operator->() const { return deref(); }
+
+		bool operator==(const IteratorImpl &iter) const { return _idx == iter._idx && _hashmap == iter._hashmap; }
+		bool operator!=(const IteratorImpl &iter) const { return !(*this == iter); }
+
+		IteratorImpl &operator++() {
+			assert(_hashmap);
+			_idx = _hashmap->nextUsedSlot(_idx + 1);
+			return *this;
+		}
+
+		IteratorImpl operator++(int) {
+			IteratorImpl old = *this;
+			operator ++();
+			return old;
+		}
+	};
+
+	/** The first used slot at or after the given one, or (size_type)-1. */
+	size_type nextUsedSlot(size_type slot) const {
+		for (; slot <= _mask; ++slot) {
+			if (isUsed(_control[slot]))
+				return slot;
+		}
+		return (size_type)-1;
+	}
+
+public:
+	typedef IteratorImpl<Node> iterator;
+	typedef IteratorImpl<const Node> const_iterator;
+
+	FlatHashMap();
+	FlatHashMap(const FHM_t &map);
+	~FlatHashMap();
+
+	FHM_t &operator=(const FHM_t &map) {
+		if (this == &map)
+			return *this;
+
+		destroyNodes();
+		free(_control);
+		free(_nodes);
+		assign(map);
+		return *this;
+	}
+
+	template<class K>
+	bool contains(const K &key) const {
+		return lookup(key) != (size_type)-1;
+	}
+
+	template<class K>
+	Val &operator[](const K &key) { return getVal(key); }
+
+	template<class K>
+	const Val &operator[](const K &key) const { return getVal(key); }
+
+	template<class K>
+	Val &getVal(const K &key) {
+		// Look up first: inserting may reallocate _nodes
+		const size_type slot = lookupAndCreateIfMissing(key);
+		return _nodes[slot]._value;
+	}
+
+	template<class K>
+	const Val &getVal(const K &key) const {
+		return getVal(key, _defaultVal);
+	}
+
+	template<class K>
+	const Val &getVal(const K &key, const Val &defaultVal) const {
+		const size_type slot = lookup(key);
+		return (slot != (size_type)-1) ? _nodes[slot]._value : defaultVal;
+	}
+
+	template<class K>
+	void setVal(const K &key, const Val &val) {
+		const size_type slot = lookupAndCreateIfMissing(key);
+		_nodes[slot]._value = val;
+	}
+
+	void clear(bool shrinkArray = 0);
+
+	/**
+	 * Make room for at least the given number of elements, so inserting
+	 * up to that many does not rehash the table.
+	 */
+	void reserve(size_type count);
+
+	void erase(iterator entry);
+
+	template<class K>
+	void erase(const K &key) {
+		const size_type slot = lookup(key);
+		if (slot != (size_type)-1)
+			eraseSlot(slot);
+	}
+
+	size_type size() const { return _size; }
+
+	iterator begin() { return iterator(nextUsedSlot(0), this); }
+	iterator end() { return iterator((size_type)-1, this); }
+
+	const_iterator begin() const { return const_iterator(nextUsedSlot(0), this); }
+	const_iterator end() const { return const_iterator((size_type)-1, this); }
+
+	template<class K>
+	iterator find(const K &key) { return iterator(lookup(key), this); }
+
+	template<class K>
+	const_iterator find(const K &key) const { return const_iterator(lookup(key), this); }
+
+	bool empty() const {
+		return (_size == 0);
+	}
+};
+
+//-------------------------------------------------------
+// FlatHashMap functions
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+FlatHashMap<Key, Val, HashFunc, EqualFunc>::FlatHashMap() : _defaultVal() {
+	allocate(kMinCapacity);
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+FlatHashMap<Key, Val, HashFunc, EqualFunc>::FlatHashMap(const FHM_t &map) : _defaultVal() {
+	assign(map);
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+FlatHashMap<Key, Val, HashFunc, EqualFunc>::~FlatHashMap() {
+	destroyNodes();
+	free(_control);
+	free(_nodes);
+}
+
+/**
+ * Internal method for setting up empty storage of the given capacity.
+ *
+ * @note The previous storage is *not* freed.
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::allocate(size_type capacity) {
+	assert(capacity >= kMinCapacity && (capacity & (capacity - 1)) == 0);
+
+	_control = (byte *)malloc(capacity);
+	_nodes = (Node *)malloc(capacity * sizeof(Node));
+	assert(_control && _nodes);
+	memset(_control, kEmpty, capacity);
+
+	_mask = capacity - 1;
+	_shift = 32;
+	while (capacity > 1) {
+		capacity >>= 1;
+		_shift--;
+	}
+
+	_size = 0;
+	_erased = 0;
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::destroyNodes() {
+	for (size_type slot = 0; slot <= _mask; ++slot) {
+		if (isUsed(_control[slot]))
+			_nodes[slot].~Node();
+	}
+}
+
+/**
+ * Internal method for assigning the content of another FlatHashMap
+ * to this one.
+ *
+ * @note We do *not* deallocate the previous storage here -- the caller is
+ *       responsible for doing that!
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::assign(const FHM_t &map) {
+	allocate(map._mask + 1);
+
+	// The layout stays the same, so the nodes can be copied slot by slot
+	memcpy(_control, map._control, _mask + 1);
+	for (size_type slot = 0; slot <= _mask; ++slot) {
+		if (isUsed(_control[slot]))
+			new ((void *)&_nodes[slot]) Node(map._nodes[slot]);
+	}
+
+	_size = map._size;
+	_erased = map._erased;
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::rehash(size_type capacity) {
+	byte *oldControl = _control;
+	Node *oldNodes = _nodes;
+	const size_type oldMask = _mask;
+	const size_type oldSize = _size;
+
+	allocate(capacity);
+
+	for (size_type slot = 0; slot <= oldMask; ++slot) {
+		if (!isUsed(oldControl[slot]))
+			continue;
+
+		// Every key is unique, so the first free slot will do
+		const uint hash = _hash(oldNodes[slot]._key);
+		size_type newSlot = homeSlot(hash);
+		while (_control[newSlot] != kEmpty)
+			newSlot = (newSlot + 1) & _mask;
+
+		_control[newSlot] = hashTag(hash);
+		new ((void *)&_nodes[newSlot]) Node(oldNodes[slot]);
+		oldNodes[slot].~Node();
+		_size++;
+	}
+
+	assert(_size == oldSize);
+
+	free(oldControl);
+	free(oldNodes);
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+template<class K>
+typename FlatHashMap<Key, Val, HashFunc, EqualFunc>::size_type FlatHashMap<Key, Val, HashFunc, EqualFunc>::lookup(const K &key) const {
+	const uint hash = _hash(key);
+	const byte tag = hashTag(hash);
+
+	// The table always has empty slots, so this terminates
+	for (size_type slot = homeSlot(hash); ; slot = (slot + 1) & _mask) {
+		const byte control = _control[slot];
+		if (control == tag && _equal(_nodes[slot]._key, key))
+			return slot;
+		if (control == kEmpty)
+			return (size_type)-1;
+	}
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+template<class K>
+typename FlatHashMap<Key, Val, HashFunc, EqualFunc>::size_type FlatHashMap<Key, Val, HashFunc, EqualFunc>::lookupAndCreateIfMissing(const K &key) {
+	const uint hash = _hash(key);
+	const byte tag = hashTag(hash);
+
+	size_type slot = homeSlot(hash);
+	size_type firstErased = (size_type)-1;
+	for (; ; slot = (slot + 1) & _mask) {
+		const byte control = _control[slot];
+		if (control == tag && _equal(_nodes[slot]._key, key))
+			return slot;
+		if (control == kEmpty)
+			break;
+		if (control == kErased && firstErased == (size_type)-1)
+			firstErased = slot;
+	}
+
+	if (firstErased != (size_type)-1) {
+		// Reusing an erased slot does not change the load
+		slot = firstErased;
+		_erased--;
+	} else if ((_size + _erased + 1) * kLoadDenominator > (_mask + 1) * kLoadNumerator) {
+		// Grow, unless mostly erased slots fill the table
+		rehash(_size * 2 * kLoadDenominator > (_mask + 1) * kLoadNumerator ? (_mask + 1) * 2 : _mask + 1);
+
+		slot = homeSlot(hash);
+		while (_control[slot] != kEmpty)
+			slot = (slot + 1) & _mask;
+	}
+
+	new ((void *)&_nodes[slot]) Node(key);
+	_control[slot] = tag;
+	_size++;
+
+	return slot;
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::eraseSlot(size_type slot) {
+	assert(isUsed(_control[slot]));
+
+	_nodes[slot].~Node();
+	_size--;
+
+	// No probe sequence can pass an empty slot, so when the next slot is
+	// empty, nothing needs this one to be marked as erased
+	if (_control[(slot + 1) & _mask] == kEmpty) {
+		_control[slot] = kEmpty;
+	} else {
+		_control[slot] = kErased;
+		_erased++;
+	}
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::erase(iterator entry) {
+	// Check whether we have a valid iterator
+	assert(entry._hashmap == this);
+	assert(entry._idx <= _mask);
+
+	eraseSlot(entry._idx);
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::clear(bool shrinkArray) {
+	destroyNodes();
+
+	if (shrinkArray && _mask + 1 > kMinCapacity) {
+		free(_control);
+		free(_nodes);
+		allocate(kMinCapacity);
+	} else {
+		memset(_control, kEmpty, _mask + 1);
+		_size = 0;
+		_erased = 0;
+	}
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::reserve(size_type count) {
+	size_type capacity = _mask + 1;
+	while ((count + _erased) * kLoadDenominator > capacity * kLoadNumerator)
+		capacity *= 2;
+
+	if (capacity > _mask + 1)
+		rehash(capacity);
+}
+
+} // End of namespace Common
+
+#endif
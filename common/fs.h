@@ -213,6 +213,16 @@ public:
 	 */
 	bool isWritable() const;
 
+	/**
+	 * Fetches the size and the modification time of the file referred by
+	 * this node, without opening it. The modification time is only meant
+	 * to tell whether the file changed, so its epoch is up to the backend.
+	 *
+	 * @return true if both values are known, false otherwise (including
+	 *         when the backend does not provide them).
+	 */
+	virtual bool getFileInfo(uint32 &size, uint32 &modificationTime) const;
+
 	/**
 	 * Creates a SeekableReadStream instance corresponding to the file
 	 * referred by this node. This assumes that the node actually refers
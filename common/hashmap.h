@@ -247,6 +247,12 @@ public:
 
 	void clear(bool shrinkArray = 0);
 
+	/**
+	 * Make room for at least the given number of elements, so inserting
+	 * up to that many does not grow the storage.
+	 */
+	void reserve(size_type count);
+
 	void erase(iterator entry);
 	void erase(const Key &key);
 
@@ -416,6 +422,16 @@ void HashMap<Key, Val, HashFunc, EqualFunc>::clear(bool shrinkArray) {
 	_deleted = 0;
 }
 
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void HashMap<Key, Val, HashFunc, EqualFunc>::reserve(size_type count) {
+	size_type capacity = _mask + 1;
+	while ((count + _deleted) * HASHMAP_LOADFACTOR_DENOMINATOR > capacity * HASHMAP_LOADFACTOR_NUMERATOR)
+		capacity *= 2;
+
+	if (capacity > _mask + 1)
+		expandStorage(capacity);
+}
+
 template<class Key, class Val, class HashFunc, class EqualFunc>
 void HashMap<Key, Val, HashFunc, EqualFunc>::expandStorage(size_type newCapacity) {
 	assert(newCapacity > _mask+1);
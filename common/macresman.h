@@ -176,6 +176,12 @@ public:
 	 */
 	MacResTagArray getResTagArray();
 
+	/**
+	 * Get the name of the AppleDouble file holding the resource fork of
+	 * the given file, as open() looks for it.
+	 */
+	static String constructAppleDoubleName(String name);
+
 private:
 	SeekableReadStream *_stream;
 	String _baseFileName;
@@ -186,7 +192,6 @@ private:
 	bool loadFromMacBinary(SeekableReadStream &stream);
 	bool loadFromAppleDouble(SeekableReadStream &stream);
 
-	static String constructAppleDoubleName(String name);
 	static String disassembleAppleDoubleName(String name, bool *isAppleDouble);
 
 	/**
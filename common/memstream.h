@@ -63,6 +63,7 @@ public:
 	}
 
 	uint32 read(void *dataPtr, uint32 dataSize);
+	const byte *borrow(uint32 dataSize);
 
 	bool eos() const { return _eos; }
 	void clearErr() { _eos = false; }
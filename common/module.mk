@@ -32,6 +32,7 @@ MODULE_OBJS := \
 	stream.o \
 	system.o \
 	textconsole.o \
+	thread.o \
 	tokenizer.o \
 	translation.o \
 	unarj.o \
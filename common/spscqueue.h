@@ -0,0 +1,174 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef COMMON_SPSCQUEUE_H
+#define COMMON_SPSCQUEUE_H
+
+#include "common/scummsys.h"
+#include "common/noncopyable.h"
+#include "common/util.h"
+
+namespace Common {
+
+/**
+ * Full memory barrier, so data written before it is visible to other
+ * threads before anything written after it.
+ */
+#if defined(__GNUC__)
+inline void memoryBarrier() {
+	__sync_synchronize();
+}
+#elif defined(_MSC_VER)
+// Calls MemoryBarrier(), which needs windows.h, in thread.cpp
+void memoryBarrier();
+#else
+#error No memory barrier is known for this compiler
+#endif
+
+/**
+ * A bounded FIFO queue for handing elements from exactly one producer
+ * thread to exactly one consumer thread without locking.
+ *
+ * Only the producer may call push() and write(), and only the consumer may
+ * call pop(), peek(), drop() and read(). size() and getFree() may be called
+ * from either side, the result is then a lower bound for the consumer and
+ * for the producer respectively.
+ */
+template<class T>
+class SPSCQueue : NonCopyable {
+public:
+	/**
+	 * @param capacity  the maximum number of queued elements, a power of two
+	 */
+	explicit SPSCQueue(uint capacity) : _buffer(new T[capacity]), _mask(capacity - 1), _readPos(0), _writePos(0) {
+		assert(capacity > 0 && (capacity & (capacity - 1)) == 0);
+	}
+
+	~SPSCQueue() {
+		delete[] _buffer;
+	}
+
+	uint capacity() const { return _mask + 1; }
+
+	uint size() const { return _writePos - _readPos; }
+	uint getFree() const { return capacity() - size(); }
+	bool empty() const { return _writePos == _readPos; }
+
+	/** Append one element; returns false if the queue is full. */
+	bool push(const T &element) {
+		const uint32 pos = _writePos;
+		if (pos - _readPos > _mask)
+			return false;
+
+		_buffer[pos & _mask] = element;
+		memoryBarrier();
+		_writePos = pos + 1;
+		return true;
+	}
+
+	/** Remove the first element; returns false if the queue is empty. */
+	bool pop(T &element) {
+		const T *first = peek();
+		if (!first)
+			return false;
+
+		element = *first;
+		drop();
+		return true;
+	}
+
+	/**
+	 * The first element, which stays queued until drop() is called, or 0
+	 * if the queue is empty.
+	 */
+	const T *peek() const {
+		const uint32 pos = _readPos;
+		if (pos == _writePos)
+			return 0;
+
+		memoryBarrier();
+		return &_buffer[pos & _mask];
+	}
+
+	/** Remove the first element, after peek() returned it. */
+	void drop() {
+		assert(!empty());
+		memoryBarrier();
+		_readPos = _readPos + 1;
+	}
+
+	/**
+	 * Append up to count elements.
+	 *
+	 * @return the number of elements which fit into the queue
+	 */
+	uint write(const T *data, uint count) {
+		const uint32 pos = _writePos;
+		count = MIN<uint>(count, capacity() - (pos - _readPos));
+
+		const uint offset = pos & _mask;
+		const uint first = MIN<uint>(count, capacity() - offset);
+		copy(_buffer + offset, data, first);
+		copy(_buffer, data + first, count - first);
+
+		memoryBarrier();
+		_writePos = pos + count;
+		return count;
+	}
+
+	/**
+	 * Remove up to count elements.
+	 *
+	 * @return the number of elements which were queued and copied to data
+	 */
+	uint read(T *data, uint count) {
+		const uint32 pos = _readPos;
+		count = MIN<uint>(count, _writePos - pos);
+		memoryBarrier();
+
+		const uint offset = pos & _mask;
+		const uint first = MIN<uint>(count, capacity() - offset);
+		copy(data, _buffer + offset, first);
+		copy(data + first, _buffer, count - first);
+
+		memoryBarrier();
+		_readPos = pos + count;
+		return count;
+	}
+
+private:
+	static void copy(T *dst, const T *src, uint count) {
+		for (uint i = 0; i < count; ++i)
+			dst[i] = src[i];
+	}
+
+	T *const _buffer;
+	const uint32 _mask;
+
+	/** Free running positions; each one is only written by one side. */
+	volatile uint32 _readPos;
+	volatile uint32 _writePos;
+};
+
+} // End of namespace Common
+
+#endif
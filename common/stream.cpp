@@ -54,6 +54,17 @@ uint32 MemoryReadStream::read(void *dataPtr, uint32 dataSize) {
 	return dataSize;
 }
 
+const byte *MemoryReadStream::borrow(uint32 dataSize) {
+	if (dataSize > _size - _pos)
+		return 0;
+
+	const byte *data = _ptr;
+	_ptr += dataSize;
+	_pos += dataSize;
+
+	return data;
+}
+
 bool MemoryReadStream::seek(int32 offs, int whence) {
 	// Pre-Condition
 	assert(_pos <= _size);
@@ -240,6 +251,17 @@ bool SeekableSubReadStream::seek(int32 offset, int whence) {
 	return ret;
 }
 
+const byte *SeekableSubReadStream::borrow(uint32 dataSize) {
+	if (dataSize > _end - _pos)
+		return 0;
+
+	const byte *data = _parentStream->borrow(dataSize);
+	if (data)
+		_pos += dataSize;
+
+	return data;
+}
+
 uint32 SafeSeekableSubReadStream::read(void *dataPtr, uint32 dataSize) {
 	// Make sure the parent stream is at the right position
 	seek(0, SEEK_CUR);
@@ -247,6 +269,13 @@ uint32 SafeSeekableSubReadStream::read(void *dataPtr, uint32 dataSize) {
 	return SeekableSubReadStream::read(dataPtr, dataSize);
 }
 
+const byte *SafeSeekableSubReadStream::borrow(uint32 dataSize) {
+	// Make sure the parent stream is at the right position
+	seek(0, SEEK_CUR);
+
+	return SeekableSubReadStream::borrow(dataSize);
+}
+
 
 #pragma mark -
 
@@ -461,6 +461,22 @@ public:
 	 */
 	virtual bool skip(uint32 offset) { return seek(offset, SEEK_CUR); }
 
+	/**
+	 * Borrows the next dataSize bytes of the stream without copying them,
+	 * and advances the position indicator past them like read() would.
+	 * Only streams which already have their whole contents in memory,
+	 * like a MemoryReadStream or a memory mapped file, support this.
+	 *
+	 * The returned data is owned by the stream and stays valid as long as
+	 * the stream exists. It must not be modified.
+	 *
+	 * @param dataSize	number of bytes to borrow
+	 * @return a pointer to the data, or 0 if the stream does not support
+	 *         borrowing or less than dataSize bytes are left; the position
+	 *         indicator is left unchanged in that case
+	 */
+	virtual const byte *borrow(uint32 dataSize) { return 0; }
+
 	/**
 	 * Reads at most one less than the number of characters specified
 	 * by bufSize from the and stores them in the string buf. Reading
@@ -0,0 +1,137 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+// Thread creation and sleeping are not available through OSystem
+#define FORBIDDEN_SYMBOL_ALLOW_ALL
+
+#if defined(_MSC_VER)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+// winnt.h defines ARRAYSIZE, but we want our own one... - this is needed before including util.h
+#undef ARRAYSIZE
+#endif
+
+#include "common/thread.h"
+#include "common/spscqueue.h"
+
+#ifdef HAVE_PTHREAD
+#include <pthread.h>
+#include <time.h>
+#endif
+
+namespace Common {
+
+#ifdef HAVE_PTHREAD
+
+struct Thread::State {
+	pthread_t thread;
+	ThreadProc proc;
+	void *param;
+
+	static void *run(void *arg) {
+		State *state = (State *)arg;
+		state->proc(state->param);
+		return 0;
+	}
+};
+
+Thread::Thread() : _state(0) {
+}
+
+Thread::~Thread() {
+	join();
+}
+
+bool Thread::isSupported() {
+	return true;
+}
+
+bool Thread::start(ThreadProc proc, void *param) {
+	assert(!_state);
+
+	State *state = new State;
+	state->proc = proc;
+	state->param = param;
+	if (pthread_create(&state->thread, 0, &State::run, state) != 0) {
+		delete state;
+		return false;
+	}
+
+	_state = state;
+	return true;
+}
+
+void Thread::join() {
+	if (!_state)
+		return;
+
+	pthread_join(_state->thread, 0);
+	delete _state;
+	_state = 0;
+}
+
+bool Thread::isCurrent() const {
+	return _state && pthread_equal(_state->thread, pthread_self());
+}
+
+void Thread::sleep(uint32 usecs) {
+	struct timespec delay;
+	delay.tv_sec = usecs / 1000000;
+	delay.tv_nsec = (usecs % 1000000) * 1000;
+	nanosleep(&delay, 0);
+}
+
+#else
+
+Thread::Thread() : _state(0) {
+}
+
+Thread::~Thread() {
+}
+
+bool Thread::isSupported() {
+	return false;
+}
+
+bool Thread::start(ThreadProc proc, void *param) {
+	return false;
+}
+
+void Thread::join() {
+}
+
+bool Thread::isCurrent() const {
+	return false;
+}
+
+void Thread::sleep(uint32 usecs) {
+}
+
+#endif
+
+#if defined(_MSC_VER)
+void memoryBarrier() {
+	MemoryBarrier();
+}
+#endif
+
+} // End of namespace Common
@@ -0,0 +1,77 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef COMMON_THREAD_H
+#define COMMON_THREAD_H
+
+#include "common/scummsys.h"
+#include "common/noncopyable.h"
+
+namespace Common {
+
+/**
+ * A minimal worker thread, for work which should neither run in the audio
+ * callback nor in the main loop.
+ *
+ * OSystem has no threading API on purpose, since many ports do not have
+ * threads. This class is only functional where the build found POSIX
+ * threads; callers check isSupported() and otherwise do their work
+ * synchronously as before.
+ */
+class Thread : NonCopyable {
+public:
+	typedef void (*ThreadProc)(void *param);
+
+	Thread();
+
+	/** Waits for the thread to finish, if it was started. */
+	~Thread();
+
+	/** Whether threads can be started in this build. */
+	static bool isSupported();
+
+	/**
+	 * Run proc(param) on a new thread.
+	 *
+	 * @return false if the thread could not be created
+	 */
+	bool start(ThreadProc proc, void *param);
+
+	/** Wait for the thread to return from its ThreadProc. */
+	void join();
+
+	bool isRunning() const { return _state != 0; }
+
+	/** Whether the caller is running on this thread. */
+	bool isCurrent() const;
+
+	/** Put the calling thread to sleep for the given number of microseconds. */
+	static void sleep(uint32 usecs);
+
+private:
+	struct State;
+	State *_state;
+};
+
+} // End of namespace Common
+
+#endif
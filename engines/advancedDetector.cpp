@@ -28,11 +28,90 @@
 #include "common/config-manager.h"
 #include "common/system.h"
 #include "common/textconsole.h"
+#include "common/thread.h"
 #include "common/translation.h"
 #include "gui/EventRecorder.h"
 #include "engines/advancedDetector.h"
+#include "engines/detectionCache.h"
 #include "engines/obsolete.h"
 
+enum {
+	// Number of threads computing MD5s in detectGame(), including the caller
+	kDetectionThreads = 4
+};
+
+namespace {
+
+/** A file detectGame() has to compute the properties of */
+struct FilePropertiesJob {
+	Common::String fname;
+	Common::FSNode node;
+	Common::String cacheKey;
+	Common::String cacheStamp;
+	bool found;
+	ADFileProperties props;
+};
+
+struct FilePropertiesWorker {
+	Common::Array<FilePropertiesJob> *jobs;
+	uint md5Bytes;
+	uint first;
+	uint step;
+};
+
+} // End of anonymous namespace
+
+static bool computeFileProperties(const Common::FSNode &node, uint md5Bytes, ADFileProperties &fileProps) {
+	Common::File testFile;
+
+	if (!testFile.open(node))
+		return false;
+
+	fileProps.size = (int32)testFile.size();
+	fileProps.md5 = Common::computeStreamMD5AsString(testFile, md5Bytes);
+	return true;
+}
+
+static void filePropertiesWorkerProc(void *param) {
+	FilePropertiesWorker *worker = (FilePropertiesWorker *)param;
+	Common::Array<FilePropertiesJob> &jobs = *worker->jobs;
+
+	for (uint i = worker->first; i < jobs.size(); i += worker->step)
+		jobs[i].found = computeFileProperties(jobs[i].node, worker->md5Bytes, jobs[i].props);
+}
+
+/**
+ * Compute the properties of the files in jobs, spread over several threads
+ * where available. Reading the files is what takes the time, so this helps
+ * even with a single core.
+ */
+static void computeFilesProperties(Common::Array<FilePropertiesJob> &jobs, uint md5Bytes) {
+	uint numThreads = 1;
+	if (Common::Thread::isSupported())
+		numThreads = MIN<uint>(jobs.size(), kDetectionThreads);
+
+	FilePropertiesWorker workers[kDetectionThreads];
+	Common::Thread threads[kDetectionThreads - 1];
+
+	for (uint i = 0; i < numThreads; i++) {
+		workers[i].jobs = &jobs;
+		workers[i].md5Bytes = md5Bytes;
+		workers[i].first = i;
+		workers[i].step = numThreads;
+	}
+
+	for (uint i = 1; i < numThreads; i++) {
+		if (!threads[i - 1].start(filePropertiesWorkerProc, &workers[i]))
+			filePropertiesWorkerProc(&workers[i]);
+	}
+
+	if (numThreads > 0)
+		filePropertiesWorkerProc(&workers[0]);
+
+	for (uint i = 1; i < numThreads; i++)
+		threads[i - 1].join();
+}
+
 static GameDescriptor toGameDescriptor(const ADGameDescription &g, const PlainGameDescriptor *sg) {
 	const char *title = 0;
 	const char *extra;
@@ -385,10 +464,48 @@ void AdvancedMetaEngine::composeFileHashMap(FileMap &allFiles, const Common::FSL
 	}
 }
 
+void AdvancedMetaEngine::getFileCacheInfo(const Common::FSNode &parent, const FileMap &allFiles, const ADGameDescription &game, const Common::String &fname, Common::String &key, Common::String &stamp) const {
+	if (game.flags & ADGF_MACRESFORK) {
+		// The fork can come from any of the files MacResManager::open() tries
+		const Common::String candidates[] = {
+			fname + ".rsrc",
+			Common::MacResManager::constructAppleDoubleName(fname),
+			fname + ".bin",
+			fname
+		};
+
+		bool known = false;
+		stamp.clear();
+		for (uint i = 0; i < ARRAYSIZE(candidates); i++) {
+			const Common::String candidateStamp = DetectionCache::makeStamp(parent.getChild(candidates[i]));
+			if (!candidateStamp.empty())
+				known = true;
+			stamp += (candidateStamp.empty() ? "-" : candidateStamp) + ",";
+		}
+		if (!known)
+			stamp.clear();
+
+		key = Common::String::format("rsrc:%u:", _md5Bytes) + parent.getPath() + "/" + fname;
+	} else {
+		const Common::FSNode &node = allFiles[fname];
+
+		stamp = DetectionCache::makeStamp(node);
+		key = Common::String::format("%u:", _md5Bytes) + node.getPath();
+	}
+}
+
 bool AdvancedMetaEngine::getFileProperties(const Common::FSNode &parent, const FileMap &allFiles, const ADGameDescription &game, const Common::String fname, ADFileProperties &fileProps) const {
 	// FIXME/TODO: We don't handle the case that a file is listed as a regular
 	// file and as one with resource fork.
 
+	if (!(game.flags & ADGF_MACRESFORK) && !allFiles.contains(fname))
+		return false;
+
+	Common::String cacheKey, cacheStamp;
+	getFileCacheInfo(parent, allFiles, game, fname, cacheKey, cacheStamp);
+	if (DetectionCacheMan.lookup(cacheKey, cacheStamp, fileProps))
+		return true;
+
 	if (game.flags & ADGF_MACRESFORK) {
 		Common::MacResManager macResMan;
 
@@ -397,24 +514,18 @@ bool AdvancedMetaEngine::getFileProperties(const Common::FSNode &parent, const F
 
 		fileProps.md5 = macResMan.computeResForkMD5AsString(_md5Bytes);
 		fileProps.size = macResMan.getResForkDataSize();
-		return true;
-	}
-
-	if (!allFiles.contains(fname))
-		return false;
-
-	Common::File testFile;
-
-	if (!testFile.open(allFiles[fname]))
+	} else if (!computeFileProperties(allFiles[fname], _md5Bytes, fileProps)) {
 		return false;
+	}
 
-	fileProps.size = (int32)testFile.size();
-	fileProps.md5 = Common::computeStreamMD5AsString(testFile, _md5Bytes);
+	DetectionCacheMan.store(cacheKey, cacheStamp, fileProps);
 	return true;
 }
 
 ADGameDescList AdvancedMetaEngine::detectGame(const Common::FSNode &parent, const FileMap &allFiles, Common::Language language, Common::Platform platform, const Common::String &extra) const {
 	ADFilePropertiesMap filesProps;
+	Common::HashMap<Common::String, bool, Common::IgnoreCase_Hash, Common::IgnoreCase_EqualTo> filesQueued;
+	Common::Array<FilePropertiesJob> jobs;
 
 	const ADGameFileDescription *fileDesc;
 	const ADGameDescription *g;
@@ -423,24 +534,63 @@ ADGameDescList AdvancedMetaEngine::detectGame(const Common::FSNode &parent, cons
 	debug(3, "Starting detection in dir '%s'", parent.getPath().c_str());
 
 	// Check which files are included in some ADGameDescription *and* are present.
-	// Compute MD5s and file sizes for these files.
+	// Compute MD5s and file sizes for these files, unless they are cached.
 	for (descPtr = _gameDescriptors; ((const ADGameDescription *)descPtr)->gameId != 0; descPtr += _descItemSize) {
 		g = (const ADGameDescription *)descPtr;
 
 		for (fileDesc = g->filesDescriptions; fileDesc->fileName; fileDesc++) {
 			Common::String fname = fileDesc->fileName;
-			ADFileProperties tmp;
 
 			if (filesProps.contains(fname))
 				continue;
 
-			if (getFileProperties(parent, allFiles, *g, fname, tmp)) {
-				debug(3, "> '%s': '%s'", fname.c_str(), tmp.md5.c_str());
-				filesProps[fname] = tmp;
+			// Resource forks are rare, and opening them involves looking
+			// around in the parent directory, so they are not threaded.
+			// A file which was not found is tried again for the next game
+			// listing it, which may not use its resource fork.
+			if (g->flags & ADGF_MACRESFORK) {
+				ADFileProperties tmp;
+
+				if (getFileProperties(parent, allFiles, *g, fname, tmp)) {
+					debug(3, "> '%s': '%s'", fname.c_str(), tmp.md5.c_str());
+					filesProps[fname] = tmp;
+				}
+				continue;
+			}
+
+			if (filesQueued.contains(fname) || !allFiles.contains(fname))
+				continue;
+			filesQueued[fname] = true;
+
+			FilePropertiesJob job;
+			job.fname = fname;
+			job.node = allFiles[fname];
+			job.found = false;
+			getFileCacheInfo(parent, allFiles, *g, fname, job.cacheKey, job.cacheStamp);
+
+			if (DetectionCacheMan.lookup(job.cacheKey, job.cacheStamp, job.props)) {
+				debug(3, "> '%s': '%s' (cached)", fname.c_str(), job.props.md5.c_str());
+				filesProps[fname] = job.props;
+				continue;
 			}
+
+			jobs.push_back(job);
 		}
 	}
 
+	computeFilesProperties(jobs, _md5Bytes);
+
+	// A job was queued before any resource fork of the same name was
+	// found, so it takes precedence, as it did when hashing in order
+	for (uint j = 0; j < jobs.size(); j++) {
+		if (!jobs[j].found)
+			continue;
+
+		debug(3, "> '%s': '%s'", jobs[j].fname.c_str(), jobs[j].props.md5.c_str());
+		DetectionCacheMan.store(jobs[j].cacheKey, jobs[j].cacheStamp, jobs[j].props);
+		filesProps[jobs[j].fname] = jobs[j].props;
+	}
+
 	ADGameDescList matched;
 	int maxFilesMatched = 0;
 	bool gotAnyMatchesWithAllFiles = false;
@@ -328,7 +328,13 @@ protected:
 	 */
 	void composeFileHashMap(FileMap &allFiles, const Common::FSList &fslist, int depth) const;
 
-	/** Get the properties (size and MD5) of this file. */
+	/**
+	 * Get the key and the stamp of this file in the DetectionCache. The
+	 * stamp is empty if the file cannot be cached.
+	 */
+	void getFileCacheInfo(const Common::FSNode &parent, const FileMap &allFiles, const ADGameDescription &game, const Common::String &fname, Common::String &key, Common::String &stamp) const;
+
+	/** Get the properties (size and MD5) of this file, from the DetectionCache if possible. */
 	bool getFileProperties(const Common::FSNode &parent, const FileMap &allFiles, const ADGameDescription &game, const Common::String fname, ADFileProperties &fileProps) const;
 };
 
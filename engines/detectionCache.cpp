@@ -0,0 +1,198 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "engines/detectionCache.h"
+
+#include "common/config-manager.h"
+#include "common/debug.h"
+#include "common/fs.h"
+#include "common/savefile.h"
+#include "common/system.h"
+#include "common/textconsole.h"
+
+namespace Common {
+DECLARE_SINGLETON(DetectionCache);
+}
+
+static const char *const kCacheFileName = "detection.cache";
+
+enum {
+	kCacheVersion = 1,
+	/**
+	 * Above this many entries, the ones this run did not use are dropped
+	 * when saving, so that the cache does not grow forever.
+	 */
+	kMaxEntries = 32768,
+	/** Sanity limit for the strings read from the cache file */
+	kMaxStringLength = 4096
+};
+
+static void writeCacheString(Common::WriteStream &stream, const Common::String &str) {
+	stream.writeUint16LE(str.size());
+	stream.write(str.c_str(), str.size());
+}
+
+static bool readCacheString(Common::SeekableReadStream &stream, Common::String &str) {
+	const uint16 length = stream.readUint16LE();
+	if (length > kMaxStringLength)
+		return false;
+
+	char buf[kMaxStringLength];
+	if (stream.read(buf, length) != length)
+		return false;
+
+	str = Common::String(buf, length);
+	return true;
+}
+
+DetectionCache::DetectionCache() : _loaded(false), _dirty(false), _hits(0), _misses(0) {
+	_enabled = !ConfMan.hasKey("detection_cache") || ConfMan.getBool("detection_cache");
+}
+
+DetectionCache::~DetectionCache() {
+	flush();
+}
+
+void DetectionCache::load() {
+	_loaded = true;
+
+	Common::InSaveFile *file = g_system->getSavefileManager()->openForLoading(kCacheFileName);
+	if (!file)
+		return;
+
+	if (file->readUint32BE() != MKTAG('D', 'C', 'C', 'H') || file->readUint32LE() != kCacheVersion) {
+		// Written by another version, it gets replaced on the next flush
+		delete file;
+		return;
+	}
+
+	uint count = file->readUint32LE();
+	while (count--) {
+		Common::String key;
+		Entry entry;
+
+		if (!readCacheString(*file, key) || !readCacheString(*file, entry.stamp))
+			break;
+		entry.props.size = file->readSint32LE();
+		if (!readCacheString(*file, entry.props.md5) || file->err() || file->eos())
+			break;
+
+		entry.used = false;
+		_entries[key] = entry;
+	}
+
+	debug(2, "DetectionCache: Loaded %d entries", _entries.size());
+	delete file;
+}
+
+bool DetectionCache::lookup(const Common::String &key, const Common::String &stamp, ADFileProperties &props) {
+	if (_enabled && !stamp.empty()) {
+		if (!_loaded)
+			load();
+
+		EntryMap::iterator i = _entries.find(key);
+		if (i != _entries.end() && i->_value.stamp == stamp) {
+			i->_value.used = true;
+			props = i->_value.props;
+			_hits++;
+			return true;
+		}
+	}
+
+	_misses++;
+	return false;
+}
+
+void DetectionCache::store(const Common::String &key, const Common::String &stamp, const ADFileProperties &props) {
+	if (!_enabled || stamp.empty() || key.size() > kMaxStringLength)
+		return;
+
+	if (!_loaded)
+		load();
+
+	Entry &entry = _entries[key];
+	entry.stamp = stamp;
+	entry.props = props;
+	entry.used = true;
+	_dirty = true;
+}
+
+Common::String DetectionCache::makeStamp(const Common::FSNode &node) {
+	uint32 size, modificationTime;
+	if (!node.getFileInfo(size, modificationTime))
+		return Common::String();
+
+	return Common::String::format("%u:%u", size, modificationTime);
+}
+
+void DetectionCache::flush() {
+	if (!_dirty)
+		return;
+
+	Common::OutSaveFile *file = g_system->getSavefileManager()->openForSaving(kCacheFileName);
+	if (!file) {
+		warning("DetectionCache: Could not write '%s'", kCacheFileName);
+		return;
+	}
+
+	const bool prune = _entries.size() > kMaxEntries;
+	uint count = 0;
+	for (EntryMap::const_iterator i = _entries.begin(); i != _entries.end(); ++i) {
+		if (!prune || i->_value.used)
+			count++;
+	}
+
+	file->writeUint32BE(MKTAG('D', 'C', 'C', 'H'));
+	file->writeUint32LE(kCacheVersion);
+	file->writeUint32LE(count);
+
+	for (EntryMap::const_iterator i = _entries.begin(); i != _entries.end(); ++i) {
+		if (prune && !i->_value.used)
+			continue;
+
+		writeCacheString(*file, i->_key);
+		writeCacheString(*file, i->_value.stamp);
+		file->writeSint32LE(i->_value.props.size);
+		writeCacheString(*file, i->_value.props.md5);
+	}
+
+	file->finalize();
+	if (file->err())
+		warning("DetectionCache: Could not write '%s'", kCacheFileName);
+	else
+		_dirty = false;
+
+	delete file;
+	debug(2, "DetectionCache: Saved %d entries", count);
+}
+
+void DetectionCache::clear() {
+	_entries.clear();
+	_loaded = true;
+	_dirty = false;
+	g_system->getSavefileManager()->removeSavefile(kCacheFileName);
+}
+
+void DetectionCache::resetStats() {
+	_hits = 0;
+	_misses = 0;
+}
@@ -0,0 +1,118 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef ENGINES_DETECTIONCACHE_H
+#define ENGINES_DETECTIONCACHE_H
+
+#include "common/hashmap.h"
+#include "common/hash-str.h"
+#include "common/singleton.h"
+#include "common/str.h"
+
+#include "engines/advancedDetector.h"
+
+namespace Common {
+class FSNode;
+}
+
+/**
+ * Remembers the file sizes and MD5s computed by the AdvancedMetaEngine
+ * detection, so that detecting the same files again does not read them.
+ *
+ * Entries are keyed by a string naming the file and everything else the
+ * MD5 depends on. Each entry also holds a stamp describing the state of
+ * the file(s) it was computed from, usually their sizes and modification
+ * times, and is only used while the stamp still matches. Files for which
+ * the backend cannot provide a stamp are never cached.
+ *
+ * The cache is shared by all engines, and kept between runs in the
+ * savefile "detection.cache". Setting the config key "detection_cache"
+ * to false disables it.
+ *
+ * The cache is not thread safe. Detection only uses it from the main
+ * thread, the worker threads just compute the MD5s.
+ */
+class DetectionCache : public Common::Singleton<DetectionCache> {
+public:
+	~DetectionCache();
+
+	/**
+	 * Look up the properties of a file.
+	 *
+	 * @param key    the key the properties were stored with
+	 * @param stamp  the current stamp of the file(s), see makeStamp()
+	 * @param props  receives the cached properties
+	 * @return true if the properties were cached and the stamp matches
+	 */
+	bool lookup(const Common::String &key, const Common::String &stamp, ADFileProperties &props);
+
+	/** Remember the properties of a file, unless the stamp is empty. */
+	void store(const Common::String &key, const Common::String &stamp, const ADFileProperties &props);
+
+	/**
+	 * Describe the size and modification time of a file.
+	 *
+	 * @return the stamp, or an empty string if the backend does not know
+	 */
+	static Common::String makeStamp(const Common::FSNode &node);
+
+	/** Write the cache to disk, if it changed since it was loaded. */
+	void flush();
+
+	/** Drop all entries, including the ones on disk. */
+	void clear();
+
+	/** Number of lookups answered from the cache since the last resetStats(). */
+	uint getHits() const { return _hits; }
+
+	/** Number of lookups which had to be computed since the last resetStats(). */
+	uint getMisses() const { return _misses; }
+
+	void resetStats();
+
+private:
+	friend class Common::Singleton<SingletonBaseType>;
+	DetectionCache();
+
+	struct Entry {
+		Common::String stamp;
+		ADFileProperties props;
+		/** Whether this run looked the entry up or stored it */
+		bool used;
+	};
+
+	typedef Common::HashMap<Common::String, Entry> EntryMap;
+
+	void load();
+
+	EntryMap _entries;
+	bool _enabled;
+	bool _loaded;
+	bool _dirty;
+	uint _hits;
+	uint _misses;
+};
+
+/** Shortcut for accessing the detection cache. */
+#define DetectionCacheMan DetectionCache::instance()
+
+#endif
@@ -653,6 +653,17 @@ bool Engine::canSaveGameStateCurrently() {
 	return false;
 }
 
+Common::Error Engine::saveGameStream(Common::WriteStream *stream) {
+	// Not supported by default
+	return Common::kEnginePluginNotSupportSaves;
+}
+
+Common::Error Engine::loadGameStream(Common::SeekableReadStream *stream) {
+	// Not supported by default
+	delete stream;
+	return Common::kEnginePluginNotSupportSaves;
+}
+
 void Engine::quitGame() {
 	Common::Event event;
 
@@ -39,8 +39,10 @@ namespace Common {
 class Error;
 class EventManager;
 class SaveFileManager;
+class SeekableReadStream;
 class TimerManager;
 class FSNode;
+class WriteStream;
 }
 namespace GUI {
 class Debugger;
@@ -245,6 +247,31 @@ public:
 	 */
 	virtual bool canSaveGameStateCurrently();
 
+	/**
+	 * Write a snapshot of the current game state into a stream, without
+	 * going through the savefile manager. Engines implementing this must
+	 * advertise the MetaEngine::kSupportsSaveStreams feature.
+	 *
+	 * Unlike saveGameState(), this is performed immediately and should be
+	 * cheap enough to be called every frame, so engines are free to leave
+	 * out data which is only useful for the launcher (e.g. thumbnails).
+	 *
+	 * @param stream	the stream into which the snapshot should be written
+	 * @return returns kNoError on success, else an error code.
+	 */
+	virtual Common::Error saveGameStream(Common::WriteStream *stream);
+
+	/**
+	 * Restore a snapshot previously written by saveGameStream().
+	 *
+	 * Like loadGameState(), engines may defer the actual restore to their
+	 * next safe point. The engine takes ownership of the stream.
+	 *
+	 * @param stream	the stream from which the snapshot should be read
+	 * @return returns kNoError on success, else an error code.
+	 */
+	virtual Common::Error loadGameStream(Common::SeekableReadStream *stream);
+
 protected:
 
 	/**
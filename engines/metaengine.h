@@ -248,7 +248,15 @@ public:
 		* unavailable. In that case Save/Load dialog for engine's
 		* games is locked during cloud saves sync.
 		*/
-		kSimpleSavesNames
+		kSimpleSavesNames,
+
+		/**
+		 * Game states can be snapshotted to and restored from memory
+		 * (i.e. the engine implements saveGameStream() and
+		 * loadGameStream()). Used by ports which need fast, file-less
+		 * save states, e.g. for rewind or netplay.
+		 */
+		kSupportsSaveStreams
 	};
 
 	/**
@@ -93,6 +93,7 @@ Console::Console(SciEngine *engine) : GUI::Debugger(),
 	registerCmd("opcodes",			WRAP_METHOD(Console, cmdOpcodes));
 	registerCmd("selector",			WRAP_METHOD(Console, cmdSelector));
 	registerCmd("selectors",			WRAP_METHOD(Console, cmdSelectors));
+	registerCmd("selector_cache",		WRAP_METHOD(Console, cmdSelectorCache));
 	registerCmd("functions",			WRAP_METHOD(Console, cmdKernelFunctions));
 	registerCmd("class_table",		WRAP_METHOD(Console, cmdClassTable));
 	// Parser
@@ -110,6 +111,7 @@ Console::Console(SciEngine *engine) : GUI::Debugger(),
 	registerCmd("resource_id",		WRAP_METHOD(Console, cmdResourceId));
 	registerCmd("resource_info",		WRAP_METHOD(Console, cmdResourceInfo));
 	registerCmd("resource_types",		WRAP_METHOD(Console, cmdResourceTypes));
+	registerCmd("resource_cache",		WRAP_METHOD(Console, cmdResourceCache));
 	registerCmd("list",				WRAP_METHOD(Console, cmdList));
 	registerCmd("hexgrep",			WRAP_METHOD(Console, cmdHexgrep));
 	registerCmd("verify_scripts",		WRAP_METHOD(Console, cmdVerifyScripts));
@@ -156,6 +158,7 @@ Console::Console(SciEngine *engine) : GUI::Debugger(),
 	registerCmd("gc_reachable",		WRAP_METHOD(Console, cmdGCShowReachable));
 	registerCmd("gc_freeable",		WRAP_METHOD(Console, cmdGCShowFreeable));
 	registerCmd("gc_normalize",		WRAP_METHOD(Console, cmdGCNormalize));
+	registerCmd("gc_stats",			WRAP_METHOD(Console, cmdGCStats));
 	// Music/SFX
 	registerCmd("songlib",			WRAP_METHOD(Console, cmdSongLib));
 	registerCmd("songinfo",			WRAP_METHOD(Console, cmdSongInfo));
@@ -339,6 +342,7 @@ bool Console::cmdHelp(int argc, const char **argv) {
 	debugPrintf(" opcodes - Lists the opcode names\n");
 	debugPrintf(" selectors - Lists the selector names\n");
 	debugPrintf(" selector - Attempts to find the requested selector by name\n");
+	debugPrintf(" selector_cache - Shows the statistics of the selector lookup cache\n");
 	debugPrintf(" functions - Lists the kernel functions\n");
 	debugPrintf(" class_table - Shows the available classes\n");
 	debugPrintf("\n");
@@ -358,6 +362,7 @@ bool Console::cmdHelp(int argc, const char **argv) {
 	debugPrintf(" resource_id - Identifies a resource number by splitting it up in resource type and resource number\n");
 	debugPrintf(" resource_info - Shows info about a resource\n");
 	debugPrintf(" resource_types - Shows the valid resource types\n");
+	debugPrintf(" resource_cache - Shows the statistics of the resource cache\n");
 	debugPrintf(" list - Lists all the resources of a given type\n");
 	debugPrintf(" hexgrep - Searches some resources for a particular sequence of bytes, represented as hexadecimal numbers\n");
 	debugPrintf(" verify_scripts - Performs sanity checks on SCI1.1-SCI2.1 game scripts (e.g. if they're up to 64KB in total)\n");
@@ -399,6 +404,7 @@ bool Console::cmdHelp(int argc, const char **argv) {
 	debugPrintf(" gc_reachable - Lists all addresses directly reachable from a given memory object\n");
 	debugPrintf(" gc_freeable - Lists all addresses freeable in a given segment\n");
 	debugPrintf(" gc_normalize - Prints the \"normal\" address of a given address\n");
+	debugPrintf(" gc_stats - Shows how long garbage collections took, and what they freed\n");
 	debugPrintf("\n");
 	debugPrintf("Music/SFX:\n");
 	debugPrintf(" songlib - Shows the song library\n");
@@ -600,6 +606,23 @@ bool Console::cmdSelectors(int argc, const char **argv) {
 	return true;
 }
 
+bool Console::cmdSelectorCache(int argc, const char **argv) {
+	bool reset;
+	if (!parseStatsArguments(argc, argv, "Shows how many selector lookups were answered by the lookup cache.", reset))
+		return true;
+
+	SelectorLookupCache &cache = _engine->_gamestate->_segMan->getSelectorLookupCache();
+	const uint lookups = cache.getHits() + cache.getMisses();
+	debugPrintf("Lookups: %d, hits: %d (%d%%), misses: %d\n", lookups, cache.getHits(),
+		lookups ? cache.getHits() * 100 / lookups : 0, cache.getMisses());
+	debugPrintf("Cleared %d times by loading and freeing scripts\n", cache.getClears());
+
+	if (reset)
+		cache.resetStats();
+
+	return true;
+}
+
 bool Console::cmdKernelFunctions(int argc, const char **argv) {
 	debugPrintf("Kernel function names in numeric order:\n");
 	for (uint seeker = 0; seeker <  _engine->getKernel()->getKernelNamesSize(); seeker++) {
@@ -967,6 +990,28 @@ bool Console::cmdResourceTypes(int argc, const char **argv) {
 	return true;
 }
 
+bool Console::cmdResourceCache(int argc, const char **argv) {
+	bool reset;
+	if (!parseStatsArguments(argc, argv, "Shows how many resource requests were answered from memory.", reset))
+		return true;
+
+	ResourceManager *resMan = _engine->getResMan();
+	const ResourceManager::CacheStats &stats = resMan->getCacheStats();
+	const uint requests = stats.hits + stats.misses;
+	debugPrintf("Requests: %d, hits: %d (%d%%), misses: %d, of which %d decompressed from packed copies\n",
+		requests, stats.hits, requests ? stats.hits * 100 / requests : 0, stats.misses, stats.packedHits);
+	debugPrintf("Loaded: %d KiB, evicted: %d resources and %d packed copies\n",
+		(int)(stats.bytesLoaded / 1024), stats.evictions, stats.packedEvictions);
+	debugPrintf("Memory: %d KiB locked, %d of %d KiB cached, %d of %d KiB packed copies\n",
+		resMan->getMemoryLocked() / 1024, resMan->getMemoryLRU() / 1024, resMan->getMaxMemoryLRU() / 1024,
+		resMan->getMemoryPacked() / 1024, resMan->getMaxMemoryPacked() / 1024);
+
+	if (reset)
+		resMan->resetCacheStats();
+
+	return true;
+}
+
 bool Console::cmdHexgrep(int argc, const char **argv) {
 	if (argc < 4) {
 		debugPrintf("Searches some resources for a particular sequence of bytes, represented as decimal or hexadecimal numbers.\n");
@@ -2421,7 +2466,34 @@ bool Console::cmdIsSample(int argc, const char **argv) {
 
 bool Console::cmdGCInvoke(int argc, const char **argv) {
 	debugPrintf("Performing garbage collection...\n");
-	run_gc(_engine->_gamestate);
+	const uint freed = run_gc(_engine->_gamestate);
+	debugPrintf("Freed %d objects in %d ms\n", freed, _engine->_gamestate->gcStats.lastPauseTime);
+	return true;
+}
+
+bool Console::cmdGCStats(int argc, const char **argv) {
+	bool reset;
+	if (!parseStatsArguments(argc, argv, "Shows how long garbage collections took, and how many objects they freed.", reset))
+		return true;
+
+	EngineState *s = _engine->_gamestate;
+	GCStats &stats = s->gcStats;
+	debugPrintf("Collections: %d, pause time: %d ms total, %d ms max, %d ms average\n", stats.cycles,
+		stats.totalPauseTime, stats.maxPauseTime, stats.cycles ? stats.totalPauseTime / stats.cycles : 0);
+	debugPrintf("Last collection: %d ms, %d references in use, %d objects freed\n",
+		stats.lastPauseTime, stats.lastMarked, stats.lastFreed);
+	debugPrintf("Objects freed: %d (lists: %d, nodes: %d, clones: %d, hunks: %d, scripts: %d)\n", stats.totalFreed,
+		stats.freedByType[SEG_TYPE_LISTS], stats.freedByType[SEG_TYPE_NODES], stats.freedByType[SEG_TYPE_CLONES],
+		stats.freedByType[SEG_TYPE_HUNK], stats.freedByType[SEG_TYPE_SCRIPT]);
+#ifdef ENABLE_SCI32
+	debugPrintf("SCI32 objects freed: arrays: %d, strings: %d, bitmaps: %d\n", stats.freedByType[SEG_TYPE_ARRAY],
+		stats.freedByType[SEG_TYPE_STRING], stats.freedByType[SEG_TYPE_BITMAP]);
+#endif
+	debugPrintf("Kernel calls until the next collection: %d\n", s->gcCountDown);
+
+	if (reset)
+		stats.reset();
+
 	return true;
 }
 
@@ -4333,6 +4405,17 @@ bool Console::parseInteger(const char *argument, int &result) {
 	return true;
 }
 
+bool Console::parseStatsArguments(int argc, const char **argv, const char *description, bool &reset) {
+	reset = (argc == 2 && !strcmp(argv[1], "reset"));
+	if (argc > 2 || (argc == 2 && !reset)) {
+		debugPrintf("%s\n", description);
+		debugPrintf("Usage: %s [reset]\n", argv[0]);
+		debugPrintf("With \"reset\", the statistics are reset afterwards.\n");
+		return false;
+	}
+	return true;
+}
+
 void Console::printBasicVarInfo(reg_t variable) {
 	int regType = g_sci->getKernel()->findRegType(variable);
 	int segType = regType;
@@ -729,7 +729,8 @@ bool SciMetaEngine::hasFeature(MetaEngineFeature f) const {
 		(f == kSavesSupportMetaInfo) ||
 		(f == kSavesSupportThumbnail) ||
 		(f == kSavesSupportCreationDate) ||
-		(f == kSavesSupportPlayTime);
+		(f == kSavesSupportPlayTime) ||
+		(f == kSupportsSaveStreams);
 }
 
 bool SciEngine::hasFeature(EngineFeature f) const {
@@ -884,6 +885,34 @@ Common::Error SciEngine::saveGameState(int slot, const Common::String &desc) {
 	return Common::kNoError;
 }
 
+Common::Error SciEngine::saveGameStream(Common::WriteStream *stream) {
+	// Same restriction as gamestate_save(), but without its warning, as
+	// snapshots are taken every frame by some ports
+	if (_gamestate->executionStackBase)
+		return Common::kWritingFailed;
+
+	if (!gamestate_save(_gamestate, stream, "", "", false) || stream->err())
+		return Common::kWritingFailed;
+
+	return Common::kNoError;
+}
+
+Common::Error SciEngine::loadGameStream(Common::SeekableReadStream *stream) {
+	// gamestate_restore() can only fail on the metadata, so check that now
+	// and refuse the snapshot, rather than failing when it is due
+	if (!gamestate_checkSnapshot(stream)) {
+		warning("Invalid game state snapshot");
+		delete stream;
+		return Common::kReadingFailed;
+	}
+
+	// Restored by gamestate_delayedrestore(), just like loadGameState()
+	delete _gamestate->_delayedRestoreStream;
+	_gamestate->_delayedRestoreStream = stream;
+	_gamestate->_delayedRestoreGame = true;
+	return Common::kNoError;
+}
+
 bool SciEngine::canLoadGameStateCurrently() {
 	return !_gamestate->executionStackBase;
 }
@@ -22,6 +22,7 @@
 
 #include "sci/engine/gc.h"
 #include "common/array.h"
+#include "common/system.h"
 #include "sci/graphics/ports.h"
 
 #ifdef ENABLE_SCI32
@@ -30,10 +31,7 @@
 
 namespace Sci {
 
-//#define GC_DEBUG_CODE
-
-#ifdef GC_DEBUG_CODE
-const char *segmentTypeNames[] = {
+static const char *const segmentTypeNames[] = {
 	"invalid",   // 0
 	"script",    // 1
 	"clones",    // 2
@@ -46,9 +44,9 @@ const char *segmentTypeNames[] = {
 	"dynmem",    // 9
 	"obsolete",  // 10: obsolete string fragments
 	"array",     // 11: SCI32 arrays
-	"string"     // 12: SCI32 strings
+	"string",    // 12: SCI32 strings
+	"bitmap"     // 13: SCI32 bitmaps
 };
-#endif
 
 void WorklistManager::push(reg_t reg) {
 	if (!reg.getSegment()) // No numbers
@@ -56,10 +54,11 @@ void WorklistManager::push(reg_t reg) {
 
 	debugC(kDebugLevelGC, "[GC] Adding %04x:%04x", PRINT_REG(reg));
 
-	if (_map.contains(reg))
+	bool &seen = _map[reg];
+	if (seen)
 		return; // already dealt with it
 
-	_map.setVal(reg, true);
+	seen = true;
 	_worklist.push_back(reg);
 }
 
@@ -179,20 +178,18 @@ AddrSet *findAllActiveReferences(EngineState *s) {
 	return normalizeAddresses(s->_segMan, wm._map);
 }
 
-void run_gc(EngineState *s) {
+uint run_gc(EngineState *s) {
 	SegManager *segMan = s->_segMan;
+	GCStats &stats = s->gcStats;
+	const uint32 startTime = g_system->getMillis();
 
-	// Some debug stuff
 	debugC(kDebugLevelGC, "[GC] Running...");
-#ifdef GC_DEBUG_CODE
-	const char *segnames[SEG_TYPE_MAX + 1];
-	int segcount[SEG_TYPE_MAX + 1];
-	memset(segnames, 0, sizeof(segnames));
-	memset(segcount, 0, sizeof(segcount));
-#endif
 
 	// Compute the set of all segments references currently in use.
 	AddrSet *activeRefs = findAllActiveReferences(s);
+	uint freed = 0;
+	uint freedByType[SEG_TYPE_MAX];
+	memset(freedByType, 0, sizeof(freedByType));
 
 	// Iterate over all segments, and check for each whether it
 	// contains stuff that can be collected.
@@ -201,10 +198,7 @@ void run_gc(EngineState *s) {
 		SegmentObj *mobj = heap[seg];
 
 		if (mobj != NULL) {
-#ifdef GC_DEBUG_CODE
 			const SegmentType type = mobj->getType();
-			segnames[type] = segmentTypeNames[type];
-#endif
 
 			// Get a list of all deallocatable objects in this segment,
 			// then free any which are not referenced from somewhere.
@@ -215,24 +209,35 @@ void run_gc(EngineState *s) {
 					// Not found -> we can free it
 					mobj->freeAtAddress(segMan, addr);
 					debugC(kDebugLevelGC, "[GC] Deallocating %04x:%04x", PRINT_REG(addr));
-#ifdef GC_DEBUG_CODE
-					segcount[type]++;
-#endif
+					freedByType[type]++;
+					freed++;
 				}
 			}
 
 		}
 	}
 
+	const uint marked = activeRefs->size();
 	delete activeRefs;
 
-#ifdef GC_DEBUG_CODE
+	const uint32 pauseTime = g_system->getMillis() - startTime;
+	stats.cycles++;
+	stats.lastPauseTime = pauseTime;
+	stats.maxPauseTime = MAX(stats.maxPauseTime, pauseTime);
+	stats.totalPauseTime += pauseTime;
+	stats.lastMarked = marked;
+	stats.lastFreed = freed;
+	stats.totalFreed += freed;
+	for (int i = 0; i < SEG_TYPE_MAX; i++)
+		stats.freedByType[i] += freedByType[i];
+
 	// Output debug summary of garbage collection
-	debugC(kDebugLevelGC, "[GC] Summary:");
-	for (int i = 0; i <= SEG_TYPE_MAX; i++)
-		if (segcount[i])
-			debugC(kDebugLevelGC, "\t%d\t* %s", segcount[i], segnames[i]);
-#endif
+	debugC(kDebugLevelGC, "[GC] Summary: %d ms, %d references in use, %d objects freed", pauseTime, marked, freed);
+	for (int i = 0; i < SEG_TYPE_MAX; i++)
+		if (freedByType[i])
+			debugC(kDebugLevelGC, "\t%d\t* %s", freedByType[i], segmentTypeNames[i]);
+
+	return freed;
 }
 
 } // End of namespace Sci
@@ -50,10 +50,12 @@ typedef Common::HashMap<reg_t, bool, reg_t_Hash> AddrSet;
 AddrSet *findAllActiveReferences(EngineState *s);
 
 /**
- * Runs garbage collection on the current system state
+ * Runs garbage collection on the current system state, and updates
+ * s->gcStats
  * @param s The state in which we should gc
+ * @return The number of freed objects
  */
-void run_gc(EngineState *s);
+uint run_gc(EngineState *s);
 
 struct WorklistManager {
 	Common::Array<reg_t> _worklist;
@@ -84,14 +84,22 @@ struct SavegameMetadata {
  * @param s			The state to save
  * @param save		The stream to save to
  * @param savename	The description of the savegame
+ * @param writeThumbnail	Whether to include a thumbnail of the screen
  * @return 0 on success, 1 otherwise
  */
-bool gamestate_save(EngineState *s, Common::WriteStream *save, const Common::String &savename, const Common::String &version);
+bool gamestate_save(EngineState *s, Common::WriteStream *save, const Common::String &savename, const Common::String &version, bool writeThumbnail = true);
 
 // does a delayed saved game restore, used by ScummVM game menu - see detection.cpp / SciEngine::loadGameState()
 void gamestate_delayedrestore(EngineState *s);
 
+/**
+ * Checks whether gamestate_restore() would accept an in-memory snapshot,
+ * without showing any dialogs. The stream is rewound afterwards.
+ */
+bool gamestate_checkSnapshot(Common::SeekableReadStream *in);
+
 // does a few fixups right after restoring a saved game
+// savegameId is -1 for in-memory snapshots, which skips the slot specific ones
 void gamestate_afterRestoreFixUp(EngineState *s, int savegameId);
 
 /**
@@ -70,6 +70,9 @@ void Script::freeScript() {
 	_offsetLookupObjectCount = 0;
 	_offsetLookupStringCount = 0;
 	_offsetLookupSaidCount = 0;
+
+	_instructionIndex.clear();
+	_instructions.clear();
 }
 
 void Script::load(int script_nr, ResourceManager *resMan, ScriptPatcher *scriptPatcher) {
@@ -868,6 +871,24 @@ bool Script::isValidOffset(uint16 offset) const {
 	return offset < _bufSize;
 }
 
+const PMachineInstruction &Script::decodeInstruction(uint32 offset) {
+	// Only the code part of the script is cached, the heap of SCI1.1+
+	// scripts does not contain any code
+	if (offset >= _scriptSize || _instructions.size() >= 0xFFFF) {
+		_uncachedInstruction.size = readPMachineInstruction(_buf + offset, _uncachedInstruction.extOpcode, _uncachedInstruction.opparams);
+		return _uncachedInstruction;
+	}
+
+	if (_instructionIndex.empty())
+		_instructionIndex.resize(_scriptSize);
+
+	PMachineInstruction instruction;
+	instruction.size = readPMachineInstruction(_buf + offset, instruction.extOpcode, instruction.opparams);
+	_instructions.push_back(instruction);
+	_instructionIndex[offset] = _instructions.size();
+	return _instructions.back();
+}
+
 SegmentRef Script::dereference(reg_t pointer) {
 	if (pointer.getOffset() > _bufSize) {
 		error("Script::dereference(): Attempt to dereference invalid pointer %04x:%04x into script segment (script size=%d)",
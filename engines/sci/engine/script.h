@@ -98,6 +98,19 @@ private:
 	uint16 _offsetLookupStringCount;
 	uint16 _offsetLookupSaidCount;
 
+	/**
+	 * For each byte of the script, 0 if no instruction starting there has
+	 * been decoded yet, or 1 + the index of its entry in _instructions.
+	 * Built when the script is first executed, and dropped with the script,
+	 * so script patches and reloads are taken into account.
+	 */
+	Common::Array<uint16> _instructionIndex;
+	Common::Array<PMachineInstruction> _instructions;
+	/** Decoded instruction which is not cached */
+	PMachineInstruction _uncachedInstruction;
+
+	const PMachineInstruction &decodeInstruction(uint32 offset);
+
 public:
 	int getLocalsOffset() const { return _localsOffset; }
 	uint16 getLocalsCount() const { return _localsCount; }
@@ -107,6 +120,21 @@ public:
 	uint32 getBufSize() const { return _bufSize; }
 	const byte *getBuf(uint offset = 0) const { return _buf + offset; }
 
+	/**
+	 * Decodes the instruction at the given offset, like
+	 * readPMachineInstruction(). Instructions in the code part of the script
+	 * are only decoded the first time, which speeds up loops. The reference
+	 * is only valid until the next call.
+	 */
+	const PMachineInstruction &getInstruction(uint32 offset) {
+		if (offset < _instructionIndex.size()) {
+			const uint16 slot = _instructionIndex[offset];
+			if (slot)
+				return _instructions[slot - 1];
+		}
+		return decodeInstruction(offset);
+	}
+
 	int getScriptNumber() const { return _nr; }
 	SegmentId getLocalsSegment() const { return _localsSegment; }
 	reg_t *getLocalsBegin() { return _localsBlock ? _localsBlock->_locals.begin() : NULL; }
@@ -61,6 +61,7 @@ void SegManager::resetSegMan() {
 	}
 
 	_heap.clear();
+	_selectorLookupCache.clear();
 
 	// And reinitialize
 	_heap.push_back(0);
@@ -167,6 +168,7 @@ void SegManager::deallocate(SegmentId seg) {
 	if (mobj->getType() == SEG_TYPE_SCRIPT) {
 		Script *scr = (Script *)mobj;
 		_scriptSegMap.erase(scr->getScriptNumber());
+		_selectorLookupCache.clear();
 		if (scr->getLocalsSegment()) {
 			// Check if the locals segment has already been deallocated.
 			// If the locals block has been stored in a segment with an ID
@@ -1051,6 +1053,9 @@ int SegManager::instantiateScript(int scriptNum) {
 		scr = allocateScript(scriptNum, &segmentId);
 	}
 
+	// The new objects may take the place of others
+	_selectorLookupCache.clear();
+
 	scr->load(scriptNum, _resMan, _scriptPatcher);
 	scr->initializeLocals(this);
 	scr->initializeClasses(this);
@@ -449,6 +449,8 @@ public:
 
 	const Common::Array<SegmentObj *> &getSegments() const { return _heap; }
 
+	SelectorLookupCache &getSelectorLookupCache() { return _selectorLookupCache; }
+
 private:
 	Common::Array<SegmentObj *> _heap;
 	Common::Array<Class> _classTable; /**< Table of all classes */
@@ -467,6 +469,8 @@ private:
 	reg_t _saveDirPtr;
 	reg_t _parserPtr;
 
+	SelectorLookupCache _selectorLookupCache;
+
 #ifdef ENABLE_SCI32
 	SegmentId _arraysSegId;
 	SegmentId _stringSegId;
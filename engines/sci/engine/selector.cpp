@@ -292,34 +292,67 @@ SelectorType lookupSelector(SegManager *segMan, reg_t obj_location, Selector sel
 				PRINT_REG(obj_location));
 	}
 
-	index = obj->locateVarSelector(segMan, selectorId);
-
-	if (index >= 0) {
-		// Found it as a variable
-		if (varp) {
-			varp->obj = obj_location;
-			varp->varindex = index;
-		}
-		return kSelectorVariable;
-	} else {
-		// Check if it's a method, with recursive lookup in superclasses
-		while (obj) {
-			index = obj->funcSelectorPosition(selectorId);
-			if (index >= 0) {
-				if (fptr)
-					*fptr = obj->getFunction(index);
-
-				return kSelectorMethod;
-			} else {
-				obj = segMan->getObject(obj->getSuperClassSelector());
+	SelectorLookupCache &cache = segMan->getSelectorLookupCache();
+	const reg_t pos = obj->getPos();
+	const reg_t species = obj->getSpeciesSelector();
+	const reg_t superClass = obj->getSuperClassSelector();
+	SelectorLookupCache::Entry &slot = cache.getSlot(pos, selectorId);
+
+	if (!cache.lookup(slot, pos, species, superClass, selectorId)) {
+		slot.type = kSelectorNone;
+		index = obj->locateVarSelector(segMan, selectorId);
+
+		if (index >= 0) {
+			// Found it as a variable
+			slot.type = kSelectorVariable;
+			slot.varIndex = index;
+		} else {
+			// Check if it's a method, with recursive lookup in superclasses
+			while (obj) {
+				index = obj->funcSelectorPosition(selectorId);
+				if (index >= 0) {
+					slot.type = kSelectorMethod;
+					slot.func = obj->getFunction(index);
+					break;
+				} else {
+					obj = segMan->getObject(obj->getSuperClassSelector());
+				}
 			}
 		}
 
-		return kSelectorNone;
+		cache.store(slot, pos, species, superClass, selectorId);
+	}
+
+	if (slot.type == kSelectorVariable && varp) {
+		varp->obj = obj_location;
+		varp->varindex = slot.varIndex;
+	} else if (slot.type == kSelectorMethod && fptr) {
+		*fptr = slot.func;
 	}
 
+	return slot.type;
+}
+
+SelectorLookupCache::SelectorLookupCache() : _generation(1), _hits(0), _misses(0), _clears(0) {
+	for (uint i = 0; i < kSize; i++)
+		_entries[i].generation = 0;
+}
+
+void SelectorLookupCache::clear() {
+	_clears++;
+
+	if (++_generation == 0) {
+		// Wrapped around, so old entries could look current again
+		for (uint i = 0; i < kSize; i++)
+			_entries[i].generation = 0;
+		_generation = 1;
+	}
+}
 
-//	return _lookupSelector_function(segMan, obj, selectorId, fptr);
+void SelectorLookupCache::resetStats() {
+	_hits = 0;
+	_misses = 0;
+	_clears = 0;
 }
 
 } // End of namespace Sci
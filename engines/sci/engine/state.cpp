@@ -70,13 +70,15 @@ static const uint16 s_halfWidthSJISMap[256] = {
 
 EngineState::EngineState(SegManager *segMan)
 : _segMan(segMan),
-	_dirseeker() {
+	_dirseeker(),
+	_delayedRestoreStream(0) {
 
 	reset(false);
 }
 
 EngineState::~EngineState() {
 	delete _msgState;
+	delete _delayedRestoreStream;
 }
 
 void EngineState::reset(bool isRestoring) {
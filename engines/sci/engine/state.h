@@ -99,6 +99,21 @@ struct VideoState {
 	}
 };
 
+/** Statistics of the garbage collector, see run_gc() */
+struct GCStats {
+	uint cycles;
+	uint32 lastPauseTime; /**< Duration of the last gc, in milliseconds */
+	uint32 maxPauseTime;
+	uint32 totalPauseTime;
+	uint lastMarked; /**< Number of references found in the last gc */
+	uint lastFreed;
+	uint totalFreed;
+	uint freedByType[SEG_TYPE_MAX];
+
+	GCStats() { reset(); }
+	void reset() { memset(this, 0, sizeof(*this)); }
+};
+
 struct EngineState : public Common::Serializable {
 public:
 	EngineState(SegManager *segMan);
@@ -135,6 +150,7 @@ public:
 	bool _delayedRestoreGame;  // boolean, that triggers delayed restore (triggered by ScummVM menu)
 	int _delayedRestoreGameId; // the saved game id, that it supposed to get restored (triggered by ScummVM menu)
 	bool _delayedRestoreFromLauncher; // is set, when the the delayed restore game was triggered from launcher
+	Common::SeekableReadStream *_delayedRestoreStream; // in-memory snapshot to restore instead of a slot (see SciEngine::loadGameStream())
 
 	uint _chosenQfGImportItem; // Remembers the item selected in QfG import rooms
 
@@ -190,6 +206,7 @@ public:
 	void shrinkStackToBase();
 
 	int gcCountDown; /**< Number of kernel calls until next gc */
+	GCStats gcStats;
 
 	MessageState *_msgState;
 
@@ -352,6 +352,88 @@ void script_debug(EngineState *s);
 SelectorType lookupSelector(SegManager *segMan, reg_t obj, Selector selectorid,
 		ObjVarRef *varp, reg_t *fptr);
 
+/**
+ * Remembers the results of lookupSelector(), so that sending a selector to
+ * an object again does not search the selector tables of the object and its
+ * superclasses.
+ *
+ * Entries are keyed by the selector and the position of the object in its
+ * script, which all clones of the object share. They also check the species
+ * and the superclass of the object. The cache is direct mapped, each entry
+ * replaces whatever was cached in its slot before.
+ *
+ * Loading and freeing scripts can reuse the same addresses for other
+ * objects, so the SegManager clears the cache whenever it does either.
+ */
+class SelectorLookupCache {
+public:
+	struct Entry {
+		uint32 generation;
+		reg_t pos;
+		reg_t species;
+		reg_t superClass;
+		Selector selector;
+		SelectorType type;
+		int varIndex;	///< For kSelectorVariable
+		reg_t func;		///< For kSelectorMethod
+	};
+
+	SelectorLookupCache();
+
+	/**
+	 * Returns the slot of the given object and selector, for lookup() and
+	 * for storing a new result.
+	 */
+	Entry &getSlot(reg_t pos, Selector selector) {
+		const uint32 key = ((uint32)pos.getSegment() << 16) ^ pos.getOffset() ^ ((uint32)selector * 0x85EBCA77);
+		return _entries[(key * 0x9E3779B1) >> (32 - kSizeBits)];
+	}
+
+	/** Returns true if the slot holds the result for the given key. */
+	bool lookup(const Entry &slot, reg_t pos, reg_t species, reg_t superClass, Selector selector) {
+		if (slot.generation == _generation && slot.selector == selector && slot.pos == pos
+				&& slot.species == species && slot.superClass == superClass) {
+			_hits++;
+			return true;
+		}
+
+		_misses++;
+		return false;
+	}
+
+	/** Marks a slot as holding the result for the given key. */
+	void store(Entry &slot, reg_t pos, reg_t species, reg_t superClass, Selector selector) {
+		slot.generation = _generation;
+		slot.pos = pos;
+		slot.species = species;
+		slot.superClass = superClass;
+		slot.selector = selector;
+	}
+
+	/** Drops all entries. */
+	void clear();
+
+	uint getHits() const { return _hits; }
+	uint getMisses() const { return _misses; }
+	/** Number of times the cache was cleared since the last resetStats() */
+	uint getClears() const { return _clears; }
+	void resetStats();
+
+private:
+	enum {
+		kSizeBits = 12,
+		kSize = 1 << kSizeBits
+	};
+
+	Entry _entries[kSize];
+	/** Entries of older generations are empty */
+	uint32 _generation;
+
+	uint _hits;
+	uint _misses;
+	uint _clears;
+};
+
 /**
  * Read a PMachine instruction from a memory buffer and return its length.
  *
@@ -370,6 +452,13 @@ SelectorType lookupSelector(SegManager *segMan, reg_t obj, Selector selectorid,
  */
 int readPMachineInstruction(const byte *src, byte &extOpcode, int16 opparams[4]);
 
+/** A PMachine instruction, as decoded by readPMachineInstruction() */
+struct PMachineInstruction {
+	int16 opparams[4];
+	uint16 size; ///< Length of the instruction in bytes
+	byte extOpcode;
+};
+
 } // End of namespace Sci
 
 #endif // SCI_ENGINE_VM_H
@@ -22,13 +22,12 @@
 
 // Resource library
 
+#include "common/config-manager.h"
 #include "common/file.h"
 #include "common/fs.h"
 #include "common/macresman.h"
-#include "common/textconsole.h"
-#ifdef ENABLE_SCI32
 #include "common/memstream.h"
-#endif
+#include "common/textconsole.h"
 
 #include "sci/resource.h"
 #include "sci/resource_intern.h"
@@ -201,11 +200,18 @@ Resource::Resource(ResourceManager *resMan, ResourceId id) : _resMan(resMan), _i
 	_source = NULL;
 	_header = NULL;
 	_headerSize = 0;
+	_lruPrev = NULL;
+	_lruNext = NULL;
+	_packedData = NULL;
+	_packedSize = 0;
+	_packedPrev = NULL;
+	_packedNext = NULL;
 }
 
 Resource::~Resource() {
 	delete[] data;
 	delete[] _header;
+	delete[] _packedData;
 	if (_source && _source->getSourceType() == kSourcePatch)
 		delete _source;
 }
@@ -550,18 +556,24 @@ Common::SeekableReadStream *ResourceSource::getVolumeFile(ResourceManager *resMa
 }
 
 void ResourceSource::loadResource(ResourceManager *resMan, Resource *res) {
+	if (resMan->loadFromPackedCopy(res))
+		return;
+
 	Common::SeekableReadStream *fileStream = getVolumeFile(resMan, res);
 	if (!fileStream)
 		return;
 
 	fileStream->seek(res->_fileOffset, SEEK_SET);
 
-	int error = res->decompress(resMan->getVolVersion(), fileStream);
+	uint32 packedSize = 0;
+	int error = res->decompress(resMan->getVolVersion(), fileStream, &packedSize);
 	if (error) {
 		warning("Error %d occurred while reading %s from resource file %s: %s",
 				error, res->_id.toString().c_str(), res->getResourceLocation().c_str(),
 				s_errorDescriptions[error]);
 		res->unalloc();
+	} else if (packedSize) {
+		resMan->addPackedCopy(res, fileStream, packedSize);
 	}
 
 	if (_resourceFile)
@@ -890,9 +902,15 @@ void ResourceManager::init() {
 	_maxMemoryLRU = 256 * 1024; // 256KiB
 	_memoryLocked = 0;
 	_memoryLRU = 0;
-	_LRU.clear();
+	_memoryPacked = 0;
+	_lruFirst = NULL;
+	_lruLast = NULL;
+	_packedFirst = NULL;
+	_packedLast = NULL;
+	_cacheStats.reset();
 	_resMap.clear();
 	_audioMapSCI1 = NULL;
+	_audioMapIndex = NULL;
 #ifdef ENABLE_SCI32
 	_currentDiscNo = 1;
 #endif
@@ -926,6 +944,13 @@ void ResourceManager::init() {
 		return;
 	}
 
+	// Audio maps are indexed per game, not while detecting games
+	const Common::String &target = ConfMan.getActiveDomainName();
+	if (g_sci && !target.empty()) {
+		_audioMapIndex = new AudioMapIndex(target + ".audiomap", _mapVersion, _volVersion);
+		_audioMapIndex->load();
+	}
+
 	scanNewSources();
 
 	if (!addAudioSources()) {
@@ -939,6 +964,12 @@ void ResourceManager::init() {
 	addScriptChunkSources();
 	scanNewSources();
 
+	if (_audioMapIndex) {
+		_audioMapIndex->save();
+		delete _audioMapIndex;
+		_audioMapIndex = NULL;
+	}
+
 	detectSciVersion();
 
 	debugC(1, kDebugLevelResMan, "resMan: Detected %s", getSciVersionDesc(getSciVersion()));
@@ -951,6 +982,14 @@ void ResourceManager::init() {
 		_maxMemoryLRU = 2048 * 1024; // 2MiB
 	}
 
+	// Allow more memory to be used on systems which have it, so that
+	// resources need to be decompressed less often
+	if (ConfMan.hasKey("sci_resource_cache_size"))
+		_maxMemoryLRU = MAX(ConfMan.getInt("sci_resource_cache_size"), 0) * 1024;
+	_maxMemoryPacked = _maxMemoryLRU;
+	if (ConfMan.hasKey("sci_packed_resource_cache_size"))
+		_maxMemoryPacked = MAX(ConfMan.getInt("sci_packed_resource_cache_size"), 0) * 1024;
+
 	switch (_viewType) {
 	case kViewEga:
 		debugC(1, kDebugLevelResMan, "resMan: Detected EGA graphic resources");
@@ -997,7 +1036,15 @@ void ResourceManager::removeFromLRU(Resource *res) {
 		warning("resMan: trying to remove resource that isn't enqueued");
 		return;
 	}
-	_LRU.remove(res);
+	if (res->_lruPrev)
+		res->_lruPrev->_lruNext = res->_lruNext;
+	else
+		_lruFirst = res->_lruNext;
+	if (res->_lruNext)
+		res->_lruNext->_lruPrev = res->_lruPrev;
+	else
+		_lruLast = res->_lruPrev;
+	res->_lruPrev = res->_lruNext = NULL;
 	_memoryLRU -= res->size;
 	res->_status = kResStatusAllocated;
 }
@@ -1007,7 +1054,13 @@ void ResourceManager::addToLRU(Resource *res) {
 		warning("resMan: trying to enqueue resource with state %d", res->_status);
 		return;
 	}
-	_LRU.push_front(res);
+	res->_lruPrev = NULL;
+	res->_lruNext = _lruFirst;
+	if (_lruFirst)
+		_lruFirst->_lruPrev = res;
+	else
+		_lruLast = res;
+	_lruFirst = res;
 	_memoryLRU += res->size;
 #if SCI_VERBOSE_RESMAN
 	debug("Adding %s (%d bytes) to lru control: %d bytes total",
@@ -1020,15 +1073,11 @@ void ResourceManager::addToLRU(Resource *res) {
 void ResourceManager::printLRU() {
 	int mem = 0;
 	int entries = 0;
-	Common::List<Resource *>::iterator it = _LRU.begin();
-	Resource *res;
 
-	while (it != _LRU.end()) {
-		res = *it;
+	for (Resource *res = _lruFirst; res; res = res->_lruNext) {
 		debug("\t%s: %d bytes", res->_id.toString().c_str(), res->size);
 		mem += res->size;
 		++entries;
-		++it;
 	}
 
 	debug("Total: %d entries, %d bytes (mgr says %d)", entries, mem, _memoryLRU);
@@ -1036,16 +1085,103 @@ void ResourceManager::printLRU() {
 
 void ResourceManager::freeOldResources() {
 	while (_maxMemoryLRU < _memoryLRU) {
-		assert(!_LRU.empty());
-		Resource *goner = *_LRU.reverse_begin();
+		assert(_lruLast);
+		Resource *goner = _lruLast;
 		removeFromLRU(goner);
 		goner->unalloc();
+		_cacheStats.evictions++;
 #ifdef SCI_VERBOSE_RESMAN
 		debug("resMan-debug: LRU: Freeing %s (%d bytes)", goner->_id.toString().c_str(), goner->size);
 #endif
 	}
 }
 
+bool ResourceManager::loadFromPackedCopy(Resource *res) {
+	if (!res->_packedData)
+		return false;
+
+	Common::MemoryReadStream stream(res->_packedData, res->_packedSize);
+	if (res->decompress(_volVersion, &stream)) {
+		// Should not happen, the copy was decompressed successfully before
+		warning("resMan: Failed to decompress the packed copy of %s", res->_id.toString().c_str());
+		res->unalloc();
+		freePackedCopy(res);
+		return false;
+	}
+
+	// Keep the copies in order of use
+	removeFromPackedCache(res);
+	addToPackedCache(res);
+
+	_cacheStats.packedHits++;
+	return true;
+}
+
+void ResourceManager::addPackedCopy(Resource *res, Common::SeekableReadStream *file, uint32 packedSize) {
+	// Keep many small resources rather than a few large ones
+	if (res->_packedData || packedSize > (uint32)_maxMemoryPacked / 4)
+		return;
+
+	while (_memoryPacked + (int)packedSize > _maxMemoryPacked) {
+		freePackedCopy(_packedLast);
+		_cacheStats.packedEvictions++;
+	}
+
+	byte *packedData = new byte[packedSize];
+	file->seek(res->_fileOffset, SEEK_SET);
+	if (file->read(packedData, packedSize) != packedSize) {
+		delete[] packedData;
+		return;
+	}
+
+	res->_packedData = packedData;
+	res->_packedSize = packedSize;
+	addToPackedCache(res);
+	_memoryPacked += packedSize;
+}
+
+void ResourceManager::freePackedCopy(Resource *res) {
+	if (!res->_packedData)
+		return;
+
+	removeFromPackedCache(res);
+	_memoryPacked -= res->_packedSize;
+	delete[] res->_packedData;
+	res->_packedData = NULL;
+	res->_packedSize = 0;
+}
+
+void ResourceManager::removeFromPackedCache(Resource *res) {
+	if (res->_packedPrev)
+		res->_packedPrev->_packedNext = res->_packedNext;
+	else
+		_packedFirst = res->_packedNext;
+	if (res->_packedNext)
+		res->_packedNext->_packedPrev = res->_packedPrev;
+	else
+		_packedLast = res->_packedPrev;
+	res->_packedPrev = res->_packedNext = NULL;
+}
+
+void ResourceManager::addToPackedCache(Resource *res) {
+	res->_packedPrev = NULL;
+	res->_packedNext = _packedFirst;
+	if (_packedFirst)
+		_packedFirst->_packedPrev = res;
+	else
+		_packedLast = res;
+	_packedFirst = res;
+}
+
+void ResourceManager::invalidateResource(Resource *res) {
+	freePackedCopy(res);
+	if (res->_status == kResStatusEnqueued) {
+		removeFromLRU(res);
+		res->unalloc();
+	}
+	res->_status = kResStatusNoMalloc;
+}
+
 Common::List<ResourceId> ResourceManager::listResources(ResourceType type, int mapNumber) {
 	Common::List<ResourceId> resources;
 
@@ -1065,9 +1201,16 @@ Resource *ResourceManager::findResource(ResourceId id, bool lock) {
 	if (!retval)
 		return NULL;
 
-	if (retval->_status == kResStatusNoMalloc)
+	if (retval->_status == kResStatusNoMalloc) {
 		loadResource(retval);
-	else if (retval->_status == kResStatusEnqueued)
+		_cacheStats.misses++;
+		if (retval->data)
+			_cacheStats.bytesLoaded += retval->size;
+	} else {
+		_cacheStats.hits++;
+	}
+
+	if (retval->_status == kResStatusEnqueued)
 		// The resource is removed from its current position
 		// in the LRU list because it has been requested
 		// again. Below, it will either be locked, or it
@@ -1765,8 +1908,9 @@ int ResourceManager::readResourceMapSCI1(ResourceSource *map) {
 					// need to be treated as unallocated in order for the new
 					// data from this volume to be picked up and used
 					if (resId.getType() == kResourceTypeMap) {
-						resource->_status = kResStatusNoMalloc;
+						invalidateResource(resource);
 					}
+					freePackedCopy(resource);
 					resource->_source = source;
 					resource->_fileOffset = fileOffset;
 					resource->size = 0;
@@ -1917,7 +2061,7 @@ Resource *ResourceManager::updateResource(ResourceId resId, ResourceSource *src,
 		_resMap.setVal(resId, res);
 	}
 
-	res->_status = kResStatusNoMalloc;
+	invalidateResource(res);
 	res->_source = src;
 	res->_headerSize = 0;
 	res->size = size;
@@ -2026,16 +2170,20 @@ int Resource::readResourceInfo(ResVersion volVersion, Common::SeekableReadStream
 	return (compression == kCompUnknown) ? SCI_ERROR_UNKNOWN_COMPRESSION : SCI_ERROR_NONE;
 }
 
-int Resource::decompress(ResVersion volVersion, Common::SeekableReadStream *file) {
+int Resource::decompress(ResVersion volVersion, Common::SeekableReadStream *file, uint32 *packedSize) {
 	int errorNum;
 	uint32 szPacked = 0;
 	ResourceCompression compression = kCompUnknown;
+	const int32 start = file->pos();
 
 	// fill resource info
 	errorNum = readResourceInfo(volVersion, file, szPacked, compression);
 	if (errorNum)
 		return errorNum;
 
+	if (packedSize)
+		*packedSize = (compression != kCompNone) ? file->pos() - start + szPacked : 0;
+
 	// getting a decompressor
 	Decompressor *dec = NULL;
 	switch (compression) {
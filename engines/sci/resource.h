@@ -136,6 +136,9 @@ enum ResVersion {
 
 class ResourceManager;
 class ResourceSource;
+class AudioMapIndex;
+struct AudioMapEntry;
+struct AudioMapLocation;
 
 class ResourceId {
 	static inline ResourceType fixupType(ResourceType type) {
@@ -284,13 +287,29 @@ protected:
 	uint16 _lockers; /**< Number of places where this resource was locked */
 	ResourceSource *_source;
 	ResourceManager *_resMan;
+	/** Neighbours in the LRU list of the resource manager, while enqueued */
+	Resource *_lruPrev, *_lruNext;
+	/**
+	 * Copy of the resource as stored in its volume, if it is compressed and
+	 * in the packed resource cache of the resource manager
+	 */
+	byte *_packedData;
+	uint32 _packedSize;
+	/** Neighbours in the packed resource cache, while it has a packed copy */
+	Resource *_packedPrev, *_packedNext;
 
 	bool loadPatch(Common::SeekableReadStream *file);
 	bool loadFromPatchFile();
 	bool loadFromWaveFile(Common::SeekableReadStream *file);
 	bool loadFromAudioVolumeSCI1(Common::SeekableReadStream *file);
 	bool loadFromAudioVolumeSCI11(Common::SeekableReadStream *file);
-	int decompress(ResVersion volVersion, Common::SeekableReadStream *file);
+	/**
+	 * Reads and decompresses the resource at the current position of file.
+	 * @param packedSize	If not NULL, set to the number of bytes the resource
+	 *						occupies in the file if it is compressed, or to 0
+	 * @return 0 on success, an SCI_ERROR_* code otherwise
+	 */
+	int decompress(ResVersion volVersion, Common::SeekableReadStream *file, uint32 *packedSize = NULL);
 	int readResourceInfo(ResVersion volVersion, Common::SeekableReadStream *file, uint32 &szPacked, ResourceCompression &compression);
 };
 
@@ -374,6 +393,27 @@ public:
 	 */
 	Common::List<ResourceId> listResources(ResourceType type, int mapNumber = -1);
 
+	/** Statistics of the resource cache, see findResource() */
+	struct CacheStats {
+		uint hits;			///< Requests for resources which were in memory
+		uint misses;		///< Requests for resources which had to be loaded
+		uint packedHits;	///< Misses which were decompressed from a packed copy
+		uint evictions;		///< Resources freed to stay within the cache size
+		uint packedEvictions;	///< Packed copies freed to stay within their cache size
+		uint64 bytesLoaded;	///< Amount of resource data loaded and decompressed
+
+		CacheStats() { reset(); }
+		void reset() { memset(this, 0, sizeof(*this)); }
+	};
+
+	const CacheStats &getCacheStats() const { return _cacheStats; }
+	void resetCacheStats() { _cacheStats.reset(); }
+	int getMemoryLocked() const { return _memoryLocked; }
+	int getMemoryLRU() const { return _memoryLRU; }
+	int getMaxMemoryLRU() const { return _maxMemoryLRU; }
+	int getMemoryPacked() const { return _memoryPacked; }
+	int getMaxMemoryPacked() const { return _maxMemoryPacked; }
+
 	void setAudioLanguage(int language);
 	int getAudioLanguage() const;
 	void changeAudioDirectory(Common::String path);
@@ -457,18 +497,30 @@ protected:
 	// Note: maxMemory will not be interpreted as a hard limit, only as a restriction
 	// for resources which are not explicitly locked. However, a warning will be
 	// issued whenever this limit is exceeded.
+	// Can be set in KiB with the "sci_resource_cache_size" config key.
 	int _maxMemoryLRU;
+	// Maximum number of bytes for copies of compressed resources, which are
+	// kept after their decompressed data has been freed, so that they can be
+	// decompressed again without reading the volume. Can be set in KiB with
+	// the "sci_packed_resource_cache_size" config key, 0 disables it.
+	int _maxMemoryPacked;
 
 	ViewType _viewType; // Used to determine if the game has EGA or VGA graphics
 	Common::List<ResourceSource *> _sources;
 	int _memoryLocked;	///< Amount of resource bytes in locked memory
 	int _memoryLRU;		///< Amount of resource bytes under LRU control
-	Common::List<Resource *> _LRU; ///< Last Resource Used list
+	int _memoryPacked;	///< Amount of bytes in packed copies of resources
+	Resource *_lruFirst;	///< Most recently used resource under LRU control
+	Resource *_lruLast;		///< Least recently used resource under LRU control
+	Resource *_packedFirst;	///< Most recently used resource with a packed copy
+	Resource *_packedLast;	///< Least recently used resource with a packed copy
+	CacheStats _cacheStats;
 	ResourceMap _resMap;
 	Common::List<Common::File *> _volumeFiles; ///< list of opened volume files
 	ResourceSource *_audioMapSCI1; ///< Currently loaded audio map for SCI1
 	ResVersion _volVersion; ///< resource.0xx version
 	ResVersion _mapVersion; ///< resource.map version
+	AudioMapIndex *_audioMapIndex; ///< Index of the audio maps, while the sources are scanned in init()
 
 	/**
 	 * Add a path to the resource manager's list of sources.
@@ -547,6 +599,20 @@ protected:
 	 */
 	int readAudioMapSCI11(IntMapResourceSource *map);
 
+	/**
+	 * Finds out where an audio map and its volume are read from, for
+	 * looking it up in the audio map index.
+	 * @return false if the map can't be indexed
+	 */
+	bool getAudioMapLocation(IntMapResourceSource *map, ResourceSource *volume, AudioMapLocation &location);
+	void addAudioMapEntries(ResourceSource *volume, const Common::Array<AudioMapEntry> &entries);
+	/**
+	 * Fetches the size and the modification time of the file of a source.
+	 * The modification time is 0 if the file system does not provide it.
+	 * @return false if the file can't be found
+	 */
+	bool getSourceFileInfo(ResourceSource *source, int32 &size, uint32 &modificationTime);
+
 	/**
 	 * Reads SCI1 audio map files.
 	 * @param map The map
@@ -584,6 +650,19 @@ protected:
 	void addToLRU(Resource *res);
 	void removeFromLRU(Resource *res);
 
+	/** Decompresses a resource from its packed copy, if it has one */
+	bool loadFromPackedCopy(Resource *res);
+	/** Keeps a copy of the packedSize bytes at the resource's offset in file */
+	void addPackedCopy(Resource *res, Common::SeekableReadStream *file, uint32 packedSize);
+	void freePackedCopy(Resource *res);
+	void removeFromPackedCache(Resource *res);
+	void addToPackedCache(Resource *res);
+	/**
+	 * Frees the data of a resource whose source or location changes, so that
+	 * it is loaded again from there
+	 */
+	void invalidateResource(Resource *res);
+
 	ResourceCompression getViewCompression();
 	ViewType detectViewType();
 	bool hasSci0Voc999();
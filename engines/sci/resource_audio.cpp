@@ -24,6 +24,8 @@
 
 #include "common/archive.h"
 #include "common/file.h"
+#include "common/savefile.h"
+#include "common/system.h"
 #include "common/textconsole.h"
 #include "common/memstream.h"
 #include "sci/resource.h"
@@ -220,6 +222,7 @@ void ResourceManager::removeAudioResource(ResourceId resId) {
 			} else {
 				if (res->_status == kResStatusEnqueued)
 					removeFromLRU(res);
+				freePackedCopy(res);
 
 				_resMap.erase(resId);
 				delete res;
@@ -286,6 +289,19 @@ int ResourceManager::readAudioMapSCI11(IntMapResourceSource *map) {
 #endif
 
 	uint32 offset = 0;
+	ResourceSource *src = findVolume(map, map->_volumeNumber);
+
+	// Take the entries from the index if possible, without loading the map
+	AudioMapLocation location;
+	const bool indexed = _audioMapIndex && src && getAudioMapLocation(map, src, location);
+	if (indexed) {
+		const Common::Array<AudioMapEntry> *indexEntries = _audioMapIndex->find(map->_mapNumber, map->_volumeNumber, location);
+		if (indexEntries) {
+			addAudioMapEntries(src, *indexEntries);
+			return 0;
+		}
+	}
+
 	Resource *mapRes = findResource(ResourceId(kResourceTypeMap, map->_mapNumber), false);
 
 	if (!mapRes) {
@@ -293,13 +309,13 @@ int ResourceManager::readAudioMapSCI11(IntMapResourceSource *map) {
 		return SCI_ERROR_RESMAP_NOT_FOUND;
 	}
 
-	ResourceSource *src = findVolume(map, map->_volumeNumber);
-
 	if (!src) {
 		warning("Failed to find volume for %i.MAP", map->_mapNumber);
 		return SCI_ERROR_NO_RESOURCE_FILES_FOUND;
 	}
 
+	Common::Array<AudioMapEntry> entries;
+
 	byte *ptr = mapRes->data;
 
 	// Heuristic to detect entry size
@@ -327,7 +343,7 @@ int ResourceManager::readAudioMapSCI11(IntMapResourceSource *map) {
 				ptr += 3;
 			}
 
-			addResource(ResourceId(kResourceTypeAudio, n), src, offset);
+			entries.push_back(AudioMapEntry(ResourceId(kResourceTypeAudio, n), offset));
 		}
 	} else if (map->_mapNumber == 0 && entrySize == 10 && ptr[3] == 0) {
 		// QFG3 demo format
@@ -344,7 +360,7 @@ int ResourceManager::readAudioMapSCI11(IntMapResourceSource *map) {
 			uint32 size = READ_LE_UINT32(ptr);
 			ptr += 4;
 
-			addResource(ResourceId(kResourceTypeAudio, n), src, offset, size);
+			entries.push_back(AudioMapEntry(ResourceId(kResourceTypeAudio, n), offset, size));
 		}
 	} else if (map->_mapNumber == 0 && entrySize == 8 && READ_LE_UINT16(ptr + 2) == 0xffff) {
 		// LB2 Floppy/Mother Goose SCI1.1 format
@@ -369,7 +385,7 @@ int ResourceManager::readAudioMapSCI11(IntMapResourceSource *map) {
 			stream->skip(5);
 			uint32 size = stream->readUint32LE() + headerSize + 2;
 
-			addResource(ResourceId(kResourceTypeAudio, n), src, offset, size);
+			entries.push_back(AudioMapEntry(ResourceId(kResourceTypeAudio, n), offset, size));
 		}
 	} else {
 		bool isEarly = (entrySize != 11);
@@ -402,7 +418,7 @@ int ResourceManager::readAudioMapSCI11(IntMapResourceSource *map) {
 				// FIXME: The sync36 resource seems to be two bytes too big in KQ6CD
 				// (bytes taken from the RAVE resource right after it)
 				if (syncSize > 0)
-					addResource(ResourceId(kResourceTypeSync36, map->_mapNumber, n & 0xffffff3f), src, offset, syncSize);
+					entries.push_back(AudioMapEntry(ResourceId(kResourceTypeSync36, map->_mapNumber, n & 0xffffff3f), offset, syncSize));
 			}
 
 			if (n & 0x40) {
@@ -412,18 +428,209 @@ int ResourceManager::readAudioMapSCI11(IntMapResourceSource *map) {
 				ptr += 2;
 
 				if (kq6HiresSyncSize > 0) {
-					addResource(ResourceId(kResourceTypeRave, map->_mapNumber, n & 0xffffff3f), src, offset + syncSize, kq6HiresSyncSize);
+					entries.push_back(AudioMapEntry(ResourceId(kResourceTypeRave, map->_mapNumber, n & 0xffffff3f), offset + syncSize, kq6HiresSyncSize));
 					syncSize += kq6HiresSyncSize;
 				}
 			}
 
-			addResource(ResourceId(kResourceTypeAudio36, map->_mapNumber, n & 0xffffff3f), src, offset + syncSize);
+			entries.push_back(AudioMapEntry(ResourceId(kResourceTypeAudio36, map->_mapNumber, n & 0xffffff3f), offset + syncSize));
 		}
 	}
 
+	addAudioMapEntries(src, entries);
+	if (indexed)
+		_audioMapIndex->add(map->_mapNumber, map->_volumeNumber, location, entries);
+
 	return 0;
 }
 
+bool ResourceManager::getAudioMapLocation(IntMapResourceSource *map, ResourceSource *volume, AudioMapLocation &location) {
+	// Only maps in files of their own, or at a fixed place in a volume, can
+	// be checked by the file sizes and modification times
+	Resource *mapRes = testResource(ResourceId(kResourceTypeMap, map->_mapNumber));
+	if (!mapRes || (mapRes->_source->getSourceType() != kSourceVolume && mapRes->_source->getSourceType() != kSourcePatch))
+		return false;
+
+	location.mapSource = mapRes->_source->getLocationName();
+	location.mapOffset = mapRes->_fileOffset;
+	location.volumeSource = volume->getLocationName();
+	return getSourceFileInfo(mapRes->_source, location.mapSourceSize, location.mapSourceTime)
+		&& getSourceFileInfo(volume, location.volumeSourceSize, location.volumeSourceTime);
+}
+
+void ResourceManager::addAudioMapEntries(ResourceSource *volume, const Common::Array<AudioMapEntry> &entries) {
+	for (Common::Array<AudioMapEntry>::const_iterator it = entries.begin(); it != entries.end(); ++it)
+		addResource(it->id, volume, it->offset, it->size);
+}
+
+bool ResourceManager::getSourceFileInfo(ResourceSource *source, int32 &size, uint32 &modificationTime) {
+	uint32 fileSize;
+	if (source->_resourceFile) {
+		if (source->_resourceFile->getFileInfo(fileSize, modificationTime)) {
+			size = fileSize;
+			return true;
+		}
+	} else {
+		Common::ArchiveMemberPtr member = SearchMan.getMember(source->getLocationName());
+		if (member && member->getFileInfo(fileSize, modificationTime)) {
+			size = fileSize;
+			return true;
+		}
+	}
+
+	// Fall back to the size alone
+	Common::SeekableReadStream *stream = getVolumeFile(source);
+	if (!stream)
+		return false;
+
+	size = stream->size();
+	modificationTime = 0;
+	if (source->_resourceFile)
+		delete stream;
+	return size >= 0;
+}
+
+enum {
+	kAudioMapIndexVersion = 2
+};
+
+AudioMapIndex::AudioMapIndex(const Common::String &filename, ResVersion mapVersion, ResVersion volVersion)
+	: _filename(filename), _mapVersion(mapVersion), _volVersion(volVersion), _dirty(false) {
+}
+
+static Common::String readIndexString(Common::ReadStream &stream) {
+	Common::String str;
+	for (uint16 length = stream.readUint16LE(); length && !stream.eos(); --length)
+		str += (char)stream.readByte();
+	return str;
+}
+
+static void writeIndexString(Common::WriteStream &stream, const Common::String &str) {
+	stream.writeUint16LE(str.size());
+	stream.write(str.c_str(), str.size());
+}
+
+void AudioMapIndex::load() {
+	Common::InSaveFile *in = g_system->getSavefileManager()->openForLoading(_filename);
+	if (!in)
+		return;
+
+	// Read it at once, and parse it in memory
+	const int32 size = in->size();
+	byte *data = size > 0 ? (byte *)malloc(size) : NULL;
+	const bool read = data && in->read(data, size) == (uint32)size;
+	delete in;
+	if (!read) {
+		free(data);
+		return;
+	}
+
+	Common::MemoryReadStream stream(data, size, DisposeAfterUse::YES);
+	if (stream.readUint32BE() != MKTAG('S', 'A', 'M', 'I') || stream.readUint16LE() != kAudioMapIndexVersion
+		|| stream.readByte() != _mapVersion || stream.readByte() != _volVersion) {
+		debugC(kDebugLevelResMan, "resMan: Ignoring outdated audio map index %s", _filename.c_str());
+		return;
+	}
+
+	const uint32 mapCount = stream.readUint32LE();
+	for (uint32 i = 0; i < mapCount && !stream.eos(); i++) {
+		const uint16 mapNumber = stream.readUint16LE();
+		const uint16 volumeNumber = stream.readUint16LE();
+		Map &map = _maps[getKey(mapNumber, volumeNumber)];
+
+		map.location.mapSource = readIndexString(stream);
+		map.location.mapOffset = stream.readUint32LE();
+		map.location.mapSourceSize = stream.readSint32LE();
+		map.location.mapSourceTime = stream.readUint32LE();
+		map.location.volumeSource = readIndexString(stream);
+		map.location.volumeSourceSize = stream.readSint32LE();
+		map.location.volumeSourceTime = stream.readUint32LE();
+
+		const uint32 entryCount = stream.readUint32LE();
+		if (entryCount > (uint32)(stream.size() - stream.pos()) / 15)
+			break;
+		map.entries.resize(entryCount);
+		for (uint32 j = 0; j < entryCount; j++) {
+			AudioMapEntry &entry = map.entries[j];
+			const ResourceType type = (ResourceType)stream.readByte();
+			const uint16 number = stream.readUint16LE();
+			const uint32 tuple = stream.readUint32LE();
+			entry.id = ResourceId(type, number, tuple);
+			entry.offset = stream.readUint32LE();
+			entry.size = stream.readUint32LE();
+		}
+	}
+
+	if (stream.eos() || _maps.size() != mapCount) {
+		warning("Audio map index %s is damaged, ignoring it", _filename.c_str());
+		_maps.clear();
+		return;
+	}
+
+	debugC(kDebugLevelResMan, "resMan: Read %d audio maps from %s", mapCount, _filename.c_str());
+}
+
+void AudioMapIndex::save() {
+	if (!_dirty)
+		return;
+
+	Common::OutSaveFile *out = g_system->getSavefileManager()->openForSaving(_filename, false);
+	if (!out) {
+		warning("Failed to create audio map index %s", _filename.c_str());
+		return;
+	}
+
+	out->writeUint32BE(MKTAG('S', 'A', 'M', 'I'));
+	out->writeUint16LE(kAudioMapIndexVersion);
+	out->writeByte(_mapVersion);
+	out->writeByte(_volVersion);
+	out->writeUint32LE(_maps.size());
+
+	for (MapTable::const_iterator it = _maps.begin(); it != _maps.end(); ++it) {
+		const Map &map = it->_value;
+		out->writeUint16LE(it->_key & 0xFFFF);
+		out->writeUint16LE(it->_key >> 16);
+		writeIndexString(*out, map.location.mapSource);
+		out->writeUint32LE(map.location.mapOffset);
+		out->writeSint32LE(map.location.mapSourceSize);
+		out->writeUint32LE(map.location.mapSourceTime);
+		writeIndexString(*out, map.location.volumeSource);
+		out->writeSint32LE(map.location.volumeSourceSize);
+		out->writeUint32LE(map.location.volumeSourceTime);
+
+		out->writeUint32LE(map.entries.size());
+		for (uint32 j = 0; j < map.entries.size(); j++) {
+			const AudioMapEntry &entry = map.entries[j];
+			out->writeByte(entry.id.getType());
+			out->writeUint16LE(entry.id.getNumber());
+			out->writeUint32LE(entry.id.getTuple());
+			out->writeUint32LE(entry.offset);
+			out->writeUint32LE(entry.size);
+		}
+	}
+
+	out->finalize();
+	if (out->err())
+		warning("Failed to write audio map index %s", _filename.c_str());
+	else
+		_dirty = false;
+	delete out;
+}
+
+const Common::Array<AudioMapEntry> *AudioMapIndex::find(uint16 mapNumber, int volumeNumber, const AudioMapLocation &location) const {
+	MapTable::const_iterator it = _maps.find(getKey(mapNumber, volumeNumber));
+	if (it == _maps.end() || !(it->_value.location == location))
+		return NULL;
+	return &it->_value.entries;
+}
+
+void AudioMapIndex::add(uint16 mapNumber, int volumeNumber, const AudioMapLocation &location, const Common::Array<AudioMapEntry> &entries) {
+	Map &map = _maps[getKey(mapNumber, volumeNumber)];
+	map.location = location;
+	map.entries = entries;
+	_dirty = true;
+}
+
 // AUDIOnnn.MAP contains 10-byte entries:
 // Early format:
 // w 5 bits resource type and 11 bits resource number
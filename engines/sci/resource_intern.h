@@ -142,6 +142,76 @@ public:
 	virtual void scanSource(ResourceManager *resMan);
 };
 
+/** A resource listed in an audio map */
+struct AudioMapEntry {
+	ResourceId id;
+	uint32 offset;
+	uint32 size;
+
+	AudioMapEntry() : offset(0), size(0) {}
+	AudioMapEntry(ResourceId i, uint32 o, uint32 s = 0) : id(i), offset(o), size(s) {}
+};
+
+/** Where an audio map and the audio volume it refers to were read from */
+struct AudioMapLocation {
+	Common::String mapSource;
+	uint32 mapOffset;
+	int32 mapSourceSize;
+	uint32 mapSourceTime; ///< 0 if the modification time is unknown
+	Common::String volumeSource;
+	int32 volumeSourceSize;
+	uint32 volumeSourceTime;
+
+	bool operator==(const AudioMapLocation &other) const {
+		return mapSource == other.mapSource && mapOffset == other.mapOffset
+			&& mapSourceSize == other.mapSourceSize && mapSourceTime == other.mapSourceTime
+			&& volumeSource == other.volumeSource && volumeSourceSize == other.volumeSourceSize
+			&& volumeSourceTime == other.volumeSourceTime;
+	}
+};
+
+/**
+ * Index of the resources listed in SCI1.1+ audio maps, which is kept in a
+ * save file. CD games have hundreds of audio maps, which otherwise all need
+ * to be loaded and parsed on startup. The entries of each map are stored
+ * with the location of the map and the sizes and modification times of the
+ * files involved, and are only used if these did not change.
+ */
+class AudioMapIndex {
+public:
+	AudioMapIndex(const Common::String &filename, ResVersion mapVersion, ResVersion volVersion);
+
+	/** Reads the index, unless it was written for other resource versions */
+	void load();
+
+	/** Writes the index, if maps were added */
+	void save();
+
+	/**
+	 * Returns the entries of an audio map, or NULL if it is not indexed or
+	 * was indexed at a different location.
+	 */
+	const Common::Array<AudioMapEntry> *find(uint16 mapNumber, int volumeNumber, const AudioMapLocation &location) const;
+
+	void add(uint16 mapNumber, int volumeNumber, const AudioMapLocation &location, const Common::Array<AudioMapEntry> &entries);
+
+private:
+	struct Map {
+		AudioMapLocation location;
+		Common::Array<AudioMapEntry> entries;
+	};
+
+	typedef Common::HashMap<uint32, Map> MapTable;
+
+	static uint32 getKey(uint16 mapNumber, int volumeNumber) { return (volumeNumber << 16) | mapNumber; }
+
+	const Common::String _filename;
+	const ResVersion _mapVersion;
+	const ResVersion _volVersion;
+	MapTable _maps;
+	bool _dirty;
+};
+
 class AudioVolumeResourceSource : public VolumeResourceSource {
 protected:
 	uint32 _audioCompressionType;
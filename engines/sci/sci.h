@@ -258,6 +258,8 @@ public:
 	Common::Error saveGameState(int slot, const Common::String &desc);
 	bool canLoadGameStateCurrently();
 	bool canSaveGameStateCurrently();
+	Common::Error saveGameStream(Common::WriteStream *stream);
+	Common::Error loadGameStream(Common::SeekableReadStream *stream);
 	void syncSoundSettings();
 	uint32 getTickCount();
 	void setTickCount(const uint32 ticks);
@@ -975,7 +975,8 @@ bool ScummMetaEngine::hasFeature(MetaEngineFeature f) const {
 		(f == kSavesSupportThumbnail) ||
 		(f == kSavesSupportCreationDate) ||
 		(f == kSavesSupportPlayTime) ||
-		(f == kSimpleSavesNames);
+		(f == kSimpleSavesNames) ||
+		(f == kSupportsSaveStreams);
 }
 
 bool ScummEngine::hasFeature(EngineFeature f) const {
@@ -70,6 +70,8 @@ struct SaveInfoSection {
 
 #define INFOSECTION_VERSION 2
 
+static bool loadSaveGameHeader(Common::SeekableReadStream *in, SaveGameHeader &hdr);
+
 #pragma mark -
 
 Common::Error ScummEngine::loadGameState(int slot) {
@@ -106,6 +108,38 @@ Common::Error ScummEngine::saveGameState(int slot, const Common::String &desc) {
 	return Common::kNoError;
 }
 
+Common::Error ScummEngine::saveGameStream(Common::WriteStream *stream) {
+	// Snapshots are taken every frame by some ports, so skip the thumbnail
+	if (!saveState(stream, true, false) || stream->err())
+		return Common::kWritingFailed;
+	return Common::kNoError;
+}
+
+Common::Error ScummEngine::loadGameStream(Common::SeekableReadStream *stream) {
+	// Do not drop a save or load the user asked for. A snapshot which was
+	// not applied yet is simply replaced.
+	if (_saveLoadFlag && !_saveLoadStream) {
+		delete stream;
+		return Common::kReadingFailed;
+	}
+
+	// Snapshots come from saveGameStream() of this version, so refuse
+	// anything else now rather than failing when it is applied
+	SaveGameHeader hdr;
+	if (!loadSaveGameHeader(stream, hdr) || hdr.ver != CURRENT_VER || !stream->seek(0)) {
+		warning("Invalid game state snapshot");
+		delete stream;
+		return Common::kReadingFailed;
+	}
+
+	// Like requestLoad(), the snapshot is applied in scummLoop_handleSaveLoad()
+	delete _saveLoadStream;
+	_saveLoadStream = stream;
+	_saveTemporaryState = false;
+	_saveLoadFlag = 2;		// 2 for load
+	return Common::kNoError;
+}
+
 bool ScummEngine::canSaveGameStateCurrently() {
 	// Disallow saving in v0-v3 games when a 'prequel' to a cutscene is shown.
 	// This is a blank screen with text, and while this is shown, saving should
@@ -173,7 +207,7 @@ static bool saveSaveGameHeader(Common::WriteStream *out, SaveGameHeader &hdr) {
 	return true;
 }
 
-bool ScummEngine::saveState(Common::WriteStream *out, bool writeHeader) {
+bool ScummEngine::saveState(Common::WriteStream *out, bool writeHeader, bool writeThumbnail) {
 	SaveGameHeader hdr;
 
 	if (writeHeader) {
@@ -181,7 +215,8 @@ bool ScummEngine::saveState(Common::WriteStream *out, bool writeHeader) {
 		saveSaveGameHeader(out, hdr);
 	}
 #if !defined(__DS__) && !defined(__N64__) /* && !defined(__PLAYSTATION2__) */
-	Graphics::saveThumbnail(*out);
+	if (writeThumbnail)
+		Graphics::saveThumbnail(*out);
 #endif
 	saveInfos(out);
 
@@ -318,16 +353,21 @@ bool ScummEngine::loadState(int slot, bool compat) {
 }
 
 bool ScummEngine::loadState(int slot, bool compat, Common::String &filename) {
-	SaveGameHeader hdr;
-	int sb, sh;
-
 	Common::SeekableReadStream *in = openSaveFileForReading(slot, compat, filename);
 	if (!in)
 		return false;
 
+	bool success = loadState(in, compat, filename);
+	delete in;
+	return success;
+}
+
+bool ScummEngine::loadState(Common::SeekableReadStream *in, bool compat, const Common::String &filename) {
+	SaveGameHeader hdr;
+	int sb, sh;
+
 	if (!loadSaveGameHeader(in, hdr)) {
 		warning("Invalid savegame '%s'", filename.c_str());
-		delete in;
 		return false;
 	}
 
@@ -343,14 +383,12 @@ bool ScummEngine::loadState(int slot, bool compat, Common::String &filename) {
 	// information).
 	if (hdr.ver < VER(7) || hdr.ver > CURRENT_VER) {
 		warning("Invalid version of '%s'", filename.c_str());
-		delete in;
 		return false;
 	}
 
 	// We (deliberately) broke HE savegame compatibility at some point.
 	if (hdr.ver < VER(50) && _game.heversion >= 71) {
 		warning("Unsupported version of '%s'", filename.c_str());
-		delete in;
 		return false;
 	}
 
@@ -360,7 +398,6 @@ bool ScummEngine::loadState(int slot, bool compat, Common::String &filename) {
 		if (hdr.ver <= VER(74)) {
 			if (!Graphics::checkThumbnailHeader(*in)) {
 				warning("Can not load thumbnail");
-				delete in;
 				return false;
 			}
 		}
@@ -374,7 +411,6 @@ bool ScummEngine::loadState(int slot, bool compat, Common::String &filename) {
 		SaveStateMetaInfos infos;
 		if (!loadInfos(in, &infos)) {
 			warning("Info section could not be found");
-			delete in;
 			return false;
 		}
 
@@ -444,7 +480,6 @@ bool ScummEngine::loadState(int slot, bool compat, Common::String &filename) {
 	//
 	Serializer ser(in, 0, hdr.ver);
 	saveOrLoad(&ser);
-	delete in;
 
 	// Update volume settings
 	syncSoundSettings();
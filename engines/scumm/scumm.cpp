@@ -215,6 +215,7 @@ ScummEngine::ScummEngine(OSystem *syst, const DetectorResult &dr)
 	_resourceHeaderSize = 8;
 	_saveLoadFlag = 0;
 	_saveLoadSlot = 0;
+	_saveLoadStream = NULL;
 	_lastSaveTime = 0;
 	_saveTemporaryState = false;
 	memset(_localScriptOffsets, 0, sizeof(_localScriptOffsets));
@@ -606,6 +607,7 @@ ScummEngine::~ScummEngine() {
 	delete _pauseDialog;
 	delete _versionDialog;
 	delete _fileHandle;
+	delete _saveLoadStream;
 
 	delete _sound;
 
@@ -2429,6 +2431,12 @@ void ScummEngine::scummLoop_handleSaveLoad() {
 
 			if (success && _saveTemporaryState && VAR_GAME_LOADED != 0xFF && _game.version <= 7)
 				VAR(VAR_GAME_LOADED) = 201;
+		} else if (_saveLoadStream) {
+			// In-memory snapshot, see loadGameStream()
+			filename = "memory snapshot";
+			success = loadState(_saveLoadStream, _saveTemporaryState, filename);
+			if (!success)
+				errMsg = _("Failed to load game state from file:\n\n%s");
 		} else {
 			success = loadState(_saveLoadSlot, _saveTemporaryState, filename);
 			if (!success)
@@ -2451,6 +2459,9 @@ void ScummEngine::scummLoop_handleSaveLoad() {
 		if (success && _saveLoadFlag != 1)
 			clearClickedStatus();
 
+		delete _saveLoadStream;
+		_saveLoadStream = NULL;
+
 		_saveLoadFlag = 0;
 		_lastSaveTime = _system->getMillis();
 	}
@@ -40,6 +40,8 @@
 #include "common/config-manager.h"
 
 #define DIRTY_RECT_LIMIT 800
+// Memory used for zoomed and rotated sprites, in bytes
+#define TRANSFORM_CACHE_SIZE (8 * 1024 * 1024)
 
 namespace Wintermute {
 
@@ -48,7 +50,7 @@ BaseRenderer *makeOSystemRenderer(BaseGame *inGame) {
 }
 
 //////////////////////////////////////////////////////////////////////////
-BaseRenderOSystem::BaseRenderOSystem(BaseGame *inGame) : BaseRenderer(inGame) {
+BaseRenderOSystem::BaseRenderOSystem(BaseGame *inGame) : BaseRenderer(inGame), _transformCache(TRANSFORM_CACHE_SIZE) {
 	_renderSurface = new Graphics::Surface();
 	_blankSurface = new Graphics::Surface();
 	_lastFrameIter = _renderQueue.end();
@@ -271,7 +273,7 @@ Graphics::PixelFormat BaseRenderOSystem::getPixelFormat() const {
 void BaseRenderOSystem::drawSurface(BaseSurfaceOSystem *owner, const Graphics::Surface *surf, Common::Rect *srcRect, Common::Rect *dstRect, Graphics::TransformStruct &transform) {
 
 	if (_disableDirtyRects) {
-		RenderTicket *ticket = new RenderTicket(owner, surf, srcRect, dstRect, transform);
+		RenderTicket *ticket = new RenderTicket(owner, surf, srcRect, dstRect, transform, &_transformCache);
 		ticket->_wantsDraw = true;
 		_renderQueue.push_back(ticket);
 		drawFromSurface(ticket);
@@ -303,7 +305,7 @@ void BaseRenderOSystem::drawSurface(BaseSurfaceOSystem *owner, const Graphics::S
 			}
 		}
 	}
-	RenderTicket *ticket = new RenderTicket(owner, surf, srcRect, dstRect, transform);
+	RenderTicket *ticket = new RenderTicket(owner, surf, srcRect, dstRect, transform, &_transformCache);
 	if (!_disableDirtyRects) {
 		drawFromTicket(ticket);
 	} else {
@@ -34,6 +34,7 @@
 #include "graphics/surface.h"
 #include "common/list.h"
 #include "graphics/transform_struct.h"
+#include "graphics/transform_cache.h"
 
 namespace Wintermute {
 class BaseSurfaceOSystem;
@@ -112,6 +113,9 @@ public:
 	void endSaveLoad();
 	void drawSurface(BaseSurfaceOSystem *owner, const Graphics::Surface *surf, Common::Rect *srcRect, Common::Rect *dstRect, Graphics::TransformStruct &transform);
 	BaseSurface *createSurface() override;
+
+	/** Scaled and rotated surfaces, shared by the tickets drawing them */
+	Graphics::TransformCache &getTransformCache() { return _transformCache; }
 private:
 	/**
 	 * Mark a specified rect of the screen as dirty.
@@ -147,6 +151,8 @@ private:
 
 	bool _skipThisFrame;
 	int _lastScreenChangeID; // previous value of OSystem::getScreenChangeID()
+
+	Graphics::TransformCache _transformCache;
 };
 
 } // End of namespace Wintermute
@@ -41,9 +41,12 @@
 
 namespace Wintermute {
 
+uint32 BaseSurfaceOSystem::_lastVersion = 0;
+
 //////////////////////////////////////////////////////////////////////////
 BaseSurfaceOSystem::BaseSurfaceOSystem(BaseGame *inGame) : BaseSurface(inGame) {
 	_surface = new Graphics::Surface();
+	newVersion();
 	_alphaMask = nullptr;
 	_alphaType = Graphics::ALPHA_FULL;
 	_lockPixels = nullptr;
@@ -186,11 +189,17 @@ bool BaseSurfaceOSystem::finishLoad() {
 
 	delete image;
 
+	newVersion();
 	_loaded = true;
 
 	return true;
 }
 
+//////////////////////////////////////////////////////////////////////////
+void BaseSurfaceOSystem::newVersion() {
+	_version = ++_lastVersion;
+}
+
 //////////////////////////////////////////////////////////////////////////
 void BaseSurfaceOSystem::genAlphaMask(Graphics::Surface *surface) {
 	warning("BaseSurfaceOSystem::GenAlphaMask - Not ported yet");
@@ -317,6 +326,7 @@ bool BaseSurfaceOSystem::startPixelOp() {
 	// Any pixel-op makes the caching useless:
 	BaseRenderOSystem *renderer = static_cast<BaseRenderOSystem *>(_gameRef->_renderer);
 	renderer->invalidateTicketsFromSurface(this);
+	newVersion();
 	return STATUS_OK;
 }
 
@@ -456,6 +466,7 @@ bool BaseSurfaceOSystem::putSurface(const Graphics::Surface &surface, bool hasAl
 	} else {
 		_alphaType = Graphics::ALPHA_OPAQUE;
 	}
+	newVersion();
 	BaseRenderOSystem *renderer = static_cast<BaseRenderOSystem *>(_gameRef->_renderer);
 	renderer->invalidateTicketsFromSurface(this);
 
@@ -83,8 +83,17 @@ public:
 	}
 
 	Graphics::AlphaType getAlphaType() const { return _alphaType; }
+
+	/**
+	 * Changes whenever the pixels may have changed. Unique among all the
+	 * surfaces, so it identifies their content in the TransformCache.
+	 */
+	uint32 getVersion() const { return _version; }
 private:
 	Graphics::Surface *_surface;
+	uint32 _version;
+	static uint32 _lastVersion;
+	void newVersion();
 	bool _loaded;
 	bool finishLoad();
 	bool drawSprite(int x, int y, Rect32 *rect, Rect32 *newRect, Graphics::TransformStruct transformStruct);
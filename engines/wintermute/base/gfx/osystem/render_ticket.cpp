@@ -34,14 +34,29 @@
 
 namespace Wintermute {
 
-RenderTicket::RenderTicket(BaseSurfaceOSystem *owner, const Graphics::Surface *surf, Common::Rect *srcRect, Common::Rect *dstRect, Graphics::TransformStruct transform) :
+RenderTicket::RenderTicket(BaseSurfaceOSystem *owner, const Graphics::Surface *surf, Common::Rect *srcRect, Common::Rect *dstRect, Graphics::TransformStruct transform, Graphics::TransformCache *transformCache) :
 	_owner(owner),
 	_srcRect(*srcRect),
 	_dstRect(*dstRect),
 	_isValid(true),
 	_wantsDraw(true),
 	_transform(transform) {
-	if (surf) {
+	const bool rotated = _transform._angle != Graphics::kDefaultAngle;
+	const bool scaled = (dstRect->width() != srcRect->width() || dstRect->height() != srcRect->height()) &&
+						_transform._numTimesX * _transform._numTimesY == 1;
+
+	if (surf && transformCache && owner && (rotated || scaled)) {
+		// Transform straight from the owner's surface, which the cache
+		// identifies by its version, so the same zoom and angle are only
+		// computed once. The cached copy is never modified.
+		Graphics::TransparentSurface src(surf->getSubArea(*srcRect), false);
+		if (rotated) {
+			_transformed = transformCache->rotoscale(src, owner->getVersion(), transform);
+		} else {
+			_transformed = transformCache->scale(src, owner->getVersion(), dstRect->width(), dstRect->height());
+		}
+		_surface = _transformed.get();
+	} else if (surf) {
 		_surface = new Graphics::Surface();
 		_surface->create((uint16)srcRect->width(), (uint16)srcRect->height(), surf->format);
 		assert(_surface->format.bytesPerPixel == 4);
@@ -57,15 +72,13 @@ RenderTicket::RenderTicket(BaseSurfaceOSystem *owner, const Graphics::Surface *s
 		// NB: Mirroring and rotation are probably done in the wrong order.
 		// (Mirroring should most likely be done before rotation. See also
 		// TransformTools.)
-		if (_transform._angle != Graphics::kDefaultAngle) {
+		if (rotated) {
 			Graphics::TransparentSurface src(*_surface, false);
 			Graphics::Surface *temp = src.rotoscale(transform);
 			_surface->free();
 			delete _surface;
 			_surface = temp;
-		} else if ((dstRect->width() != srcRect->width() ||
-					dstRect->height() != srcRect->height()) &&
-					_transform._numTimesX * _transform._numTimesY == 1) {
+		} else if (scaled) {
 			Graphics::TransparentSurface src(*_surface, false);
 			Graphics::Surface *temp = src.scale(dstRect->width(), dstRect->height());
 			_surface->free();
@@ -78,7 +91,7 @@ RenderTicket::RenderTicket(BaseSurfaceOSystem *owner, const Graphics::Surface *s
 }
 
 RenderTicket::~RenderTicket() {
-	if (_surface) {
+	if (_surface && !_transformed) {
 		_surface->free();
 		delete _surface;
 	}
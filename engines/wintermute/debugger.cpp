@@ -23,6 +23,8 @@
 #include "engines/wintermute/debugger.h"
 #include "engines/wintermute/base/base_engine.h"
 #include "engines/wintermute/base/base_file_manager.h"
+#include "engines/wintermute/base/base_game.h"
+#include "engines/wintermute/base/gfx/osystem/base_render_osystem.h"
 #include "engines/wintermute/base/scriptables/script_value.h"
 #include "engines/wintermute/debugger/debugger_controller.h"
 #include "engines/wintermute/wintermute.h"
@@ -36,6 +38,7 @@ Console::Console(WintermuteEngine *vm) : GUI::Debugger(), _engineRef(vm) {
 	registerCmd("dump_file", WRAP_METHOD(Console, Cmd_DumpFile));
 	registerCmd("show_fps", WRAP_METHOD(Console, Cmd_ShowFps));
 	registerCmd("dump_file", WRAP_METHOD(Console, Cmd_DumpFile));
+	registerCmd("transform_cache", WRAP_METHOD(Console, Cmd_TransformCache));
 	registerCmd("help", WRAP_METHOD(Console, Cmd_Help));
 	// Actual (script) debugger commands
 	registerCmd(STEP_CMD, WRAP_METHOD(Console, Cmd_Step));
@@ -308,6 +311,23 @@ bool Console::Cmd_ShowFps(int argc, const char **argv) {
 	return true;
 }
 
+bool Console::Cmd_TransformCache(int argc, const char **argv) {
+	if (argc > 2 || (argc == 2 && Common::String(argv[1]) != "reset")) {
+		debugPrintf("Usage: %s [reset]\n", argv[0]);
+		return true;
+	}
+
+	BaseRenderOSystem *renderer = static_cast<BaseRenderOSystem *>(_engineRef->_game->_renderer);
+	Graphics::TransformCache &cache = renderer->getTransformCache();
+	debugPrintf("%d surfaces, %d KB\n", cache.getEntryCount(), cache.getSize() / 1024);
+	debugPrintf("%d hits, %d misses, %d evictions\n", cache.getHits(), cache.getMisses(), cache.getEvictions());
+
+	if (argc == 2) {
+		cache.resetStats();
+	}
+	return true;
+}
+
 bool Console::Cmd_DumpFile(int argc, const char **argv) {
 	if (argc != 3) {
 		debugPrintf("Usage: %s <file path> <output file name>\n", argv[0]);
@@ -70,6 +70,7 @@ public:
 	bool Cmd_Help(int argc, const char **argv);
 	bool Cmd_ShowFps(int argc, const char **argv);
 	bool Cmd_DumpFile(int argc, const char **argv);
+	bool Cmd_TransformCache(int argc, const char **argv);
 
 #if EXTENDED_DEBUGGER_ENABLED
 	/**
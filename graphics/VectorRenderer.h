@@ -289,6 +289,9 @@ public:
 		_activeSurface = surface;
 	}
 
+	/** Returns the active drawing surface. */
+	TransparentSurface *getSurface() const { return _activeSurface; }
+
 	/**
 	 * Fills the active surface with the specified fg/bg color or the active gradient.
 	 * Defaults to using the active Foreground color for filling.
@@ -515,6 +518,24 @@ public:
 	 */
 	virtual void disableShadows() { _disableShadows = true; }
 	virtual void enableShadows() { _disableShadows = false; }
+	bool shadowsEnabled() const { return !_disableShadows; }
+
+	/**
+	 * The colors draw steps use when they do not set their own. They carry
+	 * over from whatever was drawn before, so drawing the same steps twice
+	 * only gives the same result if these match. The rest of the drawing
+	 * state is set by every draw step.
+	 */
+	struct ColorState {
+		uint32 fg, bg, bevel, gradientStart, gradientEnd;
+
+		bool operator==(const ColorState &s) const {
+			return fg == s.fg && bg == s.bg && bevel == s.bevel && gradientStart == s.gradientStart && gradientEnd == s.gradientEnd;
+		}
+	};
+
+	virtual ColorState getColorState() const = 0;
+	virtual void setColorState(const ColorState &state) = 0;
 
 	/**
 	 * Applies a whole-screen shading effect, used before opening a new dialog.
@@ -552,6 +552,12 @@ setGradientColors(uint8 r1, uint8 g1, uint8 b1, uint8 r2, uint8 g2, uint8 b2) {
 	_gradientEnd = _format.RGBToColor(r2, g2, b2);
 	_gradientStart = _format.RGBToColor(r1, g1, b1);
 
+	calcGradientBytes();
+}
+
+template<typename PixelType>
+void VectorRendererSpec<PixelType>::
+calcGradientBytes() {
 	if (sizeof(PixelType) == 4) {
 		_gradientBytes[0] = ((_gradientEnd & _redMask) >> _format.rShift) - ((_gradientStart & _redMask) >> _format.rShift);
 		_gradientBytes[1] = ((_gradientEnd & _greenMask) >> _format.gShift) - ((_gradientStart & _greenMask) >> _format.gShift);
@@ -563,6 +569,18 @@ setGradientColors(uint8 r1, uint8 g1, uint8 b1, uint8 r2, uint8 g2, uint8 b2) {
 	}
 }
 
+template<typename PixelType>
+void VectorRendererSpec<PixelType>::
+setColorState(const ColorState &state) {
+	_fgColor = state.fg;
+	_bgColor = state.bg;
+	_bevelColor = state.bevel;
+	_gradientStart = state.gradientStart;
+	_gradientEnd = state.gradientEnd;
+
+	calcGradientBytes();
+}
+
 template<typename PixelType>
 inline PixelType VectorRendererSpec<PixelType>::
 calcGradient(uint32 pos, uint32 max) {
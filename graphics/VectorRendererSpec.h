@@ -85,6 +85,18 @@ public:
 	void setBevelColor(uint8 r, uint8 g, uint8 b) { _bevelColor = _format.RGBToColor(r, g, b); }
 	void setGradientColors(uint8 r1, uint8 g1, uint8 b1, uint8 r2, uint8 g2, uint8 b2);
 
+	ColorState getColorState() const {
+		ColorState state;
+		state.fg = _fgColor;
+		state.bg = _bgColor;
+		state.bevel = _bevelColor;
+		state.gradientStart = _gradientStart;
+		state.gradientEnd = _gradientEnd;
+		return state;
+	}
+
+	void setColorState(const ColorState &state);
+
 	void copyFrame(OSystem *sys, const Common::Rect &r);
 	void copyWholeFrame(OSystem *sys) { copyFrame(sys, Common::Rect(0, 0, _activeSurface->w, _activeSurface->h)); }
 
@@ -274,6 +286,9 @@ protected:
 	 */
 	inline PixelType calcGradient(uint32 pos, uint32 max);
 
+	/** Updates _gradientBytes from the gradient start/end colors. */
+	void calcGradientBytes();
+
 	void precalcGradient(int h);
 	void gradientFill(PixelType *first, int width, int x, int y);
 	void gradientFillClip(PixelType *first, int width, int x, int y, int realX, int realY);
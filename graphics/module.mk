@@ -18,6 +18,7 @@ MODULE_OBJS := \
 	macgui/macwindowmanager.o \
 	managed_surface.o \
 	nine_patch.o \
+	palette_lut.o \
 	pixelformat.o \
 	primitives.o \
 	scaler.o \
@@ -25,6 +26,7 @@ MODULE_OBJS := \
 	screen.o \
 	sjis.o \
 	surface.o \
+	transform_cache.o \
 	transform_struct.o \
 	transform_tools.o \
 	transparent_surface.o \
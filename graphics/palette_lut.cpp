@@ -0,0 +1,154 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "graphics/palette_lut.h"
+
+#include "common/textconsole.h"
+
+#ifdef USE_NEON_PALETTE_LUT
+#include <arm_neon.h>
+#endif
+
+namespace Graphics {
+
+namespace {
+
+template<typename T>
+void convertLineScalar(T *dst, const byte *src, uint w, const T *lut) {
+	// Four pixels per iteration, so the table loads of one group are
+	// independent of each other.
+	while (w >= 4) {
+		const T a = lut[src[0]];
+		const T b = lut[src[1]];
+		const T c = lut[src[2]];
+		const T d = lut[src[3]];
+		dst[0] = a;
+		dst[1] = b;
+		dst[2] = c;
+		dst[3] = d;
+		src += 4;
+		dst += 4;
+		w -= 4;
+	}
+
+	while (w--)
+		*dst++ = lut[*src++];
+}
+
+#ifdef USE_NEON_PALETTE_LUT
+/**
+ * Look up 16 indices in a 256 entry byte table. TBL yields 0 and TBX keeps
+ * the previous result for indices outside its 64 byte window, so four
+ * lookups with the index shifted down by 64 each time cover the table.
+ */
+inline uint8x16_t lookup256(const uint8x16x4_t *table, uint8x16_t index) {
+	const uint8x16_t step = vdupq_n_u8(64);
+	uint8x16_t result = vqtbl4q_u8(table[0], index);
+	index = vsubq_u8(index, step);
+	result = vqtbx4q_u8(result, table[1], index);
+	index = vsubq_u8(index, step);
+	result = vqtbx4q_u8(result, table[2], index);
+	index = vsubq_u8(index, step);
+	return vqtbx4q_u8(result, table[3], index);
+}
+
+void convertLineNEON16(uint16 *dst, const byte *src, uint w, const byte (*planes)[256], const uint16 *lut) {
+	uint8x16x4_t lo[4], hi[4];
+	for (int i = 0; i < 4; ++i) {
+		lo[i] = vld1q_u8_x4(planes[0] + i * 64);
+		hi[i] = vld1q_u8_x4(planes[1] + i * 64);
+	}
+
+	while (w >= 16) {
+		const uint8x16_t index = vld1q_u8(src);
+		uint8x16x2_t out;
+		out.val[0] = lookup256(lo, index);
+		out.val[1] = lookup256(hi, index);
+		vst2q_u8((uint8 *)dst, out);
+		src += 16;
+		dst += 16;
+		w -= 16;
+	}
+
+	convertLineScalar<uint16>(dst, src, w, lut);
+}
+#endif
+
+} // End of anonymous namespace
+
+PaletteLUT::PaletteLUT(const PixelFormat &format) {
+	memset(_palette, 0, sizeof(_palette));
+	setFormat(format);
+}
+
+void PaletteLUT::setFormat(const PixelFormat &format) {
+	assert(format.bytesPerPixel == 2 || format.bytesPerPixel == 4);
+	_format = format;
+	updateEntries(0, 256);
+}
+
+void PaletteLUT::setPalette(const byte *colors, uint start, uint num) {
+	assert(start + num <= 256);
+	memcpy(_palette + start * 3, colors, num * 3);
+	updateEntries(start, num);
+}
+
+void PaletteLUT::grabPalette(byte *colors, uint start, uint num) const {
+	assert(start + num <= 256);
+	memcpy(colors, _palette + start * 3, num * 3);
+}
+
+void PaletteLUT::updateEntries(uint start, uint num) {
+	const byte *color = _palette + start * 3;
+
+	for (uint i = start; i < start + num; ++i, color += 3) {
+		const uint32 c = _format.RGBToColor(color[0], color[1], color[2]);
+		_lut16[i] = (uint16)c;
+		_lut32[i] = c;
+#ifdef USE_NEON_PALETTE_LUT
+		_planes16[0][i] = c & 0xFF;
+		_planes16[1][i] = (c >> 8) & 0xFF;
+#endif
+	}
+}
+
+void PaletteLUT::convertLine(void *dst, const byte *src, uint w) const {
+	if (_format.bytesPerPixel == 2) {
+#ifdef USE_NEON_PALETTE_LUT
+		convertLineNEON16((uint16 *)dst, src, w, _planes16, _lut16);
+#else
+		convertLineScalar<uint16>((uint16 *)dst, src, w, _lut16);
+#endif
+	} else {
+		convertLineScalar<uint32>((uint32 *)dst, src, w, _lut32);
+	}
+}
+
+void PaletteLUT::convert(byte *dst, uint dstPitch, const byte *src, uint srcPitch, uint w, uint h) const {
+	while (h--) {
+		convertLine(dst, src, w);
+		dst += dstPitch;
+		src += srcPitch;
+	}
+}
+
+} // End of namespace Graphics
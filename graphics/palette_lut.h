@@ -0,0 +1,129 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+/**
+ * @file
+ * CLUT8 to true color conversion.
+ *
+ * Used in backends:
+ * - libretro
+ */
+
+#ifndef GRAPHICS_PALETTE_LUT_H
+#define GRAPHICS_PALETTE_LUT_H
+
+#include "common/scummsys.h"
+#include "graphics/pixelformat.h"
+
+#if defined(__aarch64__) && defined(__ARM_NEON) && defined(SCUMM_LITTLE_ENDIAN)
+#define USE_NEON_PALETTE_LUT
+#endif
+
+namespace Graphics {
+
+/**
+ * A palette together with a lookup table mapping each of its 256 entries
+ * to a 16 or 32 bit pixel format.
+ *
+ * The table is updated whenever the palette changes, so expanding CLUT8
+ * pixels costs a single lookup per pixel instead of a RGBToColor() call.
+ * Where the platform allows it, whole spans are expanded with vector
+ * table lookups.
+ */
+class PaletteLUT {
+public:
+	/**
+	 * Create a lookup table for the given destination format.
+	 * The palette starts out all black.
+	 *
+	 * @param format  the destination format, must be 2 or 4 bytes per pixel
+	 */
+	PaletteLUT(const PixelFormat &format);
+
+	/**
+	 * Change the destination format. The palette is kept.
+	 */
+	void setFormat(const PixelFormat &format);
+
+	const PixelFormat &getFormat() const { return _format; }
+
+	/**
+	 * Replace the specified range of the palette, in the same layout as
+	 * PaletteManager::setPalette().
+	 */
+	void setPalette(const byte *colors, uint start, uint num);
+
+	/**
+	 * Grab the specified range of the palette, in the same layout as
+	 * PaletteManager::grabPalette().
+	 */
+	void grabPalette(byte *colors, uint start, uint num) const;
+
+	/**
+	 * Return the color of a palette entry in the destination format.
+	 */
+	uint32 getColor(byte index) const {
+		return (_format.bytesPerPixel == 2) ? _lut16[index] : _lut32[index];
+	}
+
+	/**
+	 * Expand a line of CLUT8 pixels into the destination format.
+	 *
+	 * @param dst  the destination pixels
+	 * @param src  the CLUT8 source pixels
+	 * @param w    the number of pixels
+	 */
+	void convertLine(void *dst, const byte *src, uint w) const;
+
+	/**
+	 * Expand a rectangle of CLUT8 pixels into the destination format.
+	 *
+	 * @param dst       the first destination pixel
+	 * @param dstPitch  the number of bytes of one destination line
+	 * @param src       the first source pixel
+	 * @param srcPitch  the number of bytes of one source line
+	 * @param w         the width of the rectangle
+	 * @param h         the height of the rectangle
+	 */
+	void convert(byte *dst, uint dstPitch, const byte *src, uint srcPitch, uint w, uint h) const;
+
+private:
+	void updateEntries(uint start, uint num);
+
+	PixelFormat _format;
+	byte _palette[256 * 3];
+
+	uint16 _lut16[256];
+	uint32 _lut32[256];
+
+#ifdef USE_NEON_PALETTE_LUT
+	/**
+	 * The 16 bit table split into its low and high bytes, which is the
+	 * layout needed by the NEON table lookup kernel.
+	 */
+	byte _planes16[2][256];
+#endif
+};
+
+} // End of namespace Graphics
+
+#endif
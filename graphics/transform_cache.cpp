@@ -0,0 +1,123 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "graphics/transform_cache.h"
+
+namespace Graphics {
+
+TransformCache::Key::Key(const TransparentSurface &source, uint32 v) :
+	pixels(source.getPixels()), w(source.w), h(source.h), pitch(source.pitch), version(v),
+	premultiplied(source.isAlphaPremultiplied()), rotated(false), newWidth(0), newHeight(0), angle(0) {
+}
+
+TransformCache::TransformCache(uint32 maxBytes) : _size(0), _maxBytes(maxBytes), _hits(0), _misses(0), _evictions(0) {
+}
+
+TransformCache::~TransformCache() {
+	clear();
+}
+
+void TransformCache::clear() {
+	_map.clear();
+	_entries.clear();
+	_size = 0;
+}
+
+void TransformCache::resetStats() {
+	_hits = 0;
+	_misses = 0;
+	_evictions = 0;
+}
+
+TransformCache::SurfacePtr TransformCache::scale(const TransparentSurface &source, uint32 version, uint16 newWidth, uint16 newHeight) {
+	Key key(source, version);
+	key.newWidth = newWidth;
+	key.newHeight = newHeight;
+
+	SurfacePtr surface;
+	if (lookup(key, surface))
+		return surface;
+
+	return insert(key, source.scale(newWidth, newHeight));
+}
+
+TransformCache::SurfacePtr TransformCache::rotoscale(const TransparentSurface &source, uint32 version, const TransformStruct &transform) {
+	// Only the zoom, the angle and the hotspot affect the result
+	Key key(source, version);
+	key.rotated = true;
+	key.zoom = transform._zoom;
+	key.hotspot = transform._hotspot;
+	key.angle = transform._angle;
+
+	SurfacePtr surface;
+	if (lookup(key, surface))
+		return surface;
+
+	return insert(key, source.rotoscale(transform));
+}
+
+bool TransformCache::lookup(const Key &key, SurfacePtr &surface) {
+	EntryMap::iterator found = _map.find(key);
+	if (found == _map.end()) {
+		_misses++;
+		return false;
+	}
+
+	EntryList::iterator i = found->_value;
+	surface = i->surface;
+
+	// Move to the front, so it is dropped last
+	if (i != _entries.begin()) {
+		_entries.push_front(*i);
+		_entries.erase(i);
+		found->_value = _entries.begin();
+	}
+
+	_hits++;
+	return true;
+}
+
+TransformCache::SurfacePtr TransformCache::insert(const Key &key, TransparentSurface *surface) {
+	SurfacePtr ptr(surface, SurfaceDeleter());
+
+	// Keep a few results around, rather than one huge one
+	const uint32 size = surface->pitch * surface->h;
+	if (size > _maxBytes / 4)
+		return ptr;
+
+	evict(size);
+	_entries.push_front(Entry(key, ptr, size));
+	_map[key] = _entries.begin();
+	_size += size;
+	return ptr;
+}
+
+void TransformCache::evict(uint32 size) {
+	while (!_entries.empty() && _size + size > _maxBytes) {
+		_size -= _entries.back().size;
+		_map.erase(_entries.back().key);
+		_entries.pop_back();
+		_evictions++;
+	}
+}
+
+} // End of namespace Graphics
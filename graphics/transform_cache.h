@@ -0,0 +1,148 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef GRAPHICS_TRANSFORM_CACHE_H
+#define GRAPHICS_TRANSFORM_CACHE_H
+
+#include "common/hashmap.h"
+#include "common/list.h"
+#include "common/ptr.h"
+#include "common/rect.h"
+
+#include "graphics/transparent_surface.h"
+
+namespace Graphics {
+
+/**
+ * Keeps the results of TransparentSurface::scale() and rotoscale(), so
+ * that drawing the same sprite at the same zoom or angle again does not
+ * allocate and transform it again.
+ *
+ * A source is identified by its pixel pointer, its size and a version
+ * number chosen by the caller. The caller has to pass a different version
+ * whenever the pixels may have changed, or may be a different image at the
+ * same address, e.g. after reloading it.
+ *
+ * The results are shared: a surface returned by the cache stays valid for
+ * as long as it is referenced, even when the cache drops it. It must not
+ * be modified. The least recently used results are dropped once the cache
+ * holds more than the given number of bytes.
+ */
+class TransformCache {
+public:
+	typedef Common::SharedPtr<TransparentSurface> SurfacePtr;
+
+	explicit TransformCache(uint32 maxBytes);
+	~TransformCache();
+
+	/** Same as source.scale(newWidth, newHeight), but cached. */
+	SurfacePtr scale(const TransparentSurface &source, uint32 version, uint16 newWidth, uint16 newHeight);
+
+	/** Same as source.rotoscale(transform), but cached. */
+	SurfacePtr rotoscale(const TransparentSurface &source, uint32 version, const TransformStruct &transform);
+
+	/** Drop all cached results. */
+	void clear();
+
+	/** Number of results taken from the cache since the last resetStats(). */
+	uint getHits() const { return _hits; }
+
+	/** Number of results which had to be computed since the last resetStats(). */
+	uint getMisses() const { return _misses; }
+
+	/** Number of results dropped to make room since the last resetStats(). */
+	uint getEvictions() const { return _evictions; }
+
+	uint getEntryCount() const { return _map.size(); }
+
+	/** Size of the cached surfaces, in bytes */
+	uint32 getSize() const { return _size; }
+
+	void resetStats();
+
+private:
+	struct Key {
+		const void *pixels;
+		uint16 w, h, pitch;
+		uint32 version;
+		bool premultiplied;
+		bool rotated;
+		/** For scale() */
+		uint16 newWidth, newHeight;
+		/** For rotoscale() */
+		Common::Point zoom, hotspot;
+		int32 angle;
+
+		Key(const TransparentSurface &source, uint32 version);
+
+		bool operator==(const Key &k) const {
+			return pixels == k.pixels && w == k.w && h == k.h && pitch == k.pitch && version == k.version
+				&& premultiplied == k.premultiplied && rotated == k.rotated && newWidth == k.newWidth
+				&& newHeight == k.newHeight && zoom == k.zoom && hotspot == k.hotspot && angle == k.angle;
+		}
+	};
+
+	struct KeyHash {
+		uint operator()(const Key &k) const {
+			uint hash = (uint)(size_t)k.pixels ^ (k.version << 16) ^ (k.w << 8) ^ k.h;
+			hash = hash * 31 + (k.rotated ? k.zoom.x ^ (k.zoom.y << 16) : k.newWidth ^ (k.newHeight << 16));
+			return hash * 31 + (uint)k.angle;
+		}
+	};
+
+	struct Entry {
+		Key key;
+		SurfacePtr surface;
+		uint32 size;
+
+		Entry(const Key &k, const SurfacePtr &s, uint32 sz) : key(k), surface(s), size(sz) {}
+	};
+
+	struct SurfaceDeleter {
+		void operator()(TransparentSurface *ptr) {
+			ptr->free();
+			delete ptr;
+		}
+	};
+
+	typedef Common::List<Entry> EntryList;
+	typedef Common::HashMap<Key, EntryList::iterator, KeyHash> EntryMap;
+
+	bool lookup(const Key &key, SurfacePtr &surface);
+	SurfacePtr insert(const Key &key, TransparentSurface *surface);
+	void evict(uint32 size);
+
+	/** Results, the most recently used first */
+	EntryList _entries;
+	/** The results in _entries, by key */
+	EntryMap _map;
+	uint32 _size;
+	const uint32 _maxBytes;
+
+	uint _hits;
+	uint _misses;
+	uint _evictions;
+};
+
+} // End of namespace Graphics
+
+#endif
@@ -37,6 +37,14 @@
 #include "graphics/transparent_surface.h"
 #include "graphics/transform_tools.h"
 
+#if defined(SCUMM_LITTLE_ENDIAN) && defined(__SSE2__)
+#include <emmintrin.h>
+#define USE_SSE2_BLIT
+#elif defined(SCUMM_LITTLE_ENDIAN) && (defined(__ARM_NEON) || defined(__ARM_NEON__))
+#include <arm_neon.h>
+#define USE_NEON_BLIT
+#endif
+
 //#define ENABLE_BILINEAR
 
 namespace Graphics {
@@ -59,15 +67,9 @@ static const int kGIndex = 1;
 static const int kRIndex = 0;
 #endif
 
-void doBlitOpaqueFast(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep);
-void doBlitBinaryFast(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep);
-void doBlitAlphaBlend(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep, uint32 color);
-void doBlitAdditiveBlend(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep, uint32 color);
-void doBlitSubtractiveBlend(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep, uint32 color);
-
-TransparentSurface::TransparentSurface() : Surface(), _alphaMode(ALPHA_FULL) {}
+TransparentSurface::TransparentSurface() : Surface(), _alphaMode(ALPHA_FULL), _premultiplied(false) {}
 
-TransparentSurface::TransparentSurface(const Surface &surf, bool copyData) : Surface(), _alphaMode(ALPHA_FULL) {
+TransparentSurface::TransparentSurface(const Surface &surf, bool copyData) : Surface(), _alphaMode(ALPHA_FULL), _premultiplied(false) {
 	if (copyData) {
 		copyFrom(surf);
 	} else {
@@ -83,20 +85,234 @@ TransparentSurface::TransparentSurface(const Surface &surf, bool copyData) : Sur
 }
 
 /**
- * Optimized version of doBlit to be used w/opaque blitting (no alpha).
+ * The color modulation of a blit, split into its components.
+ */
+struct BlitColor {
+	uint32 ca, cr, cg, cb;
+	/**
+	 * Factors used by the additive and subtractive modes, which treat a
+	 * component of 255 as 256, that is, as no modulation
+	 */
+	uint32 mr, mg, mb;
+
+	BlitColor(uint32 color) {
+		ca = (color >> kAModShift) & 0xFF;
+		cr = (color >> kRModShift) & 0xFF;
+		cg = (color >> kGModShift) & 0xFF;
+		cb = (color >> kBModShift) & 0xFF;
+		mr = cr == 255 ? 256 : cr;
+		mg = cg == 255 ? 256 : cg;
+		mb = cb == 255 ? 256 : cb;
+	}
+};
+
+/**
+ * Blends one color component.
+ *
+ * @param in   the source component, multiplied by the source alpha if premultiplied
+ * @param out  the destination component
+ * @param a    the source alpha
+ * @param ina  the source alpha, modulated by the alpha of the color
+ * @param ca   the alpha of the color
+ * @param c    the component of the color
+ * @param m    the component of the color, with 255 meaning 256
  */
-void doBlitOpaqueFast(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep) {
+template<int blendMode, bool tinted, bool premultiplied>
+static inline byte blendComponent(uint32 in, uint32 out, uint32 a, uint32 ina, uint32 ca, uint32 c, uint32 m) {
+	if (blendMode == BLEND_NORMAL) {
+		if (!tinted)
+			return premultiplied ? in + (out * (255 - a) >> 8) : (in * a + out * (255 - a)) >> 8;
+		else
+			return (out * (255 - ina) >> 8) + (premultiplied ? in * ca * c >> 16 : in * ina * c >> 16);
+	} else if (blendMode == BLEND_ADDITIVE) {
+		if (!tinted)
+			return MIN<uint32>(out + (premultiplied ? in : in * a >> 8), 255);
+		else
+			return MIN<uint32>(out + (premultiplied ? in * ca * m >> 16 : in * ina * m >> 16), 255);
+	} else {
+		// Never goes below zero, as the subtracted value is a fraction of out
+		if (!tinted)
+			return out - (premultiplied ? in * out >> 8 : in * out * a >> 16);
+		else
+			return out - (premultiplied ? in * m * out >> 16 : in * m * out * a >> 24);
+	}
+}
+
+template<int blendMode, bool tinted, bool premultiplied>
+static inline void blendPixel(const byte *in, byte *out, const BlitColor &color) {
+	const uint32 a = in[kAIndex];
+
+	// Without a color, fully transparent pixels leave the target alone
+	if (!tinted && a == 0)
+		return;
+
+	const uint32 ina = a * color.ca >> 8;
+
+	if (blendMode == BLEND_NORMAL || (blendMode == BLEND_SUBTRACTIVE && tinted))
+		out[kAIndex] = 255;
+
+	out[kRIndex] = blendComponent<blendMode, tinted, premultiplied>(in[kRIndex], out[kRIndex], a, ina, color.ca, color.cr, color.mr);
+	out[kGIndex] = blendComponent<blendMode, tinted, premultiplied>(in[kGIndex], out[kGIndex], a, ina, color.ca, color.cg, color.mg);
+	out[kBIndex] = blendComponent<blendMode, tinted, premultiplied>(in[kBIndex], out[kBIndex], a, ina, color.ca, color.cb, color.mb);
+}
+
+#if defined(USE_SSE2_BLIT) || defined(USE_NEON_BLIT)
+
+// The vector code handles four pixels at a time, without flipping, and
+// gives the same results as the scalar code. The alpha component is the
+// lowest byte of every pixel.
+
+#ifdef USE_SSE2_BLIT
+
+static uint32 blitRowOpaqueVector(const byte *in, byte *out, uint32 width) {
+	const __m128i alpha = _mm_set1_epi32(0xFF);
+
+	uint32 x = 0;
+	for (; x + 4 <= width; x += 4) {
+		const __m128i src = _mm_loadu_si128((const __m128i *)(in + x * 4));
+		_mm_storeu_si128((__m128i *)(out + x * 4), _mm_or_si128(src, alpha));
+	}
+	return x;
+}
+
+static uint32 blitRowBinaryVector(const byte *in, byte *out, uint32 width) {
+	const __m128i alpha = _mm_set1_epi32(0xFF);
+
+	uint32 x = 0;
+	for (; x + 4 <= width; x += 4) {
+		const __m128i src = _mm_loadu_si128((const __m128i *)(in + x * 4));
+		const __m128i dst = _mm_loadu_si128((const __m128i *)(out + x * 4));
+		const __m128i transparent = _mm_cmpeq_epi32(_mm_and_si128(src, alpha), _mm_setzero_si128());
+
+		const __m128i result = _mm_or_si128(_mm_and_si128(transparent, dst), _mm_andnot_si128(transparent, _mm_or_si128(src, alpha)));
+		_mm_storeu_si128((__m128i *)(out + x * 4), result);
+	}
+	return x;
+}
+
+/** Blends two pixels, with their components in 16 bit lanes */
+template<bool premultiplied>
+static inline __m128i blendAlphaVector(__m128i src, __m128i dst) {
+	const __m128i a = _mm_shufflehi_epi16(_mm_shufflelo_epi16(src, _MM_SHUFFLE(0, 0, 0, 0)), _MM_SHUFFLE(0, 0, 0, 0));
+	const __m128i dstFactor = _mm_mullo_epi16(dst, _mm_sub_epi16(_mm_set1_epi16(255), a));
+
+	// The sums are at most 255 * 255, so they fit the unsigned lanes
+	if (premultiplied)
+		return _mm_add_epi16(src, _mm_srli_epi16(dstFactor, 8));
+	else
+		return _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(src, a), dstFactor), 8);
+}
+
+template<bool premultiplied>
+static uint32 blendRowAlphaVector(const byte *in, byte *out, uint32 width) {
+	const __m128i alpha = _mm_set1_epi32(0xFF);
+	const __m128i zero = _mm_setzero_si128();
+
+	uint32 x = 0;
+	for (; x + 4 <= width; x += 4) {
+		const __m128i src = _mm_loadu_si128((const __m128i *)(in + x * 4));
+		const __m128i dst = _mm_loadu_si128((const __m128i *)(out + x * 4));
+
+		const __m128i lo = blendAlphaVector<premultiplied>(_mm_unpacklo_epi8(src, zero), _mm_unpacklo_epi8(dst, zero));
+		const __m128i hi = blendAlphaVector<premultiplied>(_mm_unpackhi_epi8(src, zero), _mm_unpackhi_epi8(dst, zero));
+		const __m128i blended = _mm_or_si128(_mm_packus_epi16(lo, hi), alpha);
+
+		const __m128i transparent = _mm_cmpeq_epi32(_mm_and_si128(src, alpha), zero);
+		const __m128i result = _mm_or_si128(_mm_and_si128(transparent, dst), _mm_andnot_si128(transparent, blended));
+		_mm_storeu_si128((__m128i *)(out + x * 4), result);
+	}
+	return x;
+}
 
-	byte *in;
-	byte *out;
+#else // USE_NEON_BLIT
 
+static uint32 blitRowOpaqueVector(const byte *in, byte *out, uint32 width) {
+	const uint32x4_t alpha = vdupq_n_u32(0xFF);
+
+	uint32 x = 0;
+	for (; x + 4 <= width; x += 4) {
+		const uint32x4_t src = vreinterpretq_u32_u8(vld1q_u8(in + x * 4));
+		vst1q_u8(out + x * 4, vreinterpretq_u8_u32(vorrq_u32(src, alpha)));
+	}
+	return x;
+}
+
+static uint32 blitRowBinaryVector(const byte *in, byte *out, uint32 width) {
+	const uint32x4_t alpha = vdupq_n_u32(0xFF);
+
+	uint32 x = 0;
+	for (; x + 4 <= width; x += 4) {
+		const uint32x4_t src = vreinterpretq_u32_u8(vld1q_u8(in + x * 4));
+		const uint32x4_t dst = vreinterpretq_u32_u8(vld1q_u8(out + x * 4));
+		const uint32x4_t transparent = vceqq_u32(vandq_u32(src, alpha), vdupq_n_u32(0));
+
+		vst1q_u8(out + x * 4, vreinterpretq_u8_u32(vbslq_u32(transparent, dst, vorrq_u32(src, alpha))));
+	}
+	return x;
+}
+
+/** Blends two pixels */
+template<bool premultiplied>
+static inline uint8x8_t blendAlphaVector(uint8x8_t src, uint8x8_t dst, uint8x8_t a) {
+	const uint16x8_t dstFactor = vmull_u8(dst, vmvn_u8(a));
+
+	// The sums are at most 255 * 255, so they fit the 16 bit lanes
+	if (premultiplied)
+		return vadd_u8(src, vshrn_n_u16(dstFactor, 8));
+	else
+		return vshrn_n_u16(vmlal_u8(dstFactor, src, a), 8);
+}
+
+template<bool premultiplied>
+static uint32 blendRowAlphaVector(const byte *in, byte *out, uint32 width) {
+	const uint32x4_t alpha = vdupq_n_u32(0xFF);
+
+	uint32 x = 0;
+	for (; x + 4 <= width; x += 4) {
+		const uint8x16_t src = vld1q_u8(in + x * 4);
+		const uint8x16_t dst = vld1q_u8(out + x * 4);
+
+		// Repeat the alpha value of every pixel in all its bytes
+		const uint32x4_t srcAlpha = vandq_u32(vreinterpretq_u32_u8(src), alpha);
+		const uint8x16_t a = vreinterpretq_u8_u32(vmulq_n_u32(srcAlpha, 0x01010101));
+
+		const uint8x8_t lo = blendAlphaVector<premultiplied>(vget_low_u8(src), vget_low_u8(dst), vget_low_u8(a));
+		const uint8x8_t hi = blendAlphaVector<premultiplied>(vget_high_u8(src), vget_high_u8(dst), vget_high_u8(a));
+		const uint32x4_t blended = vorrq_u32(vreinterpretq_u32_u8(vcombine_u8(lo, hi)), alpha);
+
+		const uint32x4_t transparent = vceqq_u32(srcAlpha, vdupq_n_u32(0));
+		vst1q_u8(out + x * 4, vreinterpretq_u8_u32(vbslq_u32(transparent, vreinterpretq_u32_u8(dst), blended)));
+	}
+	return x;
+}
+
+#endif
+
+#endif
+
+/**
+ * Optimized version of doBlit to be used w/opaque blitting (no alpha).
+ */
+template<int inStep>
+static void doBlitOpaqueFast(const byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inoStep) {
 	for (uint32 i = 0; i < height; i++) {
-		out = outo;
-		in = ino;
-		memcpy(out, in, width * 4);
-		for (uint32 j = 0; j < width; j++) {
+		const byte *in = ino;
+		byte *out = outo;
+		uint32 j = 0;
+
+#if defined(USE_SSE2_BLIT) || defined(USE_NEON_BLIT)
+		if (inStep == 4) {
+			j = blitRowOpaqueVector(in, out, width);
+			in += j * 4;
+			out += j * 4;
+		}
+#endif
+
+		for (; j < width; j++) {
+			*(uint32 *)out = *(const uint32 *)in;
 			out[kAIndex] = 0xFF;
 			out += 4;
+			in += inStep;
 		}
 		outo += pitch;
 		ino += inoStep;
@@ -106,20 +322,24 @@ void doBlitOpaqueFast(byte *ino, byte *outo, uint32 width, uint32 height, uint32
 /**
  * Optimized version of doBlit to be used w/binary blitting (blit or no-blit, no blending).
  */
-void doBlitBinaryFast(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep) {
-
-	byte *in;
-	byte *out;
-
+template<int inStep>
+static void doBlitBinaryFast(const byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inoStep) {
 	for (uint32 i = 0; i < height; i++) {
-		out = outo;
-		in = ino;
-		for (uint32 j = 0; j < width; j++) {
-			uint32 pix = *(uint32 *)in;
-			int a = in[kAIndex];
-
-			if (a != 0) {   // Full opacity (Any value not exactly 0 is Opaque here)
-				*(uint32 *)out = pix;
+		const byte *in = ino;
+		byte *out = outo;
+		uint32 j = 0;
+
+#if defined(USE_SSE2_BLIT) || defined(USE_NEON_BLIT)
+		if (inStep == 4) {
+			j = blitRowBinaryVector(in, out, width);
+			in += j * 4;
+			out += j * 4;
+		}
+#endif
+
+		for (; j < width; j++) {
+			if (in[kAIndex] != 0) {   // Full opacity (Any value not exactly 0 is Opaque here)
+				*(uint32 *)out = *(const uint32 *)in;
 				out[kAIndex] = 0xFF;
 			}
 			out += 4;
@@ -131,203 +351,90 @@ void doBlitBinaryFast(byte *ino, byte *outo, uint32 width, uint32 height, uint32
 }
 
 /**
- * Optimized version of doBlit to be used with alpha blended blitting
+ * Blends the source onto the target, for every combination of blend mode,
+ * color modulation and alpha storage.
  * @param ino a pointer to the input surface
  * @param outo a pointer to the output surface
  * @param width width of the input surface
  * @param height height of the input surface
  * @param pitch pitch of the output surface - that is, width in bytes of every row, usually bpp * width of the TARGET surface (the area we are blitting to might be smaller, do the math)
- * @inStep size in bytes to skip to address each pixel, usually bpp of the source surface
- * @inoStep width in bytes of every row on the *input* surface / kind of like pitch
- * @color colormod in 0xAARRGGBB format - 0xFFFFFFFF for no colormod
+ * @param inoStep width in bytes of every row on the *input* surface / kind of like pitch
+ * @param color colormod in 0xAARRGGBB format
+ * @tparam inStep size in bytes to skip to address each pixel, usually bpp of the source surface
  */
-void doBlitAlphaBlend(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep, uint32 color) {
-	byte *in;
-	byte *out;
-
-	if (color == 0xffffffff) {
-
-		for (uint32 i = 0; i < height; i++) {
-			out = outo;
-			in = ino;
-			for (uint32 j = 0; j < width; j++) {
-
-				if (in[kAIndex] != 0) {
-					out[kAIndex] = 255;
-					out[kRIndex] = ((in[kRIndex] * in[kAIndex]) + out[kRIndex] * (255 - in[kAIndex])) >> 8;
-					out[kGIndex] = ((in[kGIndex] * in[kAIndex]) + out[kGIndex] * (255 - in[kAIndex])) >> 8;
-					out[kBIndex] = ((in[kBIndex] * in[kAIndex]) + out[kBIndex] * (255 - in[kAIndex])) >> 8;
-				}
-
-				in += inStep;
-				out += 4;
-			}
-			outo += pitch;
-			ino += inoStep;
+template<int inStep, int blendMode, bool tinted, bool premultiplied>
+static void doBlitBlend(const byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inoStep, const BlitColor &color) {
+	for (uint32 i = 0; i < height; i++) {
+		const byte *in = ino;
+		byte *out = outo;
+		uint32 j = 0;
+
+#if defined(USE_SSE2_BLIT) || defined(USE_NEON_BLIT)
+		if (inStep == 4 && blendMode == BLEND_NORMAL && !tinted) {
+			j = blendRowAlphaVector<premultiplied>(in, out, width);
+			in += j * 4;
+			out += j * 4;
 		}
-	} else {
-
-		byte ca = (color >> kAModShift) & 0xFF;
-		byte cr = (color >> kRModShift) & 0xFF;
-		byte cg = (color >> kGModShift) & 0xFF;
-		byte cb = (color >> kBModShift) & 0xFF;
-
-		for (uint32 i = 0; i < height; i++) {
-			out = outo;
-			in = ino;
-			for (uint32 j = 0; j < width; j++) {
-
-				uint32 ina = in[kAIndex] * ca >> 8;
-				out[kAIndex] = 255;
-				out[kBIndex] = (out[kBIndex] * (255 - ina) >> 8);
-				out[kGIndex] = (out[kGIndex] * (255 - ina) >> 8);
-				out[kRIndex] = (out[kRIndex] * (255 - ina) >> 8);
-
-				out[kBIndex] = out[kBIndex] + (in[kBIndex] * ina * cb >> 16);
-				out[kGIndex] = out[kGIndex] + (in[kGIndex] * ina * cg >> 16);
-				out[kRIndex] = out[kRIndex] + (in[kRIndex] * ina * cr >> 16);
+#endif
 
-				in += inStep;
-				out += 4;
-			}
-			outo += pitch;
-			ino += inoStep;
+		for (; j < width; j++) {
+			blendPixel<blendMode, tinted, premultiplied>(in, out, color);
+			in += inStep;
+			out += 4;
 		}
+		outo += pitch;
+		ino += inoStep;
 	}
 }
 
-/**
- * Optimized version of doBlit to be used with additive blended blitting
- */
-void doBlitAdditiveBlend(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep, uint32 color) {
-	byte *in;
-	byte *out;
-
-	if (color == 0xffffffff) {
-
-		for (uint32 i = 0; i < height; i++) {
-			out = outo;
-			in = ino;
-			for (uint32 j = 0; j < width; j++) {
-
-				if (in[kAIndex] != 0) {
-					out[kRIndex] = MIN((in[kRIndex] * in[kAIndex] >> 8) + out[kRIndex], 255);
-					out[kGIndex] = MIN((in[kGIndex] * in[kAIndex] >> 8) + out[kGIndex], 255);
-					out[kBIndex] = MIN((in[kBIndex] * in[kAIndex] >> 8) + out[kBIndex], 255);
-				}
+template<int inStep, int blendMode>
+static void doBlitBlend(const byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inoStep, uint32 color, bool premultiplied) {
+	const BlitColor blitColor(color);
 
-				in += inStep;
-				out += 4;
-			}
-			outo += pitch;
-			ino += inoStep;
-		}
+	if (color == 0xFFFFFFFF) {
+		if (premultiplied)
+			doBlitBlend<inStep, blendMode, false, true>(ino, outo, width, height, pitch, inoStep, blitColor);
+		else
+			doBlitBlend<inStep, blendMode, false, false>(ino, outo, width, height, pitch, inoStep, blitColor);
 	} else {
-
-		byte ca = (color >> kAModShift) & 0xFF;
-		byte cr = (color >> kRModShift) & 0xFF;
-		byte cg = (color >> kGModShift) & 0xFF;
-		byte cb = (color >> kBModShift) & 0xFF;
-
-		for (uint32 i = 0; i < height; i++) {
-			out = outo;
-			in = ino;
-			for (uint32 j = 0; j < width; j++) {
-
-				uint32 ina = in[kAIndex] * ca >> 8;
-
-				if (cb != 255) {
-					out[kBIndex] = MIN<uint>(out[kBIndex] + ((in[kBIndex] * cb * ina) >> 16), 255u);
-				} else {
-					out[kBIndex] = MIN<uint>(out[kBIndex] + (in[kBIndex] * ina >> 8), 255u);
-				}
-
-				if (cg != 255) {
-					out[kGIndex] = MIN<uint>(out[kGIndex] + ((in[kGIndex] * cg * ina) >> 16), 255u);
-				} else {
-					out[kGIndex] = MIN<uint>(out[kGIndex] + (in[kGIndex] * ina >> 8), 255u);
-				}
-
-				if (cr != 255) {
-					out[kRIndex] = MIN<uint>(out[kRIndex] + ((in[kRIndex] * cr * ina) >> 16), 255u);
-				} else {
-					out[kRIndex] = MIN<uint>(out[kRIndex] + (in[kRIndex] * ina >> 8), 255u);
-				}
-
-				in += inStep;
-				out += 4;
-			}
-			outo += pitch;
-			ino += inoStep;
-		}
+		if (premultiplied)
+			doBlitBlend<inStep, blendMode, true, true>(ino, outo, width, height, pitch, inoStep, blitColor);
+		else
+			doBlitBlend<inStep, blendMode, true, false>(ino, outo, width, height, pitch, inoStep, blitColor);
 	}
 }
 
 /**
- * Optimized version of doBlit to be used with subtractive blended blitting
+ * Picks the blitting function for the parameters of a blit, so that the
+ * inner loops are compiled without any of these decisions.
  */
-void doBlitSubtractiveBlend(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep, uint32 color) {
-	byte *in;
-	byte *out;
-
-	if (color == 0xffffffff) {
-
-		for (uint32 i = 0; i < height; i++) {
-			out = outo;
-			in = ino;
-			for (uint32 j = 0; j < width; j++) {
-
-				if (in[kAIndex] != 0) {
-					out[kRIndex] = MAX(out[kRIndex] - ((in[kRIndex] * out[kRIndex]) * in[kAIndex] >> 16), 0);
-					out[kGIndex] = MAX(out[kGIndex] - ((in[kGIndex] * out[kGIndex]) * in[kAIndex] >> 16), 0);
-					out[kBIndex] = MAX(out[kBIndex] - ((in[kBIndex] * out[kBIndex]) * in[kAIndex] >> 16), 0);
-				}
-
-				in += inStep;
-				out += 4;
-			}
-			outo += pitch;
-			ino += inoStep;
-		}
+template<int inStep>
+static void doBlit(const byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inoStep, uint32 color, TSpriteBlendMode blendMode, AlphaType alphaMode, bool premultiplied) {
+	// The fast paths copy the colors as they are, which is only right for
+	// straight alpha
+	if (!premultiplied && color == 0xFFFFFFFF && blendMode == BLEND_NORMAL && alphaMode == ALPHA_OPAQUE) {
+		doBlitOpaqueFast<inStep>(ino, outo, width, height, pitch, inoStep);
+	} else if (!premultiplied && color == 0xFFFFFFFF && blendMode == BLEND_NORMAL && alphaMode == ALPHA_BINARY) {
+		doBlitBinaryFast<inStep>(ino, outo, width, height, pitch, inoStep);
 	} else {
-
-		byte cr = (color >> kRModShift) & 0xFF;
-		byte cg = (color >> kGModShift) & 0xFF;
-		byte cb = (color >> kBModShift) & 0xFF;
-
-		for (uint32 i = 0; i < height; i++) {
-			out = outo;
-			in = ino;
-			for (uint32 j = 0; j < width; j++) {
-
-				out[kAIndex] = 255;
-				if (cb != 255) {
-					out[kBIndex] = MAX(out[kBIndex] - ((in[kBIndex] * cb  * (out[kBIndex]) * in[kAIndex]) >> 24), 0);
-				} else {
-					out[kBIndex] = MAX(out[kBIndex] - (in[kBIndex] * (out[kBIndex]) * in[kAIndex] >> 16), 0);
-				}
-
-				if (cg != 255) {
-					out[kGIndex] = MAX(out[kGIndex] - ((in[kGIndex] * cg  * (out[kGIndex]) * in[kAIndex]) >> 24), 0);
-				} else {
-					out[kGIndex] = MAX(out[kGIndex] - (in[kGIndex] * (out[kGIndex]) * in[kAIndex] >> 16), 0);
-				}
-
-				if (cr != 255) {
-					out[kRIndex] = MAX(out[kRIndex] - ((in[kRIndex] * cr * (out[kRIndex]) * in[kAIndex]) >> 24), 0);
-				} else {
-					out[kRIndex] = MAX(out[kRIndex] - (in[kRIndex] * (out[kRIndex]) * in[kAIndex] >> 16), 0);
-				}
-
-				in += inStep;
-				out += 4;
-			}
-			outo += pitch;
-			ino += inoStep;
+		if (blendMode == BLEND_ADDITIVE) {
+			doBlitBlend<inStep, BLEND_ADDITIVE>(ino, outo, width, height, pitch, inoStep, color, premultiplied);
+		} else if (blendMode == BLEND_SUBTRACTIVE) {
+			doBlitBlend<inStep, BLEND_SUBTRACTIVE>(ino, outo, width, height, pitch, inoStep, color, premultiplied);
+		} else {
+			assert(blendMode == BLEND_NORMAL);
+			doBlitBlend<inStep, BLEND_NORMAL>(ino, outo, width, height, pitch, inoStep, color, premultiplied);
 		}
 	}
 }
 
+static void doBlit(const byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep, uint32 color, TSpriteBlendMode blendMode, AlphaType alphaMode, bool premultiplied) {
+	if (inStep == 4)
+		doBlit<4>(ino, outo, width, height, pitch, inoStep, color, blendMode, alphaMode, premultiplied);
+	else
+		doBlit<-4>(ino, outo, width, height, pitch, inoStep, color, blendMode, alphaMode, premultiplied);
+}
+
 Common::Rect TransparentSurface::blit(Graphics::Surface &target, int posX, int posY, int flipping, Common::Rect *pPartRect, uint color, int width, int height, TSpriteBlendMode blendMode) {
 
 	Common::Rect retSize;
@@ -433,20 +540,7 @@ Common::Rect TransparentSurface::blit(Graphics::Surface &target, int posX, int p
 		byte *ino = (byte *)img->getBasePtr(xp, yp);
 		byte *outo = (byte *)target.getBasePtr(posX, posY);
 
-		if (color == 0xFFFFFFFF && blendMode == BLEND_NORMAL && _alphaMode == ALPHA_OPAQUE) {
-			doBlitOpaqueFast(ino, outo, img->w, img->h, target.pitch, inStep, inoStep);
-		} else if (color == 0xFFFFFFFF && blendMode == BLEND_NORMAL && _alphaMode == ALPHA_BINARY) {
-			doBlitBinaryFast(ino, outo, img->w, img->h, target.pitch, inStep, inoStep);
-		} else {
-			if (blendMode == BLEND_ADDITIVE) {
-				doBlitAdditiveBlend(ino, outo, img->w, img->h, target.pitch, inStep, inoStep, color);
-			} else if (blendMode == BLEND_SUBTRACTIVE) {
-				doBlitSubtractiveBlend(ino, outo, img->w, img->h, target.pitch, inStep, inoStep, color);
-			} else {
-				assert(blendMode == BLEND_NORMAL);
-				doBlitAlphaBlend(ino, outo, img->w, img->h, target.pitch, inStep, inoStep, color);
-			}
-		}
+		doBlit(ino, outo, img->w, img->h, target.pitch, inStep, inoStep, color, blendMode, _alphaMode, _premultiplied);
 
 	}
 
@@ -566,20 +660,7 @@ Common::Rect TransparentSurface::blitClip(Graphics::Surface &target, Common::Rec
 		byte *ino = (byte *)img->getBasePtr(xp, yp);
 		byte *outo = (byte *)target.getBasePtr(posX, posY);
 
-		if (color == 0xFFFFFFFF && blendMode == BLEND_NORMAL && _alphaMode == ALPHA_OPAQUE) {
-			doBlitOpaqueFast(ino, outo, img->w, img->h, target.pitch, inStep, inoStep);
-		} else if (color == 0xFFFFFFFF && blendMode == BLEND_NORMAL && _alphaMode == ALPHA_BINARY) {
-			doBlitBinaryFast(ino, outo, img->w, img->h, target.pitch, inStep, inoStep);
-		} else {
-			if (blendMode == BLEND_ADDITIVE) {
-				doBlitAdditiveBlend(ino, outo, img->w, img->h, target.pitch, inStep, inoStep, color);
-			} else if (blendMode == BLEND_SUBTRACTIVE) {
-				doBlitSubtractiveBlend(ino, outo, img->w, img->h, target.pitch, inStep, inoStep, color);
-			} else {
-				assert(blendMode == BLEND_NORMAL);
-				doBlitAlphaBlend(ino, outo, img->w, img->h, target.pitch, inStep, inoStep, color);
-			}
-		}
+		doBlit(ino, outo, img->w, img->h, target.pitch, inStep, inoStep, color, blendMode, _alphaMode, _premultiplied);
 
 	}
 
@@ -628,6 +709,24 @@ void TransparentSurface::setAlphaMode(AlphaType mode) {
 	_alphaMode = mode;
 }
 
+void TransparentSurface::premultiplyAlpha() {
+	assert(format.bytesPerPixel == 4);
+	if (_premultiplied)
+		return;
+
+	for (int y = 0; y < h; y++) {
+		byte *pixel = (byte *)getBasePtr(0, y);
+		for (int x = 0; x < w; x++, pixel += 4) {
+			const uint32 a = pixel[kAIndex];
+			pixel[kRIndex] = pixel[kRIndex] * a >> 8;
+			pixel[kGIndex] = pixel[kGIndex] * a >> 8;
+			pixel[kBIndex] = pixel[kBIndex] * a >> 8;
+		}
+	}
+
+	_premultiplied = true;
+}
+
 
 
 
@@ -695,6 +794,7 @@ TransparentSurface *TransparentSurface::rotoscale(const TransformStruct &transfo
 	int dstH = dstRect.height();
 
 	target->create((uint16)dstW, (uint16)dstH, this->format);
+	target->_premultiplied = _premultiplied;
 
 	if (transform._zoom.x == 0 || transform._zoom.y == 0) {
 		return target;
@@ -806,6 +906,7 @@ TransparentSurface *TransparentSurface::scale(uint16 newWidth, uint16 newHeight)
 	int dstH = dstRect.height();
 
 	target->create((uint16)dstW, (uint16)dstH, this->format);
+	target->_premultiplied = _premultiplied;
 
 #ifdef ENABLE_BILINEAR
 
@@ -959,14 +1060,25 @@ TransparentSurface *TransparentSurface::scale(uint16 newWidth, uint16 newHeight)
 
 #else
 
+	// Nearest neighbour: the source column of every target column is
+	// computed once, and a target row with the same source row as the
+	// previous one is a copy of it.
 	int *scaleCacheX = new int[dstW];
 	for (int x = 0; x < dstW; x++) {
 		scaleCacheX[x] = (x * srcW) / dstW;
 	}
 
+	int lastSrcY = -1;
 	for (int y = 0; y < dstH; y++) {
 		uint32 *destP = (uint32 *)target->getBasePtr(0, y);
-		const uint32 *srcP = (const uint32 *)getBasePtr(0, (y * srcH) / dstH);
+		const int srcY = (y * srcH) / dstH;
+		if (srcY == lastSrcY) {
+			memcpy(destP, target->getBasePtr(0, y - 1), dstW * 4);
+			continue;
+		}
+		lastSrcY = srcY;
+
+		const uint32 *srcP = (const uint32 *)getBasePtr(0, srcY);
 		for (int x = 0; x < dstW; x++) {
 			*destP++ = srcP[scaleCacheX[x]];
 		}
@@ -997,6 +1109,7 @@ TransparentSurface *TransparentSurface::convertTo(const PixelFormat &dstFormat,
 		error("Surface::convertTo(): Can only convert to 2Bpp and 4Bpp");
 
 	surface->create(w, h, dstFormat);
+	surface->_premultiplied = _premultiplied;
 
 	if (format.bytesPerPixel == 1) {
 		// Converting from paletted to high color
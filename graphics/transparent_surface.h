@@ -163,8 +163,23 @@ struct TransparentSurface : public Graphics::Surface {
 
 	AlphaType getAlphaMode() const;
 	void setAlphaMode(AlphaType);
+
+	/**
+	 * Converts the surface to premultiplied alpha, which makes blending it
+	 * cheaper. The color components are multiplied with the alpha the same
+	 * way blit() does, so blitting the surface gives about the same result
+	 * as before. The surfaces returned by scale(), rotoscale() and
+	 * convertTo() keep using premultiplied alpha.
+	 *
+	 * Premultiplied surfaces are always blended, so surfaces using
+	 * ALPHA_OPAQUE or ALPHA_BINARY, which are copied without blending,
+	 * only get slower from it.
+	 */
+	void premultiplyAlpha();
+	bool isAlphaPremultiplied() const { return _premultiplied; }
 private:
 	AlphaType _alphaMode;
+	bool _premultiplied;
 
 };
 
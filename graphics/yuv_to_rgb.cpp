@@ -86,6 +86,14 @@
 #include "graphics/surface.h"
 #include "graphics/yuv_to_rgb.h"
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define USE_SSE2_YUV
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define USE_NEON_YUV
+#endif
+
 namespace Common {
 DECLARE_SINGLETON(Graphics::YUVToRGBManager);
 }
@@ -183,6 +191,14 @@ YUVToRGBManager::~YUVToRGBManager() {
 	delete _lookup;
 }
 
+YUVToRGBLookup *YUVToRGBManager::createLookup(const Graphics::PixelFormat &format, YUVToRGBManager::LuminanceScale scale) const {
+	return new YUVToRGBLookup(format, scale);
+}
+
+void YUVToRGBManager::destroyLookup(YUVToRGBLookup *lookup) {
+	delete lookup;
+}
+
 const YUVToRGBLookup *YUVToRGBManager::getLookup(Graphics::PixelFormat format, YUVToRGBManager::LuminanceScale scale) {
 	if (_lookup && _lookup->getFormat() == format && _lookup->getScale() == scale)
 		return _lookup;
@@ -192,6 +208,399 @@ const YUVToRGBLookup *YUVToRGBManager::getLookup(Graphics::PixelFormat format, Y
 	return _lookup;
 }
 
+#if defined(USE_SSE2_YUV) || defined(USE_NEON_YUV)
+
+// The vector code computes the same values the tables hold. The chroma
+// factors of the constructor, truncated towards zero, are k * c =
+// whole * c + ((c * frac) >> 16) for the magnitude of every chroma value
+// c in [-128, 127], and the [16, 235] luminance range is stretched as
+// x * 255 / 219 = x + ((x * kITUFrac) >> 16) for x in [0, 219].
+enum {
+	kCrRFrac = 26284, // 0.419 / 0.299, plus one
+	kCrGFrac = 46773, // 0.299 / 0.419
+	kCbGFrac = 22568, // 0.114 / 0.331
+	kCbBFrac = 50685, // 0.587 / 0.331, plus one
+	kITUFrac = 10776  // 255 / 219, plus one
+};
+
+/**
+ * A pixel format, prepared for the vector code. XRGB8888 and ARGB8888 are
+ * stored by interleaving bytes, the other formats by shifting every
+ * component into place.
+ */
+struct YUVVectorFormat {
+	Graphics::PixelFormat format;
+	uint32 alpha;
+	bool xrgb;
+
+	YUVVectorFormat(const Graphics::PixelFormat &f) : format(f) {
+		alpha = f.RGBToColor(0, 0, 0);
+#ifdef SCUMM_LITTLE_ENDIAN
+		xrgb = f.bytesPerPixel == 4 && f.rLoss == 0 && f.gLoss == 0 && f.bLoss == 0 &&
+				f.rShift == 16 && f.gShift == 8 && f.bShift == 0;
+#else
+		xrgb = false;
+#endif
+	}
+};
+
+#ifdef USE_SSE2_YUV
+
+typedef __m128i YUVVector;
+
+/** 16 values, as two vectors */
+struct YUVVectorPair {
+	YUVVector lo, hi;
+};
+
+static inline YUVVector load8(const byte *src) {
+	return _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)src), _mm_setzero_si128());
+}
+
+static inline YUVVectorPair load16(const byte *src) {
+	const __m128i v = _mm_loadu_si128((const __m128i *)src);
+	YUVVectorPair pair;
+	pair.lo = _mm_unpacklo_epi8(v, _mm_setzero_si128());
+	pair.hi = _mm_unpackhi_epi8(v, _mm_setzero_si128());
+	return pair;
+}
+
+/** Repeat every element twice, for the two pixels sharing a chroma sample */
+static inline YUVVectorPair duplicate(YUVVector v) {
+	YUVVectorPair pair;
+	pair.lo = _mm_unpacklo_epi16(v, v);
+	pair.hi = _mm_unpackhi_epi16(v, v);
+	return pair;
+}
+
+/** Give the magnitude m the sign of c */
+static inline __m128i applySign(__m128i m, __m128i c) {
+	const __m128i sign = _mm_srai_epi16(c, 15);
+	return _mm_sub_epi16(_mm_xor_si128(m, sign), sign);
+}
+
+static inline __m128i mulFrac(__m128i x, uint16 frac) {
+	return _mm_mulhi_epu16(x, _mm_set1_epi16((int16)frac));
+}
+
+/**
+ * The offsets the chroma values add to the red, green and blue components.
+ * For the ITU scale, the start of the luminance range is taken off as well.
+ */
+template<bool itu>
+static inline void chromaOffsets(YUVVector u, YUVVector v, YUVVector &dR, YUVVector &dG, YUVVector &dB) {
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i bias = _mm_set1_epi16(itu ? 16 : 0);
+	const __m128i cb = _mm_sub_epi16(u, _mm_set1_epi16(128));
+	const __m128i cr = _mm_sub_epi16(v, _mm_set1_epi16(128));
+	const __m128i absCb = _mm_max_epi16(cb, _mm_sub_epi16(zero, cb));
+	const __m128i absCr = _mm_max_epi16(cr, _mm_sub_epi16(zero, cr));
+
+	dR = _mm_sub_epi16(applySign(_mm_add_epi16(absCr, mulFrac(absCr, kCrRFrac)), cr), bias);
+	dG = _mm_sub_epi16(_mm_sub_epi16(zero, bias), _mm_add_epi16(applySign(mulFrac(absCr, kCrGFrac), cr), applySign(mulFrac(absCb, kCbGFrac), cb)));
+	dB = _mm_sub_epi16(applySign(_mm_add_epi16(absCb, mulFrac(absCb, kCbBFrac)), cb), bias);
+}
+
+/** One 8 bit component, clamped and scaled like the rgbToPix table */
+template<bool itu>
+static inline YUVVector component(YUVVector y, YUVVector offset) {
+	const __m128i x = _mm_min_epi16(_mm_max_epi16(_mm_add_epi16(y, offset), _mm_setzero_si128()), _mm_set1_epi16(itu ? 219 : 255));
+	if (itu)
+		return _mm_add_epi16(x, mulFrac(x, kITUFrac));
+	return x;
+}
+
+static inline __m128i packComponent(__m128i c, const __m128i &loss, const __m128i &shift) {
+	return _mm_sll_epi16(_mm_srl_epi16(c, loss), shift);
+}
+
+static FORCEINLINE void storePixels(uint16 *dst, YUVVector r, YUVVector g, YUVVector b, const YUVVectorFormat &f) {
+	const __m128i rLoss = _mm_cvtsi32_si128(f.format.rLoss), rShift = _mm_cvtsi32_si128(f.format.rShift);
+	const __m128i gLoss = _mm_cvtsi32_si128(f.format.gLoss), gShift = _mm_cvtsi32_si128(f.format.gShift);
+	const __m128i bLoss = _mm_cvtsi32_si128(f.format.bLoss), bShift = _mm_cvtsi32_si128(f.format.bShift);
+	const __m128i alpha = _mm_set1_epi16((int16)f.alpha);
+
+	__m128i pixels = _mm_or_si128(alpha, packComponent(r, rLoss, rShift));
+	pixels = _mm_or_si128(pixels, packComponent(g, gLoss, gShift));
+	pixels = _mm_or_si128(pixels, packComponent(b, bLoss, bShift));
+	_mm_storeu_si128((__m128i *)dst, pixels);
+}
+
+/** Store XRGB8888 or ARGB8888 pixels by interleaving the component bytes */
+static FORCEINLINE void storeXRGB(uint32 *dst, const YUVVectorPair &r, const YUVVectorPair &g, const YUVVectorPair &b, const YUVVectorFormat &f) {
+	const __m128i alpha = _mm_set1_epi8((char)(f.alpha >> 24));
+	const __m128i r8 = _mm_packus_epi16(r.lo, r.hi);
+	const __m128i g8 = _mm_packus_epi16(g.lo, g.hi);
+	const __m128i b8 = _mm_packus_epi16(b.lo, b.hi);
+
+	const __m128i bgLo = _mm_unpacklo_epi8(b8, g8);
+	const __m128i bgHi = _mm_unpackhi_epi8(b8, g8);
+	const __m128i raLo = _mm_unpacklo_epi8(r8, alpha);
+	const __m128i raHi = _mm_unpackhi_epi8(r8, alpha);
+	_mm_storeu_si128((__m128i *)dst, _mm_unpacklo_epi16(bgLo, raLo));
+	_mm_storeu_si128((__m128i *)(dst + 4), _mm_unpackhi_epi16(bgLo, raLo));
+	_mm_storeu_si128((__m128i *)(dst + 8), _mm_unpacklo_epi16(bgHi, raHi));
+	_mm_storeu_si128((__m128i *)(dst + 12), _mm_unpackhi_epi16(bgHi, raHi));
+}
+
+static FORCEINLINE void storePixels(uint32 *dst, YUVVector r, YUVVector g, YUVVector b, const YUVVectorFormat &f) {
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i rLoss = _mm_cvtsi32_si128(f.format.rLoss), rShift = _mm_cvtsi32_si128(f.format.rShift);
+	const __m128i gLoss = _mm_cvtsi32_si128(f.format.gLoss), gShift = _mm_cvtsi32_si128(f.format.gShift);
+	const __m128i bLoss = _mm_cvtsi32_si128(f.format.bLoss), bShift = _mm_cvtsi32_si128(f.format.bShift);
+	const __m128i alpha = _mm_set1_epi32((int32)f.alpha);
+
+	const __m128i r16 = _mm_srl_epi16(r, rLoss);
+	const __m128i g16 = _mm_srl_epi16(g, gLoss);
+	const __m128i b16 = _mm_srl_epi16(b, bLoss);
+
+	__m128i lo = _mm_or_si128(alpha, _mm_sll_epi32(_mm_unpacklo_epi16(r16, zero), rShift));
+	lo = _mm_or_si128(lo, _mm_sll_epi32(_mm_unpacklo_epi16(g16, zero), gShift));
+	lo = _mm_or_si128(lo, _mm_sll_epi32(_mm_unpacklo_epi16(b16, zero), bShift));
+	__m128i hi = _mm_or_si128(alpha, _mm_sll_epi32(_mm_unpackhi_epi16(r16, zero), rShift));
+	hi = _mm_or_si128(hi, _mm_sll_epi32(_mm_unpackhi_epi16(g16, zero), gShift));
+	hi = _mm_or_si128(hi, _mm_sll_epi32(_mm_unpackhi_epi16(b16, zero), bShift));
+
+	_mm_storeu_si128((__m128i *)dst, lo);
+	_mm_storeu_si128((__m128i *)(dst + 4), hi);
+}
+
+#else // USE_NEON_YUV
+
+typedef int16x8_t YUVVector;
+
+/** 16 values, as two vectors */
+struct YUVVectorPair {
+	YUVVector lo, hi;
+};
+
+static inline YUVVector load8(const byte *src) {
+	return vreinterpretq_s16_u16(vmovl_u8(vld1_u8(src)));
+}
+
+static inline YUVVectorPair load16(const byte *src) {
+	const uint8x16_t v = vld1q_u8(src);
+	YUVVectorPair pair;
+	pair.lo = vreinterpretq_s16_u16(vmovl_u8(vget_low_u8(v)));
+	pair.hi = vreinterpretq_s16_u16(vmovl_u8(vget_high_u8(v)));
+	return pair;
+}
+
+/** Repeat every element twice, for the two pixels sharing a chroma sample */
+static inline YUVVectorPair duplicate(YUVVector v) {
+	const int16x8x2_t zipped = vzipq_s16(v, v);
+	YUVVectorPair pair;
+	pair.lo = zipped.val[0];
+	pair.hi = zipped.val[1];
+	return pair;
+}
+
+/** Give the magnitude m the sign of c */
+static inline int16x8_t applySign(int16x8_t m, int16x8_t c) {
+	const int16x8_t sign = vshrq_n_s16(c, 15);
+	return vsubq_s16(veorq_s16(m, sign), sign);
+}
+
+static inline int16x8_t mulFrac(int16x8_t x, uint16 frac) {
+	const uint16x8_t ux = vreinterpretq_u16_s16(x);
+	const uint32x4_t lo = vmull_n_u16(vget_low_u16(ux), frac);
+	const uint32x4_t hi = vmull_n_u16(vget_high_u16(ux), frac);
+	return vreinterpretq_s16_u16(vcombine_u16(vshrn_n_u32(lo, 16), vshrn_n_u32(hi, 16)));
+}
+
+/**
+ * The offsets the chroma values add to the red, green and blue components.
+ * For the ITU scale, the start of the luminance range is taken off as well.
+ */
+template<bool itu>
+static inline void chromaOffsets(YUVVector u, YUVVector v, YUVVector &dR, YUVVector &dG, YUVVector &dB) {
+	const int16x8_t bias = vdupq_n_s16(itu ? 16 : 0);
+	const int16x8_t cb = vsubq_s16(u, vdupq_n_s16(128));
+	const int16x8_t cr = vsubq_s16(v, vdupq_n_s16(128));
+	const int16x8_t absCb = vabsq_s16(cb);
+	const int16x8_t absCr = vabsq_s16(cr);
+
+	dR = vsubq_s16(applySign(vaddq_s16(absCr, mulFrac(absCr, kCrRFrac)), cr), bias);
+	dG = vsubq_s16(vnegq_s16(bias), vaddq_s16(applySign(mulFrac(absCr, kCrGFrac), cr), applySign(mulFrac(absCb, kCbGFrac), cb)));
+	dB = vsubq_s16(applySign(vaddq_s16(absCb, mulFrac(absCb, kCbBFrac)), cb), bias);
+}
+
+/** One 8 bit component, clamped and scaled like the rgbToPix table */
+template<bool itu>
+static inline YUVVector component(YUVVector y, YUVVector offset) {
+	const int16x8_t x = vminq_s16(vmaxq_s16(vaddq_s16(y, offset), vdupq_n_s16(0)), vdupq_n_s16(itu ? 219 : 255));
+	if (itu)
+		return vaddq_s16(x, mulFrac(x, kITUFrac));
+	return x;
+}
+
+static FORCEINLINE void storePixels(uint16 *dst, YUVVector r, YUVVector g, YUVVector b, const YUVVectorFormat &f) {
+	// NEON shifts right by negative left shifts
+	const int16x8_t rLoss = vdupq_n_s16(-f.format.rLoss), rShift = vdupq_n_s16(f.format.rShift);
+	const int16x8_t gLoss = vdupq_n_s16(-f.format.gLoss), gShift = vdupq_n_s16(f.format.gShift);
+	const int16x8_t bLoss = vdupq_n_s16(-f.format.bLoss), bShift = vdupq_n_s16(f.format.bShift);
+	const uint16x8_t alpha = vdupq_n_u16((uint16)f.alpha);
+
+	uint16x8_t pixels = vorrq_u16(alpha, vshlq_u16(vshlq_u16(vreinterpretq_u16_s16(r), rLoss), rShift));
+	pixels = vorrq_u16(pixels, vshlq_u16(vshlq_u16(vreinterpretq_u16_s16(g), gLoss), gShift));
+	pixels = vorrq_u16(pixels, vshlq_u16(vshlq_u16(vreinterpretq_u16_s16(b), bLoss), bShift));
+	vst1q_u16(dst, pixels);
+}
+
+/** Store XRGB8888 or ARGB8888 pixels by interleaving the component bytes */
+static FORCEINLINE void storeXRGB(uint32 *dst, const YUVVectorPair &r, const YUVVectorPair &g, const YUVVectorPair &b, const YUVVectorFormat &f) {
+	uint8x16x4_t bytes;
+	bytes.val[0] = vcombine_u8(vqmovun_s16(b.lo), vqmovun_s16(b.hi));
+	bytes.val[1] = vcombine_u8(vqmovun_s16(g.lo), vqmovun_s16(g.hi));
+	bytes.val[2] = vcombine_u8(vqmovun_s16(r.lo), vqmovun_s16(r.hi));
+	bytes.val[3] = vdupq_n_u8((uint8)(f.alpha >> 24));
+	vst4q_u8((uint8 *)dst, bytes);
+}
+
+static FORCEINLINE void storePixels(uint32 *dst, YUVVector r, YUVVector g, YUVVector b, const YUVVectorFormat &f) {
+	const int16x8_t rLoss = vdupq_n_s16(-f.format.rLoss);
+	const int16x8_t gLoss = vdupq_n_s16(-f.format.gLoss);
+	const int16x8_t bLoss = vdupq_n_s16(-f.format.bLoss);
+	const int32x4_t rShift = vdupq_n_s32(f.format.rShift);
+	const int32x4_t gShift = vdupq_n_s32(f.format.gShift);
+	const int32x4_t bShift = vdupq_n_s32(f.format.bShift);
+	const uint32x4_t alpha = vdupq_n_u32(f.alpha);
+
+	const uint16x8_t r16 = vshlq_u16(vreinterpretq_u16_s16(r), rLoss);
+	const uint16x8_t g16 = vshlq_u16(vreinterpretq_u16_s16(g), gLoss);
+	const uint16x8_t b16 = vshlq_u16(vreinterpretq_u16_s16(b), bLoss);
+
+	uint32x4_t lo = vorrq_u32(alpha, vshlq_u32(vmovl_u16(vget_low_u16(r16)), rShift));
+	lo = vorrq_u32(lo, vshlq_u32(vmovl_u16(vget_low_u16(g16)), gShift));
+	lo = vorrq_u32(lo, vshlq_u32(vmovl_u16(vget_low_u16(b16)), bShift));
+	uint32x4_t hi = vorrq_u32(alpha, vshlq_u32(vmovl_u16(vget_high_u16(r16)), rShift));
+	hi = vorrq_u32(hi, vshlq_u32(vmovl_u16(vget_high_u16(g16)), gShift));
+	hi = vorrq_u32(hi, vshlq_u32(vmovl_u16(vget_high_u16(b16)), bShift));
+
+	vst1q_u32(dst, lo);
+	vst1q_u32(dst + 4, hi);
+}
+
+#endif
+
+template<bool itu>
+static inline YUVVectorPair component(const YUVVectorPair &y, const YUVVectorPair &offset) {
+	YUVVectorPair pair;
+	pair.lo = component<itu>(y.lo, offset.lo);
+	pair.hi = component<itu>(y.hi, offset.hi);
+	return pair;
+}
+
+/**
+ * Convert 16 pixels from their luminance and chroma offsets. With xrgb set,
+ * the pixels are 32 bit and stored with storeXRGB().
+ */
+template<typename PixelInt, bool itu, bool xrgb>
+static FORCEINLINE void convertPixels(PixelInt *dst, const YUVVectorPair &y, const YUVVectorPair &dR, const YUVVectorPair &dG, const YUVVectorPair &dB, const YUVVectorFormat &format) {
+	const YUVVectorPair r = component<itu>(y, dR);
+	const YUVVectorPair g = component<itu>(y, dG);
+	const YUVVectorPair b = component<itu>(y, dB);
+
+	if (xrgb) {
+		storeXRGB((uint32 *)dst, r, g, b, format);
+	} else {
+		storePixels(dst, r.lo, g.lo, b.lo, format);
+		storePixels(dst + 8, r.hi, g.hi, b.hi, format);
+	}
+}
+
+/**
+ * Convert the leading columns of a YUV444 image in groups of 16 pixels.
+ * Returns the number of columns converted.
+ */
+template<typename PixelInt, bool itu, bool xrgb>
+static int convertYUV444ToRGBVector(byte *dstPtr, int dstPitch, const YUVVectorFormat &format, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
+	const int width = yWidth & ~15;
+
+	for (int h = 0; h < yHeight; h++) {
+		PixelInt *dst = (PixelInt *)dstPtr;
+
+		for (int w = 0; w < width; w += 16) {
+			YUVVectorPair dR, dG, dB;
+			chromaOffsets<itu>(load8(uSrc + w), load8(vSrc + w), dR.lo, dG.lo, dB.lo);
+			chromaOffsets<itu>(load8(uSrc + w + 8), load8(vSrc + w + 8), dR.hi, dG.hi, dB.hi);
+			convertPixels<PixelInt, itu, xrgb>(dst + w, load16(ySrc + w), dR, dG, dB, format);
+		}
+
+		dstPtr += dstPitch;
+		ySrc += yPitch;
+		uSrc += uvPitch;
+		vSrc += uvPitch;
+	}
+
+	return width;
+}
+
+/**
+ * Convert the leading columns of a YUV420 image in groups of 16 pixels on
+ * two lines. Returns the number of columns converted.
+ */
+template<typename PixelInt, bool itu, bool xrgb>
+static int convertYUV420ToRGBVector(byte *dstPtr, int dstPitch, const YUVVectorFormat &format, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
+	const int width = yWidth & ~15;
+
+	for (int h = 0; h < yHeight; h += 2) {
+		PixelInt *dst0 = (PixelInt *)dstPtr;
+		PixelInt *dst1 = (PixelInt *)(dstPtr + dstPitch);
+
+		for (int w = 0; w < width; w += 16) {
+			YUVVector dR, dG, dB;
+			chromaOffsets<itu>(load8(uSrc + (w >> 1)), load8(vSrc + (w >> 1)), dR, dG, dB);
+
+			const YUVVectorPair pixelR = duplicate(dR);
+			const YUVVectorPair pixelG = duplicate(dG);
+			const YUVVectorPair pixelB = duplicate(dB);
+
+			convertPixels<PixelInt, itu, xrgb>(dst0 + w, load16(ySrc + w), pixelR, pixelG, pixelB, format);
+			convertPixels<PixelInt, itu, xrgb>(dst1 + w, load16(ySrc + yPitch + w), pixelR, pixelG, pixelB, format);
+		}
+
+		dstPtr += dstPitch << 1;
+		ySrc += yPitch << 1;
+		uSrc += uvPitch;
+		vSrc += uvPitch;
+	}
+
+	return width;
+}
+
+template<typename PixelInt, bool xrgb>
+static int convertYUVToRGBVector(bool is420, const YUVVectorFormat &format, Graphics::Surface *dst, YUVToRGBManager::LuminanceScale scale, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
+	byte *dstPtr = (byte *)dst->getPixels();
+
+	if (is420) {
+		if (scale == YUVToRGBManager::kScaleITU)
+			return convertYUV420ToRGBVector<PixelInt, true, xrgb>(dstPtr, dst->pitch, format, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+		return convertYUV420ToRGBVector<PixelInt, false, xrgb>(dstPtr, dst->pitch, format, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+	}
+
+	if (scale == YUVToRGBManager::kScaleITU)
+		return convertYUV444ToRGBVector<PixelInt, true, xrgb>(dstPtr, dst->pitch, format, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+	return convertYUV444ToRGBVector<PixelInt, false, xrgb>(dstPtr, dst->pitch, format, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+}
+
+/**
+ * Convert the columns of a YUV420 or YUV444 image which the vector code can
+ * handle, and return their number.
+ */
+static int convertYUVToRGBVector(bool is420, Graphics::Surface *dst, YUVToRGBManager::LuminanceScale scale, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
+	const YUVVectorFormat format(dst->format);
+
+	// Pick the way of storing the pixels once, outside of the loops
+	if (dst->format.bytesPerPixel == 2)
+		return convertYUVToRGBVector<uint16, false>(is420, format, dst, scale, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+	if (format.xrgb)
+		return convertYUVToRGBVector<uint32, true>(is420, format, dst, scale, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+	return convertYUVToRGBVector<uint32, false>(is420, format, dst, scale, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+}
+
+#endif
+
 #define PUT_PIXEL(s, d) \
 	L = &rgbToPix[(s)]; \
 	*((PixelInt *)(d)) = (L[cr_r] | L[crb_g] | L[cb_b])
@@ -235,15 +644,27 @@ void YUVToRGBManager::convert444(Graphics::Surface *dst, YUVToRGBManager::Lumina
 
 	const YUVToRGBLookup *lookup = getLookup(dst->format, scale);
 
+	int done = 0;
+#if defined(USE_SSE2_YUV) || defined(USE_NEON_YUV)
+	// The bulk of every line is converted with vector code, which gives the
+	// same result as the tables, and the remaining columns are left to them
+	done = convertYUVToRGBVector(false, dst, scale, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+
+	if (done == yWidth)
+		return;
+#endif
+
+	byte *dstPtr = (byte *)dst->getPixels() + done * dst->format.bytesPerPixel;
+
 	// Use a templated function to avoid an if check on every pixel
 	if (dst->format.bytesPerPixel == 2)
-		convertYUV444ToRGB<uint16>((byte *)dst->getPixels(), dst->pitch, lookup, _colorTab, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+		convertYUV444ToRGB<uint16>(dstPtr, dst->pitch, lookup, _colorTab, ySrc + done, uSrc + done, vSrc + done, yWidth - done, yHeight, yPitch, uvPitch);
 	else
-		convertYUV444ToRGB<uint32>((byte *)dst->getPixels(), dst->pitch, lookup, _colorTab, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+		convertYUV444ToRGB<uint32>(dstPtr, dst->pitch, lookup, _colorTab, ySrc + done, uSrc + done, vSrc + done, yWidth - done, yHeight, yPitch, uvPitch);
 }
 
 template<typename PixelInt>
-void convertYUV420ToRGB(byte *dstPtr, int dstPitch, const YUVToRGBLookup *lookup, int16 *colorTab, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
+void convertYUV420ToRGB(byte *dstPtr, int dstPitch, const YUVToRGBLookup *lookup, const int16 *colorTab, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
 	int halfHeight = yHeight >> 1;
 	int halfWidth = yWidth >> 1;
 
@@ -274,7 +695,7 @@ void convertYUV420ToRGB(byte *dstPtr, int dstPitch, const YUVToRGBLookup *lookup
 			dstPtr += sizeof(PixelInt);
 		}
 
-		dstPtr += dstPitch;
+		dstPtr += (dstPitch << 1) - yWidth * sizeof(PixelInt);
 		ySrc += (yPitch << 1) - yWidth;
 		uSrc += uvPitch - halfWidth;
 		vSrc += uvPitch - halfWidth;
@@ -282,20 +703,36 @@ void convertYUV420ToRGB(byte *dstPtr, int dstPitch, const YUVToRGBLookup *lookup
 }
 
 void YUVToRGBManager::convert420(Graphics::Surface *dst, YUVToRGBManager::LuminanceScale scale, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
+	assert(dst);
+	convert420(dst, getLookup(dst->format, scale), ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+}
+
+void YUVToRGBManager::convert420(Graphics::Surface *dst, const YUVToRGBLookup *lookup, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch) const {
 	// Sanity checks
 	assert(dst && dst->getPixels());
 	assert(dst->format.bytesPerPixel == 2 || dst->format.bytesPerPixel == 4);
 	assert(ySrc && uSrc && vSrc);
 	assert((yWidth & 1) == 0);
 	assert((yHeight & 1) == 0);
+	assert(lookup && lookup->getFormat() == dst->format);
 
-	const YUVToRGBLookup *lookup = getLookup(dst->format, scale);
+	int done = 0;
+#if defined(USE_SSE2_YUV) || defined(USE_NEON_YUV)
+	// The bulk of every line is converted with vector code, which gives the
+	// same result as the tables, and the remaining columns are left to them
+	done = convertYUVToRGBVector(true, dst, lookup->getScale(), ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+
+	if (done == yWidth)
+		return;
+#endif
+
+	byte *dstPtr = (byte *)dst->getPixels() + done * dst->format.bytesPerPixel;
 
 	// Use a templated function to avoid an if check on every pixel
 	if (dst->format.bytesPerPixel == 2)
-		convertYUV420ToRGB<uint16>((byte *)dst->getPixels(), dst->pitch, lookup, _colorTab, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+		convertYUV420ToRGB<uint16>(dstPtr, dst->pitch, lookup, _colorTab, ySrc + done, uSrc + (done >> 1), vSrc + (done >> 1), yWidth - done, yHeight, yPitch, uvPitch);
 	else
-		convertYUV420ToRGB<uint32>((byte *)dst->getPixels(), dst->pitch, lookup, _colorTab, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+		convertYUV420ToRGB<uint32>(dstPtr, dst->pitch, lookup, _colorTab, ySrc + done, uSrc + (done >> 1), vSrc + (done >> 1), yWidth - done, yHeight, yPitch, uvPitch);
 }
 
 #define READ_QUAD(ptr, prefix) \
@@ -84,6 +84,27 @@ public:
 	 */
 	void convert420(Graphics::Surface *dst, LuminanceScale scale, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch);
 
+	/**
+	 * Create a lookup table for converting to the given format.
+	 *
+	 * The manager replaces its own lookup table whenever a different format
+	 * or scale is converted, so the functions above must only be called from
+	 * one thread. Code converting on another thread has to create its own
+	 * lookup table on the main thread, and pass it to the functions below.
+	 * It must be freed with destroyLookup().
+	 */
+	YUVToRGBLookup *createLookup(const Graphics::PixelFormat &format, LuminanceScale scale) const;
+	static void destroyLookup(YUVToRGBLookup *lookup);
+
+	/**
+	 * Convert a YUV420 image to an RGB surface, like the function above,
+	 * but using the given lookup table. This does not change the state of
+	 * the manager.
+	 *
+	 * @param lookup  a lookup table for the format of dst, see createLookup()
+	 */
+	void convert420(Graphics::Surface *dst, const YUVToRGBLookup *lookup, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch) const;
+
 	/**
 	 * Convert a YUV410 image to an RGB surface
 	 *
@@ -0,0 +1,654 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "gui/ThemeCompiler.h"
+
+#include "common/debug.h"
+#include "common/md5.h"
+#include "common/savefile.h"
+#include "common/system.h"
+#include "common/textconsole.h"
+
+#include "graphics/surface.h"
+#include "graphics/transparent_surface.h"
+#include "graphics/VectorRenderer.h"
+
+#include "gui/ThemeEval.h"
+#include "gui/ThemeParser.h"
+
+namespace GUI {
+
+enum {
+	kCompiledThemeVersion = 2,
+	/** Sanity limit for the strings read from a compiled theme */
+	kMaxStringLength = 4096
+};
+
+/** Recorded calls, one byte each, followed by their arguments */
+enum ThemeOpcode {
+	kOpEnd = 0,
+	kOpFont,
+	kOpTextColor,
+	kOpCursor,
+	kOpBitmap,
+	kOpAlphaBitmap,
+	kOpTextData,
+	kOpDrawData,
+	kOpDrawStep,
+	kOpSetVar,
+	kOpDialog,
+	kOpLayout,
+	kOpWidget,
+	kOpImportedLayout,
+	kOpSpace,
+	kOpPadding,
+	kOpCloseLayout,
+	kOpCloseDialog
+};
+
+ThemeCompiler::ThemeCompiler(const Common::Archive &themeFiles) : _themeFiles(themeFiles), _stream(DisposeAfterUse::YES) {
+}
+
+Common::String ThemeCompiler::getFileName(const Common::String &themeId) {
+	return themeId + ".stxc";
+}
+
+Common::String ThemeCompiler::computeStamp(const Common::ArchiveMemberList &stxFiles) {
+	Common::String stamp;
+
+	for (Common::ArchiveMemberList::const_iterator i = stxFiles.begin(); i != stxFiles.end(); ++i) {
+		Common::SeekableReadStream *stream = (*i)->createReadStream();
+		if (!stream)
+			return Common::String();
+
+		stamp += (*i)->getName() + ":" + Common::computeStreamMD5AsString(*stream) + ";";
+		delete stream;
+	}
+
+	return stamp;
+}
+
+Common::String ThemeCompiler::computeImageStamp(const Common::Archive &themeFiles, const Common::String &filename) {
+	// The ThemeEngine decodes the first of the matching members which opens
+	Common::ArchiveMemberList members;
+	themeFiles.listMatchingMembers(members, filename);
+	for (Common::ArchiveMemberList::const_iterator i = members.begin(); i != members.end(); ++i) {
+		Common::SeekableReadStream *stream = (*i)->createReadStream();
+		if (!stream)
+			continue;
+
+		const Common::String stamp = Common::String::format("%d:", stream->size()) + Common::computeStreamMD5AsString(*stream);
+		delete stream;
+		return stamp;
+	}
+
+	return Common::String();
+}
+
+/*
+ * Writing
+ */
+
+void ThemeCompiler::addImageFile(const Common::String &filename) {
+	if (!filename.empty())
+		_imageFiles[filename] = true;
+}
+
+void ThemeCompiler::writeString(Common::WriteStream &stream, const Common::String &str) {
+	stream.writeUint16LE(str.size());
+	stream.write(str.c_str(), str.size());
+}
+
+void ThemeCompiler::writeSurface(const Graphics::Surface *surface) {
+	_stream.writeUint16LE(surface->w);
+	_stream.writeUint16LE(surface->h);
+
+	const uint32 rowSize = surface->w * surface->format.bytesPerPixel;
+	for (int y = 0; y < surface->h; ++y)
+		_stream.write(surface->getBasePtr(0, y), rowSize);
+}
+
+void ThemeCompiler::addFont(TextData textId, const Common::String &file, const Common::String &scalableFile, int pointsize) {
+	_stream.writeByte(kOpFont);
+	_stream.writeByte(textId);
+	writeString(_stream, file);
+	writeString(_stream, scalableFile);
+	_stream.writeSint32LE(pointsize);
+}
+
+void ThemeCompiler::addTextColor(TextColor colorId, int r, int g, int b) {
+	_stream.writeByte(kOpTextColor);
+	_stream.writeByte(colorId);
+	_stream.writeByte(r);
+	_stream.writeByte(g);
+	_stream.writeByte(b);
+}
+
+void ThemeCompiler::createCursor(const Common::String &filename, int hotspotX, int hotspotY) {
+	addImageFile(filename);
+	_stream.writeByte(kOpCursor);
+	writeString(_stream, filename);
+	_stream.writeSint32LE(hotspotX);
+	_stream.writeSint32LE(hotspotY);
+}
+
+void ThemeCompiler::addBitmap(const Common::String &filename, const Graphics::Surface *surface) {
+	addImageFile(filename);
+	_stream.writeByte(kOpBitmap);
+	writeString(_stream, filename);
+	writeSurface(surface);
+}
+
+void ThemeCompiler::addAlphaBitmap(const Common::String &filename, const Graphics::Surface *surface) {
+	addImageFile(filename);
+	_stream.writeByte(kOpAlphaBitmap);
+	writeString(_stream, filename);
+	writeSurface(surface);
+}
+
+void ThemeCompiler::addTextData(const Common::String &drawDataId, TextData textId, TextColor colorId, Graphics::TextAlign alignH, ThemeEngine::TextAlignVertical alignV) {
+	_stream.writeByte(kOpTextData);
+	writeString(_stream, drawDataId);
+	_stream.writeByte(textId);
+	_stream.writeByte(colorId);
+	_stream.writeByte(alignH);
+	_stream.writeByte(alignV);
+}
+
+void ThemeCompiler::addDrawData(const Common::String &data, bool cached) {
+	_stream.writeByte(kOpDrawData);
+	writeString(_stream, data);
+	_stream.writeByte(cached);
+}
+
+static void writeStepColor(Common::WriteStream &stream, const Graphics::DrawStep::Color &color) {
+	stream.writeByte(color.r);
+	stream.writeByte(color.g);
+	stream.writeByte(color.b);
+	stream.writeByte(color.set);
+}
+
+void ThemeCompiler::addDrawStep(const Common::String &drawDataId, const Graphics::DrawStep &step, const Common::String &function, const Common::String &file) {
+	_stream.writeByte(kOpDrawStep);
+	writeString(_stream, drawDataId);
+	writeString(_stream, function);
+	writeString(_stream, file);
+
+	writeStepColor(_stream, step.fgColor);
+	writeStepColor(_stream, step.bgColor);
+	writeStepColor(_stream, step.gradColor1);
+	writeStepColor(_stream, step.gradColor2);
+	writeStepColor(_stream, step.bevelColor);
+
+	_stream.writeByte(step.autoWidth);
+	_stream.writeByte(step.autoHeight);
+	_stream.writeSint16LE(step.x);
+	_stream.writeSint16LE(step.y);
+	_stream.writeSint16LE(step.w);
+	_stream.writeSint16LE(step.h);
+	_stream.writeSint16LE(step.padding.left);
+	_stream.writeSint16LE(step.padding.top);
+	_stream.writeSint16LE(step.padding.right);
+	_stream.writeSint16LE(step.padding.bottom);
+	_stream.writeByte(step.xAlign);
+	_stream.writeByte(step.yAlign);
+	_stream.writeByte(step.shadow);
+	_stream.writeByte(step.stroke);
+	_stream.writeByte(step.factor);
+	_stream.writeByte(step.radius);
+	_stream.writeByte(step.bevel);
+	_stream.writeByte(step.fillMode);
+	_stream.writeByte(step.shadowFillMode);
+	_stream.writeUint32LE(step.extraData);
+	_stream.writeUint32LE(step.scale);
+	_stream.writeByte(step.autoscale);
+}
+
+void ThemeCompiler::setVar(const Common::String &name, int val) {
+	_stream.writeByte(kOpSetVar);
+	writeString(_stream, name);
+	_stream.writeSint32LE(val);
+}
+
+void ThemeCompiler::addDialog(const Common::String &name, const Common::String &overlays, bool enabled, int inset) {
+	_stream.writeByte(kOpDialog);
+	writeString(_stream, name);
+	writeString(_stream, overlays);
+	_stream.writeByte(enabled);
+	_stream.writeSint32LE(inset);
+}
+
+void ThemeCompiler::addLayout(ThemeLayout::LayoutType type, int spacing, bool center) {
+	_stream.writeByte(kOpLayout);
+	_stream.writeByte(type);
+	_stream.writeSint32LE(spacing);
+	_stream.writeByte(center);
+}
+
+void ThemeCompiler::addWidget(const Common::String &name, int w, int h, const Common::String &type, bool enabled, Graphics::TextAlign align) {
+	_stream.writeByte(kOpWidget);
+	writeString(_stream, name);
+	_stream.writeSint32LE(w);
+	_stream.writeSint32LE(h);
+	writeString(_stream, type);
+	_stream.writeByte(enabled);
+	_stream.writeByte(align);
+}
+
+void ThemeCompiler::addImportedLayout(const Common::String &name) {
+	_stream.writeByte(kOpImportedLayout);
+	writeString(_stream, name);
+}
+
+void ThemeCompiler::addSpace(int size) {
+	_stream.writeByte(kOpSpace);
+	_stream.writeSint32LE(size);
+}
+
+void ThemeCompiler::addPadding(int16 l, int16 r, int16 t, int16 b) {
+	_stream.writeByte(kOpPadding);
+	_stream.writeSint16LE(l);
+	_stream.writeSint16LE(r);
+	_stream.writeSint16LE(t);
+	_stream.writeSint16LE(b);
+}
+
+void ThemeCompiler::closeLayout() {
+	_stream.writeByte(kOpCloseLayout);
+}
+
+void ThemeCompiler::closeDialog() {
+	_stream.writeByte(kOpCloseDialog);
+}
+
+static void writeHeader(Common::WriteStream &stream, const Common::String &stamp) {
+	const Graphics::PixelFormat format = g_system->getOverlayFormat();
+
+	stream.writeUint32BE(MKTAG('S', 'T', 'X', 'C'));
+	stream.writeUint32LE(kCompiledThemeVersion);
+	stream.writeUint16LE(strlen(SCUMMVM_THEME_VERSION_STR));
+	stream.write(SCUMMVM_THEME_VERSION_STR, strlen(SCUMMVM_THEME_VERSION_STR));
+	stream.writeUint16LE(g_system->getOverlayWidth());
+	stream.writeUint16LE(g_system->getOverlayHeight());
+	stream.writeByte(format.bytesPerPixel);
+	stream.writeByte(format.rLoss);
+	stream.writeByte(format.gLoss);
+	stream.writeByte(format.bLoss);
+	stream.writeByte(format.aLoss);
+	stream.writeByte(format.rShift);
+	stream.writeByte(format.gShift);
+	stream.writeByte(format.bShift);
+	stream.writeByte(format.aShift);
+	stream.writeUint32LE(stamp.size());
+	stream.write(stamp.c_str(), stamp.size());
+}
+
+bool ThemeCompiler::save(const Common::String &fileName, const Common::String &stamp) {
+	if (stamp.empty())
+		return false;
+
+	Common::OutSaveFile *file = g_system->getSavefileManager()->openForSaving(fileName, false);
+	if (!file)
+		return false;
+
+	writeHeader(*file, stamp);
+
+	file->writeUint32LE(_imageFiles.size());
+	for (Common::HashMap<Common::String, bool, Common::IgnoreCase_Hash, Common::IgnoreCase_EqualTo>::const_iterator i = _imageFiles.begin(); i != _imageFiles.end(); ++i) {
+		writeString(*file, i->_key);
+		writeString(*file, computeImageStamp(_themeFiles, i->_key));
+	}
+
+	file->write(_stream.getData(), _stream.size());
+	file->writeByte(kOpEnd);
+	file->finalize();
+
+	const bool success = !file->err();
+	delete file;
+
+	if (!success)
+		warning("ThemeCompiler: Could not write '%s'", fileName.c_str());
+	else
+		debug(2, "ThemeCompiler: Saved '%s', %d bytes", fileName.c_str(), _stream.size());
+	return success;
+}
+
+/*
+ * Loading
+ */
+
+bool ThemeCompiler::readString(Common::SeekableReadStream &stream, Common::String &str) {
+	const uint16 length = stream.readUint16LE();
+	if (length > kMaxStringLength || stream.pos() + length > stream.size())
+		return false;
+
+	char buf[kMaxStringLength];
+	if (stream.read(buf, length) != length)
+		return false;
+
+	str = Common::String(buf, length);
+	return true;
+}
+
+bool ThemeCompiler::readSurface(Common::SeekableReadStream &stream, Graphics::Surface &surface) {
+	const uint16 w = stream.readUint16LE();
+	const uint16 h = stream.readUint16LE();
+	const Graphics::PixelFormat format = g_system->getOverlayFormat();
+
+	// At most 0xFFFF * 0xFFFF * 4 bytes, so compute the size in 64 bits
+	const uint64 size = (uint64)w * h * format.bytesPerPixel;
+	if ((uint64)stream.pos() + size > (uint64)stream.size())
+		return false;
+
+	surface.create(w, h, format);
+	for (int y = 0; y < h; ++y)
+		stream.read(surface.getBasePtr(0, y), w * format.bytesPerPixel);
+
+	return true;
+}
+
+bool ThemeCompiler::checkImageFiles(const Common::Archive &themeFiles, Common::SeekableReadStream &stream) {
+	const uint32 count = stream.readUint32LE();
+	Common::String filename, stamp;
+
+	for (uint32 i = 0; i < count; ++i) {
+		if (!readString(stream, filename) || !readString(stream, stamp))
+			return false;
+		if (stamp != computeImageStamp(themeFiles, filename)) {
+			debug(2, "ThemeCompiler: '%s' changed", filename.c_str());
+			return false;
+		}
+	}
+
+	return !stream.eos() && !stream.err();
+}
+
+static void readStepColor(Common::SeekableReadStream &stream, Graphics::DrawStep::Color &color) {
+	color.r = stream.readByte();
+	color.g = stream.readByte();
+	color.b = stream.readByte();
+	color.set = stream.readByte() != 0;
+}
+
+bool ThemeCompiler::replay(ThemeEngine *theme, Common::SeekableReadStream &stream) {
+	ThemeEval *eval = theme->getEvaluator();
+	Common::String str, str2, str3;
+
+	for (;;) {
+		// readByte() returns 0, which is kOpEnd, at the end of a truncated file
+		const byte op = stream.readByte();
+		if (stream.eos() || stream.err())
+			return false;
+
+		switch (op) {
+		case kOpEnd:
+			return true;
+
+		case kOpFont: {
+			const TextData textId = (TextData)stream.readByte();
+			if (textId >= kTextDataMAX || !readString(stream, str) || !readString(stream, str2))
+				return false;
+			const int pointsize = stream.readSint32LE();
+			if (!theme->addFont(textId, str, str2, pointsize))
+				return false;
+			break;
+		}
+
+		case kOpTextColor: {
+			const TextColor colorId = (TextColor)stream.readByte();
+			const int r = stream.readByte();
+			const int g = stream.readByte();
+			const int b = stream.readByte();
+			if (!theme->addTextColor(colorId, r, g, b))
+				return false;
+			break;
+		}
+
+		case kOpCursor: {
+			if (!readString(stream, str))
+				return false;
+			const int hotspotX = stream.readSint32LE();
+			const int hotspotY = stream.readSint32LE();
+			if (!theme->createCursor(str, hotspotX, hotspotY))
+				return false;
+			break;
+		}
+
+		case kOpBitmap: {
+			Graphics::Surface *surface = new Graphics::Surface();
+			if (!readString(stream, str) || !readSurface(stream, *surface)) {
+				delete surface;
+				return false;
+			}
+			// Bitmaps stay loaded when switching themes
+			if (theme->getBitmap(str)) {
+				surface->free();
+				delete surface;
+			} else {
+				theme->addBitmap(str, surface);
+			}
+			break;
+		}
+
+		case kOpAlphaBitmap: {
+			Graphics::TransparentSurface *surface = new Graphics::TransparentSurface();
+			if (!readString(stream, str) || !readSurface(stream, *surface)) {
+				delete surface;
+				return false;
+			}
+			if (theme->getAlphaBitmap(str)) {
+				surface->free();
+				delete surface;
+			} else {
+				theme->addAlphaBitmap(str, surface);
+			}
+			break;
+		}
+
+		case kOpTextData: {
+			if (!readString(stream, str))
+				return false;
+			const TextData textId = (TextData)stream.readByte();
+			const TextColor colorId = (TextColor)stream.readByte();
+			const Graphics::TextAlign alignH = (Graphics::TextAlign)stream.readByte();
+			const ThemeEngine::TextAlignVertical alignV = (ThemeEngine::TextAlignVertical)stream.readByte();
+			if (textId >= kTextDataMAX || !theme->addTextData(str, textId, colorId, alignH, alignV))
+				return false;
+			break;
+		}
+
+		case kOpDrawData: {
+			if (!readString(stream, str))
+				return false;
+			if (!theme->addDrawData(str, stream.readByte() != 0))
+				return false;
+			break;
+		}
+
+		case kOpDrawStep: {
+			if (!readString(stream, str) || !readString(stream, str2) || !readString(stream, str3))
+				return false;
+
+			Graphics::DrawStep step;
+			readStepColor(stream, step.fgColor);
+			readStepColor(stream, step.bgColor);
+			readStepColor(stream, step.gradColor1);
+			readStepColor(stream, step.gradColor2);
+			readStepColor(stream, step.bevelColor);
+
+			step.autoWidth = stream.readByte() != 0;
+			step.autoHeight = stream.readByte() != 0;
+			step.x = stream.readSint16LE();
+			step.y = stream.readSint16LE();
+			step.w = stream.readSint16LE();
+			step.h = stream.readSint16LE();
+			step.padding.left = stream.readSint16LE();
+			step.padding.top = stream.readSint16LE();
+			step.padding.right = stream.readSint16LE();
+			step.padding.bottom = stream.readSint16LE();
+			step.xAlign = (Graphics::DrawStep::VectorAlignment)stream.readByte();
+			step.yAlign = (Graphics::DrawStep::VectorAlignment)stream.readByte();
+			step.shadow = stream.readByte();
+			step.stroke = stream.readByte();
+			step.factor = stream.readByte();
+			step.radius = stream.readByte();
+			step.bevel = stream.readByte();
+			step.fillMode = stream.readByte();
+			step.shadowFillMode = stream.readByte();
+			step.extraData = stream.readUint32LE();
+			step.scale = stream.readUint32LE();
+			step.autoscale = (ThemeEngine::AutoScaleMode)stream.readByte();
+
+			step.drawingCall = ThemeParser::getDrawingFunctionCallback(str2);
+			step.blitSrc = 0;
+			step.blitAlphaSrc = 0;
+			if (!step.drawingCall)
+				return false;
+
+			if (str2 == "bitmap" && !(step.blitSrc = theme->getBitmap(str3)))
+				return false;
+			if (str2 == "alphabitmap" && !(step.blitAlphaSrc = theme->getAlphaBitmap(str3)))
+				return false;
+
+			theme->addDrawStep(str, step);
+			break;
+		}
+
+		case kOpSetVar: {
+			if (!readString(stream, str))
+				return false;
+			eval->setVar(str, stream.readSint32LE());
+			break;
+		}
+
+		case kOpDialog: {
+			if (!readString(stream, str) || !readString(stream, str2))
+				return false;
+			const bool enabled = stream.readByte() != 0;
+			eval->addDialog(str, str2, enabled, stream.readSint32LE());
+			break;
+		}
+
+		case kOpLayout: {
+			const ThemeLayout::LayoutType type = (ThemeLayout::LayoutType)stream.readByte();
+			const int spacing = stream.readSint32LE();
+			eval->addLayout(type, spacing, stream.readByte() != 0);
+			break;
+		}
+
+		case kOpWidget: {
+			if (!readString(stream, str))
+				return false;
+			const int w = stream.readSint32LE();
+			const int h = stream.readSint32LE();
+			if (!readString(stream, str2))
+				return false;
+			const bool enabled = stream.readByte() != 0;
+			eval->addWidget(str, w, h, str2, enabled, (Graphics::TextAlign)stream.readByte());
+			break;
+		}
+
+		case kOpImportedLayout:
+			if (!readString(stream, str) || !eval->addImportedLayout(str))
+				return false;
+			break;
+
+		case kOpSpace:
+			eval->addSpace(stream.readSint32LE());
+			break;
+
+		case kOpPadding: {
+			const int16 l = stream.readSint16LE();
+			const int16 r = stream.readSint16LE();
+			const int16 t = stream.readSint16LE();
+			const int16 b = stream.readSint16LE();
+			eval->addPadding(l, r, t, b);
+			break;
+		}
+
+		case kOpCloseLayout:
+			eval->closeLayout();
+			break;
+
+		case kOpCloseDialog:
+			eval->closeDialog();
+			break;
+
+		default:
+			return false;
+		}
+	}
+}
+
+bool ThemeCompiler::load(ThemeEngine *theme, const Common::String &fileName, const Common::String &stamp) {
+	if (stamp.empty())
+		return false;
+
+	Common::InSaveFile *file = g_system->getSavefileManager()->openForLoading(fileName);
+	if (!file)
+		return false;
+
+	// The records are parsed from memory. If the file is memory mapped, its
+	// data is used in place, otherwise it is read at once.
+	const uint32 size = file->size();
+	const byte *data = file->borrow(size);
+	byte *buffer = 0;
+	if (!data) {
+		buffer = (byte *)malloc(size);
+		if (!buffer || file->read(buffer, size) != size) {
+			free(buffer);
+			delete file;
+			return false;
+		}
+		delete file;
+		file = 0;
+		data = buffer;
+	}
+
+	Common::MemoryReadStream stream(data, size);
+	bool success = false;
+
+	// Compare the header with the one this run would write
+	Common::MemoryWriteStreamDynamic header(DisposeAfterUse::YES);
+	writeHeader(header, stamp);
+	if (size < header.size() || memcmp(data, header.getData(), header.size()) != 0) {
+		debug(2, "ThemeCompiler: '%s' is outdated", fileName.c_str());
+	} else {
+		stream.seek(header.size());
+
+		if (!checkImageFiles(theme->getThemeFiles(), stream))
+			debug(2, "ThemeCompiler: '%s' is outdated", fileName.c_str());
+		else if (!replay(theme, stream))
+			warning("ThemeCompiler: '%s' is corrupted", fileName.c_str());
+		else
+			success = true;
+	}
+
+	free(buffer);
+	delete file;
+
+	if (success)
+		debug(2, "ThemeCompiler: Loaded '%s'", fileName.c_str());
+	return success;
+}
+
+} // End of namespace GUI
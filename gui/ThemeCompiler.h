@@ -0,0 +1,148 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef GUI_THEME_COMPILER_H
+#define GUI_THEME_COMPILER_H
+
+#include "common/archive.h"
+#include "common/hash-str.h"
+#include "common/hashmap.h"
+#include "common/memstream.h"
+#include "common/str.h"
+
+#include "gui/ThemeEngine.h"
+#include "gui/ThemeLayout.h"
+
+namespace Common {
+class SeekableReadStream;
+}
+
+namespace Graphics {
+struct Surface;
+}
+
+namespace GUI {
+
+/**
+ * Compiled form of a theme.
+ *
+ * While the STX files of a theme are parsed, the ThemeParser reports each
+ * call it makes into the ThemeEngine and the ThemeEval to a ThemeCompiler,
+ * which records them in a compact binary form, together with the decoded
+ * bitmaps. Later launches replay these calls instead of parsing the XML
+ * and decoding the images. Fonts are still loaded by the ThemeEngine, which
+ * has its own font cache.
+ *
+ * The parsed layouts depend on the overlay size and the bitmaps are stored
+ * in the overlay format, so both are checked before a compiled theme is
+ * used. So are the theme format version, the MD5s of the STX files the
+ * theme was compiled from, and the sizes and MD5s of the image files they
+ * refer to.
+ *
+ * Compiled themes are kept in the savefile returned by getFileName().
+ */
+class ThemeCompiler {
+public:
+	/**
+	 * @param themeFiles  the files the images of the theme are loaded from,
+	 *                    see ThemeEngine::getThemeFiles()
+	 */
+	ThemeCompiler(const Common::Archive &themeFiles);
+
+	/** Name of the savefile holding the compiled form of a theme. */
+	static Common::String getFileName(const Common::String &themeId);
+
+	/**
+	 * Computes the stamp identifying the sources of a theme, which is the
+	 * name and MD5 of each of its STX files.
+	 */
+	static Common::String computeStamp(const Common::ArchiveMemberList &stxFiles);
+
+	/**
+	 * Replays a compiled theme into the given ThemeEngine.
+	 *
+	 * @param theme     the theme engine to load the theme into
+	 * @param fileName  savefile holding the compiled theme
+	 * @param stamp     stamp of the theme sources, see computeStamp()
+	 * @return true if the compiled theme exists, matches the stamp and the
+	 *         current overlay, and was loaded. On failure the theme may be
+	 *         partially loaded, and must be reset before parsing it.
+	 */
+	static bool load(ThemeEngine *theme, const Common::String &fileName, const Common::String &stamp);
+
+	/**
+	 * Writes the recorded calls to a savefile, along with the stamps of
+	 * the image files they refer to.
+	 */
+	bool save(const Common::String &fileName, const Common::String &stamp);
+
+	/**
+	 * @name Recording functions
+	 * Called by the ThemeParser after each successful call of the
+	 * ThemeEngine or ThemeEval function of the same name.
+	 * @{
+	 */
+	void addFont(TextData textId, const Common::String &file, const Common::String &scalableFile, int pointsize);
+	void addTextColor(TextColor colorId, int r, int g, int b);
+	void createCursor(const Common::String &filename, int hotspotX, int hotspotY);
+	void addBitmap(const Common::String &filename, const Graphics::Surface *surface);
+	void addAlphaBitmap(const Common::String &filename, const Graphics::Surface *surface);
+	void addTextData(const Common::String &drawDataId, TextData textId, TextColor colorId, Graphics::TextAlign alignH, ThemeEngine::TextAlignVertical alignV);
+	void addDrawData(const Common::String &data, bool cached);
+	void addDrawStep(const Common::String &drawDataId, const Graphics::DrawStep &step, const Common::String &function, const Common::String &file);
+
+	void setVar(const Common::String &name, int val);
+	void addDialog(const Common::String &name, const Common::String &overlays, bool enabled, int inset);
+	void addLayout(ThemeLayout::LayoutType type, int spacing, bool center);
+	void addWidget(const Common::String &name, int w, int h, const Common::String &type, bool enabled, Graphics::TextAlign align);
+	void addImportedLayout(const Common::String &name);
+	void addSpace(int size);
+	void addPadding(int16 l, int16 r, int16 t, int16 b);
+	void closeLayout();
+	void closeDialog();
+	/** @} */
+
+private:
+	void addImageFile(const Common::String &filename);
+	static void writeString(Common::WriteStream &stream, const Common::String &str);
+	void writeSurface(const Graphics::Surface *surface);
+
+	/**
+	 * Computes the stamp of an image file, which is its size and MD5, as
+	 * found by the ThemeEngine when loading it.
+	 */
+	static Common::String computeImageStamp(const Common::Archive &themeFiles, const Common::String &filename);
+
+	static bool readString(Common::SeekableReadStream &stream, Common::String &str);
+	static bool readSurface(Common::SeekableReadStream &stream, Graphics::Surface &surface);
+	static bool checkImageFiles(const Common::Archive &themeFiles, Common::SeekableReadStream &stream);
+	static bool replay(ThemeEngine *theme, Common::SeekableReadStream &stream);
+
+	const Common::Archive &_themeFiles;
+	/** Image files the recorded calls refer to */
+	Common::HashMap<Common::String, bool, Common::IgnoreCase_Hash, Common::IgnoreCase_EqualTo> _imageFiles;
+	Common::MemoryWriteStreamDynamic _stream;
+};
+
+} // End of namespace GUI
+
+#endif
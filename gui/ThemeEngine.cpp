@@ -40,8 +40,10 @@
 #include "image/png.h"
 
 #include "gui/widget.h"
+#include "gui/ThemeCompiler.h"
 #include "gui/ThemeEngine.h"
 #include "gui/ThemeEval.h"
+#include "gui/ThemeLayerCache.h"
 #include "gui/ThemeParser.h"
 
 namespace GUI {
@@ -90,6 +92,10 @@ struct WidgetDrawData {
 
 	bool _buffer;
 
+	/** Whether all the steps stay within the area grown by _backgroundOffset,
+	    so that the item can be kept in the layer cache */
+	bool _cacheable;
+
 
 	/**
 	 * Calculates the background threshold offset of a given DrawData item.
@@ -97,6 +103,7 @@ struct WidgetDrawData {
 	 * called in order to calculate if such draw steps would be drawn outside of
 	 * the actual widget drawing zone (e.g. shadows). If this is the case, a constant
 	 * value will be added when restoring the background of the widget.
+	 * Also decides whether the item can be cached.
 	 */
 	void calcBackgroundOffset();
 };
@@ -275,11 +282,8 @@ void ThemeItemDrawData::drawSelf(bool draw, bool restore) {
 	if (restore)
 		_engine->restoreBackground(extendedRect);
 
-	if (draw) {
-		Common::List<Graphics::DrawStep>::const_iterator step;
-		for (step = _data->_steps.begin(); step != _data->_steps.end(); ++step)
-			_engine->renderer()->drawStep(_area, *step, _dynamicData);
-	}
+	if (draw)
+		_engine->drawWidgetLayer(_data, _area, Common::Rect(), _dynamicData, extendedRect);
 
 	_engine->addDirtyRect(extendedRect);
 }
@@ -292,12 +296,8 @@ void ThemeItemDrawDataClip::drawSelf(bool draw, bool restore) {
 	if (restore)
 		_engine->restoreBackground(extendedRect);
 
-	if (draw) {
-		Common::List<Graphics::DrawStep>::const_iterator step;
-		for (step = _data->_steps.begin(); step != _data->_steps.end(); ++step) {
-			_engine->renderer()->drawStepClip(_area, _clip, *step, _dynamicData);
-		}
-	}
+	if (draw)
+		_engine->drawWidgetLayer(_data, _area, _clip, _dynamicData, extendedRect);
 
 	extendedRect.clip(_clip);
 
@@ -366,12 +366,13 @@ void ThemeItemBitmapClip::drawSelf(bool draw, bool restore) {
 ThemeEngine::ThemeEngine(Common::String id, GraphicsMode mode) :
 	_system(0), _vectorRenderer(0),
 	_buffering(false), _bytesPerPixel(0),  _graphicsMode(kGfxDisabled),
-	_font(0), _initOk(false), _themeOk(false), _enabled(false), _themeFiles(),
-	_cursor(0) {
+	_font(0), _dirtyTilesPitch(0), _hasDirtyTiles(false), _presentedValid(false),
+	_initOk(false), _themeOk(false), _enabled(false), _themeFiles(), _cursor(0) {
 
 	_system = g_system;
 	_parser = new ThemeParser(this);
 	_themeEval = new GUI::ThemeEval();
+	_layerCache = new ThemeLayerCache(kLayerCacheSize);
 
 	_useCursor = false;
 
@@ -416,8 +417,10 @@ ThemeEngine::~ThemeEngine() {
 	_vectorRenderer = 0;
 	_screen.free();
 	_backBuffer.free();
+	_presented.free();
 
 	unloadTheme();
+	delete _layerCache;
 
 	// Release all graphics surfaces
 	for (ImagesMap::iterator i = _bitmaps.begin(); i != _bitmaps.end(); ++i) {
@@ -547,6 +550,7 @@ void ThemeEngine::clearAll() {
 	if (_initOk) {
 		_system->clearOverlay();
 		_system->grabOverlay(_screen.getPixels(), _screen.pitch);
+		_presentedValid = false;
 	}
 }
 
@@ -593,6 +597,7 @@ void ThemeEngine::enable() {
 
 	_system->showOverlay();
 	clearAll();
+	_presentedValid = false;
 	_enabled = true;
 }
 
@@ -634,19 +639,28 @@ void ThemeEngine::setGraphicsMode(GraphicsMode mode) {
 	_screen.free();
 	_screen.create(width, height, _overlayFormat);
 
+	_presented.free();
+	_presented.create(width, height, _overlayFormat);
+	_presentedValid = false;
+
 	delete _vectorRenderer;
 	_vectorRenderer = Graphics::createRenderer(mode);
 	_vectorRenderer->setSurface(&_screen);
+	_layerCache->clear();
 
 	// Since we reinitialized our screen surfaces we know nothing has been
 	// drawn so far. Sometimes we still end up with dirty screen bits in the
 	// list. Clearing it avoids invalid overlay writes when the backend
 	// resizes the overlay.
-	_dirtyScreen.clear();
+	_dirtyTilesPitch = (width + kDirtyTileSize - 1) / kDirtyTileSize;
+	_dirtyTiles.resize(_dirtyTilesPitch * ((height + kDirtyTileSize - 1) / kDirtyTileSize));
+	memset(_dirtyTiles.begin(), 0, _dirtyTiles.size());
+	_hasDirtyTiles = false;
 }
 
 void WidgetDrawData::calcBackgroundOffset() {
 	uint maxShadow = 0;
+	_cacheable = true;
 	for (Common::List<Graphics::DrawStep>::const_iterator step = _steps.begin();
 	        step != _steps.end(); ++step) {
 		if ((step->autoWidth || step->autoHeight) && step->shadow > maxShadow)
@@ -654,6 +668,20 @@ void WidgetDrawData::calcBackgroundOffset() {
 
 		if (step->drawingCall == &Graphics::VectorRenderer::drawCallback_BEVELSQ && step->bevel > maxShadow)
 			maxShadow = step->bevel;
+
+		// Only shapes filling the widget area are known to stay inside it.
+		// Bitmaps have their own size, and lines and circles may overflow.
+		if (!step->autoWidth || !step->autoHeight || step->padding != Common::Rect())
+			_cacheable = false;
+
+		if (step->drawingCall != &Graphics::VectorRenderer::drawCallback_SQUARE &&
+		        step->drawingCall != &Graphics::VectorRenderer::drawCallback_ROUNDSQ &&
+		        step->drawingCall != &Graphics::VectorRenderer::drawCallback_BEVELSQ &&
+		        step->drawingCall != &Graphics::VectorRenderer::drawCallback_TAB &&
+		        step->drawingCall != &Graphics::VectorRenderer::drawCallback_TRIANGLE &&
+		        step->drawingCall != &Graphics::VectorRenderer::drawCallback_CROSS &&
+		        step->drawingCall != &Graphics::VectorRenderer::drawCallback_VOID)
+			_cacheable = false;
 	}
 
 	_backgroundOffset = maxShadow;
@@ -664,6 +692,43 @@ void ThemeEngine::restoreBackground(Common::Rect r) {
 	_vectorRenderer->blitSurface(&_backBuffer, r);
 }
 
+void ThemeEngine::drawWidgetLayer(const WidgetDrawData *data, const Common::Rect &area, const Common::Rect &clip, uint32 dynamic, Common::Rect layerRect) {
+	Graphics::Surface &surface = *_vectorRenderer->getSurface();
+
+	layerRect.clip(surface.w, surface.h);
+	if (!clip.isEmpty())
+		layerRect.clip(clip);
+
+	ThemeLayerCache::Key key;
+	if (data->_cacheable) {
+		key.drawData = data;
+		key.area = area;
+		key.clip = clip;
+		key.dynamic = dynamic;
+		key.shadows = _vectorRenderer->shadowsEnabled();
+		key.colors = _vectorRenderer->getColorState();
+
+		Graphics::VectorRenderer::ColorState colors;
+		if (_layerCache->draw(key, surface, layerRect, colors)) {
+			_vectorRenderer->setColorState(colors);
+			return;
+		}
+
+		_layerCache->beginLayer(key, surface, layerRect);
+	}
+
+	Common::List<Graphics::DrawStep>::const_iterator step;
+	for (step = data->_steps.begin(); step != data->_steps.end(); ++step) {
+		if (clip.isEmpty())
+			_vectorRenderer->drawStep(area, *step, dynamic);
+		else
+			_vectorRenderer->drawStepClip(area, clip, *step, dynamic);
+	}
+
+	if (data->_cacheable)
+		_layerCache->endLayer(surface, _vectorRenderer->getColorState());
+}
+
 
 
 /**********************************************************
@@ -846,6 +911,16 @@ bool ThemeEngine::addAlphaBitmap(const Common::String &filename) {
 	return surf != 0;
 }
 
+void ThemeEngine::addBitmap(const Common::String &filename, Graphics::Surface *surf) {
+	assert(!_bitmaps[filename]);
+	_bitmaps[filename] = surf;
+}
+
+void ThemeEngine::addAlphaBitmap(const Common::String &filename, Graphics::TransparentSurface *surf) {
+	assert(!_abitmaps[filename]);
+	_abitmaps[filename] = surf;
+}
+
 bool ThemeEngine::addDrawData(const Common::String &data, bool cached) {
 	DrawData id = parseDrawDataId(data);
 
@@ -857,6 +932,7 @@ bool ThemeEngine::addDrawData(const Common::String &data, bool cached) {
 
 	_widgets[id] = new WidgetDrawData;
 	_widgets[id]->_buffer = kDrawDataDefaults[id].buffer;
+	_widgets[id]->_cacheable = false;
 	_widgets[id]->_textDataId = kTextDataNone;
 
 	return true;
@@ -896,6 +972,12 @@ void ThemeEngine::unloadTheme() {
 	if (!_themeOk)
 		return;
 
+	clearThemeData();
+	_layerCache->clear();
+	_themeOk = false;
+}
+
+void ThemeEngine::clearThemeData() {
 	for (int i = 0; i < kDrawDataMAX; ++i) {
 		delete _widgets[i];
 		_widgets[i] = 0;
@@ -912,7 +994,6 @@ void ThemeEngine::unloadTheme() {
 	}
 
 	_themeEval->reset();
-	_themeOk = false;
 }
 
 bool ThemeEngine::loadDefaultXML() {
@@ -985,27 +1066,46 @@ bool ThemeEngine::loadThemeXML(const Common::String &themeId) {
 		return false;
 	}
 
+	//
+	// Use the compiled form of the theme if it is up to date
+	//
+	const Common::String compiledFile = ThemeCompiler::getFileName(_themeId);
+	const Common::String stamp = ThemeCompiler::computeStamp(members);
+
+	if (ThemeCompiler::load(this, compiledFile, stamp))
+		return true;
+
+	clearThemeData();
+
 	//
 	// Loop over all STX files, load and parse them
 	//
+	ThemeCompiler compiler(_themeFiles);
+	_parser->setCompiler(&compiler);
+
 	for (Common::ArchiveMemberList::iterator i = members.begin(); i != members.end(); ++i) {
 		assert((*i)->getName().hasSuffix(".stx"));
 
 		if (_parser->loadStream((*i)->createReadStream()) == false) {
 			warning("Failed to load STX file '%s'", (*i)->getDisplayName().c_str());
 			_parser->close();
+			_parser->setCompiler(0);
 			return false;
 		}
 
 		if (_parser->parse() == false) {
 			warning("Failed to parse STX file '%s'", (*i)->getDisplayName().c_str());
 			_parser->close();
+			_parser->setCompiler(0);
 			return false;
 		}
 
 		_parser->close();
 	}
 
+	_parser->setCompiler(0);
+	compiler.save(compiledFile, stamp);
+
 	assert(!_themeName.empty());
 	return true;
 }
@@ -1862,6 +1962,7 @@ void ThemeEngine::updateScreen(bool render) {
 		_vectorRenderer->fillSurface();
 		_themeEval->debugDraw(&_screen, _font);
 		_vectorRenderer->copyWholeFrame(_system);
+		_presentedValid = false;
 #else
 		renderDirtyScreen();
 #endif
@@ -1876,36 +1977,114 @@ void ThemeEngine::addDirtyRect(Common::Rect r) {
 	if (r.isEmpty())
 		return;
 
-	// Check if the new rectangle is contained within another in the list
-	Common::List<Common::Rect>::iterator it;
-	for (it = _dirtyScreen.begin(); it != _dirtyScreen.end();) {
-		// If we find a rectangle which fully contains the new one,
-		// we can abort the search.
-		if (it->contains(r))
-			return;
+	// Mark all the tiles the rect touches. Nearby rects end up sharing
+	// tiles, which renderDirtyScreen() merges into larger blits.
+	const uint left = r.left / kDirtyTileSize, right = (r.right - 1) / kDirtyTileSize;
+	const uint top = r.top / kDirtyTileSize, bottom = (r.bottom - 1) / kDirtyTileSize;
 
-		// Conversely, if we find rectangles which are contained in
-		// the new one, we can remove them
-		if (r.contains(*it))
-			it = _dirtyScreen.erase(it);
-		else
-			++it;
-	}
+	for (uint y = top; y <= bottom; ++y)
+		memset(&_dirtyTiles[y * _dirtyTilesPitch + left], 1, right - left + 1);
 
-	// If we got here, we can safely add r to the list of dirty rects.
-	_dirtyScreen.push_back(r);
+	_hasDirtyTiles = true;
 }
 
 void ThemeEngine::renderDirtyScreen() {
-	if (_dirtyScreen.empty())
+	if (!_hasDirtyTiles)
 		return;
 
-	Common::List<Common::Rect>::iterator i;
-	for (i = _dirtyScreen.begin(); i != _dirtyScreen.end(); ++i) {
-		_vectorRenderer->copyFrame(_system, *i);
+	const uint bytesPerPixel = _screen.format.bytesPerPixel;
+	const uint tilesHigh = _dirtyTiles.size() / _dirtyTilesPitch;
+
+	// Widgets are often redrawn exactly as they were, e.g. when the whole
+	// dialog is redrawn for a change to a single widget. Only the tiles
+	// whose pixels differ from what the overlay already shows are kept.
+	for (uint ty = 0; ty < tilesHigh; ++ty) {
+		const int top = ty * kDirtyTileSize;
+		const int bottom = MIN<int>(top + kDirtyTileSize, _screen.h);
+
+		for (uint tx = 0; tx < _dirtyTilesPitch; ++tx) {
+			byte &tile = _dirtyTiles[ty * _dirtyTilesPitch + tx];
+			if (!tile || !_presentedValid)
+				continue;
+
+			const int left = tx * kDirtyTileSize;
+			const uint rowSize = (MIN<int>(left + kDirtyTileSize, _screen.w) - left) * bytesPerPixel;
+
+			bool changed = false;
+			for (int y = top; y < bottom; ++y) {
+				const void *src = _screen.getBasePtr(left, y);
+				void *dst = _presented.getBasePtr(left, y);
+				if (memcmp(src, dst, rowSize) != 0) {
+					memcpy(dst, src, rowSize);
+					changed = true;
+				}
+			}
+
+			if (!changed)
+				tile = 0;
+		}
+	}
+
+	if (!_presentedValid) {
+		// The overlay content is unknown, blit all dirty tiles
+		memcpy(_presented.getPixels(), _screen.getPixels(), _screen.pitch * _screen.h);
+		_presentedValid = true;
+	}
+
+	// Merge the changed tiles of each row into runs, and runs of the same
+	// width in consecutive rows into a single rect
+	Common::List<Common::Rect> rects;
+	Common::List<Common::Rect> open;
+
+	for (uint ty = 0; ty <= tilesHigh; ++ty) {
+		Common::List<Common::Rect> runs;
+
+		if (ty < tilesHigh) {
+			const int top = ty * kDirtyTileSize;
+			const int bottom = MIN<int>(top + kDirtyTileSize, _screen.h);
+			byte *row = &_dirtyTiles[ty * _dirtyTilesPitch];
+
+			for (uint tx = 0; tx < _dirtyTilesPitch;) {
+				if (!row[tx]) {
+					++tx;
+					continue;
+				}
+
+				const uint start = tx;
+				while (tx < _dirtyTilesPitch && row[tx])
+					row[tx++] = 0;
+
+				runs.push_back(Common::Rect(start * kDirtyTileSize, top,
+				                            MIN<int>(tx * kDirtyTileSize, _screen.w), bottom));
+			}
+		}
+
+		// Extend the rects of the previous row by the runs matching them
+		for (Common::List<Common::Rect>::iterator i = open.begin(); i != open.end();) {
+			Common::List<Common::Rect>::iterator run;
+			for (run = runs.begin(); run != runs.end(); ++run) {
+				if (run->left == i->left && run->right == i->right)
+					break;
+			}
+
+			if (run != runs.end()) {
+				i->bottom = run->bottom;
+				runs.erase(run);
+				++i;
+			} else {
+				rects.push_back(*i);
+				i = open.erase(i);
+			}
+		}
+
+		for (Common::List<Common::Rect>::iterator run = runs.begin(); run != runs.end(); ++run)
+			open.push_back(*run);
 	}
 
-	_dirtyScreen.clear();
+	for (Common::List<Common::Rect>::iterator i = rects.begin(); i != rects.end(); ++i)
+		_vectorRenderer->copyFrame(_system, *i);
+
+	_hasDirtyTiles = false;
 }
 
 void ThemeEngine::openDialog(bool doBuffer, ShadingStyle style) {
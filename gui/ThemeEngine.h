@@ -24,6 +24,7 @@
 #define GUI_THEME_ENGINE_H
 
 #include "common/scummsys.h"
+#include "common/array.h"
 #include "common/fs.h"
 #include "common/hash-str.h"
 #include "common/hashmap.h"
@@ -55,6 +56,7 @@ class Dialog;
 class GuiObject;
 class ThemeEval;
 class ThemeItem;
+class ThemeLayerCache;
 class ThemeParser;
 
 /**
@@ -507,6 +509,16 @@ public:
 	 */
 	bool addAlphaBitmap(const Common::String &filename);
 
+	/**
+	 * Interface for the ThemeCompiler class: Adds an already decoded bitmap,
+	 * in the overlay format. The ThemeEngine takes ownership of the surface.
+	 *
+	 * @param filename Name of the bitmap file.
+	 * @param surf     The decoded bitmap.
+	 */
+	void addBitmap(const Common::String &filename, Graphics::Surface *surf);
+	void addAlphaBitmap(const Common::String &filename, Graphics::TransparentSurface *surf);
+
 	/**
 	 * Adds a new TextStep from the ThemeParser. This will be deprecated/removed once the
 	 * new Font API is in place. FIXME: Is that so ???
@@ -542,6 +554,8 @@ public:
 	inline void startBuffering() { _buffering = true; }
 
 	inline ThemeEval *getEvaluator() { return _themeEval; }
+	/** The files the images and fonts of the theme are loaded from */
+	inline const Common::SearchSet &getThemeFiles() const { return _themeFiles; }
 	inline Graphics::VectorRenderer *renderer() { return _vectorRenderer; }
 
 	inline bool supportsImages() const { return true; }
@@ -581,6 +595,20 @@ public:
 	 */
 	void restoreBackground(Common::Rect r);
 
+	/**
+	 * Draws all the steps of a DrawData item onto the active surface of the
+	 * renderer. Items whose drawing stays within layerRect are kept in the
+	 * layer cache, so that drawing them again onto the same background is
+	 * a plain copy.
+	 *
+	 * @param data      DrawData item to draw
+	 * @param area      area of the item
+	 * @param clip      clipping rectangle, or an empty one to not clip
+	 * @param dynamic   dynamic data passed to the draw steps
+	 * @param layerRect area the item may touch, including its shadows
+	 */
+	void drawWidgetLayer(const WidgetDrawData *data, const Common::Rect &area, const Common::Rect &clip, uint32 dynamic, Common::Rect layerRect);
+
 	const Common::String &getThemeName() const { return _themeName; }
 	const Common::String &getThemeId() const { return _themeId; }
 	int getGraphicsMode() const { return _graphicsMode; }
@@ -617,6 +645,9 @@ protected:
 	 */
 	void unloadTheme();
 
+	/** Drops the DrawData, text and layout data of the theme. */
+	void clearThemeData();
+
 	const Graphics::Font *loadScalableFont(const Common::String &filename, const Common::String &charset, const int pointsize, Common::String &name);
 	const Graphics::Font *loadFont(const Common::String &filename, Common::String &name);
 	Common::String genCacheFilename(const Common::String &filename) const;
@@ -624,8 +655,8 @@ protected:
 
 	/**
 	 * Actual Dirty Screen handling function.
-	 * Handles all the dirty squares in the list, merges and optimizes
-	 * them when possible and draws them to the screen.
+	 * Compares the dirty tiles against what was last blitted, merges the
+	 * ones which changed into rectangles and draws these to the screen.
 	 * Called from updateScreen()
 	 */
 	void renderDirtyScreen();
@@ -728,8 +759,27 @@ protected:
 	Graphics::PixelFormat _cursorFormat;
 #endif
 
-	/** List of all the dirty screens that must be blitted to the overlay. */
-	Common::List<Common::Rect> _dirtyScreen;
+	/** Size in pixels of the tiles used to track the dirty parts of the screen. */
+	static const int kDirtyTileSize = 16;
+
+	/** Maximum size in bytes of the layer cache. */
+	static const uint32 kLayerCacheSize = 2 * 1024 * 1024;
+
+	/**
+	 * One entry per tile of the screen, set for the tiles which must be
+	 * compared against _presented and blitted to the overlay.
+	 */
+	Common::Array<byte> _dirtyTiles;
+	uint _dirtyTilesPitch;
+	bool _hasDirtyTiles;
+
+	/** Copy of what was last blitted to the overlay. */
+	Graphics::Surface _presented;
+	/** Whether _presented matches the overlay. */
+	bool _presentedValid;
+
+	/** Recently drawn widgets, see drawWidgetLayer() */
+	ThemeLayerCache *_layerCache;
 
 	/** Queue with all the drawing that must be done to the Back Buffer */
 	Common::List<ThemeItem *> _bufferQueue;
@@ -0,0 +1,151 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "gui/ThemeLayerCache.h"
+
+#include "graphics/surface.h"
+
+namespace GUI {
+
+ThemeLayerCache::ThemeLayerCache(uint32 maxBytes) : _recording(0), _size(0), _maxBytes(maxBytes) {
+}
+
+ThemeLayerCache::~ThemeLayerCache() {
+	clear();
+}
+
+void ThemeLayerCache::clear() {
+	for (Common::List<Layer *>::iterator i = _layers.begin(); i != _layers.end(); ++i)
+		deleteLayer(*i);
+	_layers.clear();
+	_size = 0;
+
+	if (_recording) {
+		deleteLayer(_recording);
+		_recording = 0;
+	}
+}
+
+void ThemeLayerCache::deleteLayer(Layer *layer) {
+	delete[] layer->before;
+	delete[] layer->after;
+	delete layer;
+}
+
+void ThemeLayerCache::copyFromSurface(byte *dst, const Graphics::Surface &surface, const Common::Rect &r, uint32 rowSize) {
+	const byte *src = (const byte *)surface.getBasePtr(r.left, r.top);
+	for (int y = r.top; y < r.bottom; ++y) {
+		memcpy(dst, src, rowSize);
+		dst += rowSize;
+		src += surface.pitch;
+	}
+}
+
+bool ThemeLayerCache::draw(const Key &key, Graphics::Surface &surface, const Common::Rect &r, Graphics::VectorRenderer::ColorState &colors) {
+	for (Common::List<Layer *>::iterator i = _layers.begin(); i != _layers.end(); ++i) {
+		Layer *layer = *i;
+		if (!(layer->key == key) || !(layer->rect == r))
+			continue;
+
+		// Only valid if drawn onto the same pixels
+		const byte *before = layer->before;
+		const byte *src = (const byte *)surface.getBasePtr(r.left, r.top);
+		for (int y = r.top; y < r.bottom; ++y) {
+			if (memcmp(before, src, layer->rowSize) != 0)
+				return false;
+			before += layer->rowSize;
+			src += surface.pitch;
+		}
+
+		const byte *after = layer->after;
+		byte *dst = (byte *)surface.getBasePtr(r.left, r.top);
+		for (int y = r.top; y < r.bottom; ++y) {
+			memcpy(dst, after, layer->rowSize);
+			after += layer->rowSize;
+			dst += surface.pitch;
+		}
+		colors = layer->colorsAfter;
+
+		// Move to the front, so it is dropped last
+		if (i != _layers.begin()) {
+			_layers.erase(i);
+			_layers.push_front(layer);
+		}
+		return true;
+	}
+
+	return false;
+}
+
+void ThemeLayerCache::beginLayer(const Key &key, const Graphics::Surface &surface, const Common::Rect &r) {
+	assert(!_recording);
+
+	const uint32 rowSize = r.width() * surface.format.bytesPerPixel;
+	const uint32 size = rowSize * r.height() * 2;
+
+	// Keep a few layers around, rather than one huge one
+	if (r.isEmpty() || size > _maxBytes / 4)
+		return;
+
+	_recording = new Layer;
+	_recording->key = key;
+	_recording->rect = r;
+	_recording->rowSize = rowSize;
+	_recording->before = new byte[rowSize * r.height()];
+	_recording->after = new byte[rowSize * r.height()];
+	copyFromSurface(_recording->before, surface, r, rowSize);
+}
+
+void ThemeLayerCache::endLayer(const Graphics::Surface &surface, const Graphics::VectorRenderer::ColorState &colors) {
+	Layer *layer = _recording;
+	if (!layer)
+		return;
+	_recording = 0;
+
+	copyFromSurface(layer->after, surface, layer->rect, layer->rowSize);
+	layer->colorsAfter = colors;
+
+	// A layer drawn onto different pixels replaces the old one
+	for (Common::List<Layer *>::iterator i = _layers.begin(); i != _layers.end(); ++i) {
+		if ((*i)->key == layer->key && (*i)->rect == layer->rect) {
+			_size -= (*i)->getSize();
+			deleteLayer(*i);
+			_layers.erase(i);
+			break;
+		}
+	}
+
+	evict(layer->getSize());
+	_layers.push_front(layer);
+	_size += layer->getSize();
+}
+
+void ThemeLayerCache::evict(uint32 size) {
+	while (!_layers.empty() && _size + size > _maxBytes) {
+		Layer *layer = _layers.back();
+		_size -= layer->getSize();
+		deleteLayer(layer);
+		_layers.pop_back();
+	}
+}
+
+} // End of namespace GUI
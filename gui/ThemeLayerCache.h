@@ -0,0 +1,122 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef GUI_THEME_LAYER_CACHE_H
+#define GUI_THEME_LAYER_CACHE_H
+
+#include "common/list.h"
+#include "common/rect.h"
+
+#include "graphics/VectorRenderer.h"
+
+namespace Graphics {
+struct Surface;
+}
+
+namespace GUI {
+
+/**
+ * Keeps the pixels of recently drawn widget layers, so that drawing the
+ * same DrawData again turns into a copy.
+ *
+ * A layer is identified by everything its draw steps depend on: the
+ * DrawData, the area, the clipping rectangle, the dynamic data, whether
+ * shadows are drawn and the colors the renderer carries over. Since the
+ * steps blend into what is below them, a layer also records the pixels it
+ * was drawn onto, and is only reused when these are the same.
+ *
+ * The least recently used layers are dropped once the cache holds more
+ * than the given number of bytes.
+ */
+class ThemeLayerCache {
+public:
+	struct Key {
+		const void *drawData;
+		Common::Rect area;
+		Common::Rect clip;
+		uint32 dynamic;
+		bool shadows;
+		Graphics::VectorRenderer::ColorState colors;
+
+		bool operator==(const Key &k) const {
+			return drawData == k.drawData && area == k.area && clip == k.clip && dynamic == k.dynamic
+				&& shadows == k.shadows && colors == k.colors;
+		}
+	};
+
+	explicit ThemeLayerCache(uint32 maxBytes);
+	~ThemeLayerCache();
+
+	/** Drop all layers, e.g. when the theme or the screen changes. */
+	void clear();
+
+	/**
+	 * Draw a cached layer.
+	 *
+	 * @param key      the layer to draw
+	 * @param surface  the surface to draw to
+	 * @param r        the part of the surface the layer covers
+	 * @param colors   receives the colors the renderer had after drawing
+	 *                 the layer
+	 * @return true if the layer was cached for the current content of r,
+	 *         and has been copied to the surface
+	 */
+	bool draw(const Key &key, Graphics::Surface &surface, const Common::Rect &r, Graphics::VectorRenderer::ColorState &colors);
+
+	/**
+	 * Start recording a layer, before drawing it for real. Remembers the
+	 * current content of r. Does nothing if the layer is too large.
+	 */
+	void beginLayer(const Key &key, const Graphics::Surface &surface, const Common::Rect &r);
+
+	/**
+	 * Finish recording the layer started by beginLayer(), after drawing it.
+	 * The colors left in the renderer are restored when the layer is reused.
+	 */
+	void endLayer(const Graphics::Surface &surface, const Graphics::VectorRenderer::ColorState &colors);
+
+private:
+	struct Layer {
+		Key key;
+		Common::Rect rect;
+		Graphics::VectorRenderer::ColorState colorsAfter;
+		uint32 rowSize;
+		byte *before;
+		byte *after;
+
+		uint32 getSize() const { return rowSize * rect.height() * 2; }
+	};
+
+	static void copyFromSurface(byte *dst, const Graphics::Surface &surface, const Common::Rect &r, uint32 rowSize);
+	void evict(uint32 size);
+	void deleteLayer(Layer *layer);
+
+	/** Layers, the most recently used first */
+	Common::List<Layer *> _layers;
+	Layer *_recording;
+	uint32 _size;
+	const uint32 _maxBytes;
+};
+
+} // End of namespace GUI
+
+#endif
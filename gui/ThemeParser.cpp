@@ -20,6 +20,7 @@
  *
  */
 
+#include "gui/ThemeCompiler.h"
 #include "gui/ThemeEngine.h"
 #include "gui/ThemeEval.h"
 #include "gui/ThemeParser.h"
@@ -106,6 +107,7 @@ ThemeParser::ThemeParser(ThemeEngine *parent) : XMLParser() {
 	_defaultStepGlobal = defaultDrawStep();
 	_defaultStepLocal = 0;
 	_theme = parent;
+	_compiler = 0;
 }
 
 ThemeParser::~ThemeParser() {
@@ -187,6 +189,9 @@ bool ThemeParser::parserCallback_font(ParserNode *node) {
 	if (!_theme->addFont(textDataId, node->values["file"], node->values["scalable_file"], pointsize))
 		return parserError("Error loading Font in theme engine.");
 
+	if (_compiler)
+		_compiler->addFont(textDataId, node->values["file"], node->values["scalable_file"], pointsize);
+
 	return true;
 }
 
@@ -205,6 +210,9 @@ bool ThemeParser::parserCallback_text_color(ParserNode *node) {
 	if (!_theme->addTextColor(colorId, red, green, blue))
 		return parserError("Error while adding text color information.");
 
+	if (_compiler)
+		_compiler->addTextColor(colorId, red, green, blue);
+
 	return true;
 }
 
@@ -226,6 +234,9 @@ bool ThemeParser::parserCallback_cursor(ParserNode *node) {
 	if (!_theme->createCursor(node->values["file"], spotx, spoty))
 		return parserError("Error creating Bitmap Cursor.");
 
+	if (_compiler)
+		_compiler->createCursor(node->values["file"], spotx, spoty);
+
 	return true;
 }
 
@@ -238,6 +249,9 @@ bool ThemeParser::parserCallback_bitmap(ParserNode *node) {
 	if (!_theme->addBitmap(node->values["filename"]))
 		return parserError("Error loading Bitmap file '" + node->values["filename"] + "'");
 
+	if (_compiler)
+		_compiler->addBitmap(node->values["filename"], _theme->getBitmap(node->values["filename"]));
+
 	return true;
 }
 
@@ -250,6 +264,9 @@ bool ThemeParser::parserCallback_alphabitmap(ParserNode *node) {
 	if (!_theme->addAlphaBitmap(node->values["filename"]))
 		return parserError("Error loading Bitmap file '" + node->values["filename"] + "'");
 
+	if (_compiler)
+		_compiler->addAlphaBitmap(node->values["filename"], _theme->getAlphaBitmap(node->values["filename"]));
+
 	return true;
 }
 
@@ -270,6 +287,9 @@ bool ThemeParser::parserCallback_text(ParserNode *node) {
 	if (!_theme->addTextData(id, textDataId, textColorId, alignH, alignV))
 		return parserError("Error adding Text Data for '" + id + "'.");
 
+	if (_compiler)
+		_compiler->addTextData(id, textDataId, textColorId, alignH, alignV);
+
 	return true;
 }
 
@@ -311,7 +331,7 @@ bool ThemeParser::parserCallback_color(ParserNode *node) {
 }
 
 
-static Graphics::DrawingFunctionCallback getDrawingFunctionCallback(const Common::String &name) {
+Graphics::DrawingFunctionCallback ThemeParser::getDrawingFunctionCallback(const Common::String &name) {
 
 	if (name == "circle")
 		return &Graphics::VectorRenderer::drawCallback_CIRCLE;
@@ -360,6 +380,10 @@ bool ThemeParser::parserCallback_drawstep(ParserNode *node) {
 	}
 
 	_theme->addDrawStep(getParentNode(node)->values["id"], *drawstep);
+
+	if (_compiler)
+		_compiler->addDrawStep(getParentNode(node)->values["id"], *drawstep, functionName, node->values["file"]);
+
 	delete drawstep;
 
 	return true;
@@ -381,6 +405,9 @@ bool ThemeParser::parserCallback_drawdata(ParserNode *node) {
 	if (_theme->addDrawData(node->values["id"], cached) == false)
 		return parserError("Error adding Draw Data set: Invalid DrawData name.");
 
+	if (_compiler)
+		_compiler->addDrawData(node->values["id"], cached);
+
 	delete _defaultStepLocal;
 	_defaultStepLocal = 0;
 
@@ -651,6 +678,8 @@ bool ThemeParser::parserCallback_def(ParserNode *node) {
 		return parserError("Invalid definition for '" + var + "'.");
 
 	_theme->getEvaluator()->setVar(var, value);
+	if (_compiler)
+		_compiler->setVar(var, value);
 	return true;
 }
 
@@ -704,6 +733,8 @@ bool ThemeParser::parserCallback_widget(ParserNode *node) {
 		}
 
 		_theme->getEvaluator()->addWidget(var, width, height, node->values["type"], enabled, alignH);
+		if (_compiler)
+			_compiler->addWidget(var, width, height, node->values["type"], enabled, alignH);
 	}
 
 	return true;
@@ -730,6 +761,8 @@ bool ThemeParser::parserCallback_dialog(ParserNode *node) {
 	}
 
 	_theme->getEvaluator()->addDialog(var, node->values["overlays"], enabled, inset);
+	if (_compiler)
+		_compiler->addDialog(var, node->values["overlays"], enabled, inset);
 
 	if (node->values.contains("shading")) {
 		int shading = 0;
@@ -740,6 +773,8 @@ bool ThemeParser::parserCallback_dialog(ParserNode *node) {
 		else return parserError("Invalid value for Dialog background shading.");
 
 		_theme->getEvaluator()->setVar(var + ".Shading", shading);
+		if (_compiler)
+			_compiler->setVar(var + ".Shading", shading);
 	}
 
 	return true;
@@ -749,6 +784,8 @@ bool ThemeParser::parserCallback_import(ParserNode *node) {
 
 	if (!_theme->getEvaluator()->addImportedLayout(node->values["layout"]))
 		return parserError("Error importing external layout");
+	if (_compiler)
+		_compiler->addImportedLayout(node->values["layout"]);
 	return true;
 }
 
@@ -763,13 +800,18 @@ bool ThemeParser::parserCallback_layout(ParserNode *node) {
 
 	(void)Common::parseBool(node->values["center"], center);
 
+	GUI::ThemeLayout::LayoutType type;
 	if (node->values["type"] == "vertical")
-		_theme->getEvaluator()->addLayout(GUI::ThemeLayout::kLayoutVertical, spacing, center);
+		type = GUI::ThemeLayout::kLayoutVertical;
 	else if (node->values["type"] == "horizontal")
-		_theme->getEvaluator()->addLayout(GUI::ThemeLayout::kLayoutHorizontal, spacing, center);
+		type = GUI::ThemeLayout::kLayoutHorizontal;
 	else
 		return parserError("Invalid layout type. Only 'horizontal' and 'vertical' layouts allowed.");
 
+	_theme->getEvaluator()->addLayout(type, spacing, center);
+	if (_compiler)
+		_compiler->addLayout(type, spacing, center);
+
 
 	if (node->values.contains("padding")) {
 		int paddingL, paddingR, paddingT, paddingB;
@@ -778,6 +820,8 @@ bool ThemeParser::parserCallback_layout(ParserNode *node) {
 			return false;
 
 		_theme->getEvaluator()->addPadding(paddingL, paddingR, paddingT, paddingB);
+		if (_compiler)
+			_compiler->addPadding(paddingL, paddingR, paddingT, paddingB);
 	}
 
 	return true;
@@ -795,14 +839,21 @@ bool ThemeParser::parserCallback_space(ParserNode *node) {
 	}
 
 	_theme->getEvaluator()->addSpace(size);
+	if (_compiler)
+		_compiler->addSpace(size);
 	return true;
 }
 
 bool ThemeParser::closedKeyCallback(ParserNode *node) {
-	if (node->name == "layout")
+	if (node->name == "layout") {
 		_theme->getEvaluator()->closeLayout();
-	else if (node->name == "dialog")
+		if (_compiler)
+			_compiler->closeLayout();
+	} else if (node->name == "dialog") {
 		_theme->getEvaluator()->closeDialog();
+		if (_compiler)
+			_compiler->closeDialog();
+	}
 
 	return true;
 }
@@ -851,6 +902,10 @@ bool ThemeParser::parseCommonLayoutProps(ParserNode *node, const Common::String
 
 		_theme->getEvaluator()->setVar(var + "Width", width);
 		_theme->getEvaluator()->setVar(var + "Height", height);
+		if (_compiler) {
+			_compiler->setVar(var + "Width", width);
+			_compiler->setVar(var + "Height", height);
+		}
 	}
 
 	if (node->values.contains("pos")) {
@@ -907,6 +962,10 @@ bool ThemeParser::parseCommonLayoutProps(ParserNode *node, const Common::String
 
 		_theme->getEvaluator()->setVar(var + "X", x);
 		_theme->getEvaluator()->setVar(var + "Y", y);
+		if (_compiler) {
+			_compiler->setVar(var + "X", x);
+			_compiler->setVar(var + "Y", y);
+		}
 	}
 
 	if (node->values.contains("padding")) {
@@ -919,6 +978,12 @@ bool ThemeParser::parseCommonLayoutProps(ParserNode *node, const Common::String
 		_theme->getEvaluator()->setVar(var + "Padding.Right", paddingR);
 		_theme->getEvaluator()->setVar(var + "Padding.Top", paddingT);
 		_theme->getEvaluator()->setVar(var + "Padding.Bottom", paddingB);
+		if (_compiler) {
+			_compiler->setVar(var + "Padding.Left", paddingL);
+			_compiler->setVar(var + "Padding.Right", paddingR);
+			_compiler->setVar(var + "Padding.Top", paddingT);
+			_compiler->setVar(var + "Padding.Bottom", paddingB);
+		}
 	}
 
 
@@ -929,6 +994,8 @@ bool ThemeParser::parseCommonLayoutProps(ParserNode *node, const Common::String
 			return parserError("Invalid value for text alignment.");
 
 		_theme->getEvaluator()->setVar(var + "Align", alignH);
+		if (_compiler)
+			_compiler->setVar(var + "Align", alignH);
 	}
 	return true;
 }
@@ -26,8 +26,11 @@
 #include "common/scummsys.h"
 #include "common/xmlparser.h"
 
+#include "graphics/VectorRenderer.h"
+
 namespace GUI {
 
+class ThemeCompiler;
 class ThemeEngine;
 
 class ThemeParser : public Common::XMLParser {
@@ -36,6 +39,15 @@ public:
 
 	virtual ~ThemeParser();
 
+	/**
+	 * Sets the ThemeCompiler which records the theme while it is parsed,
+	 * or 0 to stop recording.
+	 */
+	void setCompiler(ThemeCompiler *compiler) { _compiler = compiler; }
+
+	/** Returns the drawing function of the given name, or 0 if there is none. */
+	static Graphics::DrawingFunctionCallback getDrawingFunctionCallback(const Common::String &name);
+
 	bool getPaletteColor(const Common::String &name, int &r, int &g, int &b) {
 		if (!_palette.contains(name))
 			return false;
@@ -49,6 +61,7 @@ public:
 
 protected:
 	ThemeEngine *_theme;
+	ThemeCompiler *_compiler;
 
 	CUSTOM_XML_PARSER(ThemeParser) {
 		XML_KEY(render_info)
@@ -22,6 +22,8 @@
 
 #include "base/version.h"
 
+#include "engines/detectionCache.h"
+
 #include "common/config-manager.h"
 #include "common/events.h"
 #include "common/fs.h"
@@ -549,6 +551,7 @@ bool LauncherDialog::doGameDetection(const Common::String &path) {
 	// ...so let's determine a list of candidates, games that
 	// could be contained in the specified directory.
 	GameList candidates(EngineMan.detectGames(files));
+	DetectionCacheMan.flush();
 
 	int idx;
 	if (candidates.empty()) {
@@ -20,6 +20,7 @@
  *
  */
 
+#include "engines/detectionCache.h"
 #include "engines/metaengine.h"
 #include "common/algorithm.h"
 #include "common/config-manager.h"
@@ -63,6 +64,7 @@ MassAddDialog::MassAddDialog(const Common::FSNode &startDir)
 	_dirsScanned(0),
 	_oldGamesCount(0),
 	_dirTotal(0),
+	_scanTime(0),
 	_okButton(0),
 	_dirProgressText(0),
 	_gameProgressText(0) {
@@ -72,6 +74,9 @@ MassAddDialog::MassAddDialog(const Common::FSNode &startDir)
 	// The dir we start our scan at
 	_scanStack.push(startDir);
 
+	// Count the cache hits of this scan only
+	DetectionCacheMan.resetStats();
+
 	// Removed for now... Why would you put a title on mass add dialog called "Mass Add Dialog"?
 	// new StaticTextWidget(this, "massadddialog_caption", "Mass Add Dialog");
 
@@ -248,6 +253,8 @@ void MassAddDialog::handleTickle() {
 #endif
 	}
 
+	_scanTime += g_system->getMillis() - t;
+
 
 	// Update the dialog
 	Common::String buf;
@@ -256,7 +263,19 @@ void MassAddDialog::handleTickle() {
 		// Enable the OK button
 		_okButton->setEnabled(true);
 
+		// Keep the checksums for the next scan
+		DetectionCacheMan.flush();
+
+		// Report how long detection took, and how much of it the detection
+		// cache could answer. Without cache hits this is a cold scan.
+		const uint cacheHits = DetectionCacheMan.getHits();
+		const uint checksums = cacheHits + DetectionCacheMan.getMisses();
+		debug(1, "MassAdd: Scanned %d directories in %u ms, %u of %u checksums were cached",
+			_dirsScanned, _scanTime, cacheHits, checksums);
+
 		buf = _("Scan complete!");
+		buf += " " + Common::String::format(_("%u of %u checksums were cached, in %u.%02u s."),
+			cacheHits, checksums, _scanTime / 1000, (_scanTime % 1000) / 10);
 		_dirProgressText->setLabel(buf);
 
 		buf = Common::String::format(_("Discovered %d new games, ignored %d previously added games."), _games.size(), _oldGamesCount);
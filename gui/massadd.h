@@ -63,6 +63,9 @@ private:
 	int _oldGamesCount;
 	int _dirTotal;
 
+	/** Milliseconds spent detecting, without the time the GUI took */
+	uint32 _scanTime;
+
 	Widget *_okButton;
 	StaticTextWidget *_dirProgressText;
 	StaticTextWidget *_gameProgressText;
@@ -20,8 +20,10 @@ MODULE_OBJS := \
 	saveload.o \
 	saveload-dialog.o \
 	themebrowser.o \
+	ThemeCompiler.o \
 	ThemeEngine.o \
 	ThemeEval.o \
+	ThemeLayerCache.o \
 	ThemeLayout.o \
 	ThemeParser.o \
 	Tooltip.o \
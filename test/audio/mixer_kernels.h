@@ -0,0 +1,67 @@
+#include <cxxtest/TestSuite.h>
+
+#include "audio/mixer.h"
+#include "audio/mixer_kernels.h"
+#include "audio/rate.h"
+
+#include "common/util.h"
+
+class MixerKernelsTestSuite : public CxxTest::TestSuite
+{
+	public:
+	void test_accumulate_stereo() {
+		// Odd length, so both the vector and the scalar code run
+		const uint frames = 37;
+		int16 src[frames * 2];
+		int32 acc[frames * 2], expected[frames * 2];
+
+		for (uint i = 0; i < frames * 2; ++i) {
+			src[i] = (int16)((i * 2731) ^ (i << 9));
+			acc[i] = expected[i] = (int32)i * 1000 - 30000;
+		}
+
+		Audio::accumulateStereo(acc, src, frames, 200, 56);
+
+		for (uint i = 0; i < frames * 2; ++i) {
+			expected[i] += src[i] * ((i & 1) ? 56 : 200);
+			TS_ASSERT_EQUALS(acc[i], expected[i]);
+		}
+	}
+
+	void test_saturate_stereo() {
+		const uint frames = 13;
+		int32 acc[frames * 2];
+		int16 dst[frames * 2];
+
+		for (uint i = 0; i < frames * 2; ++i)
+			acc[i] = ((int32)i - 13) * 1000 * Audio::Mixer::kMaxMixerVolume * 3;
+
+		Audio::saturateStereo(dst, acc, frames);
+
+		for (uint i = 0; i < frames * 2; ++i) {
+			const int32 val = ((int32)i - 13) * 3000;
+			TS_ASSERT_EQUALS(dst[i], (int16)CLIP<int32>(val, -32768, 32767));
+		}
+	}
+
+	void test_mix_matches_clamped_add() {
+		// Without clipping, one accumulated and saturated channel must give
+		// the same result as the old per sample path.
+		const uint frames = 29;
+		int16 src[frames * 2], reference[frames * 2], dst[frames * 2];
+		int32 acc[frames * 2];
+
+		memset(reference, 0, sizeof(reference));
+		memset(acc, 0, sizeof(acc));
+		for (uint i = 0; i < frames * 2; ++i) {
+			src[i] = (int16)(i * 512);
+			Audio::clampedAdd(reference[i], (src[i] * ((i & 1) ? 128 : 256)) / Audio::Mixer::kMaxMixerVolume);
+		}
+
+		Audio::accumulateStereo(acc, src, frames, 256, 128);
+		Audio::saturateStereo(dst, acc, frames);
+
+		for (uint i = 0; i < frames * 2; ++i)
+			TS_ASSERT_EQUALS(dst[i], reference[i]);
+	}
+};
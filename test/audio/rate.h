@@ -0,0 +1,188 @@
+#include <cxxtest/TestSuite.h>
+
+#include "audio/audiostream.h"
+#include "audio/rate.h"
+
+#include <math.h>
+
+class RateTestSuite : public CxxTest::TestSuite
+{
+	/** An endless sine (or DC, for a zero frequency) generator. */
+	class ToneStream : public Audio::AudioStream {
+	public:
+		ToneStream(int rate, double frequency, double amplitude, bool stereo)
+			: _rate(rate), _frequency(frequency), _amplitude(amplitude), _stereo(stereo), _pos(0) {}
+
+		int readBuffer(int16 *buffer, const int numSamples) {
+			for (int i = 0; i < numSamples; ) {
+				const double value = (_frequency == 0.0) ? _amplitude : _amplitude * sin(2 * M_PI * _frequency * _pos / _rate);
+				buffer[i++] = (int16)floor(value + 0.5);
+				if (_stereo)
+					buffer[i++] = (int16)floor(-value + 0.5);
+				++_pos;
+			}
+			return numSamples;
+		}
+
+		bool isStereo() const { return _stereo; }
+		int getRate() const { return _rate; }
+		bool endOfData() const { return false; }
+
+	private:
+		int _rate;
+		double _frequency, _amplitude;
+		bool _stereo;
+		uint _pos;
+	};
+
+	/** A mono stream of a fixed number of samples of one value. */
+	class FiniteStream : public Audio::AudioStream {
+	public:
+		FiniteStream(int rate, int16 value, int length) : _rate(rate), _value(value), _left(length) {}
+
+		int readBuffer(int16 *buffer, const int numSamples) {
+			const int count = MIN(numSamples, _left);
+			for (int i = 0; i < count; ++i)
+				buffer[i] = _value;
+			_left -= count;
+			return count;
+		}
+
+		bool isStereo() const { return false; }
+		int getRate() const { return _rate; }
+		bool endOfData() const { return _left == 0; }
+
+	private:
+		int _rate;
+		int16 _value;
+		int _left;
+	};
+
+	/** The peak amplitude of the left channel after the filter settled. */
+	static int peak(const int16 *buf, int frames) {
+		int result = 0;
+		for (int i = frames / 2; i < frames; ++i)
+			result = MAX<int>(result, ABS(buf[i * 2]));
+		return result;
+	}
+
+	enum {
+		kFrames = 4096
+	};
+
+	public:
+	void test_sinc_dc() {
+		ToneStream dc(22050, 0.0, 10000.0, false);
+		Audio::RateConverter *converter = Audio::makeSincRateConverter(22050, 44100, false);
+		TS_ASSERT(converter != 0);
+
+		int16 buf[kFrames * 2];
+		TS_ASSERT_EQUALS(converter->resample(dc, buf, kFrames), kFrames);
+
+		for (int i = 64; i < kFrames; ++i) {
+			TS_ASSERT_EQUALS(buf[i * 2], 10000);
+			TS_ASSERT_EQUALS(buf[i * 2 + 1], 10000);
+		}
+
+		delete converter;
+	}
+
+	void test_sinc_reverse_stereo() {
+		ToneStream dc(11025, 0.0, 1000.0, true);
+		Audio::RateConverter *converter = Audio::makeSincRateConverter(11025, 48000, true, true);
+		TS_ASSERT(converter != 0);
+
+		int16 buf[kFrames * 2];
+		TS_ASSERT_EQUALS(converter->resample(dc, buf, kFrames), kFrames);
+
+		TS_ASSERT_EQUALS(buf[(kFrames - 1) * 2], -1000);
+		TS_ASSERT_EQUALS(buf[(kFrames - 1) * 2 + 1], 1000);
+
+		delete converter;
+	}
+
+	void test_sinc_flow_volume() {
+		ToneStream dc(44100, 0.0, 8000.0, false);
+		Audio::RateConverter *converter = Audio::makeSincRateConverter(44100, 22050, false);
+		TS_ASSERT(converter != 0);
+
+		int16 buf[kFrames * 2];
+		memset(buf, 0, sizeof(buf));
+		TS_ASSERT_EQUALS(converter->flow(dc, buf, kFrames, Audio::Mixer::kMaxMixerVolume / 2, 0), kFrames);
+
+		TS_ASSERT_EQUALS(buf[(kFrames - 1) * 2], 4000);
+		TS_ASSERT_EQUALS(buf[(kFrames - 1) * 2 + 1], 0);
+
+		delete converter;
+	}
+
+	void test_sinc_passband() {
+		ToneStream tone(22050, 1000.0, 16000.0, false);
+		Audio::RateConverter *converter = Audio::makeSincRateConverter(22050, 44100, false);
+
+		int16 buf[kFrames * 2];
+		converter->resample(tone, buf, kFrames);
+		TS_ASSERT_DELTA(peak(buf, kFrames), 16000, 200);
+
+		delete converter;
+	}
+
+	void test_sinc_stopband() {
+		// 20 kHz folds back to 4.05 kHz at 24.1 kHz, it has to be filtered out
+		ToneStream tone(44100, 20000.0, 16000.0, false);
+		Audio::RateConverter *converter = Audio::makeSincRateConverter(44100, 24100, false);
+		TS_ASSERT(converter != 0);
+
+		int16 buf[kFrames * 2];
+		converter->resample(tone, buf, kFrames);
+		TS_ASSERT_LESS_THAN(peak(buf, kFrames), 50);
+
+		delete converter;
+	}
+
+	void test_sinc_flush() {
+		// 1000 samples at twice the rate give 2000 frames, delayed by half
+		// the filter length, and followed by the filter ringing out
+		FiniteStream stream(22050, 10000, 1000);
+		Audio::RateConverter *converter = Audio::makeSincRateConverter(22050, 44100, false);
+		TS_ASSERT(converter != 0);
+
+		int16 buf[kFrames * 2];
+		const int frames = converter->resample(stream, buf, kFrames);
+		TS_ASSERT_EQUALS(frames, 2064);
+		TS_ASSERT(!converter->needsDrain());
+
+		// The end of the input still comes out at full level, and the
+		// output rings out into silence
+		TS_ASSERT_EQUALS(buf[2000 * 2], 10000);
+		TS_ASSERT_LESS_THAN(ABS(buf[2048 * 2]), 100);
+		TS_ASSERT_EQUALS(buf[(frames - 1) * 2], 0);
+
+		delete converter;
+	}
+
+	void test_sinc_drain() {
+		// When the output buffer is full just as the input ends, the rest
+		// comes out of drain()
+		FiniteStream stream(22050, 10000, 1000);
+		Audio::RateConverter *converter = Audio::makeSincRateConverter(22050, 44100, false);
+		TS_ASSERT(converter != 0);
+
+		int16 buf[kFrames * 2];
+		TS_ASSERT_EQUALS(converter->resample(stream, buf, 2000), 2000);
+		TS_ASSERT(stream.endOfData());
+		TS_ASSERT(converter->needsDrain());
+
+		memset(buf, 0, sizeof(buf));
+		TS_ASSERT_EQUALS(converter->drain(buf, kFrames, Audio::Mixer::kMaxMixerVolume), 64);
+		TS_ASSERT(!converter->needsDrain());
+		TS_ASSERT_EQUALS(buf[0], 10000);
+		TS_ASSERT_EQUALS(buf[63 * 2], 0);
+
+		delete converter;
+	}
+
+	void test_sinc_too_many_phases() {
+		TS_ASSERT(Audio::makeSincRateConverter(44100, 44099, false) == 0);
+	}
+};
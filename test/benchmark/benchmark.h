@@ -0,0 +1,44 @@
+#ifndef TEST_BENCHMARK_BENCHMARK_H
+#define TEST_BENCHMARK_BENCHMARK_H
+
+// This header is included ahead of everything else in the generated
+// benchmark runner, so the suites may use the C library for timing and
+// printing their results.
+#define FORBIDDEN_SYMBOL_ALLOW_ALL
+
+#include "common/scummsys.h"
+
+#include <stdio.h>
+#include <time.h>
+
+namespace Benchmark {
+
+/**
+ * Measures the processor time spent since its creation.
+ */
+class Timer {
+public:
+	Timer() : _start(clock()) {}
+
+	double getSeconds() const {
+		return (double)(clock() - _start) / CLOCKS_PER_SEC;
+	}
+
+private:
+	clock_t _start;
+};
+
+/**
+ * Print one result line: the time per iteration and the throughput in
+ * millions of units per second.
+ */
+inline void report(const char *name, const Timer &timer, uint iterations, double unitsPerIteration, const char *unit) {
+	const double seconds = timer.getSeconds();
+	const double perIteration = seconds * 1000000.0 / iterations;
+	const double throughput = (seconds > 0) ? unitsPerIteration * iterations / seconds / 1000000.0 : 0;
+	printf("  %-44s %10.2f us/iter %10.1f M%s/s\n", name, perIteration, throughput, unit);
+}
+
+} // End of namespace Benchmark
+
+#endif
@@ -0,0 +1,158 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/flathashmap.h"
+#include "common/hashmap.h"
+#include "common/hash-str.h"
+#include "common/str.h"
+#include "common/util.h"
+
+#include "benchmark.h"
+
+class HashMapBenchmarkSuite : public CxxTest::TestSuite
+{
+	enum {
+		kNumKeys = 50000,
+		kRounds = 20
+	};
+
+	typedef Common::HashMap<uint, uint> IntHashMap;
+	typedef Common::FlatHashMap<uint, uint> IntFlatHashMap;
+	typedef Common::HashMap<Common::String, uint, Common::IgnoreCase_Hash, Common::IgnoreCase_EqualTo> StringHashMap;
+	typedef Common::FlatHashMap<Common::String, uint, Common::IgnoreCase_Hash, Common::IgnoreCase_EqualTo> StringFlatHashMap;
+
+	/** Scattered, distinct keys, like addresses. */
+	static uint intKey(uint i) {
+		i ^= i >> 16;
+		i *= 0x45D9F3BU;
+		i ^= i >> 16;
+		return i;
+	}
+
+	/**
+	 * Visit the keys in a different order than they were inserted in, so
+	 * the lookups do not profit from allocation order.
+	 */
+	static uint shuffle(uint i) {
+		return (i * 7919) % kNumKeys;
+	}
+
+	/** Keys shaped like the file and resource names engines look up. */
+	static void makeStringKeys(Common::String *keys, uint count) {
+		for (uint i = 0; i < count; ++i)
+			keys[i] = Common::String::format("resource.%u/file_%04u.dat", i % 7, i);
+	}
+
+	template<class Map>
+	static void runInt(const char *mapName) {
+		char name[64];
+		uint sink = 0;
+
+		Benchmark::Timer insert;
+		for (uint r = 0; r < kRounds; ++r) {
+			Map map;
+			for (uint i = 0; i < kNumKeys; ++i)
+				map[intKey(i)] = i;
+			sink += map.size();
+		}
+		snprintf(name, sizeof(name), "%s<uint> insert", mapName);
+		Benchmark::report(name, insert, kRounds, kNumKeys, "op");
+
+		Benchmark::Timer reserved;
+		for (uint r = 0; r < kRounds; ++r) {
+			Map map;
+			map.reserve(kNumKeys);
+			for (uint i = 0; i < kNumKeys; ++i)
+				map[intKey(i)] = i;
+			sink += map.size();
+		}
+		snprintf(name, sizeof(name), "%s<uint> insert after reserve", mapName);
+		Benchmark::report(name, reserved, kRounds, kNumKeys, "op");
+
+		Map map;
+		for (uint i = 0; i < kNumKeys; ++i)
+			map[intKey(i)] = i;
+
+		Benchmark::Timer hit;
+		for (uint r = 0; r < kRounds; ++r) {
+			for (uint i = 0; i < kNumKeys; ++i)
+				sink += map.getVal(intKey(shuffle(i)), 0);
+		}
+		snprintf(name, sizeof(name), "%s<uint> find, hit", mapName);
+		Benchmark::report(name, hit, kRounds, kNumKeys, "op");
+
+		Benchmark::Timer miss;
+		for (uint r = 0; r < kRounds; ++r) {
+			for (uint i = 0; i < kNumKeys; ++i)
+				sink += map.contains(intKey(shuffle(i) + kNumKeys));
+		}
+		snprintf(name, sizeof(name), "%s<uint> find, miss", mapName);
+		Benchmark::report(name, miss, kRounds, kNumKeys, "op");
+
+		Benchmark::Timer churn;
+		for (uint r = 0; r < kRounds; ++r) {
+			for (uint i = 0; i < kNumKeys; ++i) {
+				map.erase(intKey(i));
+				map[intKey(i + kNumKeys * (r + 1))] = i;
+			}
+		}
+		snprintf(name, sizeof(name), "%s<uint> erase + insert", mapName);
+		Benchmark::report(name, churn, kRounds, kNumKeys, "op");
+
+		TS_ASSERT(sink != 0);
+	}
+
+	template<class Map>
+	static void runString(const char *mapName, const Common::String *keys) {
+		char name[64];
+		uint sink = 0;
+
+		Benchmark::Timer insert;
+		for (uint r = 0; r < kRounds; ++r) {
+			Map map;
+			for (uint i = 0; i < kNumKeys; ++i)
+				map[keys[i]] = i;
+			sink += map.size();
+		}
+		snprintf(name, sizeof(name), "%s<String> insert", mapName);
+		Benchmark::report(name, insert, kRounds, kNumKeys, "op");
+
+		Map map;
+		for (uint i = 0; i < kNumKeys; ++i)
+			map[keys[i]] = i;
+
+		Benchmark::Timer hit;
+		for (uint r = 0; r < kRounds; ++r) {
+			for (uint i = 0; i < kNumKeys; ++i)
+				sink += map.getVal(keys[shuffle(i)], 0);
+		}
+		snprintf(name, sizeof(name), "%s<String> find, String", mapName);
+		Benchmark::report(name, hit, kRounds, kNumKeys, "op");
+
+		Benchmark::Timer chars;
+		for (uint r = 0; r < kRounds; ++r) {
+			for (uint i = 0; i < kNumKeys; ++i)
+				sink += map.getVal(keys[shuffle(i)].c_str(), 0);
+		}
+		snprintf(name, sizeof(name), "%s<String> find, const char *", mapName);
+		Benchmark::report(name, chars, kRounds, kNumKeys, "op");
+
+		TS_ASSERT(sink != 0);
+	}
+
+	public:
+	void test_int_keys() {
+		printf("\n");
+		runInt<IntHashMap>("HashMap");
+		runInt<IntFlatHashMap>("FlatHashMap");
+	}
+
+	void test_string_keys() {
+		Common::String *keys = new Common::String[kNumKeys];
+		makeStringKeys(keys, kNumKeys);
+
+		runString<StringHashMap>("HashMap", keys);
+		runString<StringFlatHashMap>("FlatHashMap", keys);
+
+		delete[] keys;
+	}
+};
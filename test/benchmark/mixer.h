@@ -0,0 +1,116 @@
+#include <cxxtest/TestSuite.h>
+
+#include "audio/audiostream.h"
+#include "audio/mixer.h"
+#include "audio/mixer_kernels.h"
+#include "audio/rate.h"
+
+#include "common/memstream.h"
+#include "common/util.h"
+
+#include "test/audio/helper.h"
+
+#include "benchmark.h"
+
+class MixerBenchmarkSuite : public CxxTest::TestSuite
+{
+	enum {
+		kNumStreams = 16,
+		kBufferSize = 1024,
+		kBlockSize = 256,
+		kSeconds = 20
+	};
+
+	struct Source {
+		Audio::AudioStream *stream;
+		Audio::RateConverter *converter;
+		uint16 volL, volR;
+	};
+
+	/**
+	 * A typical busy scene: speech, music and a lot of effects at
+	 * assorted rates.
+	 */
+	static void createSources(Source *sources, uint outputRate) {
+		static const int rates[] = { 11025, 22050, 22050, 44100 };
+
+		for (int i = 0; i < kNumStreams; ++i) {
+			const int rate = rates[i % ARRAYSIZE(rates)];
+			const bool stereo = (i % 4) == 3;
+			Audio::SeekableAudioStream *sine = createSineStream<int16>(rate, 1, 0, true, stereo);
+
+			sources[i].stream = Audio::makeLoopingAudioStream(sine, 0);
+			sources[i].converter = Audio::makeRateConverter(rate, outputRate, stereo);
+			sources[i].volL = 64 + i * 8;
+			sources[i].volR = 192 - i * 8;
+		}
+	}
+
+	static void destroySources(Source *sources) {
+		for (int i = 0; i < kNumStreams; ++i) {
+			delete sources[i].converter;
+			delete sources[i].stream;
+		}
+	}
+
+	/** The old path: every channel is scaled and clamped into the output. */
+	static void mixClamped(Source *sources, int16 *buf, uint len) {
+		memset(buf, 0, len * 2 * sizeof(int16));
+		for (int i = 0; i < kNumStreams; ++i)
+			sources[i].converter->flow(*sources[i].stream, buf, len, sources[i].volL, sources[i].volR);
+	}
+
+	/** The block path, as used by MixerImpl. */
+	static void mixBlocks(Source *sources, int16 *buf, uint len) {
+		int32 acc[kBlockSize * 2];
+		int16 scratch[kBlockSize * 2];
+
+		while (len > 0) {
+			const uint blockLen = MIN<uint>(len, kBlockSize);
+			memset(acc, 0, blockLen * 2 * sizeof(int32));
+
+			for (int i = 0; i < kNumStreams; ++i) {
+				const int res = sources[i].converter->resample(*sources[i].stream, scratch, blockLen);
+				Audio::accumulateStereo(acc, scratch, res, sources[i].volL, sources[i].volR);
+			}
+
+			Audio::saturateStereo(buf, acc, blockLen);
+			buf += blockLen * 2;
+			len -= blockLen;
+		}
+	}
+
+	static void run(uint outputRate) {
+		int16 buf[kBufferSize * 2];
+		const uint iterations = outputRate * kSeconds / kBufferSize;
+		char name[64];
+
+		Source sources[kNumStreams];
+
+		createSources(sources, outputRate);
+		Benchmark::Timer clamped;
+		for (uint i = 0; i < iterations; ++i)
+			mixClamped(sources, buf, kBufferSize);
+		snprintf(name, sizeof(name), "16 streams to %u Hz, clampedAdd", outputRate);
+		Benchmark::report(name, clamped, iterations, kBufferSize, "frame");
+		destroySources(sources);
+
+		createSources(sources, outputRate);
+		Benchmark::Timer blocks;
+		for (uint i = 0; i < iterations; ++i)
+			mixBlocks(sources, buf, kBufferSize);
+		snprintf(name, sizeof(name), "16 streams to %u Hz, blocks", outputRate);
+		Benchmark::report(name, blocks, iterations, kBufferSize, "frame");
+		destroySources(sources);
+	}
+
+	public:
+	void test_mix_44100() {
+		printf("\n");
+		run(44100);
+	}
+
+	void test_mix_48000() {
+		run(48000);
+	}
+};
@@ -0,0 +1,158 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/file.h"
+#include "common/memstream.h"
+#include "common/str.h"
+
+#include "benchmark.h"
+
+#ifdef USE_MT32EMU
+#include "audio/softsynth/mt32/mt32emu.h"
+#include "audio/softsynth/mt32/BReverbModel.h"
+#endif
+
+#include <stdlib.h>
+
+class MT32BenchmarkSuite : public CxxTest::TestSuite
+{
+#ifdef USE_MT32EMU
+	enum {
+		kBlockSize = 512,
+		kSampleRate = 32000,
+		kSongSeconds = 30,
+		kReverbSeconds = 60
+	};
+
+	/** Simple deterministic noise, so every run renders the same data. */
+	static int16 noise(uint32 &seed) {
+		seed = seed * 1103515245 + 12345;
+		return (int16)(seed >> 16) >> 2;
+	}
+
+	/**
+	 * Load a ROM image from the directory named by MT32_ROM_PATH. The
+	 * emulator reads its ROMs through Common::File, which is handed a
+	 * memory stream since there is no search path here.
+	 */
+	static Common::File *openROM(const char *name) {
+		const char *path = getenv("MT32_ROM_PATH");
+		if (!path)
+			return 0;
+
+		FILE *f = fopen((Common::String(path) + "/" + name).c_str(), "rb");
+		if (!f)
+			return 0;
+
+		fseek(f, 0, SEEK_END);
+		const long size = ftell(f);
+		fseek(f, 0, SEEK_SET);
+		byte *data = (byte *)malloc(size);
+		const bool ok = data && fread(data, 1, size, f) == (size_t)size;
+		fclose(f);
+		if (!ok) {
+			free(data);
+			return 0;
+		}
+
+		Common::File *file = new Common::File();
+		file->open(new Common::MemoryReadStream(data, size, DisposeAfterUse::YES), name);
+		return file;
+	}
+
+	/**
+	 * Queue a busy, fixed piece of music: sustained chords on five melodic
+	 * parts plus a rhythm part, which keeps a realistic number of partials
+	 * playing throughout.
+	 */
+	static void queueSong(MT32Emu::Synth &synth) {
+		static const uint8 programs[] = { 0, 48, 32, 61, 88 };
+		static const uint8 chords[][3] = { { 60, 64, 67 }, { 57, 60, 64 }, { 53, 57, 60 }, { 55, 59, 62 } };
+		const uint32 beat = kSampleRate / 4;
+
+		for (uint ch = 0; ch < ARRAYSIZE(programs); ++ch)
+			synth.playMsg(0xC1 + ch + (programs[ch] << 8), 0);
+
+		for (uint32 t = 0; t < kSongSeconds * 4; ++t) {
+			const uint8 *chord = chords[(t / 8) % ARRAYSIZE(chords)];
+			for (uint ch = 0; ch < ARRAYSIZE(programs); ++ch) {
+				const uint8 note = chord[(t + ch) % 3] - 12 * (ch == 2);
+				synth.playMsg(0x91 + ch + (note << 8) + (100 << 16), t * beat);
+				synth.playMsg(0x81 + ch + (note << 8), t * beat + beat - 1);
+			}
+			synth.playMsg(0x99 + (((t & 1) ? 38 : 36) << 8) + (110 << 16), t * beat);
+			synth.playMsg(0x99 + (42 << 8) + (90 << 16), t * beat + beat / 2);
+		}
+	}
+
+	static void runReverb(const char *name, MT32Emu::ReverbMode mode) {
+		MT32Emu::Sample inL[kBlockSize], inR[kBlockSize], outL[kBlockSize], outR[kBlockSize];
+		const uint blocks = kReverbSeconds * kSampleRate / kBlockSize;
+		uint32 seed = 1;
+
+		MT32Emu::BReverbModel reverb(mode);
+		reverb.open();
+		reverb.setParameters(5, 4);
+
+		Benchmark::Timer timer;
+		int sink = 0;
+		for (uint i = 0; i < blocks; ++i) {
+			for (uint j = 0; j < kBlockSize; ++j) {
+				inL[j] = noise(seed);
+				inR[j] = noise(seed);
+			}
+			reverb.process(inL, inR, outL, outR, kBlockSize);
+			sink += outL[i % kBlockSize] + outR[i % kBlockSize];
+		}
+		Benchmark::report(name, timer, blocks, kBlockSize, "sample");
+		TS_ASSERT(sink != 0x7FFFFFFF);
+
+		reverb.close();
+	}
+#endif
+
+public:
+	void test_reverb() {
+#ifdef USE_MT32EMU
+		runReverb("Reverb, room", MT32Emu::REVERB_MODE_ROOM);
+		runReverb("Reverb, hall", MT32Emu::REVERB_MODE_HALL);
+		runReverb("Reverb, plate", MT32Emu::REVERB_MODE_PLATE);
+		runReverb("Reverb, tap delay", MT32Emu::REVERB_MODE_TAP_DELAY);
+#endif
+	}
+
+	void test_render() {
+#ifdef USE_MT32EMU
+		Common::File *controlFile = openROM("MT32_CONTROL.ROM");
+		Common::File *pcmFile = openROM("MT32_PCM.ROM");
+		if (!controlFile || !pcmFile) {
+			printf("  Rendering skipped, set MT32_ROM_PATH to the directory of the MT-32 ROMs\n");
+			delete controlFile;
+			delete pcmFile;
+			return;
+		}
+
+		const MT32Emu::ROMImage *controlROM = MT32Emu::ROMImage::makeROMImage(controlFile);
+		const MT32Emu::ROMImage *pcmROM = MT32Emu::ROMImage::makeROMImage(pcmFile);
+
+		MT32Emu::Synth synth;
+		TS_ASSERT(synth.open(*controlROM, *pcmROM));
+		queueSong(synth);
+
+		MT32Emu::Sample buf[kBlockSize * 2];
+		const uint blocks = kSongSeconds * kSampleRate / kBlockSize;
+
+		Benchmark::Timer timer;
+		for (uint i = 0; i < blocks; ++i)
+			synth.render(buf, kBlockSize);
+		const double seconds = timer.getSeconds();
+		Benchmark::report("Render, 5 parts and rhythm", timer, blocks, kBlockSize, "frame");
+		printf("  %-44s %10.1f x realtime\n", "", kSongSeconds / seconds);
+
+		synth.close();
+		MT32Emu::ROMImage::freeROMImage(controlROM);
+		MT32Emu::ROMImage::freeROMImage(pcmROM);
+		delete controlFile;
+		delete pcmFile;
+#endif
+	}
+};
@@ -0,0 +1,223 @@
+#include <cxxtest/TestSuite.h>
+
+#include "audio/softsynth/opl/dbopl.h"
+#include "audio/softsynth/opl/dosbox.h"
+
+#include "common/array.h"
+#include "common/util.h"
+
+#include "benchmark.h"
+
+class OPLBenchmarkSuite : public CxxTest::TestSuite
+{
+#ifndef DISABLE_DOSBOX_OPL
+	typedef OPL::DOSBox::DBOPL::Chip Chip;
+
+	enum {
+		kRate = 44100,
+		kTickRate = 72,
+		kSeconds = 60,
+		kBufferSize = 512
+	};
+
+	struct RegisterWrite {
+		uint16 reg;
+		uint8 val;
+	};
+
+	/** The register writes of every timer tick. */
+	typedef Common::Array<Common::Array<RegisterWrite> > RegisterLog;
+
+	/** Modulator and carrier registers 20, 40, 60, 80 and E0, then C0. */
+	struct Instrument {
+		uint8 op[2][5];
+		uint8 c0;
+	};
+
+	static void write(RegisterLog &log, uint32 tick, uint16 reg, uint8 val) {
+		RegisterWrite w = { reg, val };
+		log[tick].push_back(w);
+	}
+
+	/** Operator register offsets of the melodic channels of one bank. */
+	static uint8 operatorOffset(uint channel) {
+		static const uint8 offsets[] = { 0, 1, 2, 8, 9, 10, 16, 17, 18 };
+		return offsets[channel];
+	}
+
+	static void setInstrument(RegisterLog &log, uint32 tick, uint16 bank, uint channel, const Instrument &ins, uint8 stereo) {
+		static const uint8 regs[] = { 0x20, 0x40, 0x60, 0x80, 0xE0 };
+		for (uint op = 0; op < 2; ++op)
+			for (uint r = 0; r < ARRAYSIZE(regs); ++r)
+				write(log, tick, bank + regs[r] + operatorOffset(channel) + op * 3, ins.op[op][r]);
+		write(log, tick, bank + 0xC0 + channel, ins.c0 | stereo);
+	}
+
+	static void setNote(RegisterLog &log, uint32 tick, uint16 bank, uint channel, uint note, bool keyOn) {
+		static const uint16 fnums[] = { 0x16B, 0x181, 0x198, 0x1B0, 0x1CA, 0x1E5, 0x202, 0x220, 0x241, 0x263, 0x287, 0x2AE };
+		const uint16 fnum = fnums[note % 12];
+		const uint8 block = MIN<uint>(note / 12, 7);
+		write(log, tick, bank + 0xA0 + channel, fnum & 0xFF);
+		write(log, tick, bank + 0xB0 + channel, (keyOn ? 0x20 : 0) | (block << 2) | (fnum >> 8));
+	}
+
+	static const Instrument &instrument(uint i) {
+		static const Instrument instruments[] = {
+			// Piano
+			{ { { 0x01, 0x4F, 0xF1, 0x53, 0x00 }, { 0x01, 0x00, 0xD2, 0x74, 0x00 } }, 0x06 },
+			// Strings, with vibrato
+			{ { { 0x61, 0x1A, 0x71, 0x06, 0x00 }, { 0x61, 0x00, 0x81, 0x17, 0x00 } }, 0x0C },
+			// Bass
+			{ { { 0x11, 0x8A, 0xF1, 0x11, 0x01 }, { 0x01, 0x40, 0xF1, 0xB3, 0x00 } }, 0x08 },
+			// Organ, additive with tremolo
+			{ { { 0xC1, 0x0E, 0xF3, 0x06, 0x02 }, { 0x81, 0x00, 0xF3, 0x06, 0x00 } }, 0x01 },
+			// Brass
+			{ { { 0x21, 0x16, 0x75, 0x35, 0x00 }, { 0x21, 0x00, 0x85, 0x16, 0x00 } }, 0x0A }
+		};
+		return instruments[i % ARRAYSIZE(instruments)];
+	}
+
+	/**
+	 * A music driver's output: every channel plays its own rhythm, and one
+	 * channel has its pitch updated on every tick for a software vibrato.
+	 */
+	static void addMelody(RegisterLog &log, uint16 bank, uint firstChannel, uint numChannels, uint8 stereo) {
+		const uint32 ticks = kSeconds * kTickRate;
+
+		for (uint ch = firstChannel; ch < firstChannel + numChannels; ++ch)
+			setInstrument(log, 0, bank, ch, instrument(ch + bank), stereo);
+
+		for (uint32 tick = 1; tick < ticks; ++tick) {
+			for (uint ch = firstChannel; ch < firstChannel + numChannels; ++ch) {
+				const uint period = 6 + ch * 2;
+				const uint note = 36 + ((tick / period) * 5 + ch * 7) % 36;
+				if (tick % period == 0)
+					setNote(log, tick, bank, ch, note, true);
+				else if (tick % period == period - 2)
+					setNote(log, tick, bank, ch, note, false);
+				else if (ch == firstChannel)
+					write(log, tick, bank + 0xA0 + ch, (tick * 3) & 0xFF);
+			}
+		}
+	}
+
+	/** Bass drum, snare and hi-hat patterns in rhythm mode. */
+	static void addDrums(RegisterLog &log) {
+		const uint32 ticks = kSeconds * kTickRate;
+
+		for (uint ch = 6; ch < 9; ++ch) {
+			setInstrument(log, 0, 0, ch, instrument(ch), 0);
+			setNote(log, 0, 0, ch, 30 + ch * 4, false);
+		}
+
+		for (uint32 tick = 1; tick < ticks; ++tick) {
+			uint8 drums = 0x01;
+			if (tick % 18 == 0)
+				drums |= 0x10;
+			if (tick % 18 == 9)
+				drums |= 0x08;
+			if (tick % 36 == 27)
+				drums |= 0x04 | 0x02;
+			write(log, tick, 0xBD, 0xE0);
+			write(log, tick, 0xBD, 0xE0 | drums);
+		}
+	}
+
+	static RegisterLog makeOPL2Log(bool rhythm) {
+		RegisterLog log;
+		log.resize(kSeconds * kTickRate);
+		write(log, 0, 0x01, 0x20);
+		write(log, 0, 0xBD, 0xC0);
+		addMelody(log, 0, 0, rhythm ? 6 : 9, 0);
+		if (rhythm)
+			addDrums(log);
+		return log;
+	}
+
+	static RegisterLog makeOPL3Log() {
+		RegisterLog log;
+		log.resize(kSeconds * kTickRate);
+		write(log, 0, 0x105, 0x01);
+		// Channels 0-2 and 9-11 form four operator voices with 3-5 and 12-14
+		write(log, 0, 0x104, 0x3F);
+		write(log, 0, 0xBD, 0xC0);
+		for (uint ch = 3; ch < 6; ++ch) {
+			setInstrument(log, 0, 0, ch, instrument(ch), 0);
+			setInstrument(log, 0, 0x100, ch, instrument(ch + 1), 0);
+		}
+		addMelody(log, 0, 0, 3, 0x30);
+		addMelody(log, 0, 6, 3, 0x10);
+		addMelody(log, 0x100, 0, 3, 0x30);
+		addMelody(log, 0x100, 6, 3, 0x20);
+		return log;
+	}
+
+	/**
+	 * Replay a log the way EmulatedOPL drives the chip: the writes of one
+	 * tick come from the timer callback, so the output is generated in
+	 * slices between the ticks. With more slices per tick, the cost of
+	 * slicing itself shows, as with drivers using a faster timer.
+	 */
+	static void play(const char *name, const RegisterLog &log, bool opl3, uint slicesPerTick = 1) {
+		const uint channels = opl3 ? 2 : 1;
+		const uint32 ticks = kSeconds * kTickRate;
+		int32 buffer[kBufferSize * 2];
+		int16 output[kBufferSize * 2];
+		int sink = 0;
+
+		OPL::DOSBox::DBOPL::InitTables();
+		Chip chip;
+		chip.Setup(kRate);
+
+		Benchmark::Timer timer;
+		for (uint32 tick = 0; tick < ticks; ++tick) {
+			for (uint i = 0; i < log[tick].size(); ++i)
+				chip.WriteReg(log[tick][i].reg, log[tick][i].val);
+
+			for (uint slice = 0; slice < slicesPerTick; ++slice) {
+				const uint32 slices = tick * slicesPerTick + slice;
+				uint samples = kRate * (slices + 1) / (kTickRate * slicesPerTick) - kRate * slices / (kTickRate * slicesPerTick);
+				while (samples > 0) {
+					const uint step = MIN<uint>(samples, kBufferSize);
+					if (opl3)
+						chip.GenerateBlock3(step, buffer);
+					else
+						chip.GenerateBlock2(step, buffer);
+					OPL::DOSBox::convertSamples(output, buffer, step * channels);
+					sink += output[step - 1];
+					samples -= step;
+				}
+			}
+		}
+		const double seconds = timer.getSeconds();
+		Benchmark::report(name, timer, 1, kSeconds * kRate, "frame");
+		printf("  %-44s %10.1f x realtime\n", "", kSeconds / seconds);
+		TS_ASSERT(sink != 0x7FFFFFFF);
+	}
+#endif
+
+public:
+	void test_opl2() {
+#ifndef DISABLE_DOSBOX_OPL
+		play("OPL2, 9 melodic channels", makeOPL2Log(false), false);
+#endif
+	}
+
+	void test_opl2_sliced() {
+#ifndef DISABLE_DOSBOX_OPL
+		play("OPL2, 9 melodic channels, 16 slices per tick", makeOPL2Log(false), false, 16);
+#endif
+	}
+
+	void test_opl2_rhythm() {
+#ifndef DISABLE_DOSBOX_OPL
+		play("OPL2, 6 melodic channels and rhythm", makeOPL2Log(true), false);
+#endif
+	}
+
+	void test_opl3() {
+#ifndef DISABLE_DOSBOX_OPL
+		play("OPL3, 4-op voices and stereo", makeOPL3Log(), true);
+#endif
+	}
+};
@@ -0,0 +1,78 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/util.h"
+#include "graphics/palette_lut.h"
+
+#include "benchmark.h"
+
+class PaletteLUTBenchmarkSuite : public CxxTest::TestSuite
+{
+	struct Resolution {
+		uint w, h;
+		const char *name;
+	};
+
+	/** The old per pixel path, kept as the reference point. */
+	template<typename T>
+	static void convertRGBToColor(T *dst, const byte *src, uint count, const byte *colors, const Graphics::PixelFormat &format) {
+		for (uint i = 0; i < count; ++i) {
+			const byte *c = colors + src[i] * 3;
+			dst[i] = format.RGBToColor(c[0], c[1], c[2]);
+		}
+	}
+
+	template<typename T>
+	static void run(const Graphics::PixelFormat &format, const char *formatName) {
+		static const Resolution resolutions[] = {
+			{ 320, 200, "320x200" },
+			{ 640, 480, "640x480" },
+			{ 800, 600, "800x600" }
+		};
+
+		byte colors[256 * 3];
+		for (int i = 0; i < 256 * 3; ++i)
+			colors[i] = (i * 13) & 0xFF;
+
+		Graphics::PaletteLUT lut(format);
+		lut.setPalette(colors, 0, 256);
+
+		for (uint r = 0; r < ARRAYSIZE(resolutions); ++r) {
+			const uint w = resolutions[r].w, h = resolutions[r].h;
+			const uint count = w * h;
+			// Roughly the same amount of work for every resolution
+			const uint frames = 100000000 / count;
+
+			byte *src = new byte[count];
+			T *dst = new T[count];
+			for (uint i = 0; i < count; ++i)
+				src[i] = (i * 2654435761U) >> 24;
+
+			char name[64];
+
+			Benchmark::Timer reference;
+			for (uint f = 0; f < frames; ++f)
+				convertRGBToColor<T>(dst, src, count, colors, format);
+			snprintf(name, sizeof(name), "%s %s RGBToColor", resolutions[r].name, formatName);
+			Benchmark::report(name, reference, frames, count, "pixel");
+
+			Benchmark::Timer table;
+			for (uint f = 0; f < frames; ++f)
+				lut.convert((byte *)dst, w * sizeof(T), src, w, w, h);
+			snprintf(name, sizeof(name), "%s %s PaletteLUT", resolutions[r].name, formatName);
+			Benchmark::report(name, table, frames, count, "pixel");
+
+			delete[] src;
+			delete[] dst;
+		}
+	}
+
+	public:
+	void test_clut8_to_rgb565() {
+		printf("\n");
+		run<uint16>(Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0), "RGB565");
+	}
+
+	void test_clut8_to_xrgb8888() {
+		run<uint32>(Graphics::PixelFormat(4, 8, 8, 8, 0, 16, 8, 0, 0), "XRGB8888");
+	}
+};
@@ -0,0 +1,121 @@
+#include <cxxtest/TestSuite.h>
+
+#include "audio/audiostream.h"
+#include "audio/rate.h"
+
+#include "common/util.h"
+
+#include <math.h>
+
+#include "benchmark.h"
+
+class RateBenchmarkSuite : public CxxTest::TestSuite
+{
+	enum {
+		kBufferSize = 1024,
+		kFrames = 20000000,
+		kQualityFrames = 65536
+	};
+
+	/** A full scale sine, computed in double precision. */
+	class SineStream : public Audio::AudioStream {
+	public:
+		SineStream(int rate, double frequency, bool stereo)
+			: _rate(rate), _frequency(frequency), _stereo(stereo), _pos(0) {}
+
+		int readBuffer(int16 *buffer, const int numSamples) {
+			for (int i = 0; i < numSamples; ) {
+				const int16 value = (int16)floor(30000.0 * sin(2 * M_PI * _frequency * _pos / _rate) + 0.5);
+				buffer[i++] = value;
+				if (_stereo)
+					buffer[i++] = value;
+				++_pos;
+			}
+			return numSamples;
+		}
+
+		bool isStereo() const { return _stereo; }
+		int getRate() const { return _rate; }
+		bool endOfData() const { return false; }
+
+	private:
+		int _rate;
+		double _frequency;
+		bool _stereo;
+		uint _pos;
+	};
+
+	/**
+	 * The level of everything but the test tone, relative to it: the tone
+	 * is fitted by least squares and the residual is noise and distortion.
+	 */
+	static double thdn(const int16 *buf, uint frames, double frequency, uint rate) {
+		double ss = 0, sc = 0, cc = 0, ys = 0, yc = 0;
+		for (uint i = 0; i < frames; ++i) {
+			const double s = sin(2 * M_PI * frequency * i / rate);
+			const double c = cos(2 * M_PI * frequency * i / rate);
+			ss += s * s;
+			sc += s * c;
+			cc += c * c;
+			ys += buf[i * 2] * s;
+			yc += buf[i * 2] * c;
+		}
+
+		const double det = ss * cc - sc * sc;
+		const double a = (ys * cc - yc * sc) / det;
+		const double b = (yc * ss - ys * sc) / det;
+
+		double signal = 0, residual = 0;
+		for (uint i = 0; i < frames; ++i) {
+			const double fit = a * sin(2 * M_PI * frequency * i / rate) + b * cos(2 * M_PI * frequency * i / rate);
+			signal += fit * fit;
+			residual += (buf[i * 2] - fit) * (buf[i * 2] - fit);
+		}
+
+		return 10 * log10(residual / signal);
+	}
+
+	static void run(uint inRate, uint outRate, bool stereo) {
+		static const char *const names[] = { "default", "sinc" };
+		int16 *buf = new int16[kQualityFrames * 2];
+
+		for (uint i = 0; i < ARRAYSIZE(names); ++i) {
+			Audio::RateConverter *speedConverter = i ? Audio::makeSincRateConverter(inRate, outRate, stereo) : Audio::makeRateConverter(inRate, outRate, stereo);
+			Audio::RateConverter *qualityConverter = i ? Audio::makeSincRateConverter(inRate, outRate, stereo) : Audio::makeRateConverter(inRate, outRate, stereo);
+			SineStream speedInput(inRate, 440.0, stereo);
+			SineStream qualityInput(inRate, 1000.0, stereo);
+
+			Benchmark::Timer timer;
+			for (uint done = 0; done < kFrames; done += kBufferSize)
+				speedConverter->resample(speedInput, buf, kBufferSize);
+
+			char name[64];
+			snprintf(name, sizeof(name), "%5u -> %5u %s %s", inRate, outRate, stereo ? "stereo" : "mono  ", names[i]);
+			Benchmark::report(name, timer, kFrames / kBufferSize, kBufferSize, "frame");
+
+			// Skip the start, where the filter is still filling up
+			qualityConverter->resample(qualityInput, buf, kBufferSize);
+			qualityConverter->resample(qualityInput, buf, kQualityFrames);
+			printf("  %-44s %10.1f dB THD+N\n", "", thdn(buf, kQualityFrames, 1000.0, outRate));
+
+			delete speedConverter;
+			delete qualityConverter;
+		}
+
+		delete[] buf;
+	}
+
+	public:
+	void test_upsample() {
+		printf("\n");
+		run(11025, 44100, false);
+		run(22050, 44100, true);
+		run(22050, 48000, false);
+		run(44100, 48000, true);
+	}
+
+	void test_downsample() {
+		run(48000, 44100, true);
+		run(44100, 22050, false);
+	}
+};
@@ -0,0 +1,74 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/util.h"
+#include "graphics/transparent_surface.h"
+
+#include "benchmark.h"
+
+class TransparentSurfaceBenchmarkSuite : public CxxTest::TestSuite
+{
+	struct Mode {
+		Graphics::AlphaType alphaMode;
+		uint color;
+		Graphics::TSpriteBlendMode blend;
+		bool premultiplied;
+		const char *name;
+	};
+
+	static void run(int flipping, const char *flipName) {
+		// Sprite sizes as blitted by Wintermute, Sword25 and the GUI
+		static const uint sizes[] = { 32, 64, 128, 512 };
+		static const Mode modes[] = {
+			{ Graphics::ALPHA_OPAQUE, 0xFFFFFFFF, Graphics::BLEND_NORMAL, false, "opaque" },
+			{ Graphics::ALPHA_BINARY, 0xFFFFFFFF, Graphics::BLEND_NORMAL, false, "binary" },
+			{ Graphics::ALPHA_FULL, 0xFFFFFFFF, Graphics::BLEND_NORMAL, false, "alpha" },
+			{ Graphics::ALPHA_FULL, 0xFFFFFFFF, Graphics::BLEND_NORMAL, true, "alpha premultiplied" },
+			{ Graphics::ALPHA_FULL, 0xC0FF8040, Graphics::BLEND_NORMAL, false, "alpha tinted" },
+			{ Graphics::ALPHA_FULL, 0xFFFFFFFF, Graphics::BLEND_ADDITIVE, false, "additive" }
+		};
+
+		const Graphics::PixelFormat format = Graphics::TransparentSurface::getSupportedPixelFormat();
+
+		for (uint s = 0; s < ARRAYSIZE(sizes); ++s) {
+			const uint size = sizes[s];
+			// Roughly the same amount of work for every size
+			const uint blits = 20000000 / (size * size);
+
+			Graphics::TransparentSurface sprite, premultipliedSprite;
+			sprite.create(size, size, format);
+			for (uint i = 0; i < size * size; ++i)
+				((uint32 *)sprite.getPixels())[i] = i * 2654435761U;
+			premultipliedSprite.copyFrom(sprite);
+			premultipliedSprite.premultiplyAlpha();
+
+			Graphics::Surface dst;
+			dst.create(size, size, format);
+
+			for (uint m = 0; m < ARRAYSIZE(modes); ++m) {
+				Graphics::TransparentSurface &src = modes[m].premultiplied ? premultipliedSprite : sprite;
+				src.setAlphaMode(modes[m].alphaMode);
+
+				Benchmark::Timer timer;
+				for (uint b = 0; b < blits; ++b)
+					src.blit(dst, 0, 0, flipping, nullptr, modes[m].color, -1, -1, modes[m].blend);
+
+				char name[64];
+				snprintf(name, sizeof(name), "%ux%u %s%s", size, size, modes[m].name, flipName);
+				Benchmark::report(name, timer, blits, size * size, "pixel");
+			}
+
+			sprite.free();
+			premultipliedSprite.free();
+			dst.free();
+		}
+	}
+
+public:
+	void test_blit() {
+		run(Graphics::FLIP_NONE, "");
+	}
+
+	void test_blit_flipped() {
+		run(Graphics::FLIP_H, " flipped");
+	}
+};
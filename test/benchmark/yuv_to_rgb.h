@@ -0,0 +1,71 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/util.h"
+#include "graphics/surface.h"
+#include "graphics/yuv_to_rgb.h"
+
+#include "benchmark.h"
+
+class YUVToRGBBenchmarkSuite : public CxxTest::TestSuite
+{
+	struct Resolution {
+		uint w, h;
+		const char *name;
+	};
+
+	static void run(bool is420, const Graphics::PixelFormat &format, const char *formatName) {
+		static const Resolution resolutions[] = {
+			{ 320, 240, "320x240" },
+			{ 640, 480, "640x480" },
+			{ 1280, 720, "1280x720" }
+		};
+
+		for (uint r = 0; r < ARRAYSIZE(resolutions); ++r) {
+			const uint w = resolutions[r].w, h = resolutions[r].h;
+			const uint uvW = is420 ? w / 2 : w, uvH = is420 ? h / 2 : h;
+			// Roughly the same amount of work for every resolution
+			const uint frames = 50000000 / (w * h);
+
+			byte *y = new byte[w * h];
+			byte *u = new byte[uvW * uvH];
+			byte *v = new byte[uvW * uvH];
+			for (uint i = 0; i < w * h; ++i)
+				y[i] = (i * 2654435761U) >> 24;
+			for (uint i = 0; i < uvW * uvH; ++i) {
+				u[i] = (i * 2246822519U) >> 24;
+				v[i] = (i * 3266489917U) >> 24;
+			}
+
+			Graphics::Surface dst;
+			dst.create(w, h, format);
+
+			Benchmark::Timer timer;
+			for (uint f = 0; f < frames; ++f) {
+				if (is420)
+					YUVToRGBMan.convert420(&dst, Graphics::YUVToRGBManager::kScaleITU, y, u, v, w, h, w, uvW);
+				else
+					YUVToRGBMan.convert444(&dst, Graphics::YUVToRGBManager::kScaleITU, y, u, v, w, h, w, uvW);
+			}
+
+			char name[64];
+			snprintf(name, sizeof(name), "%s %s %s", is420 ? "420" : "444", resolutions[r].name, formatName);
+			Benchmark::report(name, timer, frames, w * h, "pixel");
+
+			dst.free();
+			delete[] y;
+			delete[] u;
+			delete[] v;
+		}
+	}
+
+public:
+	void test_convert420() {
+		run(true, Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0), "RGB565");
+		run(true, Graphics::PixelFormat(4, 8, 8, 8, 0, 16, 8, 0, 0), "XRGB8888");
+	}
+
+	void test_convert444() {
+		run(false, Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0), "RGB565");
+		run(false, Graphics::PixelFormat(4, 8, 8, 8, 0, 16, 8, 0, 0), "XRGB8888");
+	}
+};
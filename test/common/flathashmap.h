@@ -0,0 +1,178 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/flathashmap.h"
+#include "common/hashmap.h"
+#include "common/hash-str.h"
+
+class FlatHashMapTestSuite : public CxxTest::TestSuite
+{
+	typedef Common::FlatHashMap<Common::String, Common::String, Common::IgnoreCase_Hash, Common::IgnoreCase_EqualTo> FlatStringMap;
+
+	public:
+	void test_empty_clear() {
+		Common::FlatHashMap<int, int> container;
+		TS_ASSERT(container.empty());
+		container[0] = 17;
+		container[1] = 33;
+		TS_ASSERT(!container.empty());
+		container.clear();
+		TS_ASSERT(container.empty());
+
+		FlatStringMap container2;
+		TS_ASSERT(container2.empty());
+		container2["foo"] = "bar";
+		container2["quux"] = "blub";
+		TS_ASSERT(!container2.empty());
+		container2.clear(true);
+		TS_ASSERT(container2.empty());
+		TS_ASSERT(!container2.contains("foo"));
+	}
+
+	void test_contains() {
+		Common::FlatHashMap<int, int> container;
+		container[0] = 17;
+		container[1] = 33;
+		TS_ASSERT(container.contains(0));
+		TS_ASSERT(container.contains(1));
+		TS_ASSERT(!container.contains(17));
+		TS_ASSERT(!container.contains(-1));
+
+		FlatStringMap container2;
+		container2["foo"] = "bar";
+		container2["quux"] = "blub";
+		TS_ASSERT(container2.contains("foo"));
+		TS_ASSERT(container2.contains("QUUX"));
+		TS_ASSERT(container2.contains(Common::String("quux")));
+		TS_ASSERT(!container2.contains("bar"));
+		TS_ASSERT(!container2.contains("asdf"));
+	}
+
+	void test_const_char_lookup() {
+		Common::FlatHashMap<Common::String, int, Common::CaseSensitiveString_Hash, Common::CaseSensitiveString_EqualTo> container;
+		const char *key = "a rather long key which does not fit into a String's inline storage";
+		container[key] = 5;
+		container["Key"] = 7;
+
+		TS_ASSERT_EQUALS(container.getVal(key, 0), 5);
+		TS_ASSERT_EQUALS(container.getVal("Key", 0), 7);
+		TS_ASSERT_EQUALS(container.getVal("key", 0), 0);
+		TS_ASSERT(container.find("Key") != container.end());
+		TS_ASSERT_EQUALS(container.find("Key")->_value, 7);
+
+		container.erase(key);
+		TS_ASSERT(!container.contains(key));
+		TS_ASSERT_EQUALS(container.size(), 1U);
+	}
+
+	void test_add_remove_iterator() {
+		Common::FlatHashMap<int, int> container;
+		container[0] = 17;
+		container[1] = 33;
+		container[2] = 45;
+		TS_ASSERT(container.contains(1));
+		container.erase(container.find(1));
+		TS_ASSERT(!container.contains(1));
+		container[1] = 42;
+		TS_ASSERT_EQUALS(container[1], 42);
+		container.erase(container.find(0));
+		container.erase(container.find(1));
+		container.erase(container.find(2));
+		TS_ASSERT(container.empty());
+		TS_ASSERT(container.find(2) == container.end());
+	}
+
+	void test_lookup_with_default() {
+		Common::FlatHashMap<int, int> container;
+		container[0] = 17;
+		container[1] = -1;
+
+		const Common::FlatHashMap<int, int> &containerRef = container;
+
+		TS_ASSERT_EQUALS(containerRef.getVal(0), 17);
+		TS_ASSERT_EQUALS(containerRef[1], -1);
+		TS_ASSERT_EQUALS(containerRef.getVal(17), 0);
+		TS_ASSERT_EQUALS(containerRef.getVal(0, -10), 17);
+		TS_ASSERT_EQUALS(containerRef.getVal(17, -10), -10);
+		TS_ASSERT_EQUALS(container.size(), 2U);
+	}
+
+	void test_iterator() {
+		Common::FlatHashMap<int, int> container;
+		TS_ASSERT_EQUALS(container.begin(), container.end());
+
+		container[0] = 17;
+		container[1] = 33;
+		container[2] = 45;
+		container[3] = 12;
+		container[4] = 96;
+		container.erase(1);
+		container[1] = 42;
+		container.erase(0);
+		container.erase(1);
+
+		int found = 0;
+		Common::FlatHashMap<int, int>::const_iterator i;
+		for (i = container.begin(); i != container.end(); ++i) {
+			int key = i->_key;
+			TS_ASSERT(key >= 0 && key <= 4);
+			TS_ASSERT(!(found & (1 << key)));
+			found |= 1 << key;
+		}
+		TS_ASSERT(found == 16+8+4);
+	}
+
+	void test_copy() {
+		FlatStringMap map1, map2;
+		for (int i = 0; i < 100; ++i)
+			map1[Common::String::format("key%d", i)] = Common::String::format("value%d", i);
+		map1.erase("key50");
+
+		map2 = map1;
+		FlatStringMap map3(map1);
+		map1.clear();
+
+		TS_ASSERT_EQUALS(map2.size(), 99U);
+		TS_ASSERT_EQUALS(map3.size(), 99U);
+		TS_ASSERT_EQUALS(map2["KEY99"], "value99");
+		TS_ASSERT_EQUALS(map3.getVal("key0"), "value0");
+		TS_ASSERT(!map3.contains("key50"));
+	}
+
+	void test_reserve() {
+		Common::FlatHashMap<int, int> container;
+		container[1] = 2;
+		container.reserve(1000);
+		for (int i = 0; i < 1000; ++i)
+			container[i * 7] = i;
+		for (int i = 0; i < 1000; ++i)
+			TS_ASSERT_EQUALS(container.getVal(i * 7, -1), i);
+	}
+
+	void test_against_hashmap() {
+		// Mixed inserts and erases, which leave plenty of erased slots
+		Common::FlatHashMap<uint, uint> flat;
+		Common::HashMap<uint, uint> reference;
+
+		uint seed = 1;
+		for (int i = 0; i < 20000; ++i) {
+			seed = seed * 1103515245 + 12345;
+			const uint key = (seed >> 16) % 2000 * 64;
+			if (seed & 0x80000000) {
+				flat.erase(key);
+				reference.erase(key);
+			} else {
+				flat[key] = i;
+				reference[key] = i;
+			}
+		}
+
+		TS_ASSERT_EQUALS(flat.size(), reference.size());
+		for (Common::HashMap<uint, uint>::const_iterator i = reference.begin(); i != reference.end(); ++i)
+			TS_ASSERT_EQUALS(flat.getVal(i->_key, (uint)-1), i->_value);
+
+		uint count = 0;
+		for (Common::FlatHashMap<uint, uint>::const_iterator i = flat.begin(); i != flat.end(); ++i, ++count)
+			TS_ASSERT(reference.contains(i->_key));
+		TS_ASSERT_EQUALS(count, reference.size());
+	}
+};
@@ -230,5 +230,15 @@ class HashMapTestSuite : public CxxTest::TestSuite
 		TS_ASSERT(found == 16+8+4);
 }
 
+	void test_reserve() {
+		Common::HashMap<int, int> container;
+		container[1] = 2;
+		container.reserve(1000);
+		for (int i = 0; i < 1000; ++i)
+			container[i * 7] = i;
+		for (int i = 0; i < 1000; ++i)
+			TS_ASSERT_EQUALS(container.getVal(i * 7, -1), i);
+	}
+
 	// TODO: Add test cases for iterators, find, ...
 };
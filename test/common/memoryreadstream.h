@@ -104,4 +104,24 @@ class MemoryReadStreamTestSuite : public CxxTest::TestSuite {
 		ms.seek(0, SEEK_SET);
 		TS_ASSERT(!ms.eos());
 	}
+
+	void test_borrow() {
+		byte contents[] = { 1, 2, 3, 4, 5, 6, 7 };
+		Common::MemoryReadStream ms(contents, sizeof(contents));
+
+		ms.seek(2);
+		const byte *data = ms.borrow(3);
+		TS_ASSERT_EQUALS(data, contents + 2);
+		TS_ASSERT_EQUALS(ms.pos(), 5);
+
+		// Borrowing past the end fails and leaves the stream alone
+		TS_ASSERT(ms.borrow(3) == 0);
+		TS_ASSERT_EQUALS(ms.pos(), 5);
+		TS_ASSERT(!ms.eos());
+		TS_ASSERT_EQUALS(ms.readByte(), 6);
+
+		TS_ASSERT(ms.borrow(1) != 0);
+		TS_ASSERT(ms.borrow(0) != 0);
+		TS_ASSERT_EQUALS(ms.pos(), 7);
+	}
 };
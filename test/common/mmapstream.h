@@ -0,0 +1,179 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/scummsys.h"
+#include "common/ptr.h"
+#include "common/str.h"
+
+#include "backends/fs/posix/mmapstream.h"
+#include "backends/fs/stdiostream.h"
+
+#if defined(HAVE_MMAP)
+#include <stdio.h>
+#endif
+
+/**
+ * The tests map a temporary file in the current directory, which is a
+ * little larger than the smallest file MmapReadStream is willing to map. Without mmap support
+ * there is nothing to test, and the tests pass trivially.
+ */
+class MmapReadStreamTestSuite : public CxxTest::TestSuite {
+#if defined(HAVE_MMAP)
+	Common::String _path;
+
+	static byte getFileByte(uint32 offset) {
+		return (offset * 7 + (offset >> 8)) & 0xFF;
+	}
+
+	static uint32 getFileSize() {
+		return MmapReadStream::kMinMapSize + 1000;
+	}
+
+	/** Writes the temporary file, returns false if it could not be created. */
+	bool createFile(uint32 size) {
+		_path = "mmapstream-test.tmp";
+		Common::ScopedPtr<StdioStream> file(StdioStream::makeFromPath(_path, true));
+		if (!file)
+			return false;
+
+		for (uint32 offset = 0; offset < size; ++offset)
+			file->writeByte(getFileByte(offset));
+
+		return file->flush() && !file->err();
+	}
+
+	bool matchesFile(const byte *data, uint32 offset, uint32 size) {
+		for (uint32 i = 0; i < size; ++i) {
+			if (data[i] != getFileByte(offset + i))
+				return false;
+		}
+		return true;
+	}
+#endif
+
+public:
+	void tearDown() {
+#if defined(HAVE_MMAP)
+		if (!_path.empty()) {
+			remove(_path.c_str());
+			_path.clear();
+		}
+#endif
+	}
+
+	void test_read() {
+#if defined(HAVE_MMAP)
+		TS_ASSERT(createFile(getFileSize()));
+		Common::ScopedPtr<MmapReadStream> stream(MmapReadStream::makeFromPath(_path));
+		TS_ASSERT(stream);
+		if (!stream)
+			return;
+
+		TS_ASSERT_EQUALS(stream->size(), (int32)getFileSize());
+		TS_ASSERT_EQUALS(stream->pos(), 0);
+
+		byte buffer[300];
+		TS_ASSERT_EQUALS(stream->read(buffer, sizeof(buffer)), sizeof(buffer));
+		TS_ASSERT(matchesFile(buffer, 0, sizeof(buffer)));
+		TS_ASSERT_EQUALS(stream->pos(), (int32)sizeof(buffer));
+		TS_ASSERT(!stream->eos());
+
+		TS_ASSERT(stream->seek(40000));
+		TS_ASSERT_EQUALS(stream->read(buffer, sizeof(buffer)), sizeof(buffer));
+		TS_ASSERT(matchesFile(buffer, 40000, sizeof(buffer)));
+
+		// Reading across the end returns what is left, and sets eos
+		TS_ASSERT(stream->seek(-100, SEEK_END));
+		TS_ASSERT_EQUALS(stream->read(buffer, sizeof(buffer)), 100u);
+		TS_ASSERT(matchesFile(buffer, getFileSize() - 100, 100));
+		TS_ASSERT_EQUALS(stream->pos(), (int32)getFileSize());
+		TS_ASSERT(stream->eos());
+
+		stream->clearErr();
+		TS_ASSERT(!stream->eos());
+#endif
+	}
+
+	void test_seek_past_end() {
+#if defined(HAVE_MMAP)
+		TS_ASSERT(createFile(getFileSize()));
+		Common::ScopedPtr<MmapReadStream> stream(MmapReadStream::makeFromPath(_path));
+		TS_ASSERT(stream);
+		if (!stream)
+			return;
+
+		TS_ASSERT(stream->seek(500));
+
+		// Seeks outside of the file fail and leave the position alone
+		TS_ASSERT(!stream->seek(getFileSize() + 1));
+		TS_ASSERT_EQUALS(stream->pos(), 500);
+		TS_ASSERT(!stream->seek(1, SEEK_END));
+		TS_ASSERT_EQUALS(stream->pos(), 500);
+		TS_ASSERT(!stream->seek(-501, SEEK_CUR));
+		TS_ASSERT_EQUALS(stream->pos(), 500);
+		TS_ASSERT(!stream->eos());
+
+		// Seeking to the very end is fine, but there is nothing to read there
+		TS_ASSERT(stream->seek(0, SEEK_END));
+		TS_ASSERT_EQUALS(stream->pos(), (int32)getFileSize());
+		TS_ASSERT(!stream->eos());
+
+		byte b;
+		TS_ASSERT_EQUALS(stream->read(&b, 1), 0u);
+		TS_ASSERT(stream->eos());
+		TS_ASSERT(!stream->borrow(1));
+
+		// A seek clears eos again
+		TS_ASSERT(stream->seek(-1, SEEK_CUR));
+		TS_ASSERT(!stream->eos());
+		TS_ASSERT_EQUALS(stream->read(&b, 1), 1u);
+		TS_ASSERT_EQUALS(b, getFileByte(getFileSize() - 1));
+#endif
+	}
+
+	void test_borrow() {
+#if defined(HAVE_MMAP)
+		TS_ASSERT(createFile(getFileSize()));
+		Common::ScopedPtr<MmapReadStream> stream(MmapReadStream::makeFromPath(_path));
+		TS_ASSERT(stream);
+		if (!stream)
+			return;
+
+		TS_ASSERT(stream->seek(1000));
+		const byte *first = stream->borrow(5000);
+		TS_ASSERT(first);
+		TS_ASSERT_EQUALS(stream->pos(), 6000);
+		TS_ASSERT(matchesFile(first, 1000, 5000));
+
+		// Borrowing more than is left fails and does not move the stream
+		TS_ASSERT(!stream->borrow(getFileSize()));
+		TS_ASSERT_EQUALS(stream->pos(), 6000);
+
+		const byte *last = stream->borrow(getFileSize() - 6000);
+		TS_ASSERT(last);
+		TS_ASSERT(!stream->eos());
+		TS_ASSERT_EQUALS(stream->pos(), (int32)getFileSize());
+
+		// The borrowed data stays valid for as long as the stream exists:
+		// moving the stream around and removing the file does not affect it.
+		byte buffer[100];
+		TS_ASSERT(stream->seek(0));
+		TS_ASSERT_EQUALS(stream->read(buffer, sizeof(buffer)), sizeof(buffer));
+		TS_ASSERT(stream->seek(-50, SEEK_END));
+		TS_ASSERT_EQUALS(stream->read(buffer, sizeof(buffer)), 50u);
+		TS_ASSERT_EQUALS(remove(_path.c_str()), 0);
+		_path.clear();
+
+		TS_ASSERT(matchesFile(first, 1000, 5000));
+		TS_ASSERT(matchesFile(last, 6000, getFileSize() - 6000));
+#endif
+	}
+
+	void test_small_file() {
+#if defined(HAVE_MMAP)
+		// Small files are left to StdioStream
+		TS_ASSERT(createFile(MmapReadStream::kMinMapSize - 1));
+		Common::ScopedPtr<MmapReadStream> stream(MmapReadStream::makeFromPath(_path));
+		TS_ASSERT(!stream);
+#endif
+	}
+};
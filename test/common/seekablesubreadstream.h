@@ -70,4 +70,33 @@ class SeekableSubReadStreamTestSuite : public CxxTest::TestSuite {
 		b = ssrs.readByte();
 		TS_ASSERT_EQUALS(b, 1);
 	}
+
+	void test_borrow() {
+		byte contents[10] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+		Common::MemoryReadStream ms(contents, 10);
+
+		Common::SeekableSubReadStream ssrs(&ms, 2, 8);
+
+		ssrs.seek(1);
+		const byte *data = ssrs.borrow(4);
+		TS_ASSERT_EQUALS(data, contents + 3);
+		TS_ASSERT_EQUALS(ssrs.pos(), 5);
+
+		// The parent has more data, but the substream ends before it
+		TS_ASSERT(ssrs.borrow(2) == 0);
+		TS_ASSERT_EQUALS(ssrs.pos(), 5);
+		TS_ASSERT_EQUALS(ssrs.readByte(), 7);
+	}
+
+	void test_safe_borrow() {
+		byte contents[10] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+		Common::MemoryReadStream ms(contents, 10);
+
+		Common::SafeSeekableSubReadStream ssrs(&ms, 4, 10);
+
+		ms.seek(0);
+		TS_ASSERT_EQUALS(ssrs.borrow(2), contents + 4);
+		ms.seek(9);
+		TS_ASSERT_EQUALS(ssrs.borrow(2), contents + 6);
+	}
 };
@@ -0,0 +1,115 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/spscqueue.h"
+#include "common/thread.h"
+
+class SPSCQueueTestSuite : public CxxTest::TestSuite
+{
+	enum {
+		kTransferCount = 200000
+	};
+
+	struct Transfer {
+		Common::SPSCQueue<uint32> *queue;
+		bool bulk;
+	};
+
+	static void producer(void *param) {
+		Transfer *transfer = (Transfer *)param;
+		uint32 next = 0;
+		while (next < kTransferCount) {
+			if (transfer->bulk) {
+				uint32 block[7];
+				const uint count = MIN<uint>(ARRAYSIZE(block), kTransferCount - next);
+				for (uint i = 0; i < count; ++i)
+					block[i] = next + i;
+				next += transfer->queue->write(block, count);
+			} else if (transfer->queue->push(next)) {
+				next++;
+			}
+		}
+	}
+
+	static void runTransfer(bool bulk) {
+		Common::SPSCQueue<uint32> queue(64);
+		Transfer transfer;
+		transfer.queue = &queue;
+		transfer.bulk = bulk;
+
+		Common::Thread thread;
+		TS_ASSERT(thread.start(producer, &transfer));
+		TS_ASSERT(!thread.isCurrent());
+
+		uint32 expected = 0;
+		bool inOrder = true;
+		while (expected < kTransferCount) {
+			uint32 block[5];
+			const uint count = bulk ? queue.read(block, ARRAYSIZE(block)) : queue.pop(block[0]);
+			for (uint i = 0; i < count; ++i)
+				inOrder &= (block[i] == expected++);
+		}
+
+		thread.join();
+		TS_ASSERT(inOrder);
+		TS_ASSERT(queue.empty());
+	}
+
+	public:
+	void test_push_pop() {
+		Common::SPSCQueue<int> queue(4);
+		TS_ASSERT(queue.empty());
+		TS_ASSERT_EQUALS(queue.getFree(), 4U);
+
+		int value = 0;
+		TS_ASSERT(!queue.pop(value));
+		TS_ASSERT(queue.peek() == 0);
+
+		// Go around the end of the buffer a few times
+		for (int i = 0; i < 10; ++i) {
+			TS_ASSERT(queue.push(i * 2));
+			TS_ASSERT(queue.push(i * 2 + 1));
+			TS_ASSERT_EQUALS(queue.size(), 2U);
+
+			TS_ASSERT_EQUALS(*queue.peek(), i * 2);
+			queue.drop();
+			TS_ASSERT(queue.pop(value));
+			TS_ASSERT_EQUALS(value, i * 2 + 1);
+		}
+
+		for (int i = 0; i < 4; ++i)
+			TS_ASSERT(queue.push(i));
+		TS_ASSERT(!queue.push(4));
+		TS_ASSERT_EQUALS(queue.getFree(), 0U);
+	}
+
+	void test_write_read() {
+		Common::SPSCQueue<int16> queue(8);
+		const int16 data[] = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10 };
+		int16 out[10];
+
+		TS_ASSERT_EQUALS(queue.write(data, 5), 5U);
+		TS_ASSERT_EQUALS(queue.read(out, 3), 3U);
+		TS_ASSERT_EQUALS(out[0], 1);
+		TS_ASSERT_EQUALS(out[2], 3);
+
+		// Only 6 more fit, wrapping around the end
+		TS_ASSERT_EQUALS(queue.write(data, 10), 6U);
+		TS_ASSERT_EQUALS(queue.size(), 8U);
+
+		TS_ASSERT_EQUALS(queue.read(out, 10), 8U);
+		const int16 expected[] = { 4, 5, 1, 2, 3, 4, 5, 6 };
+		for (int i = 0; i < 8; ++i)
+			TS_ASSERT_EQUALS(out[i], expected[i]);
+
+		TS_ASSERT_EQUALS(queue.read(out, 10), 0U);
+		TS_ASSERT(queue.empty());
+	}
+
+	void test_threads() {
+		if (!Common::Thread::isSupported())
+			return;
+
+		runTransfer(false);
+		runTransfer(true);
+	}
+};
@@ -0,0 +1,294 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/archive.h"
+#include "common/memstream.h"
+#include "common/ptr.h"
+#include "common/unzip.h"
+
+/**
+ * Python's zipfile module created the archive: "stored.txt" is stored,
+ * "Dir/Small.bin" (1000 bytes) and "large.bin" (300000 bytes) are deflated
+ * and follow the pattern in getPatternByte().
+ */
+static const byte zipData[] = {
+		0x50, 0x4B, 0x03, 0x04, 0x14, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x21, 0x00, 0xCD, 0xBA,
+		0xB6, 0xB7, 0x15, 0x00, 0x00, 0x00, 0x15, 0x00, 0x00, 0x00, 0x0A, 0x00, 0x00, 0x00, 0x73, 0x74,
+		0x6F, 0x72, 0x65, 0x64, 0x2E, 0x74, 0x78, 0x74, 0x48, 0x65, 0x6C, 0x6C, 0x6F, 0x2C, 0x20, 0x73,
+		0x74, 0x6F, 0x72, 0x65, 0x64, 0x20, 0x77, 0x6F, 0x72, 0x6C, 0x64, 0x21, 0x0A, 0x50, 0x4B, 0x03,
+		0x04, 0x14, 0x00, 0x00, 0x00, 0x08, 0x00, 0x00, 0x00, 0x21, 0x00, 0x55, 0xD6, 0x06, 0x5C, 0x18,
+		0x00, 0x00, 0x00, 0xE8, 0x03, 0x00, 0x00, 0x0D, 0x00, 0x00, 0x00, 0x44, 0x69, 0x72, 0x2F, 0x53,
+		0x6D, 0x61, 0x6C, 0x6C, 0x2E, 0x62, 0x69, 0x6E, 0x63, 0x60, 0x64, 0x62, 0x66, 0x61, 0x65, 0x63,
+		0xE7, 0xE0, 0xE4, 0xE2, 0xE6, 0x61, 0x18, 0xE5, 0x8C, 0x72, 0x46, 0x39, 0xC3, 0x91, 0x03, 0x00,
+		0x50, 0x4B, 0x03, 0x04, 0x14, 0x00, 0x00, 0x00, 0x08, 0x00, 0x00, 0x00, 0x21, 0x00, 0x84, 0xE7,
+		0xFC, 0xCD, 0x16, 0x05, 0x00, 0x00, 0xE0, 0x93, 0x04, 0x00, 0x09, 0x00, 0x00, 0x00, 0x6C, 0x61,
+		0x72, 0x67, 0x65, 0x2E, 0x62, 0x69, 0x6E, 0xED, 0xC8, 0xD5, 0xB6, 0x10, 0x04, 0x14, 0x40, 0x41,
+		0x5A, 0x10, 0x0C, 0x90, 0x0E, 0x09, 0x69, 0x90, 0x46, 0x90, 0x90, 0x12, 0x94, 0x46, 0xBA, 0xBB,
+		0x51, 0x4A, 0x29, 0xBB, 0xBB, 0xBB, 0x5B, 0x30, 0xB0, 0xBB, 0x5B, 0xB1, 0xBB, 0x3B, 0xB1, 0xB0,
+		0xBB, 0x6F, 0x9D, 0x9F, 0x38, 0x6B, 0x9E, 0xF6, 0x9A, 0x5D, 0xAA, 0x74, 0x99, 0xB2, 0xE5, 0xCA,
+		0x57, 0xD8, 0xAA, 0x62, 0xA5, 0xAD, 0x2B, 0x57, 0x29, 0x05, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x00, 0x19, 0x51, 0xD2, 0x6D, 0xB6, 0xDD, 0x6E, 0xFB, 0xAA, 0xE5, 0x01, 0x00, 0x00, 0x00, 0x00,
+		0x00, 0x00, 0x20, 0x25, 0x8A, 0x5B, 0x6D, 0x87, 0xEA, 0x35, 0x6A, 0xC6, 0x04, 0x00, 0x00, 0x00,
+		0x00, 0x00, 0x00, 0x80, 0x64, 0x28, 0x6A, 0xAD, 0xDA, 0x75, 0xEA, 0xD6, 0x8B, 0x09, 0x00, 0x00,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0xD9, 0x50, 0xD8, 0xFA, 0x0D, 0x76, 0x6C, 0xD8, 0x28, 0x26, 0x00,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xA4, 0x43, 0x41, 0x1B, 0x37, 0xD9, 0xA9, 0x69, 0xB3, 0x98,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x90, 0x0F, 0x4D, 0x9B, 0x35, 0x6F, 0xD1, 0xB2, 0x55,
+		0xEB, 0x98, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x90, 0x10, 0xAD, 0xDB, 0xB4, 0xDD, 0xB9,
+		0x5D, 0xFB, 0x98, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x90, 0x11, 0x1D, 0x3A, 0x76, 0xEA,
+		0xDC, 0x25, 0x26, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xA4, 0xC4, 0x2E, 0xDD, 0xBA, 0xEF,
+		0x1A, 0xB3, 0x2B, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xA4, 0x44, 0xAF, 0xDE, 0xBB, 0xC5,
+		0xEC, 0xD1, 0x13, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x52, 0xA2, 0xFF, 0x80, 0x98, 0x7D,
+		0xFA, 0xF6, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x94, 0xD8, 0x33, 0xE6, 0xEE, 0x03,
+		0x07, 0xED, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x29, 0x11, 0x1D, 0x3C, 0x64, 0xE8,
+		0xB0, 0xE1, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x90, 0x12, 0x25, 0x1D, 0x31, 0x72, 0xD4,
+		0x5E, 0xA3, 0x07, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x40, 0x4A, 0x14, 0x77, 0xCC, 0xD8,
+		0x71, 0xE3, 0x27, 0xC4, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x64, 0x28, 0xEA, 0xC4,
+		0x49, 0x93, 0xA7, 0x4C, 0x8D, 0x09, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xD9, 0x50, 0xD8,
+		0x69, 0xD3, 0x67, 0xCC, 0x9C, 0x15, 0x13, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xD2, 0xA1,
+		0xA0, 0xB3, 0xE7, 0xCC, 0x9D, 0x37, 0x3F, 0x26, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xE4,
+		0xC3, 0xBC, 0xF9, 0x0B, 0x16, 0x2E, 0x5A, 0xBC, 0x24, 0x26, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x00, 0x24, 0xC4, 0x92, 0xBD, 0xF7, 0x59, 0xBA, 0x6C, 0x79, 0x4C, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x00, 0x00, 0xC8, 0x88, 0x15, 0x2B, 0xF7, 0xDD, 0x6F, 0x55, 0x4C, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x00, 0x00, 0x48, 0x89, 0x35, 0x6B, 0xD7, 0xED, 0x1F, 0x73, 0x35, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x00, 0x00, 0xA4, 0xC4, 0x41, 0x07, 0x1F, 0x12, 0xF3, 0x80, 0x03, 0x01, 0x00, 0x00, 0x00, 0x00,
+		0x00, 0x00, 0x20, 0x25, 0x8E, 0x38, 0x32, 0xE6, 0xA1, 0x87, 0x1D, 0x0E, 0x00, 0x00, 0x00, 0x00,
+		0x00, 0x00, 0x00, 0x29, 0x71, 0x5C, 0xCC, 0xA3, 0x8E, 0x3E, 0xE6, 0x58, 0x00, 0x00, 0x00, 0x00,
+		0x00, 0x00, 0x00, 0x48, 0x89, 0xE8, 0xF1, 0x27, 0x9C, 0x78, 0xD2, 0xC9, 0x00, 0x00, 0x00, 0x00,
+		0x00, 0x00, 0x00, 0x90, 0x12, 0x25, 0x3D, 0xE5, 0xD4, 0xD3, 0x4E, 0x3F, 0xE3, 0x18, 0x00, 0x00,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x48, 0x89, 0xE2, 0x9E, 0x79, 0xD6, 0xD9, 0xE7, 0x9C, 0x1B, 0x13,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x92, 0xA1, 0xA8, 0xE7, 0x9D, 0x7F, 0xC1, 0x85, 0x17,
+		0xC5, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x6C, 0x28, 0xEC, 0xC5, 0x97, 0x5C, 0x7A,
+		0xD9, 0xE5, 0x31, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x20, 0x1D, 0x0A, 0x7A, 0xC5, 0x95,
+		0x57, 0xAD, 0xDF, 0x10, 0x13, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xF2, 0x61, 0xFD, 0x86,
+		0xAB, 0xAF, 0xB9, 0xF6, 0xBA, 0x8D, 0x31, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x20, 0x21,
+		0x36, 0x5E, 0x7F, 0xC3, 0x8D, 0x37, 0xDD, 0x1C, 0x13, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x32, 0xE2, 0x96, 0x5B, 0x6F, 0xBB, 0xFD, 0x8E, 0x98, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x90, 0x12, 0x77, 0xDD, 0x7D, 0xCF, 0xBD, 0x31, 0xEF, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x80, 0x94, 0x78, 0xE0, 0xC1, 0x87, 0x62, 0xDE, 0x77, 0x3F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x00, 0xA4, 0xC4, 0x63, 0x8F, 0xC7, 0x7C, 0xF8, 0x91, 0x47, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x00, 0x20, 0x25, 0x9E, 0x8E, 0xF9, 0xC4, 0x93, 0x9B, 0x9E, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x00, 0x80, 0x94, 0x88, 0x3E, 0xF3, 0xEC, 0x73, 0xCF, 0xBF, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x00, 0x00, 0x29, 0x51, 0xD2, 0x17, 0x5F, 0x7A, 0xF9, 0x95, 0x57, 0x37, 0x01, 0x00, 0x00, 0x00,
+		0x00, 0x00, 0x00, 0x40, 0x4A, 0x14, 0xF7, 0xB5, 0xD7, 0xDF, 0x78, 0xF3, 0xAD, 0x98, 0x00, 0x00,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x90, 0x0C, 0x45, 0x7D, 0xFB, 0x9D, 0x77, 0xDF, 0x7B, 0x3F, 0x26,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x64, 0x43, 0x61, 0x3F, 0xF8, 0xF0, 0xA3, 0x8F, 0x3F,
+		0x89, 0x09, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xE9, 0x50, 0xD0, 0x4F, 0x3F, 0xFB, 0x7C,
+		0xF3, 0x17, 0x31, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x20, 0x1F, 0x36, 0x7F, 0xF1, 0xE5,
+		0x57, 0x5F, 0x7F, 0xB3, 0x25, 0x26, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x24, 0xC4, 0x96,
+		0x6F, 0xBF, 0xFB, 0xFE, 0x87, 0x1F, 0x63, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x40, 0x46,
+		0xFC, 0xF4, 0xF3, 0x2F, 0xBF, 0xFE, 0x16, 0x13, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x52,
+		0xE2, 0x8F, 0x3F, 0xFF, 0xFA, 0x3B, 0xE6, 0xEF, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x90,
+		0x12, 0xFF, 0x95, 0x2A, 0x1D, 0xF3, 0x9F, 0x7F, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x20,
+		0x25, 0xCA, 0x57, 0x88, 0x59, 0xA6, 0x6C, 0x39, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x48,
+		0x89, 0xCA, 0x31, 0xB7, 0xAA, 0x58, 0x69, 0x6B, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x48,
+		0x89, 0x68, 0x95, 0x6D, 0xB6, 0xDD, 0x6E, 0x7B, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x48,
+		0x89, 0x92, 0x56, 0xAD, 0xB6, 0x43, 0xF5, 0x1A, 0x95, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x20, 0x25, 0x8A, 0x5B, 0xB3, 0x56, 0xED, 0x3A, 0x75, 0x63, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x00, 0x40, 0x32, 0x14, 0xB5, 0x5E, 0xFD, 0x06, 0x3B, 0x36, 0x8C, 0x09, 0x00, 0x00, 0x00, 0x00,
+		0x00, 0x00, 0x00, 0xD9, 0x50, 0xD8, 0x46, 0x8D, 0x9B, 0xEC, 0xD4, 0x34, 0x26, 0x00, 0x00, 0x00,
+		0x00, 0x00, 0x00, 0x00, 0xA4, 0x43, 0x41, 0x9B, 0x35, 0x6F, 0xD1, 0xB2, 0x55, 0x4C, 0x00, 0x00,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0xC8, 0x87, 0x96, 0xAD, 0x5A, 0xB7, 0x69, 0xBB, 0x73, 0xBB, 0x98,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x90, 0x10, 0xED, 0xDA, 0x77, 0xE8, 0xD8, 0xA9, 0x73,
+		0x4C, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xC8, 0x88, 0x2E, 0x5D, 0x77, 0xE9, 0xD6, 0x3D,
+		0x26, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xA4, 0x44, 0x8F, 0x9E, 0xBD, 0x7A, 0xC7, 0xDC,
+		0x15, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x52, 0xA2, 0x6F, 0xBF, 0xFE, 0x31, 0x77, 0xEB,
+		0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x29, 0x31, 0x68, 0x8F, 0x98, 0x03, 0x76, 0x1F,
+		0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x29, 0x31, 0x2C, 0xE6, 0x9E, 0x83, 0x87, 0x0C,
+		0x05, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x94, 0x88, 0x0E, 0x1F, 0x31, 0x72, 0xD4, 0x5E,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x90, 0x12, 0x25, 0x1D, 0x3D, 0x66, 0xEC, 0xB8, 0xF1,
+		0x43, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x20, 0x25, 0x8A, 0x3B, 0x61, 0xE2, 0xA4, 0xC9,
+		0x53, 0x62, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x40, 0x32, 0x14, 0x75, 0xEA, 0xB4, 0xE9,
+		0x33, 0x66, 0xC6, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x6C, 0x28, 0xEC, 0xAC, 0xD9,
+		0x73, 0xE6, 0xCE, 0x8B, 0x09, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xE9, 0x50, 0xD0, 0xF9,
+		0x0B, 0x16, 0x2E, 0x5A, 0x1C, 0x13, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xF2, 0x61, 0xD1,
+		0xE2, 0x25, 0x7B, 0xEF, 0xB3, 0x74, 0x59, 0x4C, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x48,
+		0x88, 0x65, 0xCB, 0x57, 0xAC, 0xDC, 0x77, 0xBF, 0x98, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x90, 0x11, 0xAB, 0x56, 0xAF, 0x59, 0xBB, 0x2E, 0x26, 0x00, 0xA4, 0xC2, 0xFF, 0x50, 0x4B, 0x01,
+		0x02, 0x14, 0x03, 0x14, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x21, 0x00, 0xCD, 0xBA, 0xB6,
+		0xB7, 0x15, 0x00, 0x00, 0x00, 0x15, 0x00, 0x00, 0x00, 0x0A, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x01, 0x00, 0x00, 0x00, 0x00, 0x73, 0x74, 0x6F, 0x72, 0x65,
+		0x64, 0x2E, 0x74, 0x78, 0x74, 0x50, 0x4B, 0x01, 0x02, 0x14, 0x03, 0x14, 0x00, 0x00, 0x00, 0x08,
+		0x00, 0x00, 0x00, 0x21, 0x00, 0x55, 0xD6, 0x06, 0x5C, 0x18, 0x00, 0x00, 0x00, 0xE8, 0x03, 0x00,
+		0x00, 0x0D, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x01, 0x3D,
+		0x00, 0x00, 0x00, 0x44, 0x69, 0x72, 0x2F, 0x53, 0x6D, 0x61, 0x6C, 0x6C, 0x2E, 0x62, 0x69, 0x6E,
+		0x50, 0x4B, 0x01, 0x02, 0x14, 0x03, 0x14, 0x00, 0x00, 0x00, 0x08, 0x00, 0x00, 0x00, 0x21, 0x00,
+		0x84, 0xE7, 0xFC, 0xCD, 0x16, 0x05, 0x00, 0x00, 0xE0, 0x93, 0x04, 0x00, 0x09, 0x00, 0x00, 0x00,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x01, 0x80, 0x00, 0x00, 0x00, 0x6C, 0x61,
+		0x72, 0x67, 0x65, 0x2E, 0x62, 0x69, 0x6E, 0x50, 0x4B, 0x05, 0x06, 0x00, 0x00, 0x00, 0x00, 0x03,
+		0x00, 0x03, 0x00, 0xAA, 0x00, 0x00, 0x00, 0xBD, 0x05, 0x00, 0x00, 0x00, 0x00,
+};
+
+/** A stream which does not lend its data, like a file which is not mapped */
+class UnlendingReadStream : public Common::SeekableReadStream {
+public:
+	UnlendingReadStream(const byte *data, uint32 size) : _stream(data, size, DisposeAfterUse::YES) {}
+
+	bool err() const { return _stream.err(); }
+	void clearErr() { _stream.clearErr(); }
+	bool eos() const { return _stream.eos(); }
+	int32 pos() const { return _stream.pos(); }
+	int32 size() const { return _stream.size(); }
+	bool seek(int32 offset, int whence = SEEK_SET) { return _stream.seek(offset, whence); }
+	uint32 read(void *dataPtr, uint32 dataSize) { return _stream.read(dataPtr, dataSize); }
+
+private:
+	Common::MemoryReadStream _stream;
+};
+
+class UnzipTestSuite : public CxxTest::TestSuite
+{
+	static byte getPatternByte(uint32 pos, uint mul) {
+		return ((pos / 4096) * mul + (pos % 13)) & 0xFF;
+	}
+
+	static bool checkPattern(Common::SeekableReadStream *stream, uint32 from, uint32 count, uint mul) {
+		for (uint32 i = from; i < from + count; ++i) {
+			if (stream->readByte() != getPatternByte(i, mul))
+				return false;
+		}
+		return true;
+	}
+
+	static Common::Archive *openArchive(uint32 prefix = 0, bool lend = true) {
+		byte *data = (byte *)malloc(prefix + sizeof(zipData));
+		memset(data, 0xAA, prefix);
+		memcpy(data + prefix, zipData, sizeof(zipData));
+		if (!lend)
+			return Common::makeZipArchive(new UnlendingReadStream(data, prefix + sizeof(zipData)));
+		return Common::makeZipArchive(new Common::MemoryReadStream(data, prefix + sizeof(zipData), DisposeAfterUse::YES));
+	}
+
+	public:
+	void test_members() {
+		Common::ScopedPtr<Common::Archive> archive(openArchive());
+		TS_ASSERT(archive);
+
+		TS_ASSERT(archive->hasFile("stored.txt"));
+		TS_ASSERT(archive->hasFile("dir/small.BIN"));
+		TS_ASSERT(!archive->hasFile("missing.txt"));
+		TS_ASSERT(archive->createReadStreamForMember("missing.txt") == 0);
+
+		Common::ArchiveMemberList list;
+		TS_ASSERT_EQUALS(archive->listMembers(list), 3);
+	}
+
+	void test_stored() {
+		Common::ScopedPtr<Common::Archive> archive(openArchive());
+		Common::ScopedPtr<Common::SeekableReadStream> stream(archive->createReadStreamForMember("stored.txt"));
+		TS_ASSERT(stream);
+		TS_ASSERT_EQUALS(stream->size(), 21);
+		TS_ASSERT_EQUALS(stream->readLine(), "Hello, stored world!");
+
+		// Stored members are views into the archive
+		stream->seek(7);
+		const byte *data = stream->borrow(6);
+		TS_ASSERT(data != 0);
+		TS_ASSERT_EQUALS(memcmp(data, "stored", 6), 0);
+	}
+
+	void test_small_deflated() {
+		Common::ScopedPtr<Common::Archive> archive(openArchive());
+
+		for (int i = 0; i < 2; ++i) {
+			Common::ScopedPtr<Common::SeekableReadStream> stream(archive->createReadStreamForMember("Dir/Small.bin"));
+			TS_ASSERT(stream);
+			TS_ASSERT_EQUALS(stream->size(), 1000);
+			TS_ASSERT(checkPattern(stream.get(), 0, 1000, 3));
+			stream->readByte();
+			TS_ASSERT(stream->eos());
+		}
+	}
+
+	void test_large_deflated() {
+		Common::ScopedPtr<Common::Archive> archive(openArchive());
+		Common::ScopedPtr<Common::SeekableReadStream> stream(archive->createReadStreamForMember("large.bin"));
+		TS_ASSERT(stream);
+		TS_ASSERT_EQUALS(stream->size(), 300000);
+
+		TS_ASSERT(checkPattern(stream.get(), 0, 100, 5));
+
+		// Forward, backward and relative to the end
+		TS_ASSERT(stream->seek(200000));
+		TS_ASSERT(checkPattern(stream.get(), 200000, 5000, 5));
+		TS_ASSERT(stream->seek(1234));
+		TS_ASSERT(checkPattern(stream.get(), 1234, 100, 5));
+		TS_ASSERT(stream->seek(-10, SEEK_END));
+		TS_ASSERT(checkPattern(stream.get(), 299990, 10, 5));
+		TS_ASSERT(!stream->eos());
+		stream->readByte();
+		TS_ASSERT(stream->eos());
+		TS_ASSERT(!stream->err());
+	}
+
+	void test_outlive_archive() {
+		Common::Archive *archive = openArchive();
+		Common::ScopedPtr<Common::SeekableReadStream> stored(archive->createReadStreamForMember("stored.txt"));
+		Common::ScopedPtr<Common::SeekableReadStream> large(archive->createReadStreamForMember("large.bin"));
+		delete archive;
+
+		TS_ASSERT_EQUALS(stored->readLine(), "Hello, stored world!");
+		TS_ASSERT(checkPattern(large.get(), 0, 10000, 5));
+	}
+
+	void test_self_extracting() {
+		// Data in front of the archive, as in self-extracting archives
+		Common::ScopedPtr<Common::Archive> archive(openArchive(1000));
+		TS_ASSERT(archive);
+
+		Common::ScopedPtr<Common::SeekableReadStream> stream(archive->createReadStreamForMember("Dir/Small.bin"));
+		TS_ASSERT(stream);
+		TS_ASSERT(checkPattern(stream.get(), 0, 1000, 3));
+	}
+
+	void test_unlending_stream() {
+		// The members are read through the archive stream instead
+		Common::ScopedPtr<Common::Archive> archive(openArchive(0, false));
+		TS_ASSERT(archive);
+
+		Common::ScopedPtr<Common::SeekableReadStream> stored(archive->createReadStreamForMember("stored.txt"));
+		TS_ASSERT(stored);
+		TS_ASSERT_EQUALS(stored->readLine(), "Hello, stored world!");
+		TS_ASSERT(stored->seek(7));
+		TS_ASSERT(stored->borrow(6) == 0);
+		TS_ASSERT_EQUALS(stored->readByte(), 's');
+
+		Common::ScopedPtr<Common::SeekableReadStream> small(archive->createReadStreamForMember("Dir/Small.bin"));
+		TS_ASSERT(small);
+		TS_ASSERT(checkPattern(small.get(), 0, 1000, 3));
+
+		// Read them interleaved, so each read has to seek the archive stream
+		Common::ScopedPtr<Common::SeekableReadStream> large(archive->createReadStreamForMember("large.bin"));
+		TS_ASSERT(large);
+		TS_ASSERT(stored->seek(0));
+		for (uint32 pos = 0; pos < 300000; pos += 30000) {
+			TS_ASSERT(checkPattern(large.get(), pos, 30000, 5));
+			TS_ASSERT_EQUALS(stored->readByte(), (byte)"Hello, stored world!\n"[pos / 30000]);
+		}
+		TS_ASSERT(large->seek(1234));
+		TS_ASSERT(checkPattern(large.get(), 1234, 100, 5));
+		TS_ASSERT(!large->err());
+	}
+
+	void test_crc_mismatch() {
+		// Damage the CRC of large.bin, which is inflated while it is read
+		static const byte largeCrc[] = { 0x84, 0xE7, 0xFC, 0xCD };
+		byte *data = (byte *)malloc(sizeof(zipData));
+		memcpy(data, zipData, sizeof(zipData));
+		for (uint32 i = 0; i + sizeof(largeCrc) <= sizeof(zipData); ++i) {
+			if (memcmp(data + i, largeCrc, sizeof(largeCrc)) == 0)
+				data[i] ^= 0xFF;
+		}
+
+		Common::ScopedPtr<Common::Archive> archive(Common::makeZipArchive(new Common::MemoryReadStream(data, sizeof(zipData), DisposeAfterUse::YES)));
+		Common::ScopedPtr<Common::SeekableReadStream> stream(archive->createReadStreamForMember("large.bin"));
+		TS_ASSERT(stream);
+		TS_ASSERT(checkPattern(stream.get(), 0, 299999, 5));
+		TS_ASSERT(!stream->err());
+		stream->readByte();
+		TS_ASSERT(stream->err());
+	}
+
+	void test_invalid() {
+		static const byte garbage[100] = { 0 };
+		TS_ASSERT(Common::makeZipArchive(new Common::MemoryReadStream(garbage, sizeof(garbage))) == 0);
+	}
+};
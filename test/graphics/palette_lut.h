@@ -0,0 +1,85 @@
+#include <cxxtest/TestSuite.h>
+
+#include "graphics/palette_lut.h"
+
+class PaletteLUTTestSuite : public CxxTest::TestSuite
+{
+	static void fillPalette(byte *colors) {
+		for (int i = 0; i < 256; ++i) {
+			colors[i * 3 + 0] = i;
+			colors[i * 3 + 1] = (i * 7) & 0xFF;
+			colors[i * 3 + 2] = 255 - i;
+		}
+	}
+
+	template<typename T>
+	static void checkConvert(const Graphics::PixelFormat &format) {
+		byte colors[256 * 3];
+		fillPalette(colors);
+
+		Graphics::PaletteLUT lut(format);
+		lut.setPalette(colors, 0, 256);
+
+		// Odd sizes and pitches, so both the vector and the tail code
+		// are exercised on every line.
+		const uint w = 53, h = 5, srcPitch = 61, dstPitch = 59;
+		byte src[srcPitch * h];
+		for (uint i = 0; i < sizeof(src); ++i)
+			src[i] = (i * 37 + 11) & 0xFF;
+
+		T dst[dstPitch * h];
+		memset(dst, 0, sizeof(dst));
+		lut.convert((byte *)dst, dstPitch * sizeof(T), src, srcPitch, w, h);
+
+		for (uint y = 0; y < h; ++y) {
+			for (uint x = 0; x < dstPitch; ++x) {
+				const byte *c = colors + src[y * srcPitch + x] * 3;
+				const T expected = (x < w) ? (T)format.RGBToColor(c[0], c[1], c[2]) : 0;
+				TS_ASSERT_EQUALS(dst[y * dstPitch + x], expected);
+			}
+		}
+	}
+
+	public:
+	void test_convert_16bpp() {
+		checkConvert<uint16>(Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0));
+		checkConvert<uint16>(Graphics::PixelFormat(2, 5, 5, 5, 1, 10, 5, 0, 15));
+	}
+
+	void test_convert_32bpp() {
+		checkConvert<uint32>(Graphics::PixelFormat(4, 8, 8, 8, 0, 16, 8, 0, 0));
+	}
+
+	void test_partial_update() {
+		const Graphics::PixelFormat format(2, 5, 6, 5, 0, 11, 5, 0, 0);
+		Graphics::PaletteLUT lut(format);
+
+		const byte white[] = { 255, 255, 255, 255, 255, 255 };
+		lut.setPalette(white, 10, 2);
+
+		TS_ASSERT_EQUALS(lut.getColor(9), (uint32)0);
+		TS_ASSERT_EQUALS(lut.getColor(10), (uint32)0xFFFF);
+		TS_ASSERT_EQUALS(lut.getColor(11), (uint32)0xFFFF);
+		TS_ASSERT_EQUALS(lut.getColor(12), (uint32)0);
+
+		byte grabbed[4 * 3];
+		lut.grabPalette(grabbed, 9, 4);
+		TS_ASSERT_EQUALS(grabbed[0], 0);
+		TS_ASSERT_EQUALS(grabbed[3], 255);
+		TS_ASSERT_EQUALS(grabbed[8], 255);
+		TS_ASSERT_EQUALS(grabbed[9], 0);
+	}
+
+	void test_set_format() {
+		byte colors[256 * 3];
+		fillPalette(colors);
+
+		Graphics::PaletteLUT lut(Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0));
+		lut.setPalette(colors, 0, 256);
+
+		const Graphics::PixelFormat format(4, 8, 8, 8, 0, 16, 8, 0, 0);
+		lut.setFormat(format);
+		for (int i = 0; i < 256; ++i)
+			TS_ASSERT_EQUALS(lut.getColor(i), format.RGBToColor(colors[i * 3], colors[i * 3 + 1], colors[i * 3 + 2]));
+	}
+};
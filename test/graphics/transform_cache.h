@@ -0,0 +1,100 @@
+#include <cxxtest/TestSuite.h>
+
+#include "graphics/transform_cache.h"
+
+class TransformCacheTestSuite : public CxxTest::TestSuite
+{
+	static void fill(Graphics::TransparentSurface &surface, int w, int h) {
+		surface.create(w, h, Graphics::TransparentSurface::getSupportedPixelFormat());
+		for (int y = 0; y < h; ++y) {
+			for (int x = 0; x < w; ++x)
+				*(uint32 *)surface.getBasePtr(x, y) = (y * w + x) * 2654435761U;
+		}
+	}
+
+public:
+	void test_scale() {
+		Graphics::TransparentSurface source;
+		fill(source, 13, 7);
+
+		// Up and down, so rows are both repeated and skipped
+		static const uint16 sizes[][2] = { { 13, 7 }, { 40, 30 }, { 5, 3 }, { 26, 5 } };
+		for (uint i = 0; i < ARRAYSIZE(sizes); ++i) {
+			const int dstW = sizes[i][0], dstH = sizes[i][1];
+			Graphics::TransparentSurface *scaled = source.scale(dstW, dstH);
+			TS_ASSERT_EQUALS(scaled->w, dstW);
+			TS_ASSERT_EQUALS(scaled->h, dstH);
+
+			for (int y = 0; y < dstH; ++y) {
+				for (int x = 0; x < dstW; ++x) {
+					const uint32 expected = *(const uint32 *)source.getBasePtr(x * source.w / dstW, y * source.h / dstH);
+					TS_ASSERT_EQUALS(*(const uint32 *)scaled->getBasePtr(x, y), expected);
+				}
+			}
+
+			scaled->free();
+			delete scaled;
+		}
+
+		source.free();
+	}
+
+	void test_hits_and_misses() {
+		Graphics::TransparentSurface source;
+		fill(source, 16, 16);
+
+		Graphics::TransformCache cache(1024 * 1024);
+		Graphics::TransformCache::SurfacePtr a = cache.scale(source, 1, 32, 24);
+		Graphics::TransformCache::SurfacePtr b = cache.scale(source, 1, 32, 24);
+		TS_ASSERT_EQUALS(a.get(), b.get());
+		TS_ASSERT_EQUALS(cache.getHits(), 1U);
+		TS_ASSERT_EQUALS(cache.getMisses(), 1U);
+
+		// Another size, another version, or another part of the source
+		cache.scale(source, 1, 24, 32);
+		TS_ASSERT_DIFFERS(cache.scale(source, 2, 32, 24).get(), a.get());
+		Graphics::TransparentSurface part(source.getSubArea(Common::Rect(4, 4, 12, 12)), false);
+		cache.scale(part, 1, 32, 24);
+		TS_ASSERT_EQUALS(cache.getHits(), 1U);
+		TS_ASSERT_EQUALS(cache.getMisses(), 4U);
+		TS_ASSERT_EQUALS(cache.getEntryCount(), 4U);
+
+		const Graphics::TransformStruct transform(100, 100, 90);
+		Graphics::TransformCache::SurfacePtr rotated = cache.rotoscale(source, 1, transform);
+		TS_ASSERT_EQUALS(cache.rotoscale(source, 1, transform).get(), rotated.get());
+		TS_ASSERT_DIFFERS(cache.rotoscale(source, 1, Graphics::TransformStruct(100, 100, 45)).get(), rotated.get());
+
+		// Results stay valid after they are dropped
+		cache.clear();
+		TS_ASSERT_EQUALS(cache.getSize(), 0U);
+		TS_ASSERT_EQUALS(a->w, 32);
+		TS_ASSERT_EQUALS(*(const uint32 *)a->getBasePtr(0, 0), *(const uint32 *)source.getBasePtr(0, 0));
+
+		source.free();
+	}
+
+	void test_eviction() {
+		Graphics::TransparentSurface source;
+		fill(source, 8, 8);
+
+		// Room for four 16x16 results
+		Graphics::TransformCache cache(4 * 16 * 16 * 4);
+		for (uint32 version = 0; version < 6; ++version)
+			cache.scale(source, version, 16, 16);
+		TS_ASSERT_EQUALS(cache.getEntryCount(), 4U);
+		TS_ASSERT_EQUALS(cache.getEvictions(), 2U);
+
+		// The least recently used ones are gone
+		cache.scale(source, 2, 16, 16);
+		cache.scale(source, 0, 16, 16);
+		TS_ASSERT_EQUALS(cache.getHits(), 1U);
+
+		// Too large to be kept
+		cache.scale(source, 0, 64, 64);
+		cache.scale(source, 0, 64, 64);
+		TS_ASSERT_EQUALS(cache.getHits(), 1U);
+		TS_ASSERT(cache.getSize() <= 4 * 16 * 16 * 4);
+
+		source.free();
+	}
+};
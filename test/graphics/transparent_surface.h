@@ -0,0 +1,176 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/util.h"
+#include "graphics/transparent_surface.h"
+
+class TransparentSurfaceTestSuite : public CxxTest::TestSuite
+{
+	enum {
+		// Not a multiple of four, so both the vector code and the
+		// remaining pixels are covered
+		kWidth = 23,
+		kHeight = 5
+	};
+
+	static void fill(Graphics::Surface &surface, uint32 seed, bool withExtremes) {
+		for (int y = 0; y < surface.h; ++y) {
+			for (int x = 0; x < surface.w; ++x) {
+				seed = seed * 1103515245 + 12345;
+				uint32 pixel = seed;
+				if (withExtremes && (x % 5) == 0)
+					pixel = (x % 10) ? (pixel | 0xFF) : (pixel & ~0xFF);
+				*(uint32 *)surface.getBasePtr(x, y) = pixel;
+			}
+		}
+	}
+
+	static byte blendComponent(Graphics::TSpriteBlendMode blend, bool tinted, uint32 in, uint32 out, uint32 a, uint32 ca, uint32 c) {
+		const uint32 ina = a * ca >> 8;
+		const uint32 m = (c == 255) ? 256 : c;
+
+		switch (blend) {
+		case Graphics::BLEND_ADDITIVE:
+			return MIN<uint32>(out + (tinted ? in * ina * m >> 16 : in * a >> 8), 255);
+		case Graphics::BLEND_SUBTRACTIVE:
+			return out - (tinted ? in * m * out * a >> 24 : in * out * a >> 16);
+		default:
+			if (tinted)
+				return (out * (255 - ina) >> 8) + (in * ina * c >> 16);
+			return (in * a + out * (255 - a)) >> 8;
+		}
+	}
+
+	/** Blends one pixel, the way the original per pixel code did */
+	static uint32 blendPixel(const Graphics::PixelFormat &format, uint32 src, uint32 dst, uint color, Graphics::TSpriteBlendMode blend, Graphics::AlphaType alphaMode) {
+		byte a, r, g, b, da, dr, dg, db;
+		format.colorToARGB(src, a, r, g, b);
+		format.colorToARGB(dst, da, dr, dg, db);
+
+		const bool tinted = (color != 0xFFFFFFFF);
+		if (!tinted && blend == Graphics::BLEND_NORMAL && alphaMode == Graphics::ALPHA_OPAQUE)
+			return format.ARGBToColor(255, r, g, b);
+		if (!tinted && blend == Graphics::BLEND_NORMAL && alphaMode == Graphics::ALPHA_BINARY)
+			return a ? format.ARGBToColor(255, r, g, b) : dst;
+		if (!tinted && a == 0)
+			return dst;
+
+		// The color is always given as 0xAARRGGBB
+		const uint32 ca = (color >> 24) & 0xFF, cr = (color >> 16) & 0xFF, cg = (color >> 8) & 0xFF, cb = color & 0xFF;
+
+		if (blend == Graphics::BLEND_NORMAL || (blend == Graphics::BLEND_SUBTRACTIVE && tinted))
+			da = 255;
+		return format.ARGBToColor(da,
+			blendComponent(blend, tinted, r, dr, a, ca, cr),
+			blendComponent(blend, tinted, g, dg, a, ca, cg),
+			blendComponent(blend, tinted, b, db, a, ca, cb));
+	}
+
+	static void checkBlit(int flipping, uint color, Graphics::TSpriteBlendMode blend, Graphics::AlphaType alphaMode) {
+		const Graphics::PixelFormat format = Graphics::TransparentSurface::getSupportedPixelFormat();
+
+		Graphics::TransparentSurface src;
+		src.create(kWidth, kHeight, format);
+		src.setAlphaMode(alphaMode);
+		fill(src, 1, true);
+
+		Graphics::Surface dst, expected;
+		dst.create(kWidth, kHeight, format);
+		fill(dst, 2, false);
+		expected.copyFrom(dst);
+
+		for (int y = 0; y < kHeight; ++y) {
+			for (int x = 0; x < kWidth; ++x) {
+				const int srcX = (flipping & Graphics::FLIP_H) ? kWidth - 1 - x : x;
+				const int srcY = (flipping & Graphics::FLIP_V) ? kHeight - 1 - y : y;
+				uint32 *pixel = (uint32 *)expected.getBasePtr(x, y);
+				*pixel = blendPixel(format, *(const uint32 *)src.getBasePtr(srcX, srcY), *pixel, color, blend, alphaMode);
+			}
+		}
+
+		src.blit(dst, 0, 0, flipping, nullptr, color, -1, -1, blend);
+
+		for (int y = 0; y < kHeight; ++y) {
+			for (int x = 0; x < kWidth; ++x)
+				TS_ASSERT_EQUALS(*(const uint32 *)dst.getBasePtr(x, y), *(const uint32 *)expected.getBasePtr(x, y));
+		}
+
+		src.free();
+		dst.free();
+		expected.free();
+	}
+
+	static void checkPremultipliedBlit(Graphics::AlphaType alphaMode) {
+		const Graphics::PixelFormat format = Graphics::TransparentSurface::getSupportedPixelFormat();
+
+		Graphics::TransparentSurface straight, premultiplied;
+		straight.create(kWidth, kHeight, format);
+		straight.setAlphaMode(alphaMode);
+		fill(straight, 3, true);
+
+		// Give the surface the alpha values its mode promises
+		for (int y = 0; y < kHeight; ++y) {
+			for (int x = 0; x < kWidth; ++x) {
+				byte a, r, g, b;
+				uint32 *pixel = (uint32 *)straight.getBasePtr(x, y);
+				format.colorToARGB(*pixel, a, r, g, b);
+				if (alphaMode == Graphics::ALPHA_OPAQUE)
+					a = 255;
+				else if (alphaMode == Graphics::ALPHA_BINARY)
+					a = (a & 0x80) ? 255 : 0;
+				*pixel = format.ARGBToColor(a, r, g, b);
+			}
+		}
+
+		premultiplied.copyFrom(straight);
+		premultiplied.setAlphaMode(alphaMode);
+		premultiplied.premultiplyAlpha();
+		TS_ASSERT(premultiplied.isAlphaPremultiplied());
+		TS_ASSERT(!straight.isAlphaPremultiplied());
+
+		Graphics::Surface dst1, dst2;
+		dst1.create(kWidth, kHeight, format);
+		fill(dst1, 4, false);
+		dst2.copyFrom(dst1);
+
+		straight.blit(dst1);
+		premultiplied.blit(dst2);
+
+		// Premultiplying rounds the colors down, so allow for a small difference
+		for (int y = 0; y < kHeight; ++y) {
+			for (int x = 0; x < kWidth; ++x) {
+				byte a1, r1, g1, b1, a2, r2, g2, b2;
+				format.colorToARGB(*(const uint32 *)dst1.getBasePtr(x, y), a1, r1, g1, b1);
+				format.colorToARGB(*(const uint32 *)dst2.getBasePtr(x, y), a2, r2, g2, b2);
+				TS_ASSERT_EQUALS(a1, a2);
+				TS_ASSERT_LESS_THAN_EQUALS(ABS(r1 - r2), 2);
+				TS_ASSERT_LESS_THAN_EQUALS(ABS(g1 - g2), 2);
+				TS_ASSERT_LESS_THAN_EQUALS(ABS(b1 - b2), 2);
+			}
+		}
+
+		straight.free();
+		premultiplied.free();
+		dst1.free();
+		dst2.free();
+	}
+
+public:
+	void test_blit() {
+		static const int flips[] = { Graphics::FLIP_NONE, Graphics::FLIP_H, Graphics::FLIP_V, Graphics::FLIP_HV };
+		static const uint colors[] = { 0xFFFFFFFF, 0xFF50A0FF, 0x80FFFFFF, 0xC81EFF5A };
+		static const Graphics::TSpriteBlendMode blends[] = { Graphics::BLEND_NORMAL, Graphics::BLEND_ADDITIVE, Graphics::BLEND_SUBTRACTIVE };
+		static const Graphics::AlphaType alphaModes[] = { Graphics::ALPHA_OPAQUE, Graphics::ALPHA_BINARY, Graphics::ALPHA_FULL };
+
+		for (uint f = 0; f < ARRAYSIZE(flips); ++f)
+			for (uint c = 0; c < ARRAYSIZE(colors); ++c)
+				for (uint b = 0; b < ARRAYSIZE(blends); ++b)
+					for (uint a = 0; a < ARRAYSIZE(alphaModes); ++a)
+						checkBlit(flips[f], colors[c], blends[b], alphaModes[a]);
+	}
+
+	void test_premultiplied_blit() {
+		checkPremultipliedBlit(Graphics::ALPHA_FULL);
+		checkPremultipliedBlit(Graphics::ALPHA_OPAQUE);
+		checkPremultipliedBlit(Graphics::ALPHA_BINARY);
+	}
+};
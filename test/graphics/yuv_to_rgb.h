@@ -0,0 +1,116 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/rect.h"
+#include "graphics/surface.h"
+#include "graphics/yuv_to_rgb.h"
+
+class YUVToRGBTestSuite : public CxxTest::TestSuite
+{
+	enum {
+		kWidth = 54,
+		kHeight = 6,
+		// Pitches wider than the image, as the video decoders use
+		kYPitch = kWidth + 10,
+		kUVPitch = kWidth + 6
+	};
+
+	static void fillPlane(byte *plane, uint size, uint32 seed) {
+		for (uint i = 0; i < size; ++i) {
+			seed = seed * 1103515245 + 12345;
+			plane[i] = seed >> 24;
+		}
+
+		// Make sure the extremes, which exercise the clamping, are there
+		plane[0] = 0;
+		plane[size - 1] = 255;
+	}
+
+	/**
+	 * Convert the image once as a whole, and once two columns at a time.
+	 * The narrow slices are too small for the vector code, so they go
+	 * through the lookup tables, which are the reference.
+	 */
+	static void checkConvert(bool is420, const Graphics::PixelFormat &format, Graphics::YUVToRGBManager::LuminanceScale scale) {
+		const uint yPitch = kYPitch;
+		const uint uvPitch = is420 ? kUVPitch / 2 : kUVPitch;
+
+		byte y[kYPitch * kHeight], u[kUVPitch * kHeight], v[kUVPitch * kHeight];
+		fillPlane(y, sizeof(y), 1);
+		fillPlane(u, sizeof(u), 2);
+		fillPlane(v, sizeof(v), 3);
+
+		Graphics::Surface whole, reference;
+		whole.create(kWidth, kHeight, format);
+		reference.create(kWidth, kHeight, format);
+
+		if (is420)
+			YUVToRGBMan.convert420(&whole, scale, y, u, v, kWidth, kHeight, yPitch, uvPitch);
+		else
+			YUVToRGBMan.convert444(&whole, scale, y, u, v, kWidth, kHeight, yPitch, uvPitch);
+
+		for (uint x = 0; x < kWidth; x += 2) {
+			Graphics::Surface slice = reference.getSubArea(Common::Rect(x, 0, x + 2, kHeight));
+			const uint uvX = is420 ? x / 2 : x;
+
+			if (is420)
+				YUVToRGBMan.convert420(&slice, scale, y + x, u + uvX, v + uvX, 2, kHeight, yPitch, uvPitch);
+			else
+				YUVToRGBMan.convert444(&slice, scale, y + x, u + uvX, v + uvX, 2, kHeight, yPitch, uvPitch);
+		}
+
+		for (uint row = 0; row < kHeight; ++row)
+			TS_ASSERT_EQUALS(memcmp(whole.getBasePtr(0, row), reference.getBasePtr(0, row), kWidth * format.bytesPerPixel), 0);
+
+		whole.free();
+		reference.free();
+	}
+
+	static void checkFormats(bool is420) {
+		static const Graphics::PixelFormat formats[] = {
+			Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0),
+			Graphics::PixelFormat(2, 5, 5, 5, 1, 10, 5, 0, 15),
+			Graphics::PixelFormat(4, 8, 8, 8, 0, 16, 8, 0, 0),
+			Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0)
+		};
+
+		for (uint i = 0; i < ARRAYSIZE(formats); ++i) {
+			checkConvert(is420, formats[i], Graphics::YUVToRGBManager::kScaleFull);
+			checkConvert(is420, formats[i], Graphics::YUVToRGBManager::kScaleITU);
+		}
+	}
+
+public:
+	void test_convert420() {
+		checkFormats(true);
+	}
+
+	void test_convert444() {
+		checkFormats(false);
+	}
+
+	void test_convert420_own_lookup() {
+		const Graphics::PixelFormat format(4, 8, 8, 8, 0, 16, 8, 0, 0);
+		byte y[kYPitch * kHeight], u[kUVPitch * kHeight], v[kUVPitch * kHeight];
+		fillPlane(y, sizeof(y), 4);
+		fillPlane(u, sizeof(u), 5);
+		fillPlane(v, sizeof(v), 6);
+
+		Graphics::Surface shared, own;
+		shared.create(kWidth, kHeight, format);
+		own.create(kWidth, kHeight, format);
+
+		Graphics::YUVToRGBLookup *lookup = YUVToRGBMan.createLookup(format, Graphics::YUVToRGBManager::kScaleITU);
+		YUVToRGBMan.convert420(&shared, Graphics::YUVToRGBManager::kScaleITU, y, u, v, kWidth, kHeight, kYPitch, kUVPitch / 2);
+		// Switch the table of the manager to another scale, which must not matter
+		YUVToRGBMan.convert420(&shared, Graphics::YUVToRGBManager::kScaleFull, y, u, v, 2, 2, kYPitch, kUVPitch / 2);
+		YUVToRGBMan.convert420(&shared, Graphics::YUVToRGBManager::kScaleITU, y, u, v, 2, 2, kYPitch, kUVPitch / 2);
+		YUVToRGBMan.convert420(&own, lookup, y, u, v, kWidth, kHeight, kYPitch, kUVPitch / 2);
+		Graphics::YUVToRGBManager::destroyLookup(lookup);
+
+		for (uint row = 0; row < kHeight; ++row)
+			TS_ASSERT_EQUALS(memcmp(shared.getBasePtr(0, row), own.getBasePtr(0, row), kWidth * format.bytesPerPixel), 0);
+
+		shared.free();
+		own.free();
+	}
+};
@@ -1,12 +1,26 @@
 ######################################################################
 # Unit/regression tests, based on CxxTest.
-# Use the 'test' target to run them.
+# Use the 'test' target to run them, and the 'benchmark' target to run
+# the performance measurements in test/benchmark.
 # Edit TESTS and TESTLIBS to add more tests.
 #
 ######################################################################
 
-TESTS        := $(srcdir)/test/common/*.h $(srcdir)/test/audio/*.h
-TEST_LIBS    := audio/libaudio.a common/libcommon.a
+TESTS        := $(srcdir)/test/common/*.h $(srcdir)/test/audio/*.h $(srcdir)/test/graphics/*.h
+TEST_LIBS    := graphics/libgraphics.a audio/libaudio.a common/libcommon.a
+
+ifdef POSIX
+# The memory mapped file stream of the POSIX backend is tested directly
+TEST_LIBS    := backends/fs/posix/mmapstream.o backends/fs/stdiostream.o $(TEST_LIBS)
+endif
+
+BENCHMARKS   := $(filter-out %/benchmark.h,$(wildcard $(srcdir)/test/benchmark/*.h))
+BENCH_LIBS   := $(TEST_LIBS)
+
+ifdef USE_MT32EMU
+# The MT-32 emulator is benchmarked directly
+BENCH_LIBS   := audio/softsynth/mt32/libmt32.a $(BENCH_LIBS)
+endif
 
 #
 TEST_FLAGS   := --runner=StdioPrinter --no-std --no-eh --include=$(srcdir)/test/cxxtest_mingw.h
@@ -34,9 +48,17 @@ test/runner.cpp: $(TESTS)
 	@mkdir -p test
 	$(srcdir)/test/cxxtest/cxxtestgen.py $(TEST_FLAGS) -o $@ $+
 
+benchmark: test/benchrunner
+	./test/benchrunner
+test/benchrunner: test/benchrunner.cpp $(BENCH_LIBS)
+	$(QUIET_LINK)$(CXX) $(TEST_CXXFLAGS) $(CPPFLAGS) $(TEST_CFLAGS) -o $@ $+ $(TEST_LDFLAGS)
+test/benchrunner.cpp: $(BENCHMARKS)
+	@mkdir -p test
+	$(srcdir)/test/cxxtest/cxxtestgen.py $(TEST_FLAGS) --include=$(srcdir)/test/benchmark/benchmark.h -o $@ $+
+
 
 clean: clean-test
 clean-test:
-	-$(RM) test/runner.cpp test/runner
+	-$(RM) test/runner.cpp test/runner test/benchrunner.cpp test/benchrunner
 
-.PHONY: test clean-test
+.PHONY: test benchmark clean-test
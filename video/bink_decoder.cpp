@@ -31,6 +31,7 @@
 #include "common/textconsole.h"
 #include "common/math.h"
 #include "common/stream.h"
+#include "common/memstream.h"
 #include "common/substream.h"
 #include "common/file.h"
 #include "common/str.h"
@@ -39,6 +40,7 @@
 #include "common/rdft.h"
 #include "common/dct.h"
 #include "common/system.h"
+#include "common/config-manager.h"
 
 #include "graphics/yuv_to_rgb.h"
 #include "graphics/surface.h"
@@ -63,6 +65,10 @@ namespace Video {
 
 BinkDecoder::BinkDecoder() {
 	_bink = 0;
+
+	_decodeAhead = 0;
+	if (ConfMan.hasKey("bink_decode_ahead"))
+		_decodeAhead = MAX(ConfMan.getInt("bink_decode_ahead"), 0);
 }
 
 BinkDecoder::~BinkDecoder() {
@@ -141,6 +147,13 @@ bool BinkDecoder::loadStream(Common::SeekableReadStream *stream) {
 
 	_frames[frameCount - 1].size = _bink->size() - _frames[frameCount - 1].offset;
 
+	if (_decodeAhead > 0) {
+		// Hand the first packets to the decoding thread right away, so
+		// frames are ready before playback starts
+		if (((BinkVideoTrack *)getTrack(0))->startDecodeThread(_decodeAhead))
+			readNextPacket();
+	}
+
 	return true;
 }
 
@@ -157,11 +170,44 @@ void BinkDecoder::close() {
 void BinkDecoder::readNextPacket() {
 	BinkVideoTrack *videoTrack = (BinkVideoTrack *)getTrack(0);
 
+	if (videoTrack->isDecodingAhead()) {
+		// Keep up to _decodeAhead frames after the one on screen queued or
+		// decoded. The audio of these frames is queued early, which is fine
+		// as the audio stream is not tied to the frame on screen.
+		while (videoTrack->getQueuedPacketCount() < videoTrack->getFrameCount() &&
+				videoTrack->getQueuedPacketCount() - videoTrack->getCurFrame() <= (int)_decodeAhead) {
+			uint32 size = readAudioPackets(_frames[videoTrack->getQueuedPacketCount()]);
+
+			byte *data = (byte *)malloc(size);
+			if (!data || _bink->read(data, size) != size)
+				error("Bad bink read");
+
+			videoTrack->queuePacket(data, size);
+		}
+
+		return;
+	}
+
 	if (videoTrack->endOfTrack())
 		return;
 
 	VideoFrame &frame = _frames[videoTrack->getCurFrame() + 1];
 
+	uint32 frameSize = readAudioPackets(frame);
+
+	uint32 videoPacketStart = _bink->pos();
+	uint32 videoPacketEnd   = _bink->pos() + frameSize;
+
+	frame.bits = new Common::BitStream32LELSB(new Common::SeekableSubReadStream(_bink,
+			videoPacketStart, videoPacketEnd), true);
+
+	videoTrack->decodePacket(frame);
+
+	delete frame.bits;
+	frame.bits = 0;
+}
+
+uint32 BinkDecoder::readAudioPackets(const VideoFrame &frame) {
 	if (!_bink->seek(frame.offset))
 		error("Bad bink seek");
 
@@ -200,16 +246,7 @@ void BinkDecoder::readNextPacket() {
 		}
 	}
 
-	uint32 videoPacketStart = _bink->pos();
-	uint32 videoPacketEnd   = _bink->pos() + frameSize;
-
-	frame.bits = new Common::BitStream32LELSB(new Common::SeekableSubReadStream(_bink,
-			videoPacketStart, videoPacketEnd), true);
-
-	videoTrack->decodePacket(frame);
-
-	delete frame.bits;
-	frame.bits = 0;
+	return frameSize;
 }
 
 VideoDecoder::AudioTrack *BinkDecoder::getAudioTrack(int index) {
@@ -246,6 +283,16 @@ BinkDecoder::BinkVideoTrack::BinkVideoTrack(uint32 width, uint32 height, const G
 		_frameCount(frameCount), _frameRate(frameRate), _swapPlanes(swapPlanes), _hasAlpha(hasAlpha), _id(id) {
 	_curFrame = -1;
 
+	_stopDecoding = false;
+	_frameSurfaces = 0;
+	_frameSurfaceCount = 0;
+	_displayedSurface = -1;
+	_yuvLookup = 0;
+	_packets = 0;
+	_readyFrames = 0;
+	_freeFrames = 0;
+	_queuedPackets = 0;
+
 	for (int i = 0; i < 16; i++)
 		_huffman[i] = 0;
 
@@ -314,6 +361,8 @@ BinkDecoder::BinkVideoTrack::BinkVideoTrack(uint32 width, uint32 height, const G
 }
 
 BinkDecoder::BinkVideoTrack::~BinkVideoTrack() {
+	stopDecodeThread();
+
 	for (int i = 0; i < 4; i++) {
 		delete[] _curPlanes[i]; _curPlanes[i] = 0;
 		delete[] _oldPlanes[i]; _oldPlanes[i] = 0;
@@ -329,7 +378,140 @@ BinkDecoder::BinkVideoTrack::~BinkVideoTrack() {
 	_surface.free();
 }
 
+const Graphics::Surface *BinkDecoder::BinkVideoTrack::decodeNextFrame() {
+	if (!isDecodingAhead())
+		return &_surface;
+
+	// Nothing more was queued, so the last frame stays on screen
+	if (_curFrame + 1 >= _queuedPackets)
+		return _displayedSurface >= 0 ? &_frameSurfaces[_displayedSurface] : &_surface;
+
+	int ready;
+	while (!_readyFrames->pop(ready))
+		Common::Thread::sleep(1000);
+
+	if (_displayedSurface >= 0)
+		_freeFrames->push(_displayedSurface);
+	_displayedSurface = ready;
+
+	_curFrame++;
+
+	return &_frameSurfaces[ready];
+}
+
 void BinkDecoder::BinkVideoTrack::decodePacket(VideoFrame &frame) {
+	decodeFrame(frame, _surface);
+
+	_curFrame++;
+}
+
+bool BinkDecoder::BinkVideoTrack::startDecodeThread(uint frames) {
+	assert(!isDecodingAhead() && _curFrame == -1 && frames > 0);
+
+	if (!Common::Thread::isSupported()) {
+		warning("Threads are not supported, Bink frames are decoded when they are due");
+		return false;
+	}
+
+	// One frame is on screen, the others are queued or decoded ahead
+	_frameSurfaceCount = frames + 1;
+	_frameSurfaces = new Graphics::Surface[_frameSurfaceCount];
+	for (uint i = 0; i < _frameSurfaceCount; i++) {
+		_frameSurfaces[i].create(_surfaceWidth, _surfaceHeight, _surface.format);
+		_frameSurfaces[i].w = _surface.w;
+		_frameSurfaces[i].h = _surface.h;
+	}
+
+	uint capacity = 1;
+	while (capacity < _frameSurfaceCount)
+		capacity <<= 1;
+
+	_packets = new Common::SPSCQueue<Packet>(capacity);
+	_readyFrames = new Common::SPSCQueue<int>(capacity);
+	_freeFrames = new Common::SPSCQueue<int>(capacity);
+	for (uint i = 0; i < _frameSurfaceCount; i++)
+		_freeFrames->push(i);
+
+	// Created here, so that YUVToRGBMan is also created on the main thread
+	_yuvLookup = YUVToRGBMan.createLookup(_surface.format, Graphics::YUVToRGBManager::kScaleITU);
+
+	_stopDecoding = false;
+	if (!_decodeThread.start(decodeThreadProc, this)) {
+		warning("Failed to start the Bink decoding thread");
+		stopDecodeThread();
+		return false;
+	}
+
+	return true;
+}
+
+void BinkDecoder::BinkVideoTrack::stopDecodeThread() {
+	if (isDecodingAhead()) {
+		_stopDecoding = true;
+		_decodeThread.join();
+	}
+
+	if (_packets) {
+		Packet packet;
+		while (_packets->pop(packet))
+			free(packet.data);
+	}
+
+	delete _packets;
+	_packets = 0;
+	delete _readyFrames;
+	_readyFrames = 0;
+	delete _freeFrames;
+	_freeFrames = 0;
+
+	for (uint i = 0; i < _frameSurfaceCount; i++)
+		_frameSurfaces[i].free();
+
+	delete[] _frameSurfaces;
+	_frameSurfaces = 0;
+	_frameSurfaceCount = 0;
+	_displayedSurface = -1;
+
+	Graphics::YUVToRGBManager::destroyLookup(_yuvLookup);
+	_yuvLookup = 0;
+}
+
+void BinkDecoder::BinkVideoTrack::queuePacket(byte *data, uint32 size) {
+	Packet packet = { data, size };
+
+	// There is never more than one packet per frame surface in flight
+	bool queued = _packets->push(packet);
+	assert(queued);
+	(void)queued;
+
+	_queuedPackets++;
+}
+
+void BinkDecoder::BinkVideoTrack::decodeThreadProc(void *track) {
+	BinkVideoTrack *bink = (BinkVideoTrack *)track;
+
+	while (!bink->_stopDecoding) {
+		const Packet *packet = bink->_packets->peek();
+		int target;
+
+		if (!packet || !bink->_freeFrames->pop(target)) {
+			Common::Thread::sleep(1000);
+			continue;
+		}
+
+		// The bit stream frees the packet data along with the frame
+		VideoFrame frame;
+		frame.bits = new Common::BitStream32LELSB(new Common::MemoryReadStream(packet->data,
+				packet->size, DisposeAfterUse::YES), true);
+		bink->_packets->drop();
+
+		bink->decodeFrame(frame, bink->_frameSurfaces[target]);
+
+		bink->_readyFrames->push(target);
+	}
+}
+
+void BinkDecoder::BinkVideoTrack::decodeFrame(VideoFrame &frame, Graphics::Surface &surface) {
 	assert(frame.bits);
 
 	if (_hasAlpha) {
@@ -356,14 +538,16 @@ void BinkDecoder::BinkVideoTrack::decodePacket(VideoFrame &frame) {
 	// The width used here is the surface-width, and not the video-width
 	// to allow for odd-sized videos.
 	assert(_curPlanes[0] && _curPlanes[1] && _curPlanes[2]);
-	YUVToRGBMan.convert420(&_surface, Graphics::YUVToRGBManager::kScaleITU, _curPlanes[0], _curPlanes[1], _curPlanes[2],
-			_surfaceWidth, _surfaceHeight, _surfaceWidth, _surfaceWidth >> 1);
+	if (_yuvLookup)
+		YUVToRGBMan.convert420(&surface, _yuvLookup, _curPlanes[0], _curPlanes[1], _curPlanes[2],
+				_surfaceWidth, _surfaceHeight, _surfaceWidth, _surfaceWidth >> 1);
+	else
+		YUVToRGBMan.convert420(&surface, Graphics::YUVToRGBManager::kScaleITU, _curPlanes[0], _curPlanes[1], _curPlanes[2],
+				_surfaceWidth, _surfaceHeight, _surfaceWidth, _surfaceWidth >> 1);
 
 	// And swap the planes with the reference planes
 	for (int i = 0; i < 4; i++)
 		SWAP(_curPlanes[i], _oldPlanes[i]);
-
-	_curFrame++;
 }
 
 void BinkDecoder::BinkVideoTrack::decodePlane(VideoFrame &video, int planeIdx, bool isChroma) {
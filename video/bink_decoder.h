@@ -33,6 +33,8 @@
 
 #include "common/array.h"
 #include "common/rational.h"
+#include "common/spscqueue.h"
+#include "common/thread.h"
 
 #include "video/video_decoder.h"
 
@@ -54,6 +56,7 @@ class DCT;
 
 namespace Graphics {
 struct Surface;
+class YUVToRGBLookup;
 }
 
 namespace Video {
@@ -72,6 +75,14 @@ public:
 	bool loadStream(Common::SeekableReadStream *stream);
 	void close();
 
+	/**
+	 * Decode up to the given number of frames ahead of playback on a
+	 * separate thread, for videos loaded afterwards. 0 decodes every frame
+	 * when it is due. The default is taken from the "bink_decode_ahead"
+	 * config key.
+	 */
+	void setDecodeAhead(uint frames) { _decodeAhead = frames; }
+
 protected:
 	void readNextPacket();
 	bool supportsAudioTrackSwitching() const { return true; }
@@ -149,11 +160,28 @@ private:
 		Graphics::PixelFormat getPixelFormat() const { return _surface.format; }
 		int getCurFrame() const { return _curFrame; }
 		int getFrameCount() const { return _frameCount; }
-		const Graphics::Surface *decodeNextFrame() { return &_surface; }
+		const Graphics::Surface *decodeNextFrame();
 
 		/** Decode a video packet. */
 		void decodePacket(VideoFrame &frame);
 
+		/**
+		 * Start decoding the packets handed to queuePacket() on a separate
+		 * thread, keeping up to the given number of frames ready.
+		 */
+		bool startDecodeThread(uint frames);
+		/** Stop the decoding thread and drop the frames decoded ahead. */
+		void stopDecodeThread();
+		bool isDecodingAhead() const { return _decodeThread.isRunning(); }
+
+		/** The number of packets queued for the decoding thread so far. */
+		int getQueuedPacketCount() const { return _queuedPackets; }
+		/**
+		 * Queue the video data of the next frame for the decoding thread,
+		 * which takes ownership of the malloc()ed buffer.
+		 */
+		void queuePacket(byte *data, uint32 size);
+
 	protected:
 		Common::Rational getFrameRate() const { return _frameRate; }
 
@@ -257,6 +285,40 @@ private:
 		byte *_curPlanes[4]; ///< The 4 color planes, YUVA, current frame.
 		byte *_oldPlanes[4]; ///< The 4 color planes, YUVA, last frame.
 
+		/** The video data of a frame waiting for the decoding thread. */
+		struct Packet {
+			byte *data;
+			uint32 size;
+		};
+
+		Common::Thread _decodeThread;
+		volatile bool _stopDecoding;
+
+		/**
+		 * Frames decoded ahead. One of them is on screen, the others are
+		 * being decoded or waiting in _readyFrames.
+		 */
+		Graphics::Surface *_frameSurfaces;
+		uint _frameSurfaceCount;
+		int _displayedSurface; ///< Index of the frame on screen, or -1.
+
+		/**
+		 * The YUV to RGB lookup table of the decoding thread. The one of
+		 * YUVToRGBMan is replaced when other videos are converted on the
+		 * main thread.
+		 */
+		Graphics::YUVToRGBLookup *_yuvLookup;
+
+		Common::SPSCQueue<Packet> *_packets; ///< Packets, from the main to the decoding thread.
+		Common::SPSCQueue<int> *_readyFrames; ///< Decoded frames, from the decoding thread.
+		Common::SPSCQueue<int> *_freeFrames;  ///< Frames no longer on screen, to the decoding thread.
+		int _queuedPackets;
+
+		static void decodeThreadProc(void *track);
+
+		/** Decode a video packet into the given surface. */
+		void decodeFrame(VideoFrame &frame, Graphics::Surface &surface);
+
 		/** Initialize the bundles. */
 		void initBundles();
 		/** Deinitialize the bundles. */
@@ -352,7 +414,15 @@ private:
 	Common::Array<AudioInfo> _audioTracks; ///< All audio tracks.
 	Common::Array<VideoFrame> _frames;      ///< All video frames.
 
+	uint _decodeAhead; ///< Frames to decode ahead on a separate thread.
+
 	void initAudioTrack(AudioInfo &audio);
+
+	/**
+	 * Seek to a frame and decode its audio packets. Returns the size of the
+	 * video packet, which follows at the current stream position.
+	 */
+	uint32 readAudioPackets(const VideoFrame &frame);
 };
 
 } // End of namespace Video